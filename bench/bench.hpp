@@ -0,0 +1,85 @@
+// bench.hpp — minimal in-house micro-benchmark harness (no third-party dependencies)
+// Usage:
+//   #include "bench.hpp"
+//   tskv::bench::Result r = tskv::bench::run("lookup/map/1k", nops, [&] { ... nops lookups ... });
+//   tskv::bench::print(r);
+//
+// Notes:
+// - fn is expected to perform `ops` operations per call; results are reported in ns/op.
+// - fn is repeated until min_time has elapsed, keeping the fastest call (least noise).
+// - Use do_not_optimize() on results so the compiler cannot discard the measured work.
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string_view>
+
+namespace tskv::bench {
+
+using clock = std::chrono::steady_clock;
+
+template <class T>
+inline void do_not_optimize(const T& value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result {
+  std::string_view name;
+  std::size_t      ops       = 0;
+  std::size_t      calls     = 0;
+  double           ns_per_op = 0.0;
+};
+
+template <class Fn>
+Result run(std::string_view name,
+  std::size_t               ops,
+  Fn&&                      fn,
+  clock::duration           min_time = std::chrono::milliseconds(250))
+{
+  fn(); // warm-up: fault in pages, train predictors
+
+  double      best_ns = std::numeric_limits<double>::max();
+  std::size_t calls   = 0;
+
+  const auto deadline = clock::now() + min_time;
+  do {
+    const auto start = clock::now();
+    fn();
+    const auto stop = clock::now();
+
+    best_ns = std::min(best_ns, std::chrono::duration<double, std::nano>(stop - start).count());
+    ++calls;
+  } while (clock::now() < deadline);
+
+  return Result{name, ops, calls, best_ns / static_cast<double>(std::max<std::size_t>(ops, 1))};
+}
+
+inline void print(const Result& r)
+{
+  std::printf("%-40.*s %10.2f ns/op  (%zu ops x %zu calls)\n",
+    static_cast<int>(r.name.size()),
+    r.name.data(),
+    r.ns_per_op,
+    r.ops,
+    r.calls);
+}
+
+// Small, fast, deterministic PRNG for generating benchmark inputs.
+struct XorShift64 {
+  std::uint64_t state = 0x9E3779B97F4A7C15ull;
+
+  std::uint64_t next() noexcept
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+};
+
+} // namespace tskv::bench
@@ -0,0 +1,70 @@
+// Pipelined RX throughput of SimpleBuffer versus MirroredBuffer (and PooledBuffer, the channel
+// default, which compacts like SimpleBuffer but leases its block from a BufferPool).
+//
+// The buffer is refilled in bulk (as one large recv() would) and then drained one small frame at a
+// time (as a parser handling pipelined requests would). SimpleBuffer::consume memmoves the unread
+// tail on every frame, so its cost grows with the buffer size; MirroredBuffer::consume is O(1).
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+import tskv.common.buffer;
+
+namespace tb = tskv::bench;
+namespace tc = tskv::common;
+
+namespace {
+
+constexpr std::size_t FRAMES_PER_CALL = 1 << 15;
+
+template <tc::Buffer B>
+void drain_frames(B& buf, std::size_t frame_size, const std::vector<std::byte>& src)
+{
+  for (std::size_t i = 0; i < FRAMES_PER_CALL; ++i) {
+    if (buf.used_space() < frame_size) {
+      auto w = buf.writable_span();
+      std::memcpy(w.data(), src.data(), w.size());
+      buf.commit(w.size());
+    }
+
+    auto r = buf.readable_span(frame_size);
+    tb::do_not_optimize(r[0]);
+    buf.consume(r.size());
+  }
+}
+
+template <tc::Buffer B>
+void bench_buffer(const std::string& name, std::size_t frame_size)
+{
+  auto                   buf = std::make_unique<B>();
+  std::vector<std::byte> src(B::capacity(), std::byte{0x5A});
+
+  const std::string full_name =
+    name + "/" + std::to_string(B::capacity() / 1024) + "k/frame=" + std::to_string(frame_size);
+
+  tb::print(tb::run(full_name, FRAMES_PER_CALL, [&] { drain_frames(*buf, frame_size, src); }));
+}
+
+template <std::size_t BUFSIZE>
+void bench_size()
+{
+  for (const std::size_t frame_size : {16, 64, 512}) {
+    bench_buffer<tc::SimpleBuffer<BUFSIZE>>("pipeline/simple", frame_size);
+    bench_buffer<tc::MirroredBuffer<BUFSIZE>>("pipeline/mirrored", frame_size);
+    bench_buffer<tc::PooledBuffer<BUFSIZE>>("pipeline/pooled", frame_size);
+  }
+}
+
+} // namespace
+
+int main()
+{
+  bench_size<4 * 1024>();
+  bench_size<64 * 1024>();
+  return 0;
+}
@@ -0,0 +1,184 @@
+// Delimiter and length-line scanning (tskv.common.scan), per kernel set, over 64 KiB buffers of
+// pipelined requests as they would sit in RX.
+//
+// Cases (ns/op is per line, per length field or per command):
+//   - find_crlf/<isa>/<input>: walk every "\r\n" in the buffer; `resp` has short lines (pipelined
+//     SET commands), `lines` has ~80-byte line-protocol records, where the vector width pays off
+//   - int_line/<how>/<input>: read every *<n> / $<n> field; `resp` is the RESP buffer (1-2 digit
+//     lengths), `wide` has 10-16 digit values. `swar` is parse_int_line, `memchr+from_chars` is
+//     what the RESP parser did before, `digit_loop` the textbook loop (it does not validate)
+//     (end to end parser numbers are in bench_resp_pipeline's parse/* cases)
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench.hpp"
+
+import tskv.common.enum_traits;
+import tskv.common.scan;
+
+namespace tb = tskv::bench;
+namespace tc = tskv::common;
+
+namespace {
+
+constexpr std::size_t BUFFER_BYTES = 65536;
+
+std::span<const std::byte> as_bytes(std::string_view s)
+{
+  return {reinterpret_cast<const std::byte*>(s.data()), s.size()};
+}
+
+std::string resp_buffer()
+{
+  std::string out;
+  for (std::size_t i = 0; out.size() < BUFFER_BYTES - 128; ++i) {
+    char key[32];
+    std::snprintf(key, sizeof key, "series:%08zu", i);
+    out += "*3\r\n$3\r\nSET\r\n$15\r\n";
+    out += key;
+    out += "\r\n$32\r\n";
+    out += std::string(32, 'v');
+    out += "\r\n";
+  }
+  return out;
+}
+
+std::string line_buffer()
+{
+  tb::XorShift64 rng;
+  std::string    out;
+  while (out.size() < BUFFER_BYTES - 128) {
+    char line[128];
+    std::snprintf(line,
+      sizeof line,
+      "cpu,host=web-%02llu,region=eu-west usage_user=%llu.%02llu,usage_idle=%llu 17%011llu\r\n",
+      static_cast<unsigned long long>(rng.next() % 64),
+      static_cast<unsigned long long>(rng.next() % 100),
+      static_cast<unsigned long long>(rng.next() % 100),
+      static_cast<unsigned long long>(rng.next() % 100),
+      static_cast<unsigned long long>(rng.next() % 100'000'000'000));
+    out += line;
+  }
+  return out;
+}
+
+std::size_t count_lines(std::string_view s)
+{
+  std::size_t n = 0;
+  for (std::size_t pos = 0; (pos = s.find("\r\n", pos)) != std::string_view::npos; pos += 2) {
+    ++n;
+  }
+  return n;
+}
+
+// Offsets just past every '*' / '$' that starts a line (no key or value here starts with either).
+std::vector<std::size_t> length_fields(std::string_view s)
+{
+  std::vector<std::size_t> out;
+  for (std::size_t pos = 0; pos < s.size(); pos = s.find("\r\n", pos) + 2) {
+    if (s[pos] == '*' || s[pos] == '$') {
+      out.push_back(pos + 1);
+    }
+  }
+  return out;
+}
+
+constexpr tc::ScanIsa ISAS[] = {tc::ScanIsa::Scalar, tc::ScanIsa::Sse2, tc::ScanIsa::Avx2};
+
+bool supported(tc::ScanIsa isa) { return tc::scan_kernels(isa).isa == isa; }
+
+std::string case_name(std::string_view prefix, tc::ScanIsa isa, std::string_view suffix = {})
+{
+  return std::string(prefix) + "/" + std::string(tc::to_string(isa)) + std::string(suffix);
+}
+
+void bench_find_crlf(std::string_view input_name, const std::string& buffer)
+{
+  const std::size_t lines = count_lines(buffer);
+  for (const tc::ScanIsa isa : ISAS) {
+    if (!supported(isa)) {
+      continue;
+    }
+    const tc::ScanKernels& kernels = tc::scan_kernels(isa);
+    tb::print(tb::run(case_name("find_crlf", isa, "/" + std::string(input_name)), lines, [&] {
+      std::span<const std::byte> rest = as_bytes(buffer);
+      while (!rest.empty()) {
+        const std::size_t at = kernels.find_crlf(rest);
+        tb::do_not_optimize(at);
+        rest = rest.subspan(std::min(at + 2, rest.size()));
+      }
+    }));
+  }
+}
+
+// "$<n>\r\n" lines with 10 to 16 digit values (microsecond timestamps, large offsets).
+std::string wide_int_buffer()
+{
+  tb::XorShift64 rng;
+  std::string    out;
+  while (out.size() < BUFFER_BYTES - 128) {
+    const std::uint64_t digits = 10 + rng.next() % 7;
+    std::uint64_t       value  = 1;
+    for (std::uint64_t i = 1; i < digits; ++i) {
+      value *= 10;
+    }
+    out += "$" + std::to_string(value + rng.next() % value) + "\r\n";
+  }
+  return out;
+}
+
+void bench_int_line(std::string_view input_name, const std::string& buffer)
+{
+  const std::vector<std::size_t> fields = length_fields(buffer);
+  const std::string              suffix = "/" + std::string(input_name);
+
+  tb::print(tb::run("int_line/memchr+from_chars" + suffix, fields.size(), [&] {
+    for (const std::size_t pos : fields) {
+      const std::size_t window = std::min<std::size_t>(22, buffer.size() - pos);
+      const void*       cr     = std::memchr(buffer.data() + pos, '\r', window);
+      std::int64_t      value  = 0;
+      std::from_chars(buffer.data() + pos, static_cast<const char*>(cr), value);
+      tb::do_not_optimize(value);
+    }
+  }));
+
+  tb::print(tb::run("int_line/digit_loop" + suffix, fields.size(), [&] {
+    for (const std::size_t pos : fields) {
+      std::int64_t value = 0;
+      for (std::size_t i = pos; buffer[i] != '\r'; ++i) {
+        value = value * 10 + (buffer[i] - '0');
+      }
+      tb::do_not_optimize(value);
+    }
+  }));
+
+  tb::print(tb::run("int_line/swar" + suffix, fields.size(), [&] {
+    for (const std::size_t pos : fields) {
+      const tc::IntLine line = tc::parse_int_line(as_bytes(buffer).subspan(pos));
+      tb::do_not_optimize(line.value);
+    }
+  }));
+}
+
+} // namespace
+
+int main()
+{
+  const std::string resp  = resp_buffer();
+  const std::string lines = line_buffer();
+
+  bench_find_crlf("resp", resp);
+  bench_find_crlf("lines", lines);
+  bench_int_line("resp", resp);
+  bench_int_line("wide", wide_int_buffer());
+
+  return 0;
+}
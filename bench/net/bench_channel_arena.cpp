@@ -0,0 +1,180 @@
+// Event-dispatch cost of ChannelPool with its chunks on 4 KiB pages versus huge pages, at 10k /
+// 100k / 1M live connections.
+//
+// Each "dispatch" resolves one epoll tag to its Channel* and reads the channel's state, as
+// Reactor::poll_once does before handing the event over. Events are drawn uniformly at random over
+// the live fds, so once the pool outgrows the TLB's reach (a few MiB with 4 KiB pages) nearly every
+// dispatch pays a page walk; 2 MiB pages cover the same pool with a handful of entries.
+//
+// Besides ns/op, each case reports dTLB load misses per dispatch (perf_event_open; "n/a" where
+// the kernel or container does not allow it) and how much of the arena THP actually backed.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <linux/perf_event.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.hpp"
+
+import tskv.common.arena;
+import tskv.net.channel;
+
+namespace tb = tskv::bench;
+namespace tc = tskv::common;
+namespace tn = tskv::net;
+
+using Proto   = tn::EchoProtocol;
+using Channel = tn::Channel<Proto>;
+
+namespace {
+
+constexpr std::size_t EVENTS_PER_CALL = 1 << 16;
+
+// dTLB load-miss counter for this thread; valid() is false if perf events are unavailable.
+class DtlbMisses {
+  int fd_ = -1;
+
+public:
+  DtlbMisses()
+  {
+    perf_event_attr attr{};
+    attr.type   = PERF_TYPE_HW_CACHE;
+    attr.size   = sizeof attr;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  ~DtlbMisses()
+  {
+    if (fd_ != -1) {
+      ::close(fd_);
+    }
+  }
+
+  DtlbMisses(const DtlbMisses&)            = delete;
+  DtlbMisses& operator=(const DtlbMisses&) = delete;
+
+  [[nodiscard]] bool valid() const noexcept { return fd_ != -1; }
+
+  template <class Fn>
+  [[nodiscard]] std::uint64_t count(Fn&& fn)
+  {
+    ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+    ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    fn();
+    ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+
+    std::uint64_t value = 0;
+    if (::read(fd_, &value, sizeof value) != sizeof value) {
+      return 0;
+    }
+    return value;
+  }
+};
+
+// AnonHugePages of this process, in KiB (from /proc/self/smaps_rollup)
+std::size_t anon_huge_kib()
+{
+  std::ifstream in("/proc/self/smaps_rollup");
+  std::string   line;
+  while (std::getline(in, line)) {
+    std::size_t kib = 0;
+    if (std::sscanf(line.c_str(), "AnonHugePages: %zu kB", &kib) == 1) {
+      return kib;
+    }
+  }
+  return 0;
+}
+
+const char* to_string(tc::HugePages mode)
+{
+  switch (mode) {
+    case tc::HugePages::Off:
+      return "4k_pages";
+    case tc::HugePages::Transparent:
+      return "thp";
+    case tc::HugePages::Auto:
+      return "auto";
+  }
+  return "?";
+}
+
+void bench_dispatch(std::size_t nconns, tc::HugePages mode, DtlbMisses& dtlb)
+{
+  // the kernel hands out the lowest free fd; leave room for stdio, epoll, listener, etc.
+  constexpr int FIRST_FD = 8;
+
+  const std::size_t huge_before = anon_huge_kib();
+
+  tn::ChannelPool<Proto> pool({.huge_pages = mode});
+  pool.reserve_channels(nconns);
+
+  for (std::size_t i = 0; i < nconns; ++i) {
+    const int fd = FIRST_FD + static_cast<int>(i);
+    pool.acquire(fd)->attach(fd);
+  }
+
+  tb::XorShift64             rng;
+  std::vector<std::uint64_t> tags(EVENTS_PER_CALL);
+  for (std::uint64_t& tag : tags) {
+    tag = pool.event_tag(FIRST_FD + static_cast<int>(rng.next() % nconns));
+  }
+
+  const auto dispatch = [&] {
+    for (const std::uint64_t tag : tags) {
+      const Channel* ch = pool.lookup_tagged(tag);
+      tb::do_not_optimize(ch->desired_events());
+    }
+  };
+
+  const std::string name = std::string("dispatch/") + to_string(mode) + "/" +
+                           std::to_string(nconns / 1000) + "k";
+  tb::print(tb::run(name, EVENTS_PER_CALL, dispatch));
+
+  const tc::PageArena& arena = pool.arena();
+  std::printf("  arena=%zuMiB hugetlb_regions=%zu thp=%zuMiB numa_bound=%zu",
+    arena.mapped_bytes() >> 20,
+    arena.hugetlb_regions(),
+    (anon_huge_kib() - std::min(huge_before, anon_huge_kib())) >> 10,
+    arena.numa_bound_regions());
+  if (dtlb.valid()) {
+    const double misses = static_cast<double>(dtlb.count(dispatch));
+    std::printf(" dtlb_misses/op=%.3f\n", misses / EVENTS_PER_CALL);
+  }
+  else {
+    std::printf(" dtlb_misses/op=n/a\n");
+  }
+
+  for (std::size_t i = 0; i < nconns; ++i) {
+    const int fd = FIRST_FD + static_cast<int>(i);
+    pool.lookup(fd)->detach();
+    pool.release(fd);
+  }
+}
+
+} // namespace
+
+int main()
+{
+  std::printf("sizeof(Channel<EchoProtocol>) = %zu\n", sizeof(Channel));
+
+  DtlbMisses dtlb;
+  for (const std::size_t nconns : {10'000, 100'000, 1'000'000}) {
+    for (const tc::HugePages mode : {tc::HugePages::Off, tc::HugePages::Auto}) {
+      bench_dispatch(nconns, mode, dtlb);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,131 @@
+// Event-dispatch cost of ChannelPool (fd-indexed table + generation check) versus the previous
+// std::unordered_map<int, Handle> lookup, at 1k / 10k / 100k live connections.
+//
+// Each "dispatch" resolves one epoll tag to its Channel*, mirroring Reactor::poll_once. Events are
+// drawn uniformly at random over the live fds, so large pools are dominated by cache misses on
+// the lookup structure itself. The churn benchmark measures the release + acquire pair done by
+// every close/accept.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench.hpp"
+
+import tskv.net.channel;
+
+namespace tb = tskv::bench;
+namespace tn = tskv::net;
+
+using Proto   = tn::EchoProtocol;
+using Channel = tn::Channel<Proto>;
+
+namespace {
+
+constexpr std::size_t EVENTS_PER_CALL = 1 << 16;
+
+// The pre-table ChannelPool index, reproduced for comparison.
+struct MapIndex {
+  struct Handle {
+    void*    chunk   = nullptr;
+    Channel* channel = nullptr;
+  };
+
+  std::unordered_map<int, Handle> active;
+
+  explicit MapIndex(std::size_t nchannels)
+  {
+    active.max_load_factor(0.7);
+    active.reserve(5 * nchannels / 4);
+  }
+
+  [[nodiscard]] Channel* lookup(int fd) const noexcept
+  {
+    if (auto it = active.find(fd); it != active.end()) [[likely]] {
+      return it->second.channel;
+    }
+    return nullptr;
+  }
+};
+
+void bench_connections(std::size_t nconns)
+{
+  // the kernel hands out the lowest free fd; leave room for stdio, epoll, listener, etc.
+  constexpr int FIRST_FD = 8;
+
+  tn::ChannelPool<Proto> pool;
+  pool.reserve_channels(nconns);
+  MapIndex map(nconns);
+
+  for (std::size_t i = 0; i < nconns; ++i) {
+    const int fd = FIRST_FD + static_cast<int>(i);
+    Channel*  ch = pool.acquire(fd);
+    ch->attach(fd);
+    map.active.emplace(fd, MapIndex::Handle{nullptr, ch});
+  }
+
+  tb::XorShift64             rng;
+  std::vector<std::uint64_t> tags(EVENTS_PER_CALL);
+  std::vector<int>           fds(EVENTS_PER_CALL);
+  for (std::size_t i = 0; i < EVENTS_PER_CALL; ++i) {
+    fds[i]  = FIRST_FD + static_cast<int>(rng.next() % nconns);
+    tags[i] = pool.event_tag(fds[i]);
+  }
+
+  const std::string suffix = "/" + std::to_string(nconns / 1000) + "k";
+
+  const std::string map_name = "dispatch/unordered_map" + suffix;
+  tb::print(tb::run(map_name, EVENTS_PER_CALL, [&] {
+    for (const int fd : fds) {
+      tb::do_not_optimize(map.lookup(fd));
+    }
+  }));
+
+  const std::string table_name = "dispatch/fd_table" + suffix;
+  tb::print(tb::run(table_name, EVENTS_PER_CALL, [&] {
+    for (const std::uint64_t tag : tags) {
+      tb::do_not_optimize(pool.lookup_tagged(tag));
+    }
+  }));
+
+  // close + accept on the same fd number, as happens under connection churn
+  constexpr std::size_t CHURN_PER_CALL = 1 << 12;
+
+  const std::string map_churn_name = "churn/unordered_map" + suffix;
+  tb::print(tb::run(map_churn_name, CHURN_PER_CALL, [&] {
+    for (std::size_t i = 0; i < CHURN_PER_CALL; ++i) {
+      const int fd = fds[i];
+      auto      it = map.active.find(fd);
+      const auto h = it->second;
+      map.active.erase(it);
+      map.active.emplace(fd, h);
+    }
+  }));
+
+  const std::string table_churn_name = "churn/fd_table" + suffix;
+  tb::print(tb::run(table_churn_name, CHURN_PER_CALL, [&] {
+    for (std::size_t i = 0; i < CHURN_PER_CALL; ++i) {
+      const int fd = fds[i];
+      pool.release(fd);
+      tb::do_not_optimize(pool.acquire(fd));
+    }
+  }));
+
+  for (std::size_t i = 0; i < nconns; ++i) {
+    const int fd = FIRST_FD + static_cast<int>(i);
+    pool.lookup(fd)->detach();
+    pool.release(fd);
+  }
+}
+
+} // namespace
+
+int main()
+{
+  for (const std::size_t nconns : {1'000, 10'000, 100'000}) {
+    bench_connections(nconns);
+  }
+  return 0;
+}
@@ -0,0 +1,184 @@
+// Cross-thread round trip through CompletionQueue: a "reactor" thread hands requests to worker
+// threads and sleeps in epoll_wait until their responses come back, as Reactor does for channels
+// that use ChannelIO::completion_target().
+//
+// Cases:
+//   - pingpong: one request in flight, so every response costs the reactor a wakeup; this is the
+//     latency of post -> eventfd -> wakeup -> drain, in both directions
+//   - pipelined/<workers>w/<depth>: `depth` requests in flight, spread round-robin over the
+//     workers; responses that arrive while the reactor is still busy share its next wakeup
+//
+// Pipelined cases also run with an eventfd write per response (what a queue without coalescing
+// would do) for comparison. Besides ns/op, each case reports per request the eventfd writes done
+// by the workers and the epoll_wait wakeups taken by the reactor.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <poll.h>
+#include <string>
+#include <sys/epoll.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.hpp"
+
+import tskv.net.completion_queue;
+
+namespace tb = tskv::bench;
+namespace tn = tskv::net;
+
+namespace {
+
+constexpr std::size_t REQUESTS_PER_CALL = 20'000;
+
+enum class Wake : std::uint8_t { Coalesced, EveryPost };
+
+class Harness {
+  static constexpr std::uint64_t STOP = UINT64_MAX;
+
+  struct Worker {
+    tn::CompletionQueue        inbox;
+    std::thread                thread;
+    std::atomic<std::uint64_t> eventfd_writes{0}; // single writer
+  };
+
+  tn::CompletionQueue                  replies_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  Wake                                 wake_;
+  int                                  epoll_fd_ = -1;
+  std::uint64_t                        wakeups_  = 0;
+
+  void reply(Worker& worker, std::uint64_t tag)
+  {
+    if (replies_.post(tag, tn::TxSegment{})) {
+      worker.eventfd_writes.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (wake_ == Wake::EveryPost) {
+      const std::uint64_t one = 1;
+      (void)::write(replies_.wakeup_fd(), &one, sizeof one);
+      worker.eventfd_writes.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void worker_loop(Worker& worker)
+  {
+    for (bool stop = false; !stop;) {
+      pollfd pfd{.fd = worker.inbox.wakeup_fd(), .events = POLLIN, .revents = 0};
+      (void)::poll(&pfd, 1, -1);
+
+      worker.inbox.drain([&](tn::Completion& request) {
+        if (request.tag == STOP) {
+          stop = true;
+        }
+        else {
+          reply(worker, request.tag);
+        }
+      });
+    }
+  }
+
+public:
+  Harness(std::size_t nworkers, Wake wake) : wake_(wake)
+  {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev{.events = EPOLLIN, .data = {.u64 = 0}};
+    (void)epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, replies_.wakeup_fd(), &ev);
+
+    for (std::size_t i = 0; i < nworkers; ++i) {
+      workers_.push_back(std::make_unique<Worker>());
+      Worker& worker = *workers_.back();
+      worker.thread  = std::thread([this, &worker] { worker_loop(worker); });
+    }
+  }
+
+  ~Harness()
+  {
+    for (auto& worker : workers_) {
+      (void)worker->inbox.post(STOP, tn::TxSegment{});
+      worker->thread.join();
+    }
+    ::close(epoll_fd_);
+  }
+
+  Harness(const Harness&)            = delete;
+  Harness& operator=(const Harness&) = delete;
+
+  // Issue `total` requests with at most `depth` in flight; returns once all are answered.
+  void run(std::size_t total, std::size_t depth)
+  {
+    std::size_t issued   = 0;
+    std::size_t answered = 0;
+
+    const auto issue = [&] {
+      Worker& worker = *workers_[issued % workers_.size()];
+      (void)worker.inbox.post(issued, tn::TxSegment{});
+      ++issued;
+    };
+
+    while (issued < std::min(depth, total)) {
+      issue();
+    }
+
+    while (answered < total) {
+      epoll_event ev;
+      if (epoll_wait(epoll_fd_, &ev, 1, -1) != 1) {
+        continue;
+      }
+      ++wakeups_;
+
+      answered += replies_.drain([&](tn::Completion&) {
+        if (issued < total) {
+          issue();
+        }
+      });
+    }
+  }
+
+  [[nodiscard]] std::uint64_t wakeups() const noexcept { return wakeups_; }
+
+  [[nodiscard]] std::uint64_t eventfd_writes() const noexcept
+  {
+    std::uint64_t total = 0;
+    for (const auto& worker : workers_) {
+      total += worker->eventfd_writes.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+};
+
+void bench_case(const std::string& name, std::size_t nworkers, std::size_t depth, Wake wake)
+{
+  Harness harness(nworkers, wake);
+
+  const tb::Result r =
+    tb::run(name, REQUESTS_PER_CALL, [&] { harness.run(REQUESTS_PER_CALL, depth); });
+  tb::print(r);
+
+  // run() also made one warm-up call
+  const double requests = static_cast<double>((r.calls + 1) * REQUESTS_PER_CALL);
+  std::printf("  eventfd_writes/req=%.3f wakeups/req=%.3f\n",
+    static_cast<double>(harness.eventfd_writes()) / requests,
+    static_cast<double>(harness.wakeups()) / requests);
+}
+
+} // namespace
+
+int main()
+{
+  bench_case("roundtrip/pingpong", 1, 1, Wake::Coalesced);
+
+  for (const std::size_t nworkers : {1, 4}) {
+    for (const std::size_t depth : {16, 256}) {
+      const std::string base = "roundtrip/pipelined/" + std::to_string(nworkers) + "w/" +
+                               std::to_string(depth);
+      bench_case(base + "/coalesced", nworkers, depth, Wake::Coalesced);
+      bench_case(base + "/every_post", nworkers, depth, Wake::EveryPost);
+    }
+  }
+  return 0;
+}
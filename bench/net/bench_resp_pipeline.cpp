@@ -0,0 +1,228 @@
+// RESP request handling: the parser alone, then pipelined GET/SET through a live
+// Reactor<RespProtocol> over loopback TCP.
+//
+// Cases:
+//   - parse/<cmd>: parse_resp_command over a 64 KiB buffer of pipelined commands; ns/op is per
+//     command
+//   - pipeline/<cmd>/depth=<n>: the client writes n commands, then reads the n replies; ns/op is
+//     per command, so depth=1 is the round-trip latency and deeper pipelines show what batching
+//     replies into one TX flush buys
+
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <latch>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.hpp"
+#include "tskv/common/logging.hpp"
+
+import tskv.common.logging;
+import tskv.net.reactor;
+import tskv.net.resp;
+import tskv.net.server;
+import tskv.storage.engine;
+
+namespace tb = tskv::bench;
+namespace tn = tskv::net;
+namespace ts = tskv::storage;
+
+namespace {
+
+constexpr std::size_t NKEYS           = 10'000;
+constexpr std::size_t PIPELINE_ROUNDS = 20'000; // commands per measured call
+
+std::string command(std::initializer_list<std::string_view> args)
+{
+  std::string out = "*" + std::to_string(args.size()) + "\r\n";
+  for (const std::string_view arg : args) {
+    out += "$" + std::to_string(arg.size()) + "\r\n";
+    out += arg;
+    out += "\r\n";
+  }
+  return out;
+}
+
+std::string key(std::size_t i)
+{
+  char buf[32];
+  std::snprintf(buf, sizeof buf, "series:%08zu", i % NKEYS);
+  return buf;
+}
+
+using MakeCommand = std::string (*)(std::size_t);
+
+std::string get_command(std::size_t i) { return command({"GET", key(i)}); }
+std::string set_command(std::size_t i) { return command({"SET", key(i), std::string(32, 'v')}); }
+
+// Reactor on its own thread until destroyed.
+class Server {
+  std::unique_ptr<tn::Reactor<tn::RespProtocol>> reactor_;
+  std::jthread                                   thread_;
+
+public:
+  explicit Server(const tn::ServerConfig& config)
+  {
+    std::latch ready(1);
+    thread_ = std::jthread([&] {
+      reactor_ = std::make_unique<tn::Reactor<tn::RespProtocol>>(config, false);
+      ready.count_down();
+      reactor_->run();
+    });
+    ready.wait();
+  }
+
+  ~Server()
+  {
+    reactor_->notify_shutdown();
+    thread_.join();
+  }
+
+  Server(const Server&)            = delete;
+  Server& operator=(const Server&) = delete;
+};
+
+std::uint16_t free_tcp_port()
+{
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  const int fd  = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  socklen_t len = sizeof addr;
+  (void)bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr);
+  (void)getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+  ::close(fd);
+  return ntohs(addr.sin_port);
+}
+
+int connect_to(std::uint16_t port)
+{
+  const int   fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == -1) {
+    std::perror("connect");
+    std::exit(1);
+  }
+  const int yes = 1;
+  (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+  return fd;
+}
+
+void write_all(int fd, std::string_view data)
+{
+  while (!data.empty()) {
+    const ssize_t w = ::write(fd, data.data(), data.size());
+    if (w <= 0) {
+      std::perror("write");
+      std::exit(1);
+    }
+    data.remove_prefix(static_cast<std::size_t>(w));
+  }
+}
+
+// Reads until `n` more replies have arrived. Every reply in a case has the same size, so counting
+// bytes is enough.
+void read_replies(int fd, std::size_t n, std::size_t reply_size, std::vector<char>& buf)
+{
+  std::size_t want = n * reply_size;
+  while (want > 0) {
+    const ssize_t r = ::read(fd, buf.data(), std::min(buf.size(), want));
+    if (r <= 0) {
+      std::perror("read");
+      std::exit(1);
+    }
+    want -= static_cast<std::size_t>(r);
+  }
+}
+
+void bench_parse(const std::string& name, MakeCommand make)
+{
+  std::string buffer;
+  std::size_t ncommands = 0;
+  while (buffer.size() < 65536 - 64) {
+    buffer += make(ncommands++);
+  }
+
+  std::vector<std::string_view> argv;
+  tb::print(tb::run(name, ncommands, [&] {
+    std::string_view rest = buffer;
+    while (!rest.empty()) {
+      const tn::RespParse parsed = tn::parse_resp_command(rest, argv, 65536);
+      tb::do_not_optimize(argv.data());
+      rest.remove_prefix(parsed.size);
+    }
+  }));
+}
+
+void bench_pipeline(const std::string& name,
+  int                                  fd,
+  MakeCommand                          make,
+  std::size_t                          reply_size,
+  std::size_t                          depth)
+{
+  std::vector<std::string> batches(16);
+  for (std::size_t b = 0; b < batches.size(); ++b) {
+    for (std::size_t i = 0; i < depth; ++i) {
+      batches[b] += make(b * depth + i);
+    }
+  }
+  std::vector<char> buf(1 << 20);
+
+  const std::size_t rounds = PIPELINE_ROUNDS / depth;
+  tb::print(tb::run(name, rounds * depth, [&] {
+    for (std::size_t r = 0; r < rounds; ++r) {
+      write_all(fd, batches[r % batches.size()]);
+      read_replies(fd, depth, reply_size, buf);
+    }
+  }));
+}
+
+} // namespace
+
+int main()
+{
+  TSKV_SET_LOG_LEVEL(Warn);
+
+  bench_parse("parse/get", get_command);
+  bench_parse("parse/set", set_command);
+
+  ts::Engine engine;
+  for (std::size_t i = 0; i < NKEYS; ++i) {
+    engine.put(key(i), std::string(32, 'v'));
+  }
+  tn::RespProtocol::bind_engine(&engine);
+
+  tn::ServerConfig config;
+  config.host            = "127.0.0.1";
+  config.port            = free_tcp_port();
+  config.idle_timeout_ms = 0;
+
+  const Server server(config);
+  const int    fd = connect_to(config.port);
+
+  constexpr std::size_t SET_REPLY = 5;  // +OK\r\n
+  constexpr std::size_t GET_REPLY = 39; // $32\r\n<32 bytes>\r\n
+
+  for (const std::size_t depth : {1, 16, 128}) {
+    const std::string suffix = "/depth=" + std::to_string(depth);
+    bench_pipeline("pipeline/set" + suffix, fd, set_command, SET_REPLY, depth);
+    bench_pipeline("pipeline/get" + suffix, fd, get_command, GET_REPLY, depth);
+  }
+
+  ::close(fd);
+  return 0;
+}
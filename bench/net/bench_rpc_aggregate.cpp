@@ -0,0 +1,277 @@
+// Time-bucketed aggregation (tskv.net.rpc Aggregate) against pulling the raw points with Scan and
+// folding them on the client, over one series of 1M points (one per second, ~11.5 days). The
+// engine is driven directly first, then through a live Reactor<RpcProtocol> over loopback TCP.
+//
+// Cases (ns/op is per point covered, so the cases compare directly):
+//   - engine/aggregate/width=<s>: Engine::aggregate alone, all five functions
+//   - rpc/scan+fold: every point crosses the socket as a ScanBatch entry and the client buckets
+//     it (width 60)
+//   - rpc/aggregate/width=<s>: only bucket results cross the socket
+// After each rpc case the bytes received per query are printed.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <latch>
+#include <map>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <span>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.hpp"
+#include "tskv/common/logging.hpp"
+
+import tskv.common.logging;
+import tskv.net.frame;
+import tskv.net.reactor;
+import tskv.net.rpc;
+import tskv.net.server;
+import tskv.storage.engine;
+import tskv.storage.series;
+
+namespace tb = tskv::bench;
+namespace tn = tskv::net;
+namespace ts = tskv::storage;
+
+namespace {
+
+constexpr std::int64_t NPOINTS  = 1'000'000;
+constexpr std::int64_t WIDTHS[] = {60, 3600};
+
+// Reactor on its own thread until destroyed.
+class Server {
+  std::unique_ptr<tn::Reactor<tn::RpcProtocol>> reactor_;
+  std::jthread                                  thread_;
+
+public:
+  explicit Server(const tn::ServerConfig& config)
+  {
+    std::latch ready(1);
+    thread_ = std::jthread([&] {
+      reactor_ = std::make_unique<tn::Reactor<tn::RpcProtocol>>(config, false);
+      ready.count_down();
+      reactor_->run();
+    });
+    ready.wait();
+  }
+
+  ~Server()
+  {
+    reactor_->notify_shutdown();
+    thread_.join();
+  }
+
+  Server(const Server&)            = delete;
+  Server& operator=(const Server&) = delete;
+};
+
+std::uint16_t free_tcp_port()
+{
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  const int fd  = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  socklen_t len = sizeof addr;
+  (void)bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr);
+  (void)getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+  ::close(fd);
+  return ntohs(addr.sin_port);
+}
+
+int connect_to(std::uint16_t port)
+{
+  const int   fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == -1) {
+    std::perror("connect");
+    std::exit(1);
+  }
+  const int yes = 1;
+  (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+  return fd;
+}
+
+void write_all(int fd, std::span<const std::byte> data)
+{
+  while (!data.empty()) {
+    const ssize_t w = ::write(fd, data.data(), data.size());
+    if (w <= 0) {
+      std::perror("write");
+      std::exit(1);
+    }
+    data = data.subspan(static_cast<std::size_t>(w));
+  }
+}
+
+std::vector<std::byte> frame(
+  tn::FrameType type, std::uint32_t id, std::span<const std::byte> payload)
+{
+  std::vector<std::byte> out(tn::FRAME_HEADER_SIZE + payload.size());
+  tn::encode_frame_header({type, 0, static_cast<std::uint32_t>(payload.size()), id},
+    std::span(out).first<tn::FRAME_HEADER_SIZE>());
+  std::ranges::copy(payload, out.begin() + tn::FRAME_HEADER_SIZE);
+  return out;
+}
+
+// Reads the frames of one streamed response up to the one flagged END, calling on_frame(payload)
+// for each and answering every ScanBatch with a credit. Returns the bytes received.
+template <typename Fn>
+std::size_t read_stream(int fd, std::vector<std::byte>& rx, Fn&& on_frame)
+{
+  std::vector<std::byte> credit_payload;
+  tn::append_u32(credit_payload, 1);
+  const std::vector<std::byte> credit = frame(tn::FrameType::ScanCredit, 1, credit_payload);
+
+  std::size_t received = 0;
+  std::size_t have     = 0;
+  for (;;) {
+    const ssize_t r = ::read(fd, rx.data() + have, rx.size() - have);
+    if (r <= 0) {
+      std::perror("read");
+      std::exit(1);
+    }
+    have += static_cast<std::size_t>(r);
+    received += static_cast<std::size_t>(r);
+
+    std::size_t offset = 0;
+    for (;;) {
+      const tn::FrameParse parsed =
+        tn::parse_frame(std::span(rx).subspan(offset, have - offset), rx.size());
+      if (parsed.status != tn::FrameStatus::Complete) {
+        break;
+      }
+      offset += parsed.size;
+      on_frame(parsed.frame.payload);
+      if (parsed.frame.header.flags & tn::FRAME_FLAG_END) {
+        return received;
+      }
+      if (parsed.frame.header.type == tn::FrameType::ScanBatch) {
+        write_all(fd, credit);
+      }
+    }
+    std::copy(rx.begin() + static_cast<std::ptrdiff_t>(offset),
+      rx.begin() + static_cast<std::ptrdiff_t>(have),
+      rx.begin());
+    have -= offset;
+  }
+}
+
+void bench_engine(const ts::Engine& engine)
+{
+  for (const std::int64_t width : WIDTHS) {
+    const std::string name = "engine/aggregate/width=" + std::to_string(width);
+    tb::print(tb::run(name, NPOINTS, [&] {
+      const auto          sink = [](const ts::BucketAggregate& b) { tb::do_not_optimize(b.sum); };
+      ts::BucketAggregate open;
+      const auto          next =
+        engine.aggregate("cpu", 0, NPOINTS, width, SIZE_MAX, SIZE_MAX, open, sink);
+      tb::do_not_optimize(next);
+    }));
+  }
+}
+
+void bench_scan(int fd, std::vector<std::byte>& rx)
+{
+  std::vector<std::byte> payload;
+  const std::string      first = ts::point_key("cpu", 0);
+  const std::string      last  = ts::point_key("cpu", NPOINTS);
+  tn::append_u32(payload, static_cast<std::uint32_t>(first.size()));
+  tn::append_bytes(payload, first);
+  tn::append_u32(payload, static_cast<std::uint32_t>(last.size()));
+  tn::append_bytes(payload, last);
+  tn::append_u32(payload, 16);
+  const std::vector<std::byte> request = frame(tn::FrameType::Scan, 1, payload);
+
+  std::size_t bytes = 0;
+  tb::print(tb::run("rpc/scan+fold", NPOINTS, [&] {
+    std::map<std::int64_t, ts::BucketAggregate> buckets;
+    write_all(fd, request);
+    bytes = read_stream(fd, rx, [&](std::span<const std::byte> batch) {
+      tn::PayloadReader in(batch);
+      for (std::uint32_t n = in.u32(); n > 0; --n) {
+        const std::uint32_t klen  = in.u32();
+        const std::uint32_t vlen  = in.u32();
+        const auto          point = ts::parse_point_key(in.bytes(klen));
+        const auto          start = ts::bucket_start(point->timestamp, WIDTHS[0]);
+        buckets[start].add(*ts::decode_sample(in.bytes(vlen)));
+      }
+    });
+    tb::do_not_optimize(buckets.size());
+  }));
+  std::printf("  %zu bytes received per query\n", bytes);
+}
+
+void bench_aggregate(int fd, std::vector<std::byte>& rx)
+{
+  for (const std::int64_t width : WIDTHS) {
+    std::vector<std::byte> payload;
+    tn::append_u32(payload, 3);
+    tn::append_bytes(payload, "cpu");
+    tn::append_u64(payload, 0);
+    tn::append_u64(payload, NPOINTS);
+    tn::append_u64(payload, static_cast<std::uint64_t>(width));
+    tn::append_u32(payload, ts::AGGREGATE_FNS_ALL);
+    const std::vector<std::byte> request = frame(tn::FrameType::Aggregate, 1, payload);
+
+    std::size_t       bytes = 0;
+    const std::string name  = "rpc/aggregate/width=" + std::to_string(width);
+    tb::print(tb::run(name, NPOINTS, [&] {
+      write_all(fd, request);
+      bytes = read_stream(fd, rx, [](std::span<const std::byte> batch) {
+        tb::do_not_optimize(batch.data());
+      });
+    }));
+    std::printf("  %zu bytes received per query\n", bytes);
+  }
+}
+
+} // namespace
+
+int main()
+{
+  TSKV_SET_LOG_LEVEL(Warn);
+
+  ts::Engine  engine;
+  std::string key;
+  std::string value;
+  for (std::int64_t t = 0; t < NPOINTS; ++t) {
+    ts::point_key(key, "cpu", t);
+    ts::encode_sample(value, static_cast<double>(t % 100));
+    engine.put(key, value);
+  }
+  bench_engine(engine);
+
+  tn::RpcProtocol::bind_engine(&engine);
+
+  tn::ServerConfig config;
+  config.host            = "127.0.0.1";
+  config.port            = free_tcp_port();
+  config.idle_timeout_ms = 0;
+
+  {
+    const Server server(config);
+    const int    fd = connect_to(config.port);
+
+    std::vector<std::byte> rx(2 * tn::RpcProtocol::SCAN_BATCH_BYTES);
+    bench_scan(fd, rx);
+    bench_aggregate(fd, rx);
+
+    ::close(fd);
+  }
+
+  tn::RpcProtocol::bind_engine(nullptr);
+  return 0;
+}
@@ -0,0 +1,250 @@
+// Batched MGet/MPut frames (tskv.net.rpc), per batch size: the engine alone, then one batch
+// frame per round trip through a live Reactor<RpcProtocol> over loopback TCP. The engine logs to
+// a WAL in a scratch directory (WALSyncPolicy::Append), as the server's does.
+//
+// Cases (ns/op is per key or point, so the sizes compare directly):
+//   - engine/put/batch=<n>: n points through Engine::put_batch (one WAL write and one lock per
+//     batch); batch=1 is what n separate put() calls cost
+//   - rpc/mput/batch=<n>, rpc/mget/batch=<n>: the client writes one frame of n points (or keys)
+//     and waits for its result frame; batch=1 is the per-key round trip that batching amortizes
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <latch>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.hpp"
+#include "tskv/common/logging.hpp"
+
+import tskv.common.logging;
+import tskv.net.frame;
+import tskv.net.reactor;
+import tskv.net.rpc;
+import tskv.net.server;
+import tskv.storage.engine;
+import tskv.storage.memtable;
+import tskv.storage.wal;
+
+namespace fs = std::filesystem;
+namespace tb = tskv::bench;
+namespace tn = tskv::net;
+namespace ts = tskv::storage;
+
+namespace {
+
+constexpr std::size_t NKEYS         = 10'000;
+constexpr std::size_t VALUE_BYTES   = 32;
+constexpr std::size_t ROUND_POINTS  = 16'384; // points (or keys) per measured call
+constexpr std::size_t BATCH_SIZES[] = {1, 8, 64, 512};
+
+std::string key(std::size_t i)
+{
+  char buf[32];
+  std::snprintf(buf, sizeof buf, "series:%08zu", i % NKEYS);
+  return buf;
+}
+
+// Reactor on its own thread until destroyed.
+class Server {
+  std::unique_ptr<tn::Reactor<tn::RpcProtocol>> reactor_;
+  std::jthread                                  thread_;
+
+public:
+  explicit Server(const tn::ServerConfig& config)
+  {
+    std::latch ready(1);
+    thread_ = std::jthread([&] {
+      reactor_ = std::make_unique<tn::Reactor<tn::RpcProtocol>>(config, false);
+      ready.count_down();
+      reactor_->run();
+    });
+    ready.wait();
+  }
+
+  ~Server()
+  {
+    reactor_->notify_shutdown();
+    thread_.join();
+  }
+
+  Server(const Server&)            = delete;
+  Server& operator=(const Server&) = delete;
+};
+
+std::uint16_t free_tcp_port()
+{
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  const int fd  = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  socklen_t len = sizeof addr;
+  (void)bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr);
+  (void)getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+  ::close(fd);
+  return ntohs(addr.sin_port);
+}
+
+int connect_to(std::uint16_t port)
+{
+  const int   fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == -1) {
+    std::perror("connect");
+    std::exit(1);
+  }
+  const int yes = 1;
+  (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+  return fd;
+}
+
+void write_all(int fd, std::span<const std::byte> data)
+{
+  while (!data.empty()) {
+    const ssize_t w = ::write(fd, data.data(), data.size());
+    if (w <= 0) {
+      std::perror("write");
+      std::exit(1);
+    }
+    data = data.subspan(static_cast<std::size_t>(w));
+  }
+}
+
+void read_exactly(int fd, std::size_t n, std::vector<std::byte>& buf)
+{
+  while (n > 0) {
+    const ssize_t r = ::read(fd, buf.data(), std::min(buf.size(), n));
+    if (r <= 0) {
+      std::perror("read");
+      std::exit(1);
+    }
+    n -= static_cast<std::size_t>(r);
+  }
+}
+
+std::vector<std::byte> batch_frame(tn::FrameType type, std::size_t first, std::size_t n)
+{
+  const std::string value(VALUE_BYTES, 'v');
+
+  std::vector<std::byte> frame(tn::FRAME_HEADER_SIZE);
+  tn::append_u32(frame, static_cast<std::uint32_t>(n));
+  for (std::size_t i = first; i < first + n; ++i) {
+    const std::string k = key(i);
+    tn::append_u32(frame, static_cast<std::uint32_t>(k.size()));
+    if (type == tn::FrameType::MPut) {
+      tn::append_u32(frame, static_cast<std::uint32_t>(value.size()));
+    }
+    tn::append_bytes(frame, k);
+    if (type == tn::FrameType::MPut) {
+      tn::append_bytes(frame, value);
+    }
+  }
+  const auto length = static_cast<std::uint32_t>(frame.size() - tn::FRAME_HEADER_SIZE);
+  tn::encode_frame_header({type, 0, length, 1}, std::span(frame).first<tn::FRAME_HEADER_SIZE>());
+  return frame;
+}
+
+void bench_engine(const fs::path& dir, std::size_t batch)
+{
+  ts::Engine engine(dir, ts::WALSyncPolicy::Append);
+
+  const std::string        value(VALUE_BYTES, 'v');
+  std::vector<std::string> keys;
+  for (std::size_t i = 0; i < ROUND_POINTS; ++i) {
+    keys.push_back(key(i));
+  }
+  std::vector<ts::KeyValue> points;
+  for (const std::string& k : keys) {
+    points.push_back({k, value});
+  }
+
+  const std::string name = "engine/put/batch=" + std::to_string(batch);
+  tb::print(tb::run(name, ROUND_POINTS, [&] {
+    for (std::size_t i = 0; i < ROUND_POINTS; i += batch) {
+      tb::do_not_optimize(engine.put_batch(std::span(points).subspan(i, batch)));
+    }
+  }));
+}
+
+void bench_rpc(int fd, tn::FrameType type, std::size_t batch)
+{
+  std::vector<std::vector<std::byte>> frames;
+  for (std::size_t first = 0; first < NKEYS; first += batch) {
+    frames.push_back(batch_frame(type, first, batch));
+  }
+
+  // every key exists, so an MGet result always has the same size
+  const std::size_t result_size = type == tn::FrameType::MPut
+                                    ? tn::FRAME_HEADER_SIZE + 4
+                                    : tn::FRAME_HEADER_SIZE + 4 + batch * (4 + VALUE_BYTES);
+  std::vector<std::byte> buf(1 << 20);
+
+  const std::string name = std::string(type == tn::FrameType::MPut ? "rpc/mput" : "rpc/mget") +
+                           "/batch=" + std::to_string(batch);
+  const std::size_t rounds = ROUND_POINTS / batch;
+  tb::print(tb::run(name, rounds * batch, [&] {
+    for (std::size_t r = 0; r < rounds; ++r) {
+      write_all(fd, frames[r % frames.size()]);
+      read_exactly(fd, result_size, buf);
+    }
+  }));
+}
+
+} // namespace
+
+int main()
+{
+  TSKV_SET_LOG_LEVEL(Warn);
+
+  const fs::path dir =
+    fs::temp_directory_path() / ("tskv-bench-rpc-batch-" + std::to_string(::getpid()));
+
+  for (const std::size_t batch : BATCH_SIZES) {
+    fs::remove_all(dir);
+    bench_engine(dir, batch);
+  }
+
+  fs::remove_all(dir);
+  ts::Engine engine(dir, ts::WALSyncPolicy::Append);
+  tn::RpcProtocol::bind_engine(&engine);
+
+  tn::ServerConfig config;
+  config.host            = "127.0.0.1";
+  config.port            = free_tcp_port();
+  config.idle_timeout_ms = 0;
+
+  {
+    const Server server(config);
+    const int    fd = connect_to(config.port);
+
+    for (const std::size_t batch : BATCH_SIZES) {
+      bench_rpc(fd, tn::FrameType::MPut, batch);
+    }
+    for (const std::size_t batch : BATCH_SIZES) {
+      bench_rpc(fd, tn::FrameType::MGet, batch);
+    }
+
+    ::close(fd);
+  }
+
+  tn::RpcProtocol::bind_engine(nullptr);
+  fs::remove_all(dir);
+  return 0;
+}
@@ -0,0 +1,272 @@
+// Columnar point blocks (tskv.storage.point_codec): the codec alone, then ingest through a live
+// Reactor<RpcProtocol> over loopback TCP, a PutPoints block per frame against an MPut of the same
+// points as point keys and samples. The engine logs to a WAL in a scratch directory
+// (WALSyncPolicy::Append), as the server's does.
+//
+// Cases (ns/op is per point):
+//   - codec/encode, codec/decode: one block of BLOCK_POINTS points of a steady series (10 s
+//     interval with occasional jitter, a slow walk of values on a 0.1 grid)
+//   - rpc/mput/batch=<n>, rpc/put_points/batch=<n>: the client writes one frame of n points and
+//     waits for its result frame
+// Each rpc case also prints the bytes per point it sent.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <latch>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <optional>
+#include <span>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.hpp"
+#include "tskv/common/logging.hpp"
+
+import tskv.common.logging;
+import tskv.net.frame;
+import tskv.net.reactor;
+import tskv.net.rpc;
+import tskv.net.server;
+import tskv.storage.engine;
+import tskv.storage.point_codec;
+import tskv.storage.series;
+import tskv.storage.wal;
+
+namespace fs = std::filesystem;
+namespace tb = tskv::bench;
+namespace tn = tskv::net;
+namespace ts = tskv::storage;
+
+namespace {
+
+constexpr std::size_t NPOINTS       = 65'536; // points per measured call
+constexpr std::size_t BLOCK_POINTS  = 4'096;
+constexpr std::size_t BATCH_SIZES[] = {64, 512, 4096};
+
+std::vector<ts::Point> steady_series(std::size_t n)
+{
+  tb::XorShift64         rng;
+  std::vector<ts::Point> points;
+  std::int64_t           timestamp = 1'700'000'000'000;
+  std::int64_t           tenths    = 200;
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::uint64_t r = rng.next();
+    timestamp += 10'000 + (r % 16 == 0 ? static_cast<std::int64_t>(r >> 60) : 0);
+    tenths += static_cast<std::int64_t>((r >> 8) % 3) - 1;
+    points.push_back({timestamp, static_cast<double>(tenths) / 10.0});
+  }
+  return points;
+}
+
+// Reactor on its own thread until destroyed.
+class Server {
+  std::unique_ptr<tn::Reactor<tn::RpcProtocol>> reactor_;
+  std::jthread                                  thread_;
+
+public:
+  explicit Server(const tn::ServerConfig& config)
+  {
+    std::latch ready(1);
+    thread_ = std::jthread([&] {
+      reactor_ = std::make_unique<tn::Reactor<tn::RpcProtocol>>(config, false);
+      ready.count_down();
+      reactor_->run();
+    });
+    ready.wait();
+  }
+
+  ~Server()
+  {
+    reactor_->notify_shutdown();
+    thread_.join();
+  }
+
+  Server(const Server&)            = delete;
+  Server& operator=(const Server&) = delete;
+};
+
+std::uint16_t free_tcp_port()
+{
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  const int fd  = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  socklen_t len = sizeof addr;
+  (void)bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr);
+  (void)getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+  ::close(fd);
+  return ntohs(addr.sin_port);
+}
+
+int connect_to(std::uint16_t port)
+{
+  const int   fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == -1) {
+    std::perror("connect");
+    std::exit(1);
+  }
+  const int yes = 1;
+  (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+  return fd;
+}
+
+void write_all(int fd, std::span<const std::byte> data)
+{
+  while (!data.empty()) {
+    const ssize_t w = ::write(fd, data.data(), data.size());
+    if (w <= 0) {
+      std::perror("write");
+      std::exit(1);
+    }
+    data = data.subspan(static_cast<std::size_t>(w));
+  }
+}
+
+void read_exactly(int fd, std::size_t n, std::vector<std::byte>& buf)
+{
+  while (n > 0) {
+    const ssize_t r = ::read(fd, buf.data(), std::min(buf.size(), n));
+    if (r <= 0) {
+      std::perror("read");
+      std::exit(1);
+    }
+    n -= static_cast<std::size_t>(r);
+  }
+}
+
+void finish_frame(std::vector<std::byte>& frame, tn::FrameType type)
+{
+  const auto length = static_cast<std::uint32_t>(frame.size() - tn::FRAME_HEADER_SIZE);
+  tn::encode_frame_header({type, 0, length, 1}, std::span(frame).first<tn::FRAME_HEADER_SIZE>());
+}
+
+std::vector<std::byte> mput_frame(std::span<const ts::Point> points)
+{
+  std::vector<std::byte> frame(tn::FRAME_HEADER_SIZE);
+  tn::append_u32(frame, static_cast<std::uint32_t>(points.size()));
+  std::string key;
+  std::string value;
+  for (const ts::Point& point : points) {
+    ts::point_key(key, "cpu", point.timestamp);
+    ts::encode_sample(value, point.value);
+    tn::append_u32(frame, static_cast<std::uint32_t>(key.size()));
+    tn::append_u32(frame, static_cast<std::uint32_t>(value.size()));
+    tn::append_bytes(frame, key);
+    tn::append_bytes(frame, value);
+  }
+  finish_frame(frame, tn::FrameType::MPut);
+  return frame;
+}
+
+std::vector<std::byte> put_points_frame(std::span<const ts::Point> points)
+{
+  std::vector<std::byte> frame(tn::FRAME_HEADER_SIZE);
+  ts::encode_points(frame, "cpu", points);
+  finish_frame(frame, tn::FrameType::PutPoints);
+  return frame;
+}
+
+void bench_codec(const std::vector<ts::Point>& points)
+{
+  const std::span<const ts::Point> block_points = std::span(points).first(BLOCK_POINTS);
+
+  std::vector<std::byte> block;
+  tb::print(tb::run("codec/encode", BLOCK_POINTS, [&] {
+    block.clear();
+    ts::encode_points(block, "cpu", block_points);
+    tb::do_not_optimize(block.data());
+  }));
+
+  tb::print(tb::run("codec/decode", BLOCK_POINTS, [&] {
+    ts::PointDecoder decoder(block);
+    double           sum = 0.0;
+    while (const std::optional<ts::Point> point = decoder.next()) {
+      sum += point->value;
+    }
+    tb::do_not_optimize(sum);
+  }));
+  std::printf("  %.2f bytes/point in a block of %zu\n",
+    static_cast<double>(block.size()) / BLOCK_POINTS,
+    BLOCK_POINTS);
+}
+
+void bench_rpc(int fd, const std::vector<ts::Point>& points, tn::FrameType type, std::size_t batch)
+{
+  std::vector<std::vector<std::byte>> frames;
+  std::size_t                         bytes = 0;
+  for (std::size_t first = 0; first < NPOINTS; first += batch) {
+    const std::span<const ts::Point> slice = std::span(points).subspan(first, batch);
+    frames.push_back(type == tn::FrameType::MPut ? mput_frame(slice) : put_points_frame(slice));
+    bytes += frames.back().size();
+  }
+
+  // both result frames are a header and a u32 count
+  const std::size_t      result_size = tn::FRAME_HEADER_SIZE + 4;
+  std::vector<std::byte> buf(1 << 16);
+
+  const char*       kind = type == tn::FrameType::MPut ? "rpc/mput" : "rpc/put_points";
+  const std::string name = std::string(kind) + "/batch=" + std::to_string(batch);
+  tb::print(tb::run(name, NPOINTS, [&] {
+    for (const std::vector<std::byte>& frame : frames) {
+      write_all(fd, frame);
+      read_exactly(fd, result_size, buf);
+    }
+  }));
+  std::printf("  %.2f bytes/point on the wire\n", static_cast<double>(bytes) / NPOINTS);
+}
+
+} // namespace
+
+int main()
+{
+  TSKV_SET_LOG_LEVEL(Warn);
+
+  const std::vector<ts::Point> points = steady_series(NPOINTS);
+  bench_codec(points);
+
+  const fs::path dir =
+    fs::temp_directory_path() / ("tskv-bench-rpc-points-" + std::to_string(::getpid()));
+  fs::remove_all(dir);
+
+  {
+    ts::Engine engine(dir, ts::WALSyncPolicy::Append);
+    tn::RpcProtocol::bind_engine(&engine);
+
+    tn::ServerConfig config;
+    config.host            = "127.0.0.1";
+    config.port            = free_tcp_port();
+    config.idle_timeout_ms = 0;
+
+    {
+      const Server server(config);
+      const int    fd = connect_to(config.port);
+
+      for (const std::size_t batch : BATCH_SIZES) {
+        bench_rpc(fd, points, tn::FrameType::MPut, batch);
+        bench_rpc(fd, points, tn::FrameType::PutPoints, batch);
+      }
+
+      ::close(fd);
+    }
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  fs::remove_all(dir);
+  return 0;
+}
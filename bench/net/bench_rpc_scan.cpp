@@ -0,0 +1,223 @@
+// Streaming Scan (tskv.net.rpc) of a whole engine through a live Reactor<RpcProtocol> over
+// loopback TCP, per credit window: the client keeps <w> ScanBatch credits outstanding, returning
+// one per batch it reads, until the batch flagged END.
+//
+// Cases (ns/op is per entry):
+//   - scan/credits=<w>: w = 1 is stop-and-wait (one batch per round trip); larger windows let
+//     the server refill TX as the socket drains
+// After each case the process's peak RSS growth is printed: the server holds one batch per scan
+// however large the range, so it stays far below the size of the data scanned.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <latch>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <span>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.hpp"
+#include "tskv/common/logging.hpp"
+
+import tskv.common.logging;
+import tskv.net.frame;
+import tskv.net.reactor;
+import tskv.net.rpc;
+import tskv.net.server;
+import tskv.storage.engine;
+
+namespace tb = tskv::bench;
+namespace tn = tskv::net;
+namespace ts = tskv::storage;
+
+namespace {
+
+constexpr std::size_t   NKEYS            = 200'000;
+constexpr std::size_t   VALUE_BYTES      = 64;
+constexpr std::uint32_t CREDIT_WINDOWS[] = {1, 4, 16};
+
+// Reactor on its own thread until destroyed.
+class Server {
+  std::unique_ptr<tn::Reactor<tn::RpcProtocol>> reactor_;
+  std::jthread                                  thread_;
+
+public:
+  explicit Server(const tn::ServerConfig& config)
+  {
+    std::latch ready(1);
+    thread_ = std::jthread([&] {
+      reactor_ = std::make_unique<tn::Reactor<tn::RpcProtocol>>(config, false);
+      ready.count_down();
+      reactor_->run();
+    });
+    ready.wait();
+  }
+
+  ~Server()
+  {
+    reactor_->notify_shutdown();
+    thread_.join();
+  }
+
+  Server(const Server&)            = delete;
+  Server& operator=(const Server&) = delete;
+};
+
+std::uint16_t free_tcp_port()
+{
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  const int fd  = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  socklen_t len = sizeof addr;
+  (void)bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr);
+  (void)getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+  ::close(fd);
+  return ntohs(addr.sin_port);
+}
+
+int connect_to(std::uint16_t port)
+{
+  const int   fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == -1) {
+    std::perror("connect");
+    std::exit(1);
+  }
+  const int yes = 1;
+  (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+  return fd;
+}
+
+void write_all(int fd, std::span<const std::byte> data)
+{
+  while (!data.empty()) {
+    const ssize_t w = ::write(fd, data.data(), data.size());
+    if (w <= 0) {
+      std::perror("write");
+      std::exit(1);
+    }
+    data = data.subspan(static_cast<std::size_t>(w));
+  }
+}
+
+std::vector<std::byte> frame(
+  tn::FrameType type, std::uint32_t id, std::span<const std::byte> payload)
+{
+  std::vector<std::byte> out(tn::FRAME_HEADER_SIZE + payload.size());
+  tn::encode_frame_header({type, 0, static_cast<std::uint32_t>(payload.size()), id},
+    std::span(out).first<tn::FRAME_HEADER_SIZE>());
+  std::ranges::copy(payload, out.begin() + tn::FRAME_HEADER_SIZE);
+  return out;
+}
+
+long max_rss_kib()
+{
+  rusage usage{};
+  (void)getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+// One whole-range scan; returns the number of entries received.
+std::size_t scan_all(int fd, std::uint32_t window, std::vector<std::byte>& rx)
+{
+  std::vector<std::byte> scan_payload;
+  tn::append_u32(scan_payload, 0); // from the first key
+  tn::append_u32(scan_payload, 0); // to the last
+  tn::append_u32(scan_payload, window);
+  write_all(fd, frame(tn::FrameType::Scan, 1, scan_payload));
+
+  std::vector<std::byte> credit_payload;
+  tn::append_u32(credit_payload, 1);
+  const std::vector<std::byte> credit = frame(tn::FrameType::ScanCredit, 1, credit_payload);
+
+  std::size_t entries = 0;
+  std::size_t have    = 0;
+  for (;;) {
+    const ssize_t r = ::read(fd, rx.data() + have, rx.size() - have);
+    if (r <= 0) {
+      std::perror("read");
+      std::exit(1);
+    }
+    have += static_cast<std::size_t>(r);
+
+    std::size_t offset = 0;
+    for (;;) {
+      const tn::FrameParse parsed =
+        tn::parse_frame(std::span(rx).subspan(offset, have - offset), rx.size());
+      if (parsed.status != tn::FrameStatus::Complete) {
+        break;
+      }
+      offset += parsed.size;
+      entries += tn::PayloadReader(parsed.frame.payload).u32();
+      if (parsed.frame.header.flags & tn::FRAME_FLAG_END) {
+        return entries;
+      }
+      write_all(fd, credit);
+    }
+    std::copy(rx.begin() + static_cast<std::ptrdiff_t>(offset),
+      rx.begin() + static_cast<std::ptrdiff_t>(have),
+      rx.begin());
+    have -= offset;
+  }
+}
+
+} // namespace
+
+int main()
+{
+  TSKV_SET_LOG_LEVEL(Warn);
+
+  ts::Engine        engine;
+  const std::string value(VALUE_BYTES, 'v');
+  for (std::size_t i = 0; i < NKEYS; ++i) {
+    char key[32];
+    std::snprintf(key, sizeof key, "series:%08zu", i);
+    engine.put(key, value);
+  }
+  tn::RpcProtocol::bind_engine(&engine);
+
+  tn::ServerConfig config;
+  config.host            = "127.0.0.1";
+  config.port            = free_tcp_port();
+  config.idle_timeout_ms = 0;
+
+  {
+    const Server server(config);
+    const int    fd = connect_to(config.port);
+
+    std::vector<std::byte> rx(2 * tn::RpcProtocol::SCAN_BATCH_BYTES);
+    for (const std::uint32_t window : CREDIT_WINDOWS) {
+      const long        rss_before = max_rss_kib();
+      const std::string name       = "scan/credits=" + std::to_string(window);
+      tb::print(tb::run(name, NKEYS, [&] {
+        if (scan_all(fd, window, rx) != NKEYS) {
+          std::fprintf(stderr, "short scan\n");
+          std::exit(1);
+        }
+      }));
+      std::printf("  peak RSS growth %ld KiB while scanning %zu KiB\n",
+        max_rss_kib() - rss_before,
+        NKEYS * (VALUE_BYTES + 15) / 1024);
+    }
+
+    ::close(fd);
+  }
+
+  tn::RpcProtocol::bind_engine(nullptr);
+  return 0;
+}
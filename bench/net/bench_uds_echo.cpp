@@ -0,0 +1,246 @@
+// Echo round trips through a live Reactor<EchoProtocol>, over loopback TCP versus the AF_UNIX
+// listener (--unix-socket). Client and reactor run on separate threads of this process, so on a
+// single core the numbers include the context switches a co-located sidecar would pay.
+//
+// Cases, for each transport:
+//   - pingpong/<size>: one message in flight; ns/op is the round-trip latency. A second pass
+//     reports the p50/p99 of individually timed round trips
+//   - stream/<chunk>: the client keeps up to WINDOW bytes outstanding and reads the echo back as
+//     it arrives; ns/op is per chunk, and MB/s is the echoed payload throughput
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <latch>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.hpp"
+#include "tskv/common/logging.hpp"
+
+import tskv.common.logging;
+import tskv.net.channel;
+import tskv.net.reactor;
+import tskv.net.server;
+
+namespace tb = tskv::bench;
+namespace tn = tskv::net;
+
+namespace {
+
+constexpr std::size_t PINGPONG_ROUNDS = 2'000;
+constexpr std::size_t LATENCY_SAMPLES = 20'000;
+constexpr std::size_t STREAM_BYTES    = 8 << 20;
+constexpr std::size_t WINDOW          = 256 << 10;
+
+enum class Transport : std::uint8_t { Tcp, Unix };
+
+// Reactor on its own thread, listening on both transports until destroyed.
+class Server {
+  std::unique_ptr<tn::Reactor<tn::EchoProtocol>> reactor_;
+  std::jthread                                   thread_;
+
+public:
+  explicit Server(const tn::ServerConfig& config)
+  {
+    std::latch ready(1);
+    thread_ = std::jthread([&] {
+      reactor_ = std::make_unique<tn::Reactor<tn::EchoProtocol>>(config, false);
+      ready.count_down();
+      reactor_->run();
+    });
+    ready.wait();
+  }
+
+  ~Server()
+  {
+    reactor_->notify_shutdown();
+    thread_.join();
+  }
+
+  Server(const Server&)            = delete;
+  Server& operator=(const Server&) = delete;
+};
+
+// An ephemeral port nobody is using right now (good enough for a benchmark).
+std::uint16_t free_tcp_port()
+{
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  const int fd  = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  socklen_t len = sizeof addr;
+  (void)bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr);
+  (void)getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+  ::close(fd);
+  return ntohs(addr.sin_port);
+}
+
+int connect_to(Transport transport, const tn::ServerConfig& config)
+{
+  int fd = -1;
+  if (transport == Transport::Tcp) {
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(config.port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == -1) {
+      std::perror("connect tcp");
+      std::exit(1);
+    }
+    const int yes = 1;
+    (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+  }
+  else {
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, config.unix_socket.c_str(), sizeof addr.sun_path - 1);
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == -1) {
+      std::perror("connect unix");
+      std::exit(1);
+    }
+  }
+  return fd;
+}
+
+void write_all(int fd, const char* data, std::size_t n)
+{
+  while (n > 0) {
+    const ssize_t w = ::write(fd, data, n);
+    if (w <= 0) {
+      std::perror("write");
+      std::exit(1);
+    }
+    data += w;
+    n -= static_cast<std::size_t>(w);
+  }
+}
+
+void read_all(int fd, char* data, std::size_t n)
+{
+  while (n > 0) {
+    const ssize_t r = ::read(fd, data, n);
+    if (r <= 0) {
+      std::perror("read");
+      std::exit(1);
+    }
+    data += r;
+    n -= static_cast<std::size_t>(r);
+  }
+}
+
+void bench_pingpong(const std::string& name, int fd, std::size_t size)
+{
+  std::vector<char> out(size, 'x');
+  std::vector<char> in(size);
+
+  const auto round_trip = [&] {
+    write_all(fd, out.data(), size);
+    read_all(fd, in.data(), size);
+  };
+
+  tb::print(tb::run(name, PINGPONG_ROUNDS, [&] {
+    for (std::size_t i = 0; i < PINGPONG_ROUNDS; ++i) {
+      round_trip();
+    }
+  }));
+
+  std::vector<std::int64_t> samples(LATENCY_SAMPLES);
+  for (auto& sample : samples) {
+    const auto start = tb::clock::now();
+    round_trip();
+    sample = std::chrono::duration_cast<std::chrono::nanoseconds>(tb::clock::now() - start).count();
+  }
+  std::ranges::sort(samples);
+  std::printf("  p50=%lld ns p99=%lld ns\n",
+    static_cast<long long>(samples[samples.size() / 2]),
+    static_cast<long long>(samples[samples.size() * 99 / 100]));
+}
+
+// Pipelined: keep writing while less than WINDOW is unanswered, read whatever has come back.
+void stream(int fd, std::size_t chunk, std::vector<char>& out, std::vector<char>& in)
+{
+  std::size_t sent     = 0;
+  std::size_t received = 0;
+
+  while (received < STREAM_BYTES) {
+    const bool can_send = sent < STREAM_BYTES && sent - received < WINDOW;
+
+    pollfd pfd{.fd = fd, .events = POLLIN, .revents = 0};
+    if (can_send) {
+      pfd.events |= POLLOUT;
+    }
+    (void)::poll(&pfd, 1, -1);
+
+    if ((pfd.revents & POLLOUT) != 0) {
+      const std::size_t n = std::min({chunk, STREAM_BYTES - sent, WINDOW - (sent - received)});
+      const ssize_t     w = ::send(fd, out.data(), n, MSG_DONTWAIT);
+      sent += w > 0 ? static_cast<std::size_t>(w) : 0;
+    }
+    if ((pfd.revents & POLLIN) != 0) {
+      const ssize_t r = ::recv(fd, in.data(), in.size(), MSG_DONTWAIT);
+      if (r == 0 || (r < 0 && errno != EAGAIN)) {
+        std::perror("recv");
+        std::exit(1);
+      }
+      received += r > 0 ? static_cast<std::size_t>(r) : 0;
+    }
+  }
+}
+
+void bench_stream(const std::string& name, int fd, std::size_t chunk)
+{
+  std::vector<char> out(chunk, 'x');
+  std::vector<char> in(WINDOW);
+
+  const tb::Result r = tb::run(name, STREAM_BYTES / chunk, [&] { stream(fd, chunk, out, in); });
+  tb::print(r);
+  std::printf("  %.1f MB/s\n", static_cast<double>(chunk) / r.ns_per_op * 1e3);
+}
+
+} // namespace
+
+int main()
+{
+  TSKV_SET_LOG_LEVEL(Warn);
+
+  tn::ServerConfig config;
+  config.host            = "127.0.0.1";
+  config.port            = free_tcp_port();
+  config.unix_socket     = "/tmp/tskv-bench-" + std::to_string(getpid()) + ".sock";
+  config.idle_timeout_ms = 0;
+
+  const Server server(config);
+
+  for (const Transport transport : {Transport::Tcp, Transport::Unix}) {
+    const std::string base = transport == Transport::Tcp ? "echo/tcp/" : "echo/uds/";
+    const int         fd   = connect_to(transport, config);
+
+    for (const std::size_t size : {64, 1024}) {
+      bench_pingpong(base + "pingpong/" + std::to_string(size) + "B", fd, size);
+    }
+    for (const std::size_t chunk : {4096, 65536}) {
+      bench_stream(base + "stream/" + std::to_string(chunk / 1024) + "KiB", fd, chunk);
+    }
+
+    ::close(fd);
+  }
+  return 0;
+}
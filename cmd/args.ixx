@@ -102,6 +102,11 @@ public:
       TSKV_REQUIRE(o_policy.has_value(), "invalid_wal_sync: unrecognized policy \"{}\"", sv);
       return *o_policy;
     }
+    else if constexpr (std::is_enum_v<V>) {
+      auto o_value = tc::from_string<V>(sv);
+      TSKV_REQUIRE(o_value.has_value(), errmsg());
+      return *o_value;
+    }
     else if constexpr (std::is_integral_v<V> && !std::is_same_v<V, bool>) {
       const char* first = sv.data();
       const char* last  = first + sv.size();
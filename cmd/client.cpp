@@ -1,7 +1,12 @@
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
+#include <format>
 #include <iostream>
+#include <optional>
 #include <print>
+#include <string>
+#include <string_view>
 
 #include "macros.hpp"
 #include "tskv/common/logging.hpp"
@@ -11,6 +16,7 @@ import tskv.common.logging;
 import tskv.storage.wal;
 import tskv.cmd.args;
 import tskv.cmd.version;
+import tskv.net.client;
 import tskv.net.utils;
 
 namespace tc  = tskv::common;
@@ -23,52 +29,191 @@ static void print_help()
   using std::println;
 
   println("tskv client — usage:");
-  println("  client [--host <ip|name>] [--port <1-65535>] [--timeout-ms <n>]");
-  println("         [--version] [--help] [--dry-run]");
+  println("  client get --key <key> [--count <n>] [options]");
+  println("  client put --key <key> --value <value> [--count <n>] [options]");
+  println("  client scan [--from <key>] [--to <key>] [options]");
+  println("  client [--version] [--help] [--dry-run]");
+  println("");
+
+  println("Commands (frame protocol, i.e. a server started with --protocol frame):");
+  println("  get                        Print the value of --key, or (nil)");
+  println("  put                        Store --value under --key");
+  println("  scan                       Print the entries in [--from, --to), tab-separated");
   println("");
 
   println("Options:");
-  println("  --host <ip|name>           Bind address (default: 127.0.0.1)");
+  println("  --host <ip|name>           Server address (default: 127.0.0.1)");
   println("  --port <n>                 TCP port (default: 7070)");
-  println("  --timeout-ms <n>           Timeout [milliseconds] (default: 2000)");
+  println("  --timeout-ms <n>           Per-request timeout [ms], 0: none (default: 2000)");
+  println("  --connections <n>          Connections in the pool (default: 1)");
+  println("  --depth <n>                Requests in flight per connection (default: 16)");
+  println("  --scan-credits <n>         Scan batches in flight (default: 4)");
+  println("  --count <n>                get/put <key>0 .. <key>n-1 and report throughput");
   println("  --dry-run                  Print CLI args and exit");
   println("  --version                  Print version and exit");
   println("  --help                     Show this help and exit");
 }
 
-struct ClientConfig {
-  std::string host       = "127.0.0.1";
-  uint16_t    port       = 7070;
-  uint32_t    timeout_ms = 2000;
+static tn::ClientConfig from_cli(cmd::CmdLineArgs& args)
+{
+  tn::ClientConfig config;
+
+  // 1) Parse
+  TRY_ARG_ASSIGN(args, config.host, "host");
+  TRY_ARG_ASSIGN(args, config.port, "port");
+  TRY_ARG_ASSIGN(args, config.timeout_ms, "timeout-ms");
+  TRY_ARG_ASSIGN(args, config.connections, "connections");
+  TRY_ARG_ASSIGN(args, config.depth, "depth");
+  TRY_ARG_ASSIGN(args, config.scan_credits, "scan-credits");
+
+  // 2) Validate
+  TSKV_REQUIRE(
+    tn::is_valid_port(config.port), "invalid_port: expected 1..65535 (got {})", config.port);
+
+  TSKV_REQUIRE(config.connections >= 1 && config.connections <= 1024,
+    "invalid_connections: expected 1..1024 (got {})",
+    config.connections);
+
+  TSKV_REQUIRE(config.depth >= 1, "invalid_depth: expected >= 1 (got {})", config.depth);
+
+  TSKV_REQUIRE(
+    config.scan_credits >= 1, "invalid_scan_credits: expected >= 1 (got {})", config.scan_credits);
+
+  return config;
+}
+
+// `count` gets or puts of <key>0 .. <key>n-1, keeping the pool full; prints the throughput.
+static int run_load(tn::Client& client,
+  const tn::ClientConfig&       config,
+  bool                          put,
+  const std::string&            key,
+  const std::string&            value,
+  std::uint64_t                 count)
+{
+  const std::size_t window = std::size_t{config.connections} * config.depth * 2;
+
+  std::uint64_t failed  = 0;
+  std::uint64_t missing = 0;
+  std::uint64_t next    = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  while (next < count || client.pending() > 0) {
+    for (; next < count && client.pending() < window; ++next) {
+      const std::string k = std::format("{}{}", key, next);
+      if (put) {
+        client.put(k, value, [&](tn::CallStatus status) {
+          failed += status != tn::CallStatus::Ok;
+        });
+      }
+      else {
+        client.get(k, [&](tn::CallStatus status, std::optional<std::string_view> v) {
+          failed += status != tn::CallStatus::Ok;
+          missing += status == tn::CallStatus::Ok && !v;
+        });
+      }
+    }
+    client.poll(-1);
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::println("{} {} in {:.3f} s: {:.0f} ops/s ({} failed{})",
+    count,
+    put ? "puts" : "gets",
+    elapsed.count(),
+    static_cast<double>(count) / elapsed.count(),
+    failed,
+    put ? "" : std::format(", {} missing", missing));
+  return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int run_command(std::string_view command,
+  cmd::CmdLineArgs&                       args,
+  const tn::ClientConfig&                 config,
+  bool                                    dry_run)
+{
+  std::string   key;
+  std::string   value;
+  std::string   from;
+  std::string   to;
+  std::uint64_t count = 0;
+
+  TRY_ARG_ASSIGN(args, key, "key");
+  TRY_ARG_ASSIGN(args, value, "value");
+  TRY_ARG_ASSIGN(args, from, "from");
+  TRY_ARG_ASSIGN(args, to, "to");
+  TRY_ARG_ASSIGN(args, count, "count");
+
+  args.enforce_no_unused_args();
 
-  static ClientConfig from_cli(cmd::CmdLineArgs& args)
-  {
-    ClientConfig config;
+  const bool is_get  = command == "get";
+  const bool is_put  = command == "put";
+  const bool is_scan = command == "scan";
+  TSKV_REQUIRE(is_get || is_put || is_scan, "unknown_command: expected get|put|scan ({})", command);
+  TSKV_REQUIRE(is_scan || !key.empty(), "missing_key: {} needs --key", command);
+  TSKV_REQUIRE(!is_scan || count == 0, "bad_cli_arg: --count applies to get and put only");
 
-    // 1) Parse
-    TRY_ARG_ASSIGN(args, config.host, "host");
-    TRY_ARG_ASSIGN(args, config.port, "port");
-    TRY_ARG_ASSIGN(args, config.timeout_ms, "timeout-ms");
+  if (dry_run) {
+    config.print();
+    return EXIT_SUCCESS;
+  }
 
-    // 2) Validate
-    TSKV_REQUIRE(
-      tn::is_valid_port(config.port), "invalid_port: expected 1..65535 (got {})", config.port);
+  tn::Client client(config);
 
-    return config;
+  if (count > 0) {
+    return run_load(client, config, is_put, key, value, count);
   }
 
-  void print() const
-  {
-    std::print("tskv client CFG ::");
-    std::print(" host={}", this->host);
-    std::print(" port={}", this->port);
-    std::print(" timeout-ms={}", this->timeout_ms);
-    std::print("\n");
+  tn::CallStatus result = tn::CallStatus::Ok;
+  if (is_get) {
+    client.get(key, [&](tn::CallStatus status, std::optional<std::string_view> v) {
+      result = status;
+      if (status == tn::CallStatus::Ok) {
+        std::println("{}", v.value_or("(nil)"));
+      }
+    });
+  }
+  else if (is_put) {
+    client.put(key, value, [&](tn::CallStatus status) {
+      result = status;
+      if (status == tn::CallStatus::Ok) {
+        std::println("OK");
+      }
+    });
   }
-};
+  else {
+    std::uint64_t entries = 0;
+    client.scan(
+      from,
+      to,
+      [&](std::string_view k, std::string_view v) {
+        std::println("{}\t{}", k, v);
+        ++entries;
+      },
+      [&](tn::CallStatus status) {
+        result = status;
+        std::println("({} entries)", entries);
+      });
+  }
+  client.run();
+
+  if (result != tn::CallStatus::Ok) {
+    std::cerr << std::format("{} failed: {}", command, tc::to_string(result)) << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
 int main_(int argc, char** argv)
 {
+  // `client <command> --opt ...`: the command takes the place of the program name, so the rest
+  // parses like any other command line
+  std::string_view command;
+  if (argc > 1 && !std::string_view(argv[1]).starts_with("--")) {
+    command = argv[1];
+    --argc;
+    ++argv;
+  }
+
   cmd::CmdLineArgs args(argc, argv);
 
   args.parse();
@@ -83,10 +228,14 @@ int main_(int argc, char** argv)
     return EXIT_SUCCESS;
   }
 
-  const auto config = ClientConfig::from_cli(args);
+  const tn::ClientConfig config = from_cli(args);
 
   const bool dry_run = args.pop_flag("dry-run");
 
+  if (!command.empty()) {
+    return run_command(command, args, config, dry_run);
+  }
+
   args.enforce_no_unused_args();
 
   if (dry_run) {
@@ -94,7 +243,8 @@ int main_(int argc, char** argv)
     return EXIT_SUCCESS;
   }
 
-  return EXIT_SUCCESS;
+  print_help();
+  return EXIT_FAILURE;
 }
 
 int main(int argc, char** argv)
@@ -1,8 +1,11 @@
+#include <climits>
 #include <cstdlib>
 #include <filesystem>
 #include <iostream>
+#include <optional>
 #include <print>
 #include <signal.h>
+#include <sys/un.h>
 
 #include "macros.hpp"
 #include "tskv/common/logging.hpp"
@@ -14,16 +17,23 @@ import tskv.cmd.version;
 import tskv.common.enum_traits;
 import tskv.common.files;
 import tskv.common.logging;
+import tskv.common.metrics;
 import tskv.net.reactor;
+import tskv.net.reactor_group;
+import tskv.net.resp;
+import tskv.net.rpc;
 import tskv.net.server;
 import tskv.net.utils;
 import tskv.net.channel;
+import tskv.net.uring_reactor;
+import tskv.storage.engine;
 import tskv.storage.wal;
 
-namespace tc  = tskv::common;
-namespace ts  = tskv::storage;
-namespace tn  = tskv::net;
-namespace cmd = tskv::cmd;
+namespace tc      = tskv::common;
+namespace metrics = tskv::common::metrics;
+namespace ts      = tskv::storage;
+namespace tn      = tskv::net;
+namespace cmd     = tskv::cmd;
 
 static tn::ServerConfig from_cli(cmd::CmdLineArgs& args)
 {
@@ -32,15 +42,50 @@ static tn::ServerConfig from_cli(cmd::CmdLineArgs& args)
   // 1) Parse
   TRY_ARG_ASSIGN(args, config.host, "host");
   TRY_ARG_ASSIGN(args, config.port, "port");
+  TRY_ARG_ASSIGN(args, config.unix_socket, "unix-socket");
   TRY_ARG_ASSIGN(args, config.data_dir, "data-dir");
   TRY_ARG_ASSIGN(args, config.wal_sync_policy, "wal-sync");
   TRY_ARG_ASSIGN(args, config.memtable_bytes, "memtable-bytes");
   TRY_ARG_ASSIGN(args, config.max_connections, "max-connections");
+  TRY_ARG_ASSIGN(args, config.io_threads, "io-threads");
+  TRY_ARG_ASSIGN(args, config.io_backend, "io-backend");
+  TRY_ARG_ASSIGN(args, config.protocol, "protocol");
+  TRY_ARG_ASSIGN(args, config.rx_budget_bytes, "rx-budget");
+  TRY_ARG_ASSIGN(args, config.tx_budget_bytes, "tx-budget");
+  TRY_ARG_ASSIGN(args, config.tx_zerocopy, "tx-zerocopy");
+  TRY_ARG_ASSIGN(args, config.idle_timeout_ms, "idle-timeout");
+  TRY_ARG_ASSIGN(args, config.busy_poll_us, "busy-poll");
+  TRY_ARG_ASSIGN(args, config.socket.backlog, "backlog");
+  TRY_ARG_ASSIGN(args, config.socket.defer_accept_s, "tcp-defer-accept");
+  TRY_ARG_ASSIGN(args, config.socket.rcvbuf_bytes, "so-rcvbuf");
+  TRY_ARG_ASSIGN(args, config.socket.sndbuf_bytes, "so-sndbuf");
+  TRY_ARG_ASSIGN(args, config.socket.notsent_lowat, "tcp-notsent-lowat");
+  TRY_ARG_ASSIGN(args, config.socket.user_timeout_ms, "tcp-user-timeout");
+  config.socket.tcp_nodelay = !args.pop_flag("no-tcp-nodelay");
 
   // 2) Validate
   TSKV_REQUIRE(
     tn::is_valid_port(config.port), "invalid_port: expected 1..65535 (got {})", config.port);
 
+  TSKV_REQUIRE(config.io_threads >= 1 && config.io_threads <= 1024,
+    "invalid_io_threads: expected 1..1024 (got {})",
+    config.io_threads);
+
+  TSKV_REQUIRE(config.max_connections >= 1,
+    "invalid_max_connections: expected >= 1 (got {})",
+    config.max_connections);
+
+  TSKV_REQUIRE(config.socket.backlog >= 1 && config.socket.backlog <= INT_MAX,
+    "invalid_backlog: expected 1..{} (got {})",
+    INT_MAX,
+    config.socket.backlog);
+
+  TSKV_REQUIRE(config.socket.rcvbuf_bytes <= INT_MAX && config.socket.sndbuf_bytes <= INT_MAX,
+    "invalid_socket_buffer: expected <= {} bytes (got so-rcvbuf={} so-sndbuf={})",
+    INT_MAX,
+    config.socket.rcvbuf_bytes,
+    config.socket.sndbuf_bytes);
+
   {
     auto clean_data_dir = tc::standardize_path(config.data_dir);
     TSKV_REQUIRE(clean_data_dir, "invalid_data_dir: {}", config.data_dir.string());
@@ -52,26 +97,90 @@ static tn::ServerConfig from_cli(cmd::CmdLineArgs& args)
     TSKV_REQUIRE(!parent_bad && !leaf_bad, "invalid_data_dir: {}", config.data_dir.string());
   }
 
+  if (!config.unix_socket.empty()) {
+    constexpr std::size_t max_len = sizeof(sockaddr_un::sun_path) - 1;
+    TSKV_REQUIRE(config.unix_socket.native().size() <= max_len,
+      "invalid_unix_socket: path longer than {} bytes: {}",
+      max_len,
+      config.unix_socket.string());
+
+    const fs::path parent = config.unix_socket.has_parent_path() ? config.unix_socket.parent_path()
+                                                                  : fs::path(".");
+    TSKV_REQUIRE(tc::can_create_in(parent),
+      "invalid_unix_socket: cannot create in {}",
+      parent.string());
+  }
+
   return config;
 }
 
+template <typename R>
+static void run_reactors(const tn::ServerConfig& config)
+{
+  if (config.io_threads == 1) {
+    R reactor(config);
+    reactor.run();
+  }
+  else {
+    tn::ReactorGroup<R> group(config);
+    group.run();
+  }
+}
+
+template <tn::Protocol Proto>
+static void serve(const tn::ServerConfig& config)
+{
+  switch (config.io_backend) {
+    case tn::IoBackend::Epoll:
+      run_reactors<tn::Reactor<Proto>>(config);
+      break;
+    case tn::IoBackend::Uring:
+      run_reactors<tn::UringReactor<Proto>>(config);
+      break;
+  }
+}
+
 static void print_help()
 {
   using std::println;
 
   println("tskv server — usage:");
-  println("  server [--host <ip|name>] [--port <1-65535>] [--data-dir <path>]");
+  println("  server [--host <ip|name>] [--port <1-65535>] [--unix-socket <path>]");
+  println("         [--data-dir <path>]");
   println("         [--wal-sync <append|fdatasync>] [--memtable-bytes <n>]");
-  println("         [--max-connections <n>] [--version] [--help] [--dry-run]");
+  println("         [--max-connections <n>] [--io-threads <n>] [--io-backend <epoll|uring>]");
+  println("         [--protocol <echo|frame|resp>]");
+  println("         [--rx-budget <bytes>] [--tx-budget <bytes>] [--tx-zerocopy <bytes>]");
+  println("         [--idle-timeout <ms>] [--busy-poll <us>]");
+  println("         [--backlog <n>] [--tcp-defer-accept <s>] [--no-tcp-nodelay]");
+  println("         [--so-rcvbuf <bytes>] [--so-sndbuf <bytes>]");
+  println("         [--tcp-notsent-lowat <bytes>] [--tcp-user-timeout <ms>]");
+  println("         [--version] [--help] [--dry-run]");
   println("");
 
   println("Options:");
   println("  --host <ip|name>           Bind address (default: 0.0.0.0)");
   println("  --port <n>                 TCP port (default: 7070)");
+  println("  --unix-socket <path>       Also listen on this AF_UNIX socket path (default: off)");
   println("  --data-dir <path>          Data directory (default: ./data)");
   println("  --wal-sync <mode>          WAL durability: append | fdatasync (default: append)");
   println("  --memtable-bytes <n>       Target memtable size in bytes (default: 67108864)");
   println("  --max-connections <n>      Max concurrent connections (default: 1024)");
+  println("  --io-threads <n>           Reactor threads sharing the port (default: 1)");
+  println("  --io-backend <mode>        Event loop: epoll | uring (default: epoll)");
+  println("  --protocol <name>          Wire protocol: echo | frame | resp (default: echo)");
+  println("  --rx-budget <bytes>        Per-connection read cap per turn, 0: off (default: 65536)");
+  println("  --tx-budget <bytes>        Per-connection send cap per turn, 0: off (default: 65536)");
+  println("  --tx-zerocopy <bytes>      MSG_ZEROCOPY above this reply size, 0: off (default: 0)");
+  println("  --idle-timeout <ms>        Close idle connections after ms, 0: off (default: 300000)");
+  println("  --busy-poll <us>           Spin before blocking in epoll, 0: off (default: 0)");
+  println("  --backlog <n>              Listen queue length (default: SOMAXCONN)");
+  println("  --tcp-defer-accept <s>     Accept once the client has sent data, 0: off (default: 0)");
+  println("  --no-tcp-nodelay           Leave Nagle's algorithm on for accepted connections");
+  println("  --so-rcvbuf <bytes>        Socket receive buffer, 0: kernel autotuning (default: 0)");
+  println("  --so-sndbuf <bytes>        Socket send buffer, 0: kernel autotuning (default: 0)");
+  println("  --tcp-notsent-lowat <n>    Max unsent bytes kept in the kernel, 0: off (default: 0)");
+  println("  --tcp-user-timeout <ms>    Drop peers not acking data for ms, 0: off (default: 0)");
   println("  --dry-run                  Print CLI args and exit");
   println("  --version                  Print version and exit");
   println("  --help                     Show this help and exit");
@@ -108,8 +217,28 @@ int main_(int argc, char** argv)
 
   (void)signal(SIGPIPE, SIG_IGN);
 
-  tn::Reactor<tn::EchoProtocol> reactor(config);
-  reactor.run();
+  // echo never touches storage, so it does not open (or replay) the WAL
+  std::optional<ts::Engine> engine;
+  if (config.protocol != tn::WireProtocol::Echo) {
+    engine.emplace(config.data_dir, config.wal_sync_policy);
+  }
+
+  switch (config.protocol) {
+    case tn::WireProtocol::Echo:
+      serve<tn::EchoProtocol>(config);
+      break;
+    case tn::WireProtocol::Frame:
+      tn::RpcProtocol::bind_engine(&*engine);
+      serve<tn::RpcProtocol>(config);
+      break;
+    case tn::WireProtocol::Resp:
+      tn::RespProtocol::bind_engine(&*engine);
+      serve<tn::RespProtocol>(config);
+      break;
+  }
+
+  // reactor threads have flushed their metric shards by now
+  metrics::print();
 
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,204 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.common.arena
+// Summary: bump-pointer arena over 2 MiB-aligned, huge-page-backed, NUMA-bound regions
+//
+//  - for long-lived slabs that are freed all at once (e.g. ChannelPool chunks)
+//    * allocate() is a pointer bump; there is no per-allocation free, only ~PageArena()
+//  - each region is REGION_BYTES (or a multiple, for larger requests) mapped with
+//    * HugePages::Auto: MAP_HUGETLB if the system has reserved huge pages, else THP
+//    * HugePages::Transparent: anonymous memory plus madvise(MADV_HUGEPAGE)
+//    * HugePages::Off: 4 KiB pages (MADV_NOHUGEPAGE), i.e. what the general heap would give
+//  - regions are bound (MPOL_PREFERRED) to a NUMA node, by default the node of the thread that
+//    constructs the arena; binding is best effort and skipped where mbind() is unavailable
+//  - not thread-safe
+//------------------------------------------------------------------------------
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include "tskv/common/logging.hpp"
+
+export module tskv.common.arena;
+
+import tskv.common.logging;
+
+export namespace tskv::common {
+
+enum class HugePages : std::uint8_t { Off, Transparent, Auto };
+
+struct ArenaOptions {
+  static constexpr int NUMA_LOCAL = -1; // node of the constructing thread
+  static constexpr int NUMA_NONE  = -2; // leave placement to the kernel (first touch)
+
+  HugePages huge_pages = HugePages::Auto;
+  int       numa_node  = NUMA_LOCAL;
+};
+
+// NUMA node of the CPU the calling thread is running on (0 if unknown)
+[[nodiscard]] inline int current_numa_node() noexcept
+{
+  unsigned cpu  = 0;
+  unsigned node = 0;
+  if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+    return 0;
+  }
+  return static_cast<int>(node);
+}
+
+class PageArena {
+public:
+  static constexpr std::size_t REGION_BYTES = std::size_t{2} << 20; // x86-64 huge page size
+
+private:
+  struct Region {
+    std::byte*  base;
+    std::size_t bytes;
+  };
+
+  ArenaOptions        options_;
+  std::vector<Region> regions_;
+  std::byte*          cursor_ = nullptr; // next free byte of regions_.back()
+  std::byte*          limit_  = nullptr;
+
+  std::size_t hugetlb_regions_ = 0;
+  std::size_t numa_bound_      = 0;
+
+  [[nodiscard]] static constexpr std::size_t round_up(std::size_t n, std::size_t align) noexcept
+  {
+    return (n + align - 1) / align * align;
+  }
+
+  // Reserve bytes + REGION_BYTES and trim both ends, leaving a REGION_BYTES-aligned mapping that
+  // THP can back with huge pages from the first fault.
+  [[nodiscard]] static std::byte* map_aligned(std::size_t bytes) noexcept
+  {
+    void* raw = ::mmap(nullptr,
+      bytes + REGION_BYTES,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+      -1,
+      0);
+    if (raw == MAP_FAILED) {
+      return nullptr;
+    }
+
+    const auto        addr    = reinterpret_cast<std::uintptr_t>(raw);
+    const auto        aligned = round_up(addr, REGION_BYTES);
+    std::byte*        base    = reinterpret_cast<std::byte*>(aligned);
+    const std::size_t head    = aligned - addr;
+
+    if (head > 0) {
+      ::munmap(raw, head);
+    }
+    ::munmap(base + bytes, REGION_BYTES - head); // head < REGION_BYTES, so never empty
+    return base;
+  }
+
+  void bind_to_node(std::byte* base, std::size_t bytes) noexcept
+  {
+    const int node = options_.numa_node;
+    if (node < 0 || node >= static_cast<int>(8 * sizeof(unsigned long))) {
+      return;
+    }
+
+    const unsigned long nodemask = 1UL << node;
+    const long          maxnode  = 8 * sizeof nodemask;
+    if (::syscall(SYS_mbind, base, bytes, MPOL_PREFERRED, &nodemask, maxnode, 0) == 0) {
+      ++numa_bound_;
+    }
+    else {
+      TSKV_LOG_DEBUG("mbind to NUMA node {} failed: errno={}", node, errno);
+    }
+  }
+
+  void map_region(std::size_t min_bytes)
+  {
+    const std::size_t bytes = round_up(min_bytes, REGION_BYTES);
+    std::byte*        base  = nullptr;
+
+    if (options_.huge_pages == HugePages::Auto) {
+      void* p = ::mmap(nullptr,
+        bytes,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+        -1,
+        0);
+      if (p != MAP_FAILED) {
+        base = static_cast<std::byte*>(p);
+        ++hugetlb_regions_;
+      }
+    }
+
+    if (base == nullptr) {
+      base = map_aligned(bytes);
+      TSKV_DEMAND(base != nullptr, "PageArena: mmap of {} bytes failed: errno={}", bytes, errno);
+
+      const int advice = options_.huge_pages == HugePages::Off ? MADV_NOHUGEPAGE : MADV_HUGEPAGE;
+      (void)::madvise(base, bytes, advice); // EINVAL without THP support; 4 KiB pages it is
+    }
+
+    bind_to_node(base, bytes);
+
+    regions_.push_back(Region{base, bytes});
+    cursor_ = base;
+    limit_  = base + bytes;
+  }
+
+public:
+  explicit PageArena(ArenaOptions options = {}) : options_(options)
+  {
+    if (options_.numa_node == ArenaOptions::NUMA_LOCAL) {
+      options_.numa_node = current_numa_node();
+    }
+  }
+
+  ~PageArena()
+  {
+    for (const Region& region : regions_) {
+      ::munmap(region.base, region.bytes);
+    }
+  }
+
+  PageArena(const PageArena&)            = delete;
+  PageArena& operator=(const PageArena&) = delete;
+
+  // CONTRACT: align is a power of two no larger than REGION_BYTES
+  [[nodiscard]] void* allocate(std::size_t bytes, std::size_t align)
+  {
+    std::byte* p = reinterpret_cast<std::byte*>(
+      round_up(reinterpret_cast<std::uintptr_t>(cursor_), align));
+
+    if (cursor_ == nullptr || bytes > static_cast<std::size_t>(limit_ - p)) {
+      map_region(bytes);
+      p = cursor_; // region bases are REGION_BYTES-aligned
+    }
+
+    cursor_ = p + bytes;
+    return p;
+  }
+
+  [[nodiscard]] const ArenaOptions& options() const noexcept { return options_; }
+
+  [[nodiscard]] std::size_t regions() const noexcept { return regions_.size(); }
+  [[nodiscard]] std::size_t hugetlb_regions() const noexcept { return hugetlb_regions_; }
+  [[nodiscard]] std::size_t numa_bound_regions() const noexcept { return numa_bound_; }
+
+  [[nodiscard]] std::size_t mapped_bytes() const noexcept
+  {
+    std::size_t total = 0;
+    for (const Region& region : regions_) {
+      total += region.bytes;
+    }
+    return total;
+  }
+};
+
+} // namespace tskv::common
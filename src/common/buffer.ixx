@@ -2,7 +2,7 @@ module;
 
 //------------------------------------------------------------------------------
 // Module: tskv.common.buffer
-// Summary: simple fixed-capacity byte buffer with span-based API
+// Summary: fixed-capacity byte buffers with span-based API (see Buffer concept)
 //
 //  - SimpleBuffer<BUFSIZE> owns a contiguous std::byte[BUFSIZE]
 //    * capacity() is constexpr and fixed at compile time
@@ -17,21 +17,42 @@ module;
 //    * suitable as a simple baseline for higher-performance buffer variants
 //  - type is trivially constructible and not thread-safe
 //    * callers are responsible for any external synchronization
+//
+//  - MirroredBuffer<BUFSIZE> is a ring buffer over one memfd mapped twice back-to-back
+//    * byte i and byte i + BUFSIZE alias, so spans crossing the wrap point stay contiguous
+//    * consume() is O(1): no compaction, regardless of how the buffer is drained
+//    * BUFSIZE must be a multiple of the page size
+//    * costs two VMAs per buffer (vm.max_map_count), so prefer it where pipelining is expected
+//
+//  - PooledBuffer<MAXSIZE> holds no memory while empty
+//    * a block is leased from the thread's BufferPool on first write and released when drained
+//    * starts at the smallest tier and moves up a tier (copying) whenever the block fills, so
+//      capacity() is an upper bound, not what an idle or lightly used buffer costs
+//    * consume() compacts like SimpleBuffer
 //------------------------------------------------------------------------------
 
 #include <algorithm>
 #include <cassert>
+#include <cerrno>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <span>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+#include "tskv/common/logging.hpp"
 
 export module tskv.common.buffer;
 
+import tskv.common.buffer_pool;
+import tskv.common.logging;
+
 export namespace tskv::common {
 
 // TODO[@zmeadows][P3]: Implement higher performance alternatives with identical interface.
-//                      (e.g., sliding window buffer, ring buffer, virtual memory mirrored ring buffer)
+//                      (e.g., sliding window buffer)
 
 template <typename B>
 concept Buffer =
@@ -140,7 +161,311 @@ public:
   }
 };
 
+template <std::size_t BUFSIZE>
+struct MirroredBuffer {
+private:
+  // [base_, base_ + BUFSIZE) and [base_ + BUFSIZE, base_ + 2 * BUFSIZE) map the same pages.
+  // INVARIANT: head_ < BUFSIZE and used_ <= BUFSIZE, so every span lies within the mapping.
+  std::byte*  base_ = nullptr;
+  std::size_t head_ = 0;
+  std::size_t used_ = 0;
+
+  static std::byte* map_mirrored()
+  {
+    const long page_size = ::sysconf(_SC_PAGESIZE);
+    TSKV_DEMAND(page_size > 0 && BUFSIZE % static_cast<std::size_t>(page_size) == 0,
+      "MirroredBuffer size {} is not a multiple of the page size {}",
+      BUFSIZE,
+      page_size);
+
+    const int memfd = ::memfd_create("tskv.buffer", MFD_CLOEXEC);
+    TSKV_DEMAND(memfd != -1, "memfd_create failed: errno={}", errno);
+    TSKV_DEMAND(::ftruncate(memfd, BUFSIZE) == 0, "ftruncate(memfd) failed: errno={}", errno);
+
+    // reserve 2 * BUFSIZE of address space, then map the memfd over both halves
+    void* base = ::mmap(nullptr, 2 * BUFSIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TSKV_DEMAND(base != MAP_FAILED, "mmap reservation failed: errno={}", errno);
+
+    std::byte* lo = static_cast<std::byte*>(base);
+    std::byte* hi = lo + BUFSIZE;
+
+    constexpr int prot  = PROT_READ | PROT_WRITE;
+    constexpr int flags = MAP_SHARED | MAP_FIXED;
+    TSKV_DEMAND(::mmap(lo, BUFSIZE, prot, flags, memfd, 0) != MAP_FAILED, "mmap (lo) failed");
+    TSKV_DEMAND(::mmap(hi, BUFSIZE, prot, flags, memfd, 0) != MAP_FAILED, "mmap (hi) failed");
+
+    // the mappings keep the pages alive; no need to hold on to the descriptor
+    ::close(memfd);
+
+    return lo;
+  }
+
+  void unmap() noexcept
+  {
+    if (base_ != nullptr) {
+      ::munmap(base_, 2 * BUFSIZE);
+      base_ = nullptr;
+    }
+  }
+
+public:
+  MirroredBuffer() : base_(map_mirrored()) {}
+  ~MirroredBuffer() { unmap(); }
+
+  MirroredBuffer(const MirroredBuffer&)            = delete;
+  MirroredBuffer& operator=(const MirroredBuffer&) = delete;
+
+  // CONTRACT: a moved-from buffer may only be destroyed or assigned to
+  MirroredBuffer(MirroredBuffer&& other) noexcept
+    : base_(std::exchange(other.base_, nullptr)),
+      head_(std::exchange(other.head_, 0)),
+      used_(std::exchange(other.used_, 0))
+  {
+  }
+
+  MirroredBuffer& operator=(MirroredBuffer&& other) noexcept
+  {
+    if (this != &other) {
+      unmap();
+      base_ = std::exchange(other.base_, nullptr);
+      head_ = std::exchange(other.head_, 0);
+      used_ = std::exchange(other.used_, 0);
+    }
+    return *this;
+  }
+
+  [[nodiscard]] static constexpr std::size_t capacity() noexcept { return BUFSIZE; }
+
+  [[nodiscard]] std::size_t used_space() const noexcept { return used_; }
+  [[nodiscard]] std::size_t free_space() const noexcept { return BUFSIZE - used_; }
+
+  [[nodiscard]] bool empty() const noexcept { return used_ == 0; }
+  [[nodiscard]] bool full() const noexcept { return used_ == BUFSIZE; }
+
+  void clear() noexcept
+  {
+    head_ = 0;
+    used_ = 0;
+  }
+
+  // Write as many bytes as will fit; returns bytes written.
+  [[nodiscard]] std::size_t write_from(std::span<const std::byte> src) noexcept
+  {
+    const std::size_t count = std::min(src.size(), free_space());
+    std::memcpy(base_ + head_ + used_, src.data(), count);
+    used_ += count;
+    return count;
+  }
+
+  // Read as many bytes as available; returns bytes read.
+  [[nodiscard]] std::size_t read_into(std::span<std::byte> dst) noexcept
+  {
+    const std::size_t count = std::min(dst.size(), used_space());
+    std::memcpy(dst.data(), base_ + head_, count);
+    consume(count);
+    return count;
+  }
+
+  // Returns a contiguous writable span up to `max_len` (and <= free_space()).
+  // Caller must later call commit(n) with n <= returned span size.
+  [[nodiscard]] std::span<std::byte> writable_span(std::size_t max_len = capacity()) noexcept
+  {
+    return std::span(base_ + head_ + used_, std::min(max_len, free_space()));
+  }
+
+  // Caller must ensure n <= returned span size from last writable_span call,
+  // with exactly one commit call per writable_span call
+  void commit(std::size_t n) noexcept { used_ += std::min(n, free_space()); }
+
+  // Returns a contiguous readable span up to `max_len` (and <= used_space())
+  // Caller can later optionally call consume(n) with n <= returned span size.
+  [[nodiscard]] std::span<const std::byte> readable_span(
+    std::size_t max_len = capacity()) const noexcept
+  {
+    return std::span(base_ + head_, std::min(max_len, used_space()));
+  }
+
+  // Caller must ensure n <= returned span size from last readable_span call,
+  // with exactly one consume call per readable_span call
+  void consume(std::size_t n) noexcept
+  {
+    n = std::min(n, used_space());
+
+    used_ -= n;
+    head_ += n;
+    if (head_ >= BUFSIZE) {
+      head_ -= BUFSIZE;
+    }
+
+    // restart at the front when drained, keeping the next writes on the same (hot) pages
+    if (used_ == 0) {
+      head_ = 0;
+    }
+  }
+};
+
+template <std::size_t MAXSIZE>
+struct PooledBuffer {
+private:
+  static_assert(BufferPool::is_tier_size(MAXSIZE), "PooledBuffer size must be a BufferPool tier");
+  static constexpr std::size_t MAX_TIER = BufferPool::tier_for(MAXSIZE);
+
+  // INVARIANT: block_ == nullptr <=> used_ == 0 (outside a writable_span/commit pair)
+  std::byte*  block_ = nullptr;
+  std::size_t tier_  = 0;
+  std::size_t used_  = 0;
+
+  [[nodiscard]] std::size_t block_size() const noexcept
+  {
+    return block_ ? BufferPool::TIER_BYTES[tier_] : 0;
+  }
+
+  // lease the first block, or move the contents up one tier
+  void grow() noexcept
+  {
+    if (block_ == nullptr) {
+      tier_  = 0;
+      block_ = BufferPool::local().lease(tier_);
+      return;
+    }
+
+    if (tier_ == MAX_TIER) {
+      return;
+    }
+
+    std::byte* bigger = BufferPool::local().lease(tier_ + 1);
+    std::memcpy(bigger, block_, used_);
+    BufferPool::local().release(block_, tier_);
+    block_ = bigger;
+    ++tier_;
+  }
+
+  void release_if_empty() noexcept
+  {
+    if (used_ == 0 && block_ != nullptr) {
+      BufferPool::local().release(block_, tier_);
+      block_ = nullptr;
+    }
+  }
+
+public:
+  PooledBuffer() = default;
+  ~PooledBuffer() { clear(); }
+
+  PooledBuffer(const PooledBuffer&)            = delete;
+  PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+  PooledBuffer(PooledBuffer&& other) noexcept
+    : block_(std::exchange(other.block_, nullptr)),
+      tier_(std::exchange(other.tier_, 0)),
+      used_(std::exchange(other.used_, 0))
+  {
+  }
+
+  PooledBuffer& operator=(PooledBuffer&& other) noexcept
+  {
+    if (this != &other) {
+      clear();
+      block_ = std::exchange(other.block_, nullptr);
+      tier_  = std::exchange(other.tier_, 0);
+      used_  = std::exchange(other.used_, 0);
+    }
+    return *this;
+  }
+
+  [[nodiscard]] static constexpr std::size_t capacity() noexcept { return MAXSIZE; }
+
+  [[nodiscard]] std::size_t used_space() const noexcept { return used_; }
+  [[nodiscard]] std::size_t free_space() const noexcept { return MAXSIZE - used_; }
+
+  [[nodiscard]] bool empty() const noexcept { return used_ == 0; }
+  [[nodiscard]] bool full() const noexcept { return used_ == MAXSIZE; }
+
+  // bytes of pool memory currently held (0 while empty)
+  [[nodiscard]] std::size_t leased_bytes() const noexcept { return block_size(); }
+
+  void clear() noexcept
+  {
+    used_ = 0;
+    release_if_empty();
+  }
+
+  // Write as many bytes as will fit; returns bytes written.
+  [[nodiscard]] std::size_t write_from(std::span<const std::byte> src) noexcept
+  {
+    std::size_t count = 0;
+    while (count < src.size() && !full()) {
+      const std::span<std::byte> dst = writable_span(src.size() - count);
+      std::memcpy(dst.data(), src.data() + count, dst.size());
+      commit(dst.size());
+      count += dst.size();
+    }
+    return count;
+  }
+
+  // Read as many bytes as available; returns bytes read.
+  [[nodiscard]] std::size_t read_into(std::span<std::byte> dst) noexcept
+  {
+    const std::size_t count = std::min(dst.size(), used_space());
+    if (count > 0) {
+      std::memcpy(dst.data(), block_, count);
+      consume(count);
+    }
+    return count;
+  }
+
+  // Returns a contiguous writable span up to `max_len` (and <= free_space()), leasing or growing
+  // the block if it has no room left. May be shorter than free_space(): the rest of the capacity
+  // becomes available once this span is filled.
+  // Caller must later call commit(n) with n <= returned span size.
+  [[nodiscard]] std::span<std::byte> writable_span(std::size_t max_len = capacity()) noexcept
+  {
+    if (used_ == block_size() && max_len > 0) {
+      grow();
+    }
+    return std::span(block_ + used_, std::min(max_len, block_size() - used_));
+  }
+
+  // Caller must ensure n <= returned span size from last writable_span call,
+  // with exactly one commit call per writable_span call
+  void commit(std::size_t n) noexcept
+  {
+    used_ += std::min(n, block_size() - used_);
+    release_if_empty(); // nothing arrived, e.g. recv() hit EAGAIN
+  }
+
+  // Returns a contiguous readable span up to `max_len` (and <= used_space())
+  // Caller can later optionally call consume(n) with n <= returned span size.
+  [[nodiscard]] std::span<const std::byte> readable_span(
+    std::size_t max_len = capacity()) const noexcept
+  {
+    return std::span(block_, std::min(max_len, used_space()));
+  }
+
+  // Caller must ensure n <= returned span size from last readable_span call,
+  // with exactly one consume call per readable_span call
+  void consume(std::size_t n) noexcept
+  {
+    if (n == 0) {
+      return;
+    }
+
+    n = std::min(n, used_space());
+
+    const std::size_t leftover = used_ - n;
+
+    if (leftover > 0) {
+      std::memmove(block_, block_ + n, leftover);
+    }
+
+    used_ -= n;
+    release_if_empty();
+  }
+};
+
 // Quick concept sanity check
 static_assert(Buffer<SimpleBuffer<1024>>);
+static_assert(Buffer<MirroredBuffer<4096>>);
+static_assert(Buffer<PooledBuffer<65536>>);
 
 } // namespace tskv::common
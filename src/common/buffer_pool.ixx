@@ -0,0 +1,143 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.common.buffer_pool
+// Summary: thread-local slab pool of fixed-size I/O blocks in a few size tiers
+//
+//  - blocks come in TIERS sizes (4 KiB, 16 KiB, 64 KiB), each carved out of 256 KiB slabs
+//    * lease()/release() are O(1) pops/pushes on a per-tier intrusive free list
+//    * slabs are never returned to the OS; the pool only grows to its high-water mark
+//  - BufferPool::local() is the calling thread's pool
+//    * a block must be released on the thread that leased it, before that thread exits
+//      (reactors own their channels, so buffers never migrate between threads)
+//  - leased/reserved bytes are published as buffer_pool.* additive gauges
+//------------------------------------------------------------------------------
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "tskv/common/logging.hpp"
+
+export module tskv.common.buffer_pool;
+
+import tskv.common.logging;
+import tskv.common.metrics;
+
+namespace metrics = tskv::common::metrics;
+
+export namespace tskv::common {
+
+class BufferPool {
+public:
+  static constexpr std::size_t                    TIERS      = 3;
+  static constexpr std::array<std::size_t, TIERS> TIER_BYTES = {4096, 16384, 65536};
+  static constexpr std::size_t                    SLAB_BYTES = 262144;
+
+  static_assert(SLAB_BYTES % TIER_BYTES[TIERS - 1] == 0);
+
+  // Smallest tier holding at least `bytes` (the largest tier if none does).
+  [[nodiscard]] static constexpr std::size_t tier_for(std::size_t bytes) noexcept
+  {
+    for (std::size_t tier = 0; tier < TIERS; ++tier) {
+      if (bytes <= TIER_BYTES[tier]) {
+        return tier;
+      }
+    }
+    return TIERS - 1;
+  }
+
+  [[nodiscard]] static constexpr bool is_tier_size(std::size_t bytes) noexcept
+  {
+    return TIER_BYTES[tier_for(bytes)] == bytes;
+  }
+
+private:
+  // free blocks store the link to the next free block in their first bytes
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  std::array<FreeBlock*, TIERS> free_{};
+  std::vector<void*>            slabs_;
+  std::size_t                   leased_bytes_   = 0;
+  std::size_t                   reserved_bytes_ = 0;
+
+  void grow(std::size_t tier)
+  {
+    void* slab = std::aligned_alloc(TIER_BYTES[0], SLAB_BYTES);
+    TSKV_DEMAND(slab != nullptr, "BufferPool: failed to allocate a {} byte slab", SLAB_BYTES);
+    slabs_.push_back(slab);
+
+    // thread the new blocks onto the free list, lowest address first
+    const std::size_t block_bytes = TIER_BYTES[tier];
+    std::byte*        base        = static_cast<std::byte*>(slab);
+    for (std::size_t offset = SLAB_BYTES; offset > 0; offset -= block_bytes) {
+      auto* block = reinterpret_cast<FreeBlock*>(base + offset - block_bytes);
+      block->next = free_[tier];
+      free_[tier] = block;
+    }
+
+    reserved_bytes_ += SLAB_BYTES;
+    metrics::add_gauge<"buffer_pool.reserved_bytes">(SLAB_BYTES);
+  }
+
+public:
+  BufferPool() = default;
+
+  BufferPool(const BufferPool&)            = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  ~BufferPool()
+  {
+    assert(leased_bytes_ == 0 && "BufferPool destroyed with blocks still leased");
+    for (void* slab : slabs_) {
+      std::free(slab);
+    }
+  }
+
+  [[nodiscard]] static BufferPool& local() noexcept
+  {
+    thread_local BufferPool pool;
+    return pool;
+  }
+
+  // Returns a block of exactly TIER_BYTES[tier] bytes, aligned to TIER_BYTES[0].
+  [[nodiscard]] std::byte* lease(std::size_t tier) noexcept
+  {
+    assert(tier < TIERS && "INVALID ARGS: no such buffer tier");
+
+    if (free_[tier] == nullptr) [[unlikely]] {
+      grow(tier);
+    }
+
+    FreeBlock* block = free_[tier];
+    free_[tier]      = block->next;
+
+    leased_bytes_ += TIER_BYTES[tier];
+    metrics::add_gauge<"buffer_pool.leased_bytes">(TIER_BYTES[tier]);
+
+    return reinterpret_cast<std::byte*>(block);
+  }
+
+  // CONTRACT: block came from lease(tier) on this pool and is not used afterwards
+  void release(std::byte* block, std::size_t tier) noexcept
+  {
+    assert(block != nullptr && tier < TIERS);
+
+    auto* freed = reinterpret_cast<FreeBlock*>(block);
+    freed->next = free_[tier];
+    free_[tier] = freed;
+
+    leased_bytes_ -= TIER_BYTES[tier];
+    metrics::sub_gauge<"buffer_pool.leased_bytes">(TIER_BYTES[tier]);
+  }
+
+  [[nodiscard]] std::size_t leased_bytes() const noexcept { return leased_bytes_; }
+  [[nodiscard]] std::size_t reserved_bytes() const noexcept { return reserved_bytes_; }
+};
+
+} // namespace tskv::common
@@ -0,0 +1,80 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.common.bytes
+// Summary: little-endian integers and raw bytes in byte buffers, shared by the wire format
+//          (tskv.net.frame) and the write-ahead log (tskv.storage.wal)
+//
+//  - load_le / store_le read and write an integer at any (unaligned) address
+//  - append_u32 / append_u64 / append_f64 / append_bytes grow a std::vector<std::byte>;
+//    patch_u32 overwrites a u32 reserved before its value was known
+//  - as_chars views bytes as the std::string_view keys and values are passed around as
+//------------------------------------------------------------------------------
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+
+export module tskv.common.bytes;
+
+export namespace tskv::common {
+
+template <typename T>
+[[nodiscard]] T load_le(const std::byte* p) noexcept
+{
+  T v;
+  std::memcpy(&v, p, sizeof v);
+  if constexpr (std::endian::native == std::endian::big) {
+    v = std::byteswap(v);
+  }
+  return v;
+}
+
+template <typename T>
+void store_le(std::byte* p, T v) noexcept
+{
+  if constexpr (std::endian::native == std::endian::big) {
+    v = std::byteswap(v);
+  }
+  std::memcpy(p, &v, sizeof v);
+}
+
+inline void append_u32(std::vector<std::byte>& out, std::uint32_t v)
+{
+  out.resize(out.size() + sizeof v);
+  store_le(out.data() + out.size() - sizeof v, v);
+}
+
+inline void append_u64(std::vector<std::byte>& out, std::uint64_t v)
+{
+  out.resize(out.size() + sizeof v);
+  store_le(out.data() + out.size() - sizeof v, v);
+}
+
+inline void append_f64(std::vector<std::byte>& out, double v)
+{
+  append_u64(out, std::bit_cast<std::uint64_t>(v));
+}
+
+// Overwrites the u32 at `offset`, e.g. a count reserved before the entries it counts were known.
+inline void patch_u32(std::vector<std::byte>& out, std::size_t offset, std::uint32_t v)
+{
+  store_le(out.data() + offset, v);
+}
+
+inline void append_bytes(std::vector<std::byte>& out, std::string_view s)
+{
+  const auto* p = reinterpret_cast<const std::byte*>(s.data());
+  out.insert(out.end(), p, p + s.size());
+}
+
+[[nodiscard]] inline std::string_view as_chars(std::span<const std::byte> bytes) noexcept
+{
+  return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+} // namespace tskv::common
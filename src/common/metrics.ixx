@@ -12,9 +12,15 @@ module;
 //    * all synchronization beyond flush_thread calls is hidden behind public API
 //  - global_reset is not intended in actual use, only in tests
 //  - counters and gauges are 64-bit unsigned, and currently allowed to freely wrap
+//  - histograms are fixed-size log-linear bucket arrays (no allocation on record)
 //------------------------------------------------------------------------------
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <mutex>
 #include <print>
@@ -40,7 +46,10 @@ using clock = std::chrono::steady_clock;
 //  Counter
 //==============================================================================
 
-using CounterKeysST = tc::key_set<"testc.foo_st",
+using CounterKeysST = tc::key_set<"testc.foo_st">;
+
+// net.* metrics are updated from every reactor thread, so they live in thread-local shards
+using CounterKeysMT = tc::key_set<"testc.foo_mt",
   "net.socket_error.total",
   "net.socket_error.econnreset",
   "net.socket_error.etimedout",
@@ -48,13 +57,46 @@ using CounterKeysST = tc::key_set<"testc.foo_st",
   "net.socket_error.enetdown",
   "net.socket_error.other",
   "net.bytes_received",
+  "net.rx_body_bytes",
   "net.bytes_sent",
   "net.accept_error.emfile",
   "net.accept_error.enfile",
   "net.accept_error.enobufs",
-  "net.accept_error.other">;
-
-using CounterKeysMT = tc::key_set<"testc.foo_mt">;
+  "net.accept_error.other",
+  "net.accept_shed",
+  "net.listener_pauses",
+  "net.stale_events",
+  "net.budget_deferrals",
+  "net.backpressure_events_total",
+  "net.zerocopy_sends",
+  "net.zerocopy_copied",
+  "net.idle_timeouts",
+  "net.deadline_timeouts",
+  "net.completions",
+  "net.completion_batches",
+  "net.stale_completions",
+  "net.uring.recv_nobufs",
+  "rpc.frames",
+  "rpc.frame_errors",
+  "rpc.streamed_frames",
+  "rpc.unknown_frames",
+  "rpc.bad_payloads",
+  "rpc.mget_keys",
+  "rpc.mput_points",
+  "rpc.scans",
+  "rpc.scan_batches",
+  "rpc.scan_entries",
+  "rpc.aggregates",
+  "rpc.aggregate_buckets",
+  "rpc.aggregate_points",
+  "rpc.points_written",
+  "rpc.points_scanned",
+  "resp.commands",
+  "resp.errors",
+  "resp.protocol_errors",
+  "wal.appends",
+  "wal.bytes",
+  "wal.errors">;
 
 using CounterKeys = tc::key_set_union_t<CounterKeysST, CounterKeysMT>;
 
@@ -64,7 +106,10 @@ using CounterKeys = tc::key_set_union_t<CounterKeysST, CounterKeysMT>;
 
 using AdditiveGaugeKeysST = tc::key_set<"testg.foo_st">;
 
-using AdditiveGaugeKeysMT = tc::key_set<"testg.foo_mt">;
+using AdditiveGaugeKeysMT = tc::key_set<"testg.foo_mt",
+  "net.backpressured_connections",
+  "buffer_pool.leased_bytes",
+  "buffer_pool.reserved_bytes">;
 
 using AdditiveGaugeKeys = tc::key_set_union_t<AdditiveGaugeKeysST, AdditiveGaugeKeysMT>;
 
@@ -96,6 +141,96 @@ void AdditiveGaugeShard::sync(gauge_t& global, const AdditiveGaugeShard& shard)
   }
 }
 
+//==============================================================================
+//  Histogram
+//==============================================================================
+
+using HistogramKeysST = tc::key_set<"testh.foo_st">;
+
+using HistogramKeysMT = tc::key_set<"testh.foo_mt",
+  "net.loop_iteration_ns",
+  "net.wakeup_latency_ns",
+  "rpc.batch_size",
+  "rpc.mget_batch_ns",
+  "rpc.mput_batch_ns",
+  "rpc.put_points_batch_ns">;
+
+using HistogramKeys = tc::key_set_union_t<HistogramKeysST, HistogramKeysMT>;
+
+// HDR-style log-linear buckets: exact below 2^SUB_BITS, then 2^SUB_BITS buckets per power of two,
+// so quantiles are reported within 1/16 (6.25%) of the true value. About 8 KiB per histogram.
+struct Histogram {
+  static constexpr unsigned    SUB_BITS = 4;
+  static constexpr std::size_t NBUCKETS = (64 - SUB_BITS + 1) << SUB_BITS;
+
+  std::array<counter_t, NBUCKETS> buckets{};
+  counter_t                       count = 0;
+  std::uint64_t                   sum   = 0;
+  std::uint64_t                   max   = 0;
+
+  [[nodiscard]] static constexpr std::size_t bucket_of(std::uint64_t value) noexcept
+  {
+    if (value < (std::uint64_t{1} << SUB_BITS)) {
+      return value;
+    }
+    const unsigned shift = std::bit_width(value) - 1 - SUB_BITS;
+    return ((shift + 1) << SUB_BITS) + ((value >> shift) & ((1u << SUB_BITS) - 1));
+  }
+
+  // largest value that maps to bucket b
+  [[nodiscard]] static constexpr std::uint64_t bucket_upper(std::size_t b) noexcept
+  {
+    if (b < (std::size_t{1} << SUB_BITS)) {
+      return b;
+    }
+    const unsigned      shift = (b >> SUB_BITS) - 1;
+    const std::uint64_t base  = (b & ((1u << SUB_BITS) - 1)) | (std::uint64_t{1} << SUB_BITS);
+    return (base << shift) + ((std::uint64_t{1} << shift) - 1);
+  }
+
+  TSKV_INLINE void record(std::uint64_t value) noexcept
+  {
+    ++buckets[bucket_of(value)];
+    ++count;
+    sum += value;
+    max = std::max(max, value);
+  }
+
+  Histogram& operator+=(const Histogram& other) noexcept
+  {
+    if (other.count == 0) {
+      return *this; // common for idle shards; skip the bucket walk
+    }
+    for (std::size_t b = 0; b < NBUCKETS; ++b) {
+      buckets[b] += other.buckets[b];
+    }
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+    return *this;
+  }
+
+  // Upper bound of the bucket holding the q-th quantile (q in [0, 1]); 0 when empty.
+  [[nodiscard]] std::uint64_t quantile(double q) const noexcept
+  {
+    if (count == 0) {
+      return 0;
+    }
+
+    const auto rank = std::clamp<counter_t>(
+      static_cast<counter_t>(std::ceil(q * static_cast<double>(count))), 1, count);
+
+    counter_t seen = 0;
+    for (std::size_t b = 0; b < NBUCKETS; ++b) {
+      seen += buckets[b];
+      if (seen >= rank) {
+        return std::min(bucket_upper(b), max);
+      }
+    }
+    return max;
+  }
+};
+
 //==============================================================================
 //  ThreadLocalMetrics
 //==============================================================================
@@ -103,6 +238,7 @@ void AdditiveGaugeShard::sync(gauge_t& global, const AdditiveGaugeShard& shard)
 struct ThreadLocalMetrics {
   tc::key_array<counter_t, CounterKeysMT>                counters{};
   tc::key_array<AdditiveGaugeShard, AdditiveGaugeKeysMT> additive_gauges{};
+  tc::key_array<Histogram, HistogramKeysMT>              histograms{};
 
   ThreadLocalMetrics() = default;
 
@@ -123,6 +259,12 @@ void ThreadLocalMetrics::post_sync()
   for (AdditiveGaugeShard& shard : additive_gauges.data) {
     shard.post_sync();
   }
+
+  for (Histogram& h : histograms.data) {
+    if (h.count != 0) {
+      h = Histogram{};
+    }
+  }
 }
 
 inline ThreadLocalMetrics& local_metrics()
@@ -138,6 +280,7 @@ inline ThreadLocalMetrics& local_metrics()
 struct GlobalMetrics {
   tc::key_array<counter_t, CounterKeys>     counters{};
   tc::key_array<gauge_t, AdditiveGaugeKeys> additive_gauges{};
+  tc::key_array<Histogram, HistogramKeys>   histograms{};
 
   void sync_with(const ThreadLocalMetrics& local);
 };
@@ -148,6 +291,7 @@ std::mutex              global_metrics_mutex;
 void GlobalMetrics::sync_with(const ThreadLocalMetrics& local)
 {
   this->counters += local.counters;
+  this->histograms += local.histograms;
 
   tc::bitransform_key_arrays(
     this->additive_gauges, local.additive_gauges, AdditiveGaugeShard::sync);
@@ -199,6 +343,18 @@ void print()
   for (std::size_t i = 0; i < metrics.additive_gauges.size; i++) {
     std::println("{}: {}", metrics.additive_gauges.key_names[i], metrics.additive_gauges.data[i]);
   }
+
+  for (std::size_t i = 0; i < metrics.histograms.size; i++) {
+    const Histogram& h = metrics.histograms.data[i];
+    std::println("{}: count={} p50={} p90={} p99={} p999={} max={}",
+      metrics.histograms.key_names[i],
+      h.count,
+      h.quantile(0.5),
+      h.quantile(0.9),
+      h.quantile(0.99),
+      h.quantile(0.999),
+      h.max);
+  }
 }
 
 template <auto>
@@ -232,6 +388,35 @@ void set_gauge(gauge_t n) noexcept
   }
 }
 
+template <tc::string_literal K>
+void add_gauge(gauge_t n) noexcept
+{
+  if constexpr (AdditiveGaugeKeysMT::contains<K>()) {
+    AdditiveGaugeShard& shard = local_metrics().additive_gauges.get<K>();
+    shard.set(shard.current() + n);
+  }
+  else if constexpr (AdditiveGaugeKeysST::contains<K>()) {
+    global_metrics.additive_gauges.get<K>() += n;
+  }
+  else {
+    static_assert(dependent_false<K>, "Unrecognized gauge key.");
+  }
+}
+
+template <tc::string_literal K>
+void record_histogram(std::uint64_t value) noexcept
+{
+  if constexpr (HistogramKeysMT::contains<K>()) {
+    local_metrics().histograms.get<K>().record(value);
+  }
+  else if constexpr (HistogramKeysST::contains<K>()) {
+    global_metrics.histograms.get<K>().record(value);
+  }
+  else {
+    static_assert(dependent_false<K>, "Unrecognized histogram key.");
+  }
+}
+
 } // namespace detail
 
 //==============================================================================
@@ -243,6 +428,7 @@ export namespace tskv::common::metrics {
 using clock     = std::chrono::steady_clock;
 using counter_t = counter_t;
 using gauge_t   = gauge_t;
+using Histogram = detail::Histogram;
 
 TSKV_INLINE void print()
 {
@@ -285,6 +471,20 @@ TSKV_INLINE void set_gauge(gauge_t n) noexcept
   detail::set_gauge<K>(n);
 }
 
+// Relative updates, for gauges tracking a count (e.g., connections in some state). For MT gauges
+// the shard may dip "below zero" and wrap; only the global sum is meaningful.
+template <tc::string_literal K>
+TSKV_INLINE void add_gauge(gauge_t n) noexcept
+{
+  detail::add_gauge<K>(n);
+}
+
+template <tc::string_literal K>
+TSKV_INLINE void sub_gauge(gauge_t n) noexcept
+{
+  detail::add_gauge<K>(gauge_t{0} - n);
+}
+
 template <tc::string_literal K>
 TSKV_INLINE gauge_t get_gauge() noexcept
 {
@@ -292,4 +492,19 @@ TSKV_INLINE gauge_t get_gauge() noexcept
   return detail::global_metrics.additive_gauges.get<K>();
 }
 
+// e.g. record_histogram<"net.loop_iteration_ns">(elapsed.count());
+template <tc::string_literal K>
+TSKV_INLINE void record_histogram(std::uint64_t value) noexcept
+{
+  detail::record_histogram<K>(value);
+}
+
+// Snapshot of the global histogram (MT histograms only include flushed shards).
+template <tc::string_literal K>
+TSKV_INLINE Histogram get_histogram() noexcept
+{
+  std::scoped_lock lock(detail::global_metrics_mutex);
+  return detail::global_metrics.histograms.get<K>();
+}
+
 } // namespace tskv::common::metrics
@@ -0,0 +1,281 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.common.scan
+// Summary: vectorized delimiter and integer scanning for text protocol parsers
+//
+//  - kernels work on std::span<const std::byte> (what ChannelIO::rx_span() hands out)
+//    * find_crlf: offset of the first "\r\n"
+//  - each kernel has a scalar, an SSE2 and an AVX2 version; the best one the CPU supports is picked
+//    once at startup (cpuid via __builtin_cpu_supports) and called through a function table
+//    * AVX2 versions are compiled with __attribute__((target("avx2"))), so the rest of the build
+//      needs no -mavx2
+//  - parse_int_line() reads a "[-]<digits>\r\n" length line (RESP's *<n> and $<n>) with SWAR
+//    (8 bytes per 64-bit word): one word finds the end of the digit run, and values of more than
+//    4 digits are combined eight digits at a time instead of one multiply-add per digit
+//    * deliberately not dispatched: length fields are a few bytes long, and an indirect call plus
+//      a 16-byte vector load cost more than they save there (see bench_scan)
+//  - set_scan_isa() pins a kernel set, so tests and benchmarks can compare against the scalar path;
+//    it is not synchronized and must be called before other threads start scanning
+//------------------------------------------------------------------------------
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#if defined(__x86_64__)
+#  include <immintrin.h>
+#endif
+
+#include "tskv/common/attributes.hpp"
+
+export module tskv.common.scan;
+
+import tskv.common.enum_traits;
+
+export namespace tskv::common {
+
+enum class ScanIsa : std::uint8_t { Scalar, Sse2, Avx2 };
+
+struct ScanKernels {
+  ScanIsa isa;
+  std::size_t (*find_crlf)(std::span<const std::byte> bytes) noexcept;
+};
+
+} // namespace tskv::common
+
+namespace tskv::common::detail {
+
+inline constexpr std::byte CR{'\r'};
+inline constexpr std::byte LF{'\n'};
+
+[[nodiscard]] constexpr bool is_digit(std::byte b) noexcept
+{
+  return static_cast<unsigned char>(static_cast<unsigned char>(b) - '0') <= 9;
+}
+
+[[nodiscard]] inline std::size_t find_crlf_scalar(std::span<const std::byte> bytes) noexcept
+{
+  for (std::size_t i = 0; i + 1 < bytes.size(); ++i) {
+    if (bytes[i] == CR && bytes[i + 1] == LF) {
+      return i;
+    }
+  }
+  return bytes.size();
+}
+
+#if defined(__x86_64__)
+
+// A match needs the '\r' at i and the '\n' at i + 1, so each step compares two overlapping loads.
+[[nodiscard]] inline std::size_t find_crlf_sse2(std::span<const std::byte> bytes) noexcept
+{
+  const std::byte* p  = bytes.data();
+  const __m128i    cr = _mm_set1_epi8('\r');
+  const __m128i    lf = _mm_set1_epi8('\n');
+
+  std::size_t i = 0;
+  for (; i + 17 <= bytes.size(); i += 16) {
+    const __m128i a    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    const __m128i b    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 1));
+    const auto    mask = static_cast<unsigned>(
+      _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, cr), _mm_cmpeq_epi8(b, lf))));
+    if (mask != 0) {
+      return i + static_cast<std::size_t>(std::countr_zero(mask));
+    }
+  }
+  return i + find_crlf_scalar(bytes.subspan(i));
+}
+
+__attribute__((target("avx2"))) inline std::size_t find_crlf_avx2(
+  std::span<const std::byte> bytes) noexcept
+{
+  const std::byte* p  = bytes.data();
+  const __m256i    cr = _mm256_set1_epi8('\r');
+  const __m256i    lf = _mm256_set1_epi8('\n');
+
+  std::size_t i = 0;
+  for (; i + 33 <= bytes.size(); i += 32) {
+    const __m256i a    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    const __m256i b    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 1));
+    const auto    mask = static_cast<unsigned>(_mm256_movemask_epi8(
+      _mm256_and_si256(_mm256_cmpeq_epi8(a, cr), _mm256_cmpeq_epi8(b, lf))));
+    if (mask != 0) {
+      return i + static_cast<std::size_t>(std::countr_zero(mask));
+    }
+  }
+  return i + find_crlf_sse2(bytes.subspan(i));
+}
+
+#endif
+
+inline constexpr ScanKernels SCALAR_KERNELS{ScanIsa::Scalar, find_crlf_scalar};
+#if defined(__x86_64__)
+inline constexpr ScanKernels SSE2_KERNELS{ScanIsa::Sse2, find_crlf_sse2};
+inline constexpr ScanKernels AVX2_KERNELS{ScanIsa::Avx2, find_crlf_avx2};
+#endif
+
+[[nodiscard]] inline ScanIsa best_scan_isa() noexcept
+{
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return ScanIsa::Avx2;
+  }
+  return ScanIsa::Sse2; // baseline on x86-64
+#else
+  return ScanIsa::Scalar;
+#endif
+}
+
+[[nodiscard]] inline const ScanKernels& kernels_for(ScanIsa isa) noexcept
+{
+  switch (isa) {
+#if defined(__x86_64__)
+    case ScanIsa::Avx2:
+      return best_scan_isa() == ScanIsa::Avx2 ? AVX2_KERNELS : SSE2_KERNELS;
+    case ScanIsa::Sse2:
+      return SSE2_KERNELS;
+#endif
+    default:
+      return SCALAR_KERNELS;
+  }
+}
+
+inline const ScanKernels* active_kernels = &kernels_for(best_scan_isa());
+
+[[nodiscard]] inline std::uint64_t load_word(const std::byte* p) noexcept
+{
+  std::uint64_t v;
+  std::memcpy(&v, p, sizeof v);
+  return v;
+}
+
+// Number of leading ASCII digits in bytes, stopping early once there are more than `limit`. A byte
+// is a digit iff its high nibble is 3 and adding 6 leaves it at 3; the lowest byte failing that is
+// the first non-digit (a carry out of a failing byte can only spoil the bytes after it).
+[[nodiscard]] inline std::size_t count_digits_swar(
+  std::span<const std::byte> bytes, std::size_t limit) noexcept
+{
+  std::size_t n = 0;
+  for (; n + 8 <= bytes.size() && n <= limit; n += 8) {
+    const std::uint64_t v     = load_word(bytes.data() + n);
+    const std::uint64_t tags  = (v & 0xF0F0F0F0F0F0F0F0)
+                             | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4);
+    const std::uint64_t wrong = tags ^ 0x3333333333333333;
+    if (wrong != 0) {
+      return n + static_cast<std::size_t>(std::countr_zero(wrong)) / 8;
+    }
+  }
+  while (n < bytes.size() && n <= limit && is_digit(bytes[n])) {
+    ++n;
+  }
+  return n;
+}
+
+// Value of up to 8 ASCII digits at p; 8 bytes must be readable from p. The digits are shifted to
+// the top of the word (the bytes below them become leading zeros), then adjacent lanes are
+// combined pairwise: 1-digit lanes into 2-digit, into 4-digit, into the 8-digit result.
+[[nodiscard]] inline std::uint64_t parse_digits_swar(const std::byte* p, std::size_t n) noexcept
+{
+  std::uint64_t v = load_word(p) << (8 * (8 - n));
+  v = ((v & 0x0F0F0F0F0F0F0F0F) * 2561) >> 8;
+  v = ((v & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+  return ((v & 0x0000FFFF0000FFFF) * 42949672960001) >> 32;
+}
+
+} // namespace tskv::common::detail
+
+export namespace tskv::common {
+
+template <>
+struct enum_traits<ScanIsa> {
+  static constexpr std::array<std::pair<ScanIsa, std::string_view>, 3> entries{{
+    {ScanIsa::Scalar, "scalar"},
+    {ScanIsa::Sse2, "sse2"},
+    {ScanIsa::Avx2, "avx2"},
+  }};
+};
+
+// Kernel set for `isa`, or the best available one below it if the CPU lacks it.
+[[nodiscard]] inline const ScanKernels& scan_kernels(ScanIsa isa) noexcept
+{
+  return detail::kernels_for(isa);
+}
+
+[[nodiscard]] inline ScanIsa scan_isa() noexcept { return detail::active_kernels->isa; }
+
+// Routes find_crlf through `isa` (clamped to what the CPU supports) and returns the previous
+// setting.
+inline ScanIsa set_scan_isa(ScanIsa isa) noexcept
+{
+  const ScanIsa previous = scan_isa();
+  detail::active_kernels = &detail::kernels_for(isa);
+  return previous;
+}
+
+// Offset of the first "\r\n" in bytes, or bytes.size() if there is none.
+[[nodiscard]] inline std::size_t find_crlf(std::span<const std::byte> bytes) noexcept
+{
+  return detail::active_kernels->find_crlf(bytes);
+}
+
+enum class IntLineStatus : std::uint8_t {
+  Ok,
+  Incomplete, // a valid prefix; need more bytes
+  Bad, // not "[-]<digits>\r\n", or more than INT_LINE_MAX_DIGITS digits
+};
+
+inline constexpr std::size_t INT_LINE_MAX_DIGITS = 18; // always fits in int64_t
+
+struct IntLine {
+  IntLineStatus status = IntLineStatus::Incomplete;
+  std::size_t   size   = 0; // bytes taken, CRLF included, if Ok
+  std::int64_t  value  = 0;
+};
+
+// Parses "[-]<digits>\r\n" at the front of bytes.
+[[nodiscard]] TSKV_INLINE IntLine parse_int_line(std::span<const std::byte> bytes) noexcept
+{
+  const bool        negative = !bytes.empty() && bytes[0] == std::byte{'-'};
+  const std::size_t start    = negative ? 1 : 0;
+
+  const std::span<const std::byte> rest = bytes.subspan(start);
+  const std::size_t                n    = detail::count_digits_swar(rest, INT_LINE_MAX_DIGITS);
+  if (n > INT_LINE_MAX_DIGITS) {
+    return {IntLineStatus::Bad, 0, 0};
+  }
+  if (n + 2 > rest.size()) {
+    // nothing after the digits yet, or a lone '\r'
+    const bool prefix = n == rest.size() || rest[n] == detail::CR;
+    return {prefix ? IntLineStatus::Incomplete : IntLineStatus::Bad, 0, 0};
+  }
+  if (n == 0 || rest[n] != detail::CR || rest[n + 1] != detail::LF) {
+    return {IntLineStatus::Bad, 0, 0};
+  }
+
+  // Short values (most RESP lengths) are cheaper as a plain loop than as the multiply chain. The
+  // leading chunk is the short one, so every chunk has 8 readable bytes once rest has 8.
+  std::uint64_t value = 0;
+  if (n > 4 && rest.size() >= 8) {
+    std::size_t i     = 0;
+    std::size_t chunk = n % 8 == 0 ? 8 : n % 8;
+    for (; i < n; i += chunk, chunk = 8) {
+      value = value * 100'000'000 + detail::parse_digits_swar(rest.data() + i, chunk);
+    }
+  }
+  else {
+    for (std::size_t i = 0; i < n; ++i) {
+      value = value * 10 + (static_cast<std::uint64_t>(rest[i]) - '0');
+    }
+  }
+
+  const auto signed_value = static_cast<std::int64_t>(value);
+  return {IntLineStatus::Ok, start + n + 2, negative ? -signed_value : signed_value};
+}
+
+} // namespace tskv::common
@@ -1,23 +1,28 @@
 module;
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
+#include <chrono>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <linux/errqueue.h>
 #include <memory>
 #include <netdb.h>
+#include <netinet/in.h>
 #include <numeric>
+#include <optional>
 #include <span>
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <system_error>
 #include <unistd.h>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -26,9 +31,13 @@ module;
 
 export module tskv.net.channel;
 
+import tskv.common.arena;
 import tskv.common.buffer;
 import tskv.common.logging;
 import tskv.common.metrics;
+import tskv.net.completion_queue;
+import tskv.net.timer_wheel;
+import tskv.net.tx_queue;
 
 namespace tc      = tskv::common;
 namespace metrics = tskv::common::metrics;
@@ -40,6 +49,11 @@ inline std::size_t ceil_div(std::size_t x, std::size_t y)
 }
 
 // TODO[@zmeadows][P2]: stricter requirements: default-constructible, nothrow, etc
+// Optional: `void on_timeout(IO&)`, called when a deadline set via ChannelIO::set_deadline passes.
+// Optional: `void on_body(IO&)`, called when a span handed to ChannelIO::rx_stream has filled up;
+// required by protocols that call rx_stream.
+// Optional: `void on_writable(IO&)`, called once TX has room after ChannelIO::request_writable;
+// required by protocols that call request_writable.
 template <class P, class IO>
 concept ProtocolFor = requires(P p, IO& io, int ec) {
   { p.on_read(io) } -> std::same_as<void>;
@@ -49,7 +63,20 @@ concept ProtocolFor = requires(P p, IO& io, int ec) {
 
 export namespace tskv::net {
 
-enum class SendResult : std::uint8_t { Full, Partial, Forbidden };
+enum class SendResult : std::uint8_t {
+  Full, // every byte queued
+  Backpressured, // every byte queued, but TX is now above its high watermark
+  Partial, // some bytes queued, TX is full (implies backpressured)
+  Blocked, // nothing queued, TX is full (implies backpressured)
+  Forbidden // channel is closing; nothing will ever be sent
+};
+
+// Upper bound on socket I/O performed for one channel per dispatch, so that a single busy peer
+// cannot monopolize its reactor. Work left over is reported via Channel::deferred_events().
+struct IoBudget {
+  std::size_t rx_bytes = std::numeric_limits<std::size_t>::max();
+  std::size_t tx_bytes = std::numeric_limits<std::size_t>::max();
+};
 
 template <class Proto>
 class ChannelIO;
@@ -57,56 +84,344 @@ class ChannelIO;
 template <class Proto>
 concept Protocol = ProtocolFor<Proto, ChannelIO<Proto>>;
 
+// typical life-cycle is Running -> Draining -> Closed. Aborting can come from any state.
+enum class ChannelState : std::uint8_t {
+  Running, // normal
+  Draining, // EOF, flushing TX
+  Aborting, // dropping immediately
+  Closed
+};
+
+namespace detail {
+
+template <class Ch>
+struct ChannelLink {
+  ChannelLink* prev  = nullptr;
+  ChannelLink* next  = nullptr;
+  Ch*          owner = nullptr;
+};
+
+} // namespace detail
+
+// Intrusive doubly-linked list of channels, threaded through one of their ChannelLinks. O(1)
+// insert/erase and no allocation; a channel's own transitions keep it on the right list.
+template <class Ch>
+class ChannelList {
+  using Link = detail::ChannelLink<Ch>;
+
+  Link        head_;
+  std::size_t size_ = 0;
+
+public:
+  ChannelList() noexcept { head_.prev = head_.next = &head_; }
+
+  // head_ points at itself
+  ChannelList(const ChannelList&)            = delete;
+  ChannelList& operator=(const ChannelList&) = delete;
+
+  [[nodiscard]] bool        empty() const noexcept { return size_ == 0; }
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+  void push_back(Link& link) noexcept
+  {
+    assert(link.next == nullptr && "ChannelLink already on a list");
+    link.prev        = head_.prev;
+    link.next        = &head_;
+    head_.prev->next = &link;
+    head_.prev       = &link;
+    ++size_;
+  }
+
+  // CONTRACT: link is on this list, or on none (then this is a no-op)
+  void erase(Link& link) noexcept
+  {
+    if (link.next == nullptr) {
+      return;
+    }
+    link.prev->next = link.next;
+    link.next->prev = link.prev;
+    link.prev       = nullptr;
+    link.next       = nullptr;
+    --size_;
+  }
+
+  // fn(Ch*) may move the visited channel to another list (or close it), but no other channel.
+  template <typename Fn>
+  void for_each(Fn&& fn)
+  {
+    for (Link* link = head_.next; link != &head_;) {
+      Link* next = link->next;
+      fn(link->owner);
+      link = next;
+    }
+  }
+};
+
+template <class Ch>
+struct ChannelLists {
+  ChannelList<Ch> by_state[3]; // indexed by ChannelState (Closed channels are on no list)
+  ChannelList<Ch> backpressured;
+
+  [[nodiscard]] ChannelList<Ch>& of(ChannelState state) noexcept
+  {
+    assert(state != ChannelState::Closed);
+    return by_state[static_cast<std::size_t>(state)];
+  }
+
+  [[nodiscard]] const ChannelList<Ch>& of(ChannelState state) const noexcept
+  {
+    assert(state != ChannelState::Closed);
+    return by_state[static_cast<std::size_t>(state)];
+  }
+};
+
+template <Protocol Proto>
+struct ChannelPool;
+
+// Per-protocol buffer selection. By default both buffers are leased from the reactor thread's
+// BufferPool only while they hold data, so an idle connection costs no buffer memory; RX may grow
+// to 64 KiB for large requests, while TX stays at 4 KiB (it sets the backpressure watermarks, and
+// large responses go through tx_enqueue instead). Specialize to swap buffer types, e.g. for
+// pipelined protocols where compaction on partial consume() becomes the bottleneck:
+//
+//   template <>
+//   struct channel_traits<MyProtocol> {
+//     using rx_buffer = tc::MirroredBuffer<65536>;
+//     using tx_buffer = tc::MirroredBuffer<65536>;
+//   };
+//
+// A specialization may also set `static constexpr std::size_t tx_high_watermark`, for protocols
+// whose large responses are queued segments: TX then holds that much before backpressure, instead
+// of 3/4 of tx_buffer.
+template <class Proto>
+struct channel_traits {
+  using rx_buffer = tc::PooledBuffer<65536>;
+  using tx_buffer = tc::PooledBuffer<4096>;
+};
+
 template <Protocol Proto>
 struct Channel {
 private:
-  static constexpr auto TX_BUF_SIZE = 4096;
-  static constexpr auto RX_BUF_SIZE = 4096;
-
-  tc::SimpleBuffer<TX_BUF_SIZE> tx_buf_{};
-  tc::SimpleBuffer<RX_BUF_SIZE> rx_buf_{};
-
-  // typical life-cycle is Running -> Draining -> Closed. Aborting can come from any state.
-  enum class SocketState : std::uint8_t {
-    Running, // normal
-    Draining, // EOF, flushing TX
-    Aborting, // dropping immediately
-    Closed
-  };
+  using TxBuffer = typename channel_traits<Proto>::tx_buffer;
+  using RxBuffer = typename channel_traits<Proto>::rx_buffer;
+  static_assert(tc::Buffer<TxBuffer> && tc::Buffer<RxBuffer>);
+
+  TxBuffer tx_buf_{};
+  RxBuffer rx_buf_{};
+
+  // Outgoing bytes are tx_buf_ (copied in by tx_send) followed by tx_queue_ (segments handed over
+  // by tx_enqueue, never copied). tx_send only writes to tx_buf_ while tx_queue_ is empty, so
+  // bytes always leave in the order the protocol produced them.
+  TxQueue         tx_queue_;
+  ZeroCopyTracker zerocopy_;
+  std::size_t     zerocopy_threshold_ = 0; // 0: MSG_ZEROCOPY disabled
+
+  // max iovecs per sendmsg(); well below IOV_MAX
+  static constexpr std::size_t TX_IOV_BATCH = 64;
+
+  // Once TX holds TX_HIGH_WATERMARK bytes the channel is backpressured: it stops reading from the
+  // socket until TX drains to TX_LOW_WATERMARK. The gap keeps EPOLLIN from flapping on every send.
+  static constexpr std::size_t TX_HIGH_WATERMARK = [] {
+    if constexpr (requires { channel_traits<Proto>::tx_high_watermark; }) {
+      return std::size_t{channel_traits<Proto>::tx_high_watermark};
+    }
+    else {
+      return TxBuffer::capacity() * 3 / 4;
+    }
+  }();
+  static constexpr std::size_t TX_LOW_WATERMARK = TX_HIGH_WATERMARK / 3;
+
+  using SocketState = ChannelState;
 
   int fd_ = -1;
 
   std::uint32_t last_events_mask_ = 0;
 
+  // events cut short by the IoBudget in the last handle_events() call (or TX filled by
+  // deliver_completion); with edge-triggering the kernel will not report these again, so the
+  // reactor must replay them itself
+  std::uint32_t deferred_events_ = 0;
+  bool          ready_queued_    = false;
+
+  bool backpressured_ = false;
+
+  // Scheduled on the reactor's TimerWheel; the channel only carries them. The idle timer is not
+  // moved on every event: the reactor stamps last_active_tick_ and re-checks when it fires.
+  Timer         idle_timer_;
+  Timer         deadline_timer_;
+  std::uint64_t last_active_tick_ = 0;
+
+  // Body sink set by ChannelIO::rx_stream: the unfilled rest of the protocol's span. While it is
+  // non-empty, received bytes go straight into it instead of into rx_buf_ (which is empty then).
+  // body_done_ is set once it fills; the protocol hears about it through on_body().
+  std::span<std::byte> body_;
+  bool                 body_done_ = false;
+
+  // set by ChannelIO::request_writable: the protocol has more output to produce once TX has room
+  // (see refill_tx)
+  bool writable_wanted_ = false;
+
+  // set through ChannelIO::set_deadline, applied by the reactor after the protocol returns
+  bool                      deadline_request_pending_ = false;
+  std::chrono::milliseconds deadline_request_{0};
+
   SocketState socket_state_ = SocketState::Closed;
 
+  // The owning ChannelPool, and hooks into its lists: one per socket state, plus the backpressured
+  // list. Kept current by set_socket_state() and set_backpressured(), so the reactor can find the
+  // channels that need attention without sweeping the whole pool.
+  ChannelPool<Proto>*          pool_ = nullptr;
+  detail::ChannelLink<Channel> state_link_{nullptr, nullptr, this};
+  detail::ChannelLink<Channel> backpressure_link_{nullptr, nullptr, this};
+
+  // responses handed out via ChannelIO::completion_target() that have not come back yet; a
+  // draining channel stays open until they have (see should_close)
+  std::uint32_t completions_pending_ = 0;
+
   Proto proto_;
 
   friend class ChannelIO<Proto>; // allow IO façade to access internals
+  friend struct ChannelPool<Proto>;
+
+  void set_socket_state(SocketState state) noexcept
+  {
+    if (pool_ != nullptr) {
+      if (socket_state_ != SocketState::Closed) {
+        pool_->lists_.of(socket_state_).erase(state_link_);
+      }
+      if (state != SocketState::Closed) {
+        pool_->lists_.of(state).push_back(state_link_);
+      }
+    }
+    socket_state_ = state;
+  }
+
+  void set_backpressured(bool backpressured) noexcept
+  {
+    if (pool_ != nullptr) {
+      if (backpressured) {
+        pool_->lists_.backpressured.push_back(backpressure_link_);
+      }
+      else {
+        pool_->lists_.backpressured.erase(backpressure_link_);
+      }
+    }
+    backpressured_ = backpressured;
+  }
+
+  // the pool releases a slot: forget the lists even if the channel was never detached
+  void unlink_from_lists() noexcept
+  {
+    if (pool_ != nullptr) {
+      if (socket_state_ != SocketState::Closed) {
+        pool_->lists_.of(socket_state_).erase(state_link_);
+      }
+      pool_->lists_.backpressured.erase(backpressure_link_);
+    }
+  }
 
   [[nodiscard]] inline bool can_read() const noexcept
   {
-    return socket_state_ == SocketState::Running && !rx_buf_.full();
+    return socket_state_ == SocketState::Running && (!body_.empty() || !rx_buf_.full()) &&
+           !backpressured_;
   }
 
   [[nodiscard]] inline bool can_write() const noexcept
   {
     const bool valid_state =
       socket_state_ == SocketState::Running || socket_state_ == SocketState::Draining;
-    return valid_state && !tx_buf_.empty();
+    return valid_state && (!tx_buf_.empty() || !tx_queue_.empty());
+  }
+
+  [[nodiscard]] inline std::size_t tx_pending_bytes() const noexcept
+  {
+    return tx_buf_.used_space() + tx_queue_.bytes();
+  }
+
+  // Bytes tx_send() would accept right now. Behind queued segments a copy becomes a segment of its
+  // own, so the limit is the high watermark rather than tx_buf_: a small response still fits
+  // while a long stream keeps the queue non-empty.
+  [[nodiscard]] inline std::size_t tx_room() const noexcept
+  {
+    if (tx_queue_.empty()) [[likely]] {
+      return tx_buf_.free_space();
+    }
+    constexpr std::size_t limit = std::max(TxBuffer::capacity(), TX_HIGH_WATERMARK);
+    return limit - std::min(limit, tx_pending_bytes());
+  }
+
+  [[nodiscard]] inline bool wants_zerocopy(const TxSegment& segment) const noexcept
+  {
+    return zerocopy_threshold_ != 0 && segment.size() >= zerocopy_threshold_;
   }
 
-  TSKV_COLD_PATH void handle_error_event() noexcept
+  // sent bytes come off tx_buf_ first, then off the head of tx_queue_
+  void tx_consume(std::size_t nbytes) noexcept
   {
-    socket_state_ = SocketState::Aborting;
+    const std::size_t from_buf = std::min(nbytes, tx_buf_.used_space());
+    tx_buf_.consume(from_buf);
+    tx_queue_.consume(nbytes - from_buf);
+  }
 
+  // reads (and clears) the pending socket error
+  [[nodiscard]] int take_socket_error() const noexcept
+  {
     int       err = 0;
     socklen_t len = sizeof(err);
     const int opc = getsockopt(fd_, SOL_SOCKET, SO_ERROR, &err, &len);
+    return opc == 0 ? err : 0;
+  }
+
+  TSKV_COLD_PATH void handle_error_event() noexcept { abort_with_error(take_socket_error()); }
+
+  // Drain MSG_ZEROCOPY completions from the socket error queue, unpinning finished segments.
+  // Returns true if at least one completion was found.
+  bool reap_zerocopy_completions() noexcept
+  {
+    bool found = false;
+
+    for (;;) {
+      alignas(cmsghdr) char control[128];
+
+      msghdr msg{};
+      msg.msg_control    = control;
+      msg.msg_controllen = sizeof control;
+
+      if (::recvmsg(fd_, &msg, MSG_ERRQUEUE) == -1) {
+        return found; // EAGAIN: queue drained
+      }
+
+      for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+        const bool recverr = (cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                             (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR);
+        if (!recverr) {
+          continue;
+        }
+
+        sock_extended_err serr;
+        std::memcpy(&serr, CMSG_DATA(cm), sizeof serr);
+        if (serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr.ee_errno != 0) {
+          continue;
+        }
+
+        // the kernel had to copy after all (e.g. loopback, or NIC without scatter-gather)
+        if (serr.ee_code == SO_EE_CODE_ZEROCOPY_COPIED) {
+          metrics::inc_counter<"net.zerocopy_copied">();
+        }
+
+        zerocopy_.on_completion(serr.ee_data);
+        found = true;
+      }
+    }
+  }
+
+  TSKV_COLD_PATH void abort_with_error(int err) noexcept
+  {
+    set_socket_state(SocketState::Aborting);
 
     ::shutdown(fd_, SHUT_RDWR);
 
-    if (opc != 0 || err == 0) {
+    if (err == 0) {
       return;
     }
 
@@ -137,49 +452,87 @@ private:
     proto_.on_error(io, err);
   }
 
-  std::size_t try_flush_tx_buffer() noexcept
+  void update_backpressure() noexcept
   {
-    if (!can_write()) {
-      return 0;
+    const std::size_t tx_used = tx_pending_bytes();
+
+    if (!backpressured_ && tx_used >= TX_HIGH_WATERMARK) {
+      set_backpressured(true);
+      metrics::inc_counter<"net.backpressure_events_total">();
+      metrics::add_gauge<"net.backpressured_connections">(1);
+    }
+    else if (backpressured_ && tx_used <= TX_LOW_WATERMARK) {
+      set_backpressured(false);
+      metrics::sub_gauge<"net.backpressured_connections">(1);
     }
+  }
 
+  // Sends at most max_bytes (tx_buf_, then queued segments, batched into one sendmsg() where
+  // possible); returns the number of bytes sent.
+  std::size_t try_flush_tx_buffer(std::size_t max_bytes) noexcept
+  {
     std::size_t bytes_sent = 0;
 
-    for (;;) {
-      std::span<const std::byte> tx_span = tx_buf_.readable_span();
+    while (can_write() && bytes_sent < max_bytes) {
+      const std::size_t budget = max_bytes - bytes_sent;
 
-      const ssize_t send_rc = send(fd_, tx_span.data(), tx_span.size(), 0);
+      iovec       iov[TX_IOV_BATCH];
+      std::size_t niov      = 0;
+      int         flags     = 0;
+      std::size_t iov_bytes = 0;
+
+      if (!tx_buf_.empty()) {
+        const std::span<const std::byte> head = tx_buf_.readable_span(budget);
+        iov[niov++] = iovec{const_cast<std::byte*>(head.data()), head.size()};
+        iov_bytes   = head.size();
+      }
+      else if (wants_zerocopy(tx_queue_.front())) {
+        // large segments go out alone, so a completion pins exactly one owner
+        const std::span<const std::byte> head = tx_queue_.front().bytes;
+        iov[niov++] = iovec{const_cast<std::byte*>(head.data()), std::min(head.size(), budget)};
+        flags       = MSG_ZEROCOPY;
+      }
+
+      if (flags == 0) {
+        niov += tx_queue_.gather(std::span(iov).subspan(niov),
+          budget - iov_bytes,
+          [this](const TxSegment& seg) { return wants_zerocopy(seg); });
+      }
+
+      msghdr msg{};
+      msg.msg_iov    = iov;
+      msg.msg_iovlen = niov;
+
+      const ssize_t send_rc = ::sendmsg(fd_, &msg, flags);
 
       if (send_rc >= 0) {
-        tx_buf_.consume(send_rc);
-        bytes_sent += send_rc;
-        if (tx_buf_.empty()) {
-          break;
+        if (flags & MSG_ZEROCOPY) {
+          zerocopy_.on_send(tx_queue_.front().owner);
+          metrics::inc_counter<"net.zerocopy_sends">();
         }
+        tx_consume(send_rc);
+        bytes_sent += send_rc;
       }
       else if (send_rc == -1) {
-        switch (errno) {
-#if defined(EWOULDBLOCK) && (EWOULDBLOCK != EAGAIN)
-          case EWOULDBLOCK:
-#endif
-          case EAGAIN: {
-            break;
-          }
-          case EINTR: {
-            continue;
-          }
-          default: {
-            handle_error_event();
-            break;
-          }
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+          handle_error_event();
         }
+        break;
       }
     }
 
+    if (bytes_sent > 0) {
+      update_backpressure();
+    }
+
     return bytes_sent;
   }
 
-  std::size_t try_fill_rx_buffer() noexcept
+  // Receives at most max_bytes; returns the number of bytes received.
+  std::size_t try_fill_rx_buffer(std::size_t max_bytes) noexcept
   {
     if (!can_read()) {
       return 0;
@@ -187,18 +540,34 @@ private:
 
     std::size_t bytes_received = 0;
 
-    while (!rx_buf_.full()) {
-      std::span<std::byte> recv_span = rx_buf_.writable_span();
+    while ((!body_.empty() || !rx_buf_.full()) && bytes_received < max_bytes) {
+      const bool           to_body   = !body_.empty();
+      const std::size_t    room      = max_bytes - bytes_received;
+      std::span<std::byte> recv_span = to_body ? body_.first(std::min(body_.size(), room))
+                                               : rx_buf_.writable_span(room);
       assert(!recv_span.empty());
 
       const ssize_t recv_rc = recv(fd_, recv_span.data(), recv_span.size(), 0);
 
+      if (to_body) {
+        if (recv_rc > 0) {
+          fill_body(static_cast<std::size_t>(recv_rc));
+        }
+      }
+      else {
+        // every writable_span() is paired with a commit(), even an empty one: a pooled buffer
+        // hands its block back if nothing arrived
+        rx_buf_.commit(recv_rc > 0 ? static_cast<std::size_t>(recv_rc) : 0);
+      }
+
       if (recv_rc > 0) {
-        rx_buf_.commit(recv_rc);
         bytes_received += recv_rc;
+        if (body_done_) {
+          return bytes_received; // let the protocol see the body before anything after it
+        }
       }
       else if (recv_rc == 0) {
-        socket_state_ = SocketState::Draining;
+        set_socket_state(SocketState::Draining);
         return bytes_received;
       }
       else if (recv_rc == -1) {
@@ -228,6 +597,71 @@ private:
 
   TSKV_INLINE void rx_consume(std::size_t nbytes) noexcept { rx_buf_.consume(nbytes); }
 
+  // `nbytes` landed at the front of body_
+  void fill_body(std::size_t nbytes) noexcept
+  {
+    body_ = body_.subspan(nbytes);
+    if (body_.empty()) {
+      body_done_ = true;
+    }
+    metrics::add_counter<"net.rx_body_bytes">(nbytes);
+  }
+
+  void rx_stream(std::span<std::byte> dest) noexcept
+  {
+    assert(body_.empty() && !body_done_ && "rx_stream: previous body has not been delivered");
+
+    // whatever is already buffered comes first
+    std::size_t copied = 0;
+    while (copied < dest.size() && !rx_buf_.empty()) {
+      const std::span<const std::byte> chunk = rx_buf_.readable_span(dest.size() - copied);
+      std::memcpy(dest.data() + copied, chunk.data(), chunk.size());
+      rx_buf_.consume(chunk.size());
+      copied += chunk.size();
+    }
+
+    body_      = dest.subspan(copied);
+    body_done_ = body_.empty();
+    if (copied > 0) {
+      metrics::add_counter<"net.rx_body_bytes">(copied);
+    }
+  }
+
+  // Hands a filled body sink to the protocol. Returns true if there was one.
+  bool finish_body(ChannelIO<Proto>& io) noexcept
+  {
+    if (!body_done_) {
+      return false;
+    }
+    body_done_ = false;
+    if (socket_state_ != SocketState::Aborting) {
+      if constexpr (requires { proto_.on_body(io); }) {
+        proto_.on_body(io);
+      }
+    }
+    return true;
+  }
+
+  // Lets a protocol that asked for it (ChannelIO::request_writable) produce more output, unless TX
+  // is still backpressured. Returns true if it queued anything.
+  bool refill_tx(ChannelIO<Proto>& io) noexcept
+  {
+    if constexpr (requires { proto_.on_writable(io); }) {
+      const bool open =
+        socket_state_ == SocketState::Running || socket_state_ == SocketState::Draining;
+      if (!writable_wanted_ || backpressured_ || !open) {
+        return false;
+      }
+      writable_wanted_            = false; // one-shot; the protocol re-arms while it has more
+      const std::size_t tx_before = tx_pending_bytes();
+      proto_.on_writable(io);
+      return tx_pending_bytes() != tx_before;
+    }
+    else {
+      return false;
+    }
+  }
+
   [[nodiscard]] std::pair<std::size_t, SendResult> tx_send(std::span<const std::byte> data) noexcept
   {
     if (socket_state_ == SocketState::Closed || socket_state_ == SocketState::Aborting)
@@ -235,9 +669,50 @@ private:
       return {0, SendResult::Forbidden};
     }
 
-    const std::size_t bytes_queued = tx_buf_.write_from(data);
+    std::size_t bytes_queued = 0;
+
+    if (tx_queue_.empty()) [[likely]] {
+      bytes_queued = tx_buf_.write_from(data);
+    }
+    else {
+      // must line up behind the queued segments; copy into one of our own, within tx_room()
+      bytes_queued = std::min(tx_room(), data.size());
+      if (bytes_queued > 0) {
+        tx_queue_.push(TxSegment::copy_of(data.first(bytes_queued)));
+      }
+    }
+
+    update_backpressure();
+
+    if (bytes_queued == data.size()) {
+      return {bytes_queued, backpressured_ ? SendResult::Backpressured : SendResult::Full};
+    }
+    return {bytes_queued, bytes_queued > 0 ? SendResult::Partial : SendResult::Blocked};
+  }
+
+  // Queue a segment without copying it. Always accepted (unless the channel is closing), so
+  // producers of large responses should pace themselves on backpressured().
+  [[nodiscard]] SendResult tx_enqueue(TxSegment segment)
+  {
+    if (socket_state_ == SocketState::Closed || socket_state_ == SocketState::Aborting)
+      [[unlikely]] {
+      return SendResult::Forbidden;
+    }
 
-    return {bytes_queued, bytes_queued == data.size() ? SendResult::Full : SendResult::Partial};
+    tx_queue_.push(std::move(segment));
+
+    update_backpressure();
+
+    return backpressured_ ? SendResult::Backpressured : SendResult::Full;
+  }
+
+  [[nodiscard]] CompletionTarget reserve_completion() noexcept
+  {
+    if (pool_ == nullptr || pool_->completions_ == nullptr) [[unlikely]] {
+      return {};
+    }
+    ++completions_pending_;
+    return CompletionTarget{pool_->completions_, pool_->event_tag(fd_)};
   }
 
 public:
@@ -247,15 +722,49 @@ public:
     fd_ = client_fd;
     tx_buf_.clear();
     rx_buf_.clear();
-    socket_state_ = SocketState::Running;
+    tx_queue_.clear();
+    zerocopy_.reset();
+    zerocopy_threshold_       = 0;
+    deferred_events_          = 0;
+    ready_queued_             = false;
+    last_active_tick_         = 0;
+    deadline_request_pending_ = false;
+    completions_pending_      = 0;
+    body_                     = {};
+    body_done_                = false;
+    writable_wanted_          = false;
+    set_backpressured(false);
+    set_socket_state(SocketState::Running);
   }
 
   void detach() noexcept
   {
+    if (backpressured_) {
+      set_backpressured(false);
+      metrics::sub_gauge<"net.backpressured_connections">(1);
+    }
+
     fd_ = -1;
     tx_buf_.clear();
     rx_buf_.clear();
-    socket_state_ = SocketState::Closed;
+    tx_queue_.clear();
+    zerocopy_.reset();
+    body_            = {};
+    body_done_       = false;
+    writable_wanted_ = false;
+    set_socket_state(SocketState::Closed);
+  }
+
+  // Send queued segments of at least `threshold` bytes with MSG_ZEROCOPY. Returns false, leaving
+  // zerocopy off, if the socket does not support it (e.g. AF_UNIX, or kernels before 4.14).
+  bool enable_zerocopy(std::size_t threshold) noexcept
+  {
+    const int one = 1;
+    if (threshold == 0 || ::setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof one) != 0) {
+      return false;
+    }
+    zerocopy_threshold_ = threshold;
+    return true;
   }
 
   void notify_close() noexcept
@@ -264,10 +773,48 @@ public:
     proto_.on_close(io);
   }
 
+  // Drop the connection without flushing TX (e.g. on idle timeout).
+  void abort() noexcept
+  {
+    if (socket_state_ == SocketState::Running || socket_state_ == SocketState::Draining) {
+      abort_with_error(0);
+    }
+  }
+
+  // The protocol's deadline passed: let it answer via on_timeout(io) if it has one, otherwise
+  // abort with ETIMEDOUT.
+  void expire_deadline() noexcept
+  {
+    if (socket_state_ != SocketState::Running && socket_state_ != SocketState::Draining) {
+      return;
+    }
+
+    ChannelIO<Proto> io(*this);
+    if constexpr (requires { proto_.on_timeout(io); }) {
+      proto_.on_timeout(io);
+    }
+    else {
+      abort_with_error(ETIMEDOUT);
+    }
+  }
+
+  // A response posted to a CompletionTarget of this channel came back through the reactor's
+  // CompletionQueue. It goes onto TX behind anything already there, and EPOLLOUT is reported as
+  // deferred so the reactor flushes the channel once it has drained the whole batch.
+  void deliver_completion(TxSegment payload) noexcept
+  {
+    assert(completions_pending_ > 0 && "completion delivered that was never handed out");
+    --completions_pending_;
+
+    if (tx_enqueue(std::move(payload)) != SendResult::Forbidden && can_write()) {
+      deferred_events_ |= EPOLLOUT;
+    }
+  }
+
   void begin_shutdown() noexcept
   {
     if (socket_state_ == SocketState::Running) {
-      socket_state_ = SocketState::Draining;
+      set_socket_state(SocketState::Draining);
       // stop reading at kernel level, as we won't be reading anymore regardless
       ::shutdown(fd_, SHUT_RD);
     }
@@ -275,70 +822,159 @@ public:
 
   [[nodiscard]] inline int fd() const noexcept { return fd_; }
 
+  [[nodiscard]] Proto&       proto() noexcept { return proto_; }
+  [[nodiscard]] const Proto& proto() const noexcept { return proto_; }
+
   [[nodiscard]] std::uint32_t get_last_event_mask() const noexcept { return last_events_mask_; }
   void set_last_event_mask(std::uint32_t new_mask) noexcept { last_events_mask_ = new_mask; }
 
+  // Subset of EPOLLIN/EPOLLOUT that the last handle_events() call stopped servicing because its
+  // IoBudget ran out (rather than because the socket returned EAGAIN), plus EPOLLOUT after
+  // deliver_completion() and while refill_pending().
+  [[nodiscard]] std::uint32_t deferred_events() const noexcept { return deferred_events_; }
+
+  // reactor bookkeeping: whether this channel currently sits in the reactor's ready list
+  [[nodiscard]] bool is_ready_queued() const noexcept { return ready_queued_; }
+  void set_ready_queued(bool queued) noexcept { ready_queued_ = queued; }
+
+  [[nodiscard]] inline bool backpressured() const noexcept { return backpressured_; }
+
+  // The protocol wants to produce more output (ChannelIO::request_writable) but TX is empty, so no
+  // EPOLLOUT edge or send completion will bring it back: the reactor has to, on its next turn.
+  // This is how a protocol yields, by re-arming from on_writable without queuing anything.
+  [[nodiscard]] bool refill_pending() const noexcept
+  {
+    const bool open =
+      socket_state_ == SocketState::Running || socket_state_ == SocketState::Draining;
+    return open && writable_wanted_ && !backpressured_ && !can_write();
+  }
+
+  // reactor bookkeeping for timeouts
+  [[nodiscard]] Timer&        idle_timer() noexcept { return idle_timer_; }
+  [[nodiscard]] Timer&        deadline_timer() noexcept { return deadline_timer_; }
+  [[nodiscard]] std::uint64_t last_active_tick() const noexcept { return last_active_tick_; }
+  void set_last_active_tick(std::uint64_t tick) noexcept { last_active_tick_ = tick; }
+
+  // Deadline set or cleared (0ms) by the protocol since the last call, if any.
+  [[nodiscard]] std::optional<std::chrono::milliseconds> take_deadline_request() noexcept
+  {
+    if (!deadline_request_pending_) {
+      return std::nullopt;
+    }
+    deadline_request_pending_ = false;
+    return deadline_request_;
+  }
+
   [[nodiscard]] inline bool should_close() const noexcept
   {
     if (socket_state_ == SocketState::Aborting)
       return true;
-    if (socket_state_ == SocketState::Draining && tx_buf_.empty())
+    // zerocopy segments must stay pinned until the kernel is done with them, and responses still
+    // being produced elsewhere have to go out before the close
+    if (socket_state_ == SocketState::Draining && tx_pending_bytes() == 0 && zerocopy_.idle() &&
+        completions_pending_ == 0 && !writable_wanted_)
       return true;
     return false;
   }
 
-  void handle_events(std::uint32_t event_mask) noexcept
+  void handle_events(std::uint32_t event_mask, IoBudget budget = {}) noexcept
   {
     assert(socket_state_ != SocketState::Closed && "handling events on closed socket");
 
+    deferred_events_ = 0;
+
     if (event_mask & EPOLLERR) {
-      handle_error_event();
-      return;
+      // MSG_ZEROCOPY completions are signalled through the error queue too; they are only
+      // routine notifications, so carry on unless a real socket error is also pending
+      const bool zerocopy_done = !zerocopy_.idle() && reap_zerocopy_completions();
+      if (!zerocopy_done) {
+        handle_error_event();
+        return;
+      }
+      if (const int err = take_socket_error(); err != 0) {
+        abort_with_error(err);
+        return;
+      }
     }
 
     ChannelIO<Proto> io(*this);
 
-    // Drain readable side fully, respecting ET semantics
-    if (event_mask & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)) {
-      // TODO[@zmeadows][P2]: limit iterations and/or rx/tx bytes to tame pathologically hot connections
+    std::size_t total_sent = 0;
+
+    // Data the protocol left in RX may have been waiting on TX space, and a full RX or
+    // backpressure stops reads short of EAGAIN, so no new EPOLLIN edge is coming. Once TX drains,
+    // resume the read path.
+    const bool rx_resume = (event_mask & EPOLLOUT) && (!rx_buf_.empty() || backpressured_);
+
+    // Pure-write wakeup from epoll
+    if (event_mask & EPOLLOUT) {
+      total_sent += try_flush_tx_buffer(budget.tx_bytes);
+    }
+
+    // Drain readable side until EAGAIN (respecting ET semantics) or the RX budget is spent
+    if ((event_mask & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)) || rx_resume) {
+      std::size_t total_received = 0;
+
       for (;;) {
-        // 1) Pull everything we can (until EAGAIN or buffer full)
-        const std::size_t nrecv = try_fill_rx_buffer();
+        // 1) Pull everything we can (until EAGAIN, buffer full, or budget spent)
+        const std::size_t nrecv = try_fill_rx_buffer(budget.rx_bytes - total_received);
+        total_received += nrecv;
 
-        const bool rx_blocked = nrecv == 0; // either EAGAIN or not allowed to read
-        if (!rx_blocked) {
-          metrics::add_counter<"net.bytes_received">(nrecv);
-        }
+        const bool rx_blocked = nrecv == 0; // EAGAIN, not allowed to read, or out of budget
 
-        // 2) If the rx buffer has data to process, let the protocol process/consume it
+        // 2) If a streamed body is complete, or the rx buffer has data to process, let the
+        //    protocol process/consume it
+        const bool        body_finished  = finish_body(io);
         const std::size_t rx_used_before = rx_buf_.used_space();
         if (!rx_buf_.empty()) {
           proto_.on_read(io); // expected to rx_consume()
         }
-        const bool proto_consumed = rx_buf_.used_space() < rx_used_before;
+        const bool proto_consumed = body_finished || rx_buf_.used_space() < rx_used_before;
 
         // 3) Try to flush any responses as we go (good for backpressure)
-        if (can_write()) {
-          (void)try_flush_tx_buffer();
-        }
+        total_sent += try_flush_tx_buffer(budget.tx_bytes - total_sent);
 
         // 4) Stop when we made no forward progress
         if (rx_blocked && !proto_consumed) {
           break;
         }
       }
+
+      if (total_received > 0) {
+        metrics::add_counter<"net.bytes_received">(total_received);
+      }
+
+      // the socket may still hold unread data that no further edge will announce
+      if (total_received == budget.rx_bytes && can_read()) {
+        deferred_events_ |= EPOLLIN;
+      }
     }
 
-    // Pure-write wakeup from epoll
-    if (event_mask & EPOLLOUT) {
-      const std::size_t nsent = try_flush_tx_buffer();
-      metrics::add_counter<"net.bytes_sent">(nsent);
+    // A protocol producing a long response refills TX as it drains, until the socket stops taking
+    // bytes (EPOLLOUT brings us back) or the TX budget is spent
+    while (total_sent < budget.tx_bytes && refill_tx(io)) {
+      total_sent += try_flush_tx_buffer(budget.tx_bytes - total_sent);
+      if (can_write()) {
+        break;
+      }
+    }
+    if (refill_pending()) {
+      deferred_events_ |= EPOLLOUT; // out of budget, or the protocol yielded (see refill_pending)
+    }
+
+    if (total_sent > 0) {
+      metrics::add_counter<"net.bytes_sent">(total_sent);
+    }
+
+    // TX stopped by the budget, not by EAGAIN, so EPOLLOUT will not fire again by itself
+    if (total_sent == budget.tx_bytes && can_write()) {
+      deferred_events_ |= EPOLLOUT;
     }
 
     if (event_mask & (EPOLLHUP | EPOLLRDHUP) && socket_state_ == SocketState::Running) {
       // Peer won’t send more. If we already hit recv() == 0, try_fill_rx_buffer()
       // may have already set Draining; otherwise, do it here.
-      socket_state_ = SocketState::Draining;
+      set_socket_state(SocketState::Draining);
     }
   }
 
@@ -351,6 +987,89 @@ public:
       mask |= EPOLLOUT;
     return mask;
   }
+
+  // ---------------------------------------------------------------------------
+  // Completion-based backends (io_uring) perform the socket I/O themselves and report results
+  // through the methods below, instead of letting handle_events() call recv()/send().
+  // ---------------------------------------------------------------------------
+
+  // Copy received bytes into RX, letting the protocol consume as we go. Returns the number of
+  // bytes accepted; the caller must hold on to the remainder and offer it again later (e.g. once
+  // TX has drained). An empty span just gives the protocol another look at what is buffered.
+  std::size_t deliver_rx(std::span<const std::byte> data) noexcept
+  {
+    ChannelIO<Proto> io(*this);
+
+    if (socket_state_ != SocketState::Running) {
+      (void)refill_tx(io); // a draining channel may still be producing
+      return data.size();  // nobody will read these bytes anymore
+    }
+
+    std::size_t accepted = 0;
+
+    for (;;) {
+      std::size_t ncopied = 0;
+      if (!backpressured_ && !body_.empty()) {
+        ncopied = std::min(body_.size(), data.size() - accepted);
+        if (ncopied > 0) {
+          std::memcpy(body_.data(), data.data() + accepted, ncopied);
+          fill_body(ncopied);
+        }
+      }
+      else if (!backpressured_) {
+        ncopied = rx_buf_.write_from(data.subspan(accepted));
+      }
+      accepted += ncopied;
+
+      const bool        body_finished  = finish_body(io);
+      const std::size_t rx_used_before = rx_buf_.used_space();
+      if (!rx_buf_.empty()) {
+        proto_.on_read(io);
+      }
+      const bool proto_consumed = body_finished || rx_buf_.used_space() < rx_used_before;
+
+      if (accepted == data.size() || (ncopied == 0 && !proto_consumed)) {
+        break;
+      }
+    }
+
+    // the backend calls this after every send completion, so it doubles as the TX refill point
+    (void)refill_tx(io);
+
+    metrics::add_counter<"net.bytes_received">(accepted);
+
+    return accepted;
+  }
+
+  // recv() completed with 0 bytes
+  void on_peer_eof() noexcept
+  {
+    if (socket_state_ == SocketState::Running) {
+      set_socket_state(SocketState::Draining);
+    }
+  }
+
+  // an operation on this socket failed with (positive) errno `err`
+  void on_io_error(int err) noexcept { abort_with_error(err); }
+
+  // Bytes the backend should hand to its next send; stable until tx_complete() is called.
+  [[nodiscard]] std::span<const std::byte> tx_pending() const noexcept
+  {
+    if (!can_write()) {
+      return {};
+    }
+    if (!tx_buf_.empty()) {
+      return tx_buf_.readable_span();
+    }
+    return tx_queue_.front().bytes;
+  }
+
+  void tx_complete(std::size_t nbytes) noexcept
+  {
+    tx_consume(nbytes);
+    update_backpressure();
+    metrics::add_counter<"net.bytes_sent">(nbytes);
+  }
 };
 
 template <class Proto>
@@ -359,10 +1078,6 @@ public:
   ChannelIO() = delete;
   explicit ChannelIO(Channel<Proto>& ch) : ch_(ch) {}
 
-  // TODO[@zmeadows][P2]: allow protocols to detect when they're backpressured by
-  //    * extending SendResult enum
-  //    * adding a bool backpressured() method to this wrapper
-
   [[nodiscard]] TSKV_INLINE std::span<const std::byte> rx_span() const noexcept
   {
     return ch_.rx_span();
@@ -374,8 +1089,78 @@ public:
     return ch_.tx_send(data);
   }
 
+  // Zero-copy alternative to tx_send for large payloads; see Channel::tx_enqueue.
+  [[nodiscard]] TSKV_INLINE SendResult tx_enqueue(TxSegment segment)
+  {
+    return ch_.tx_enqueue(std::move(segment));
+  }
+
+  // How many bytes tx_send() would take in full right now. Protocols that must not split a
+  // response check this first and leave the request in RX until there is room. While segments are
+  // queued this can exceed the TX buffer's capacity (see Channel::tx_room).
+  [[nodiscard]] TSKV_INLINE std::size_t tx_room() const noexcept { return ch_.tx_room(); }
+
+  // True while TX is above its high watermark (until it drains to the low watermark). Reads from
+  // the socket are paused meanwhile; protocols should stop producing output and leave RX alone.
+  [[nodiscard]] TSKV_INLINE bool backpressured() const noexcept { return ch_.backpressured(); }
+
   TSKV_INLINE void rx_consume(std::size_t nbytes) noexcept { ch_.rx_consume(nbytes); }
 
+  // Receive the next dest.size() bytes of the stream into `dest` instead of RX, for payloads that
+  // do not fit in RX (typically after consuming their header). Bytes already in RX are moved over
+  // first; the rest is recv()ed straight into `dest` on the epoll backend (io_uring copies it out
+  // of its receive buffers). on_read is not called meanwhile; once `dest` is full the channel calls
+  // the protocol's on_body(io), which may arm the next chunk. `dest` must stay valid until then,
+  // or until on_close/on_error.
+  TSKV_INLINE void rx_stream(std::span<std::byte> dest) noexcept
+  {
+    static_assert(requires(Proto& p, ChannelIO& io) { p.on_body(io); },
+      "protocols that use rx_stream must define on_body(IO&)");
+    ch_.rx_stream(dest);
+  }
+
+  // Have the channel call the protocol's on_writable(io) once TX has room (is not backpressured),
+  // for responses produced piecewise as TX drains rather than queued whole (e.g. a streaming
+  // scan). One-shot: re-arm from on_writable while there is more to send; re-arming without
+  // queuing anything yields, and the reactor calls on_writable again on its next turn. A draining
+  // channel stays open while this is armed.
+  TSKV_INLINE void request_writable() noexcept
+  {
+    static_assert(requires(Proto& p, ChannelIO& io) { p.on_writable(io); },
+      "protocols that use request_writable must define on_writable(IO&)");
+    ch_.writable_wanted_ = true;
+  }
+
+  // Bytes the armed rx_stream span is still waiting for (0 if none is armed).
+  [[nodiscard]] TSKV_INLINE std::size_t rx_stream_remaining() const noexcept
+  {
+    return ch_.body_.size();
+  }
+
+  // Bound the current request: unless cleared or re-set first, the reactor calls the protocol's
+  // on_timeout(io) after `after` (or aborts the connection with ETIMEDOUT if it has none).
+  // Replaces any previous deadline; 0ms clears it.
+  TSKV_INLINE void set_deadline(std::chrono::milliseconds after) noexcept
+  {
+    ch_.deadline_request_pending_ = true;
+    ch_.deadline_request_         = after;
+  }
+
+  TSKV_INLINE void clear_deadline() noexcept { set_deadline(std::chrono::milliseconds{0}); }
+
+  // Stop reading from the peer; the connection closes once TX (and any outstanding completion)
+  // has been flushed. For protocol errors that still deserve a reply.
+  TSKV_INLINE void shutdown() noexcept { ch_.begin_shutdown(); }
+
+  // Hand the current request to another thread: post exactly one response to the returned target
+  // (from any thread) and the reactor appends it to TX as if by tx_enqueue. Until it arrives the
+  // connection stays open, even after the peer's EOF, unless it is aborted. Empty (false) when
+  // the backend has no CompletionQueue.
+  [[nodiscard]] TSKV_INLINE CompletionTarget completion_target() noexcept
+  {
+    return ch_.reserve_completion();
+  }
+
 private:
   Channel<Proto>& ch_;
 };
@@ -396,6 +1181,23 @@ struct EchoProtocol {
   void on_close(ChannelIO<EchoProtocol>&) {}
 };
 
+// epoll_event.data.u64 layout used by the reactor: [generation:32][fd:32]. ChannelPool never hands
+// out generation 0, so it is free for reactor-owned descriptors (listener, eventfd, signalfd).
+[[nodiscard]] constexpr std::uint64_t make_event_tag(int fd, std::uint32_t generation) noexcept
+{
+  return (static_cast<std::uint64_t>(generation) << 32) | static_cast<std::uint32_t>(fd);
+}
+
+[[nodiscard]] constexpr int event_tag_fd(std::uint64_t tag) noexcept
+{
+  return static_cast<int>(static_cast<std::uint32_t>(tag));
+}
+
+[[nodiscard]] constexpr std::uint32_t event_tag_generation(std::uint64_t tag) noexcept
+{
+  return static_cast<std::uint32_t>(tag >> 32);
+}
+
 template <Protocol Proto>
 struct ChannelPool {
 private:
@@ -438,24 +1240,39 @@ private:
   };
 
   struct Handle {
-    Chunk*          chunk   = nullptr;
-    Channel<Proto>* channel = nullptr;
+    Chunk*          chunk      = nullptr;
+    Channel<Proto>* channel    = nullptr;
+    std::uint32_t   generation = 0; // bumped on every acquire(fd), never 0 while active
+    std::uint32_t   active_idx = 0; // position of fd within active_fds_
   };
 
   void allocate_new_chunk()
   {
-    chunks_.emplace_back(std::make_unique<Chunk>());
-    nonfull_chunks_.push_back(chunks_.back().get());
+    chunks_.reserve(chunks_.size() + 1); // nothing to unwind if this throws
+    void* memory = arena_.allocate(sizeof(Chunk), alignof(Chunk));
+    chunks_.push_back(new (memory) Chunk());
+    nonfull_chunks_.push_back(chunks_.back());
   }
 
-  std::vector<std::unique_ptr<Chunk>> chunks_;
-  std::vector<Chunk*>                 nonfull_chunks_;
+  // Chunks are placed in huge-page-backed, NUMA-local arena regions: at high connection counts
+  // event dispatch touches channels all over the pool, and 4 KiB pages would cost a TLB miss on
+  // nearly every one. Chunks are only destroyed with the pool, so the arena never frees.
+  tc::PageArena       arena_;
+  std::vector<Chunk*> chunks_;
+  std::vector<Chunk*> nonfull_chunks_;
+
+  // The kernel hands out the lowest free descriptor, so fds stay dense and can index a flat table
+  // directly. handles_ grows on demand and is never shrunk.
+  std::vector<Handle> handles_;
+  std::vector<int>    active_fds_;
+
+  ChannelLists<Channel<Proto>> lists_;
+  CompletionQueue*             completions_ = nullptr; // owned by the reactor, if it has one
 
-  // TODO[@zmeadows][P2]: replace with open-addressed hash map tailored to int keys
-  std::unordered_map<int, Handle> active_;
+  friend struct Channel<Proto>;
 
 public:
-  ChannelPool() { active_.max_load_factor(0.7); }
+  explicit ChannelPool(tc::ArenaOptions arena_options = {}) : arena_(arena_options) {}
 
   void reserve_channels(std::size_t nchannels)
   {
@@ -463,7 +1280,8 @@ public:
       return;
     }
 
-    active_.reserve(5 * nchannels / 4);
+    handles_.reserve(nchannels);
+    active_fds_.reserve(nchannels);
     const std::size_t chunks_required = ceil_div(nchannels, Chunk::CHUNK_SIZE);
     chunks_.reserve(chunks_required);
     nonfull_chunks_.reserve(chunks_required);
@@ -476,72 +1294,119 @@ public:
   ChannelPool(const ChannelPool&)            = delete;
   ChannelPool& operator=(const ChannelPool&) = delete;
 
-  ~ChannelPool() { TSKV_DEMAND(active_.empty(), "destroyed ChannelPool with active channels"); }
+  ~ChannelPool()
+  {
+    TSKV_DEMAND(active_fds_.empty(), "destroyed ChannelPool with active channels");
+    for (Chunk* chunk : chunks_) {
+      chunk->~Chunk();
+    }
+  }
+
+  [[nodiscard]] const tc::PageArena& arena() const noexcept { return arena_; }
+
+  // Queue that ChannelIO::completion_target() points worker threads at; nullptr (the default)
+  // means this pool's channels cannot hand work off.
+  void set_completion_queue(CompletionQueue* queue) noexcept { completions_ = queue; }
 
   [[nodiscard]] Channel<Proto>* lookup(int fd) const noexcept
   {
-    if (auto it = active_.find(fd); it != active_.end()) [[likely]] {
-      return it->second.channel;
+    if (static_cast<std::size_t>(fd) < handles_.size()) [[likely]] {
+      return handles_[fd].channel;
+    }
+    return nullptr;
+  }
+
+  // Like lookup(), but also rejects tags minted for an earlier occupant of the same fd number.
+  [[nodiscard]] Channel<Proto>* lookup_tagged(std::uint64_t tag) const noexcept
+  {
+    const std::size_t fd = static_cast<std::uint32_t>(tag);
+    if (fd < handles_.size()) [[likely]] {
+      const Handle& handle = handles_[fd];
+      if (handle.generation == event_tag_generation(tag)) [[likely]] {
+        return handle.channel;
+      }
     }
     return nullptr;
   }
 
-  [[nodiscard]] inline bool empty() const noexcept { return active_.empty(); }
+  // CONTRACT: fd is active
+  [[nodiscard]] std::uint64_t event_tag(int fd) const noexcept
+  {
+    assert(lookup(fd) != nullptr && "INVALID ARGS: event_tag called with unknown fd");
+    return make_event_tag(fd, handles_[fd].generation);
+  }
+
+  [[nodiscard]] inline bool empty() const noexcept { return active_fds_.empty(); }
+  [[nodiscard]] inline std::size_t size() const noexcept { return active_fds_.size(); }
 
   // CONTRACT: returned Channel* only valid between acquire(fd) and release(fd)
   [[nodiscard]] Channel<Proto>* acquire(int fd)
   {
-    assert(fd != -1 && "INVALID ARGS: poisoned socket file descriptor (fd = -1)");
+    assert(fd >= 0 && "INVALID ARGS: poisoned socket file descriptor");
+
+    if (static_cast<std::size_t>(fd) >= handles_.size()) [[unlikely]] {
+      handles_.resize(std::max<std::size_t>(fd + 1, 2 * handles_.size()));
+    }
+
+    Handle& handle = handles_[fd];
+    if (handle.channel != nullptr) [[unlikely]] {
+      assert(false && "INVALID ARGS: fd already present in pool");
+      return nullptr;
+    }
 
     if (nonfull_chunks_.empty()) [[unlikely]] {
       allocate_new_chunk();
     }
 
+    active_fds_.push_back(fd); // may throw; nothing has been modified yet
+
     Chunk* chunk = nonfull_chunks_.back();
 
     Channel<Proto>* channel = chunk->acquire();
 
-    try { // emplace can throw
-      auto [it, inserted] = active_.emplace(fd, Handle{chunk, channel});
-
-      if (!inserted) [[unlikely]] {
-        chunk->release(channel);
-        assert(inserted && "INVALID ARGS: fd already present in pool");
-        return nullptr;
-      }
-    }
-    catch (const std::exception&) {
-      chunk->release(channel);
-      throw;
-    }
-
     if (chunk->full()) [[unlikely]] {
       nonfull_chunks_.pop_back();
     }
 
+    channel->pool_ = this;
+
+    handle.chunk      = chunk;
+    handle.channel    = channel;
+    handle.active_idx = static_cast<std::uint32_t>(active_fds_.size() - 1);
+    if (++handle.generation == 0) [[unlikely]] {
+      handle.generation = 1;
+    }
+
     return channel;
   }
 
   // CONTRACT: associated Channel* for fd never used again after release(fd)
   void release(int fd) noexcept
   {
-    auto it = active_.find(fd);
-
-    if (it == active_.end()) [[unlikely]] {
+    if (lookup(fd) == nullptr) [[unlikely]] {
       assert(false && "INVALID ARGS: release called with unknown fd");
       return;
     }
 
-    const auto& [chunk, channel] = it->second;
+    Handle& handle = handles_[fd];
 
-    const bool was_full = chunk->full();
-    chunk->release(channel);
+    handle.channel->unlink_from_lists();
+
+    const bool was_full = handle.chunk->full();
+    handle.chunk->release(handle.channel);
 
     if (was_full) [[unlikely]] {
-      nonfull_chunks_.push_back(chunk);
+      nonfull_chunks_.push_back(handle.chunk);
     }
 
-    active_.erase(it);
+    // swap-remove from the dense active list
+    const int moved_fd             = active_fds_.back();
+    active_fds_[handle.active_idx] = moved_fd;
+    handles_[moved_fd].active_idx  = handle.active_idx;
+    active_fds_.pop_back();
+
+    handle.chunk   = nullptr;
+    handle.channel = nullptr;
   }
 
   // CONTRACT: Do not modify ChannelPool within Fn
@@ -549,10 +1414,35 @@ public:
   template <typename Fn>
   void for_each(Fn&& fn)
   {
-    for (auto& [_, handle] : active_) {
-      fn(handle.channel);
+    for (const int fd : active_fds_) {
+      fn(handles_[fd].channel);
     }
   }
+
+  // Attached channels currently in `state` (never Closed), without touching any other channel.
+  // Unlike for_each, Fn may change the visited channel's state or release it.
+  template <typename Fn>
+  void for_each_in(ChannelState state, Fn&& fn)
+  {
+    lists_.of(state).for_each(std::forward<Fn>(fn));
+  }
+
+  [[nodiscard]] std::size_t count_in(ChannelState state) const noexcept
+  {
+    return lists_.of(state).size();
+  }
+
+  // Attached channels whose TX is above its high watermark. Fn may release the visited channel.
+  template <typename Fn>
+  void for_each_backpressured(Fn&& fn)
+  {
+    lists_.backpressured.for_each(std::forward<Fn>(fn));
+  }
+
+  [[nodiscard]] std::size_t count_backpressured() const noexcept
+  {
+    return lists_.backpressured.size();
+  }
 };
 
 } // namespace tskv::net
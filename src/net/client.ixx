@@ -0,0 +1,725 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.net.client
+// Summary: asynchronous client for the frame protocol (tskv.net.rpc), pipelining requests over a
+//          pool of non-blocking connections
+//
+//  - submit() queues a request and returns at once; poll() does the I/O and runs the callbacks
+//    * a request goes to the connection with the fewest in flight, up to `depth` per connection;
+//      the rest wait client-side, so at most connections * depth are ever in flight
+//    * whatever was submitted between two polls leaves in one send() per connection
+//    * replies are matched to requests by frame id (unique per Client), not by arrival order
+//  - streamed requests (Scan, ScanPoints) get one callback per batch; the client returns a credit
+//    for each batch it has handed over, so the window granted in the request stays full
+//  - each request has timeout_ms from submit() to its last reply (a streamed batch restarts it)
+//    * timeouts live on a TimerWheel of 1 ms ticks driven by a one-shot timerfd in the same epoll
+//      set, as in Reactor; a reply arriving after its request timed out is dropped, and a timed-out
+//      stream is cancelled on the server
+//  - a connection that fails fails the requests it carried (Disconnected); the next request that
+//    needs it reconnects
+//  - single-threaded, and callbacks must not call poll() / run()
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <print>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tskv/common/logging.hpp"
+
+export module tskv.net.client;
+
+import tskv.common.enum_traits;
+import tskv.common.logging;
+import tskv.common.time;
+import tskv.net.frame;
+import tskv.net.socket;
+import tskv.net.timer_wheel;
+
+namespace tc = tskv::common;
+
+export namespace tskv::net {
+
+struct ClientConfig {
+  std::string   host         = "127.0.0.1";
+  uint16_t      port         = 7070;
+  uint32_t      timeout_ms   = 2000;     // per request, 0 = none
+  uint32_t      connections  = 1;        // pool size
+  uint32_t      depth        = 16;       // requests in flight per connection
+  uint32_t      scan_credits = 4;        // batches a scan() keeps in flight
+  uint32_t      max_payload  = 64 << 20; // a larger reply closes its connection
+  SocketProfile socket;                  // per-connection options (TCP_NODELAY by default)
+
+  void print() const
+  {
+    std::print("tskv client CFG ::");
+    std::print(" host={}", this->host);
+    std::print(" port={}", this->port);
+    std::print(" timeout-ms={}", this->timeout_ms);
+    std::print(" connections={}", this->connections);
+    std::print(" depth={}", this->depth);
+    std::print(" scan-credits={}", this->scan_credits);
+    std::print("\n");
+  }
+};
+
+enum class CallStatus : uint8_t {
+  Ok,
+  Error,        // an Error frame, or a reply that does not fit the request
+  Timeout,      // no (further) reply within timeout_ms
+  Disconnected, // the connection failed before the last reply
+};
+
+// One reply to a request. `frame` is set for Ok and Error, and is only valid during the callback.
+struct Reply {
+  CallStatus status = CallStatus::Ok;
+  FrameView  frame;
+  bool       last = true; // no further replies for this request
+};
+
+using ReplyFn = std::move_only_function<void(const Reply&)>;
+using GetFn   = std::move_only_function<void(CallStatus, std::optional<std::string_view> value)>;
+using DoneFn  = std::move_only_function<void(CallStatus)>;
+using EntryFn = std::move_only_function<void(std::string_view key, std::string_view value)>;
+
+class Client {
+public:
+  explicit Client(ClientConfig config);
+  ~Client();
+
+  Client(const Client&)            = delete;
+  Client& operator=(const Client&) = delete;
+
+  // Queues a request frame and returns its id. on_reply runs once per reply frame, the last one
+  // with Reply::last set (or once with a failure status). For a streamed type, `payload` grants
+  // the initial credits; one more is sent back per batch received.
+  std::uint32_t submit(FrameType type, std::span<const std::byte> payload, ReplyFn on_reply);
+
+  // One-key MGet / MPut. A missing key reads as Ok with std::nullopt.
+  void get(std::string_view key, GetFn on_done);
+  void put(std::string_view key, std::string_view value, DoneFn on_done);
+
+  // Entries of [start, end) in key order (empty end: to the last key), then on_done once.
+  void scan(std::string_view start, std::string_view end, EntryFn on_entry, DoneFn on_done);
+
+  // Requests submitted and not yet completed.
+  [[nodiscard]] std::size_t pending() const noexcept { return calls_.size(); }
+
+  // Sends what was submitted, waits up to timeout_ms (-1: until something happens) and runs the
+  // callbacks of the replies and timeouts that came in.
+  void poll(int timeout_ms);
+
+  // poll() until every request has completed.
+  void run()
+  {
+    while (!calls_.empty()) {
+      poll(-1);
+    }
+  }
+
+private:
+  static constexpr std::size_t   NO_CONNECTION   = SIZE_MAX;
+  static constexpr std::size_t   RX_CHUNK        = 64 * 1024; // free RX space offered to recv()
+  static constexpr std::size_t   EVENT_BATCH     = 64;
+  static constexpr std::uint64_t TIMER_TAG       = 0; // epoll tag; connection i is tagged i + 1
+  static constexpr std::uint64_t TIMER_NOT_ARMED = UINT64_MAX;
+
+  struct Call {
+    FrameType              type = FrameType::Ping;
+    std::vector<std::byte> frame; // the encoded request while it waits for a connection
+    ReplyFn                on_reply;
+    std::size_t            connection = NO_CONNECTION;
+    Timer                  timer;
+  };
+
+  struct Connection {
+    int                    fd              = -1;
+    bool                   connecting      = false;
+    bool                   writable_wanted = false; // EPOLLOUT is registered
+    std::uint32_t          in_flight       = 0;
+    std::vector<std::byte> tx;
+    std::size_t            tx_sent = 0;
+    std::vector<std::byte> rx;
+    std::size_t            rx_size = 0;
+  };
+
+  using Calls = std::unordered_map<std::uint32_t, std::unique_ptr<Call>>;
+
+  ClientConfig              config_;
+  std::vector<Connection>   connections_;
+  Calls                     calls_;
+  std::deque<std::uint32_t> queued_; // ids waiting for a connection, in submit order
+  std::uint32_t             next_id_ = 1;
+  std::vector<std::byte>    payload_; // scratch for get/put/scan
+
+  TimerWheel               timers_;
+  std::chrono::nanoseconds clock_epoch_{};
+  std::uint64_t            now_tick_         = 0;
+  std::uint64_t            timer_armed_tick_ = TIMER_NOT_ARMED;
+
+  int epoll_fd_ = -1;
+  int timer_fd_ = -1;
+
+  [[nodiscard]] static bool streamed(FrameType type) noexcept
+  {
+    return type == FrameType::Scan || type == FrameType::ScanPoints;
+  }
+
+  [[nodiscard]] std::uint64_t read_tick() const noexcept;
+
+  [[nodiscard]] std::size_t pick_connection(bool open_only) const noexcept;
+  bool                      open_connection(std::size_t c) noexcept;
+  void                      close_connection(std::size_t c);
+  void                      set_writable_wanted(std::size_t c, bool wanted) noexcept;
+
+  void assign(Call& call, std::size_t c);
+  void dispatch();
+  void flush(std::size_t c);
+
+  void on_connection_event(std::size_t c, std::uint32_t event_mask);
+  void read_replies(std::size_t c);
+  void on_reply(std::size_t c, const FrameView& frame);
+  void on_timeout(Timer& timer);
+  void complete(Calls::iterator it, const Reply& reply);
+
+  void arm_timer_fd() noexcept;
+};
+
+} // namespace tskv::net
+
+namespace tn = tskv::net;
+
+export namespace tskv::common {
+
+template <>
+struct enum_traits<tn::CallStatus> {
+  static constexpr std::array<std::pair<tn::CallStatus, std::string_view>, 4> entries{{
+    {tn::CallStatus::Ok, "ok"},
+    {tn::CallStatus::Error, "error"},
+    {tn::CallStatus::Timeout, "timeout"},
+    {tn::CallStatus::Disconnected, "disconnected"},
+  }};
+};
+
+} // namespace tskv::common
+
+namespace tskv::net {
+
+Client::Client(ClientConfig config)
+  : config_(std::move(config)), connections_(std::max<std::uint32_t>(config_.connections, 1))
+{
+  config_.depth = std::max<std::uint32_t>(config_.depth, 1);
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  TSKV_DEMAND(epoll_fd_ != -1, "epoll_create1 failed");
+
+  timespec ts;
+  TSKV_DEMAND(clock_gettime(CLOCK_MONOTONIC, &ts) == 0, "clock_gettime failed");
+  clock_epoch_ = std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  TSKV_DEMAND(timer_fd_ != -1, "timerfd_create failed");
+
+  epoll_event tev{.events = EPOLLIN, .data = {.u64 = TIMER_TAG}};
+  TSKV_DEMAND(epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &tev) != -1, "epoll add timer failed");
+}
+
+Client::~Client()
+{
+  for (auto& [id, call] : calls_) {
+    timers_.cancel(call->timer);
+  }
+  for (const Connection& conn : connections_) {
+    if (conn.fd != -1) {
+      ::close(conn.fd);
+    }
+  }
+  ::close(timer_fd_);
+  ::close(epoll_fd_);
+}
+
+std::uint32_t Client::submit(FrameType type, std::span<const std::byte> payload, ReplyFn on_reply)
+{
+  const std::uint32_t id   = next_id_++;
+  auto                call = std::make_unique<Call>();
+  call->type               = type;
+  call->on_reply           = std::move(on_reply);
+
+  if (config_.timeout_ms != 0) {
+    call->timer.cookie = id;
+    timers_.schedule(call->timer, read_tick() + config_.timeout_ms);
+  }
+
+  const FrameHeader header{type, 0, static_cast<std::uint32_t>(payload.size()), id};
+  const std::size_t c = queued_.empty() ? pick_connection(true) : NO_CONNECTION;
+  if (c != NO_CONNECTION) {
+    // straight into the connection's TX: no copy kept per request
+    std::vector<std::byte>& tx = connections_[c].tx;
+    const auto              at = tx.size();
+    tx.resize(at + FRAME_HEADER_SIZE);
+    encode_frame_header(header, std::span(tx).subspan(at).first<FRAME_HEADER_SIZE>());
+    tx.insert(tx.end(), payload.begin(), payload.end());
+    call->connection = c;
+    ++connections_[c].in_flight;
+  }
+  else {
+    call->frame.resize(FRAME_HEADER_SIZE);
+    encode_frame_header(header, std::span(call->frame).first<FRAME_HEADER_SIZE>());
+    call->frame.insert(call->frame.end(), payload.begin(), payload.end());
+    queued_.push_back(id);
+  }
+
+  calls_.emplace(id, std::move(call));
+  return id;
+}
+
+void Client::get(std::string_view key, GetFn on_done)
+{
+  payload_.clear();
+  append_u32(payload_, 1);
+  append_u32(payload_, static_cast<std::uint32_t>(key.size()));
+  append_bytes(payload_, key);
+
+  submit(FrameType::MGet, payload_, [on_done = std::move(on_done)](const Reply& reply) mutable {
+    if (reply.status != CallStatus::Ok) {
+      on_done(reply.status, std::nullopt);
+      return;
+    }
+    PayloadReader       in(reply.frame.payload);
+    const bool          one  = in.u32() == 1;
+    const std::uint32_t vlen = in.u32();
+    if (vlen == FRAME_NO_VALUE) {
+      const bool ok = reply.frame.header.type == FrameType::MGetResult && one && in.done();
+      on_done(ok ? CallStatus::Ok : CallStatus::Error, std::nullopt);
+      return;
+    }
+    const std::string_view value = in.bytes(vlen);
+    if (reply.frame.header.type != FrameType::MGetResult || !one || !in.done()) {
+      on_done(CallStatus::Error, std::nullopt);
+      return;
+    }
+    on_done(CallStatus::Ok, value);
+  });
+}
+
+void Client::put(std::string_view key, std::string_view value, DoneFn on_done)
+{
+  payload_.clear();
+  append_u32(payload_, 1);
+  append_u32(payload_, static_cast<std::uint32_t>(key.size()));
+  append_u32(payload_, static_cast<std::uint32_t>(value.size()));
+  append_bytes(payload_, key);
+  append_bytes(payload_, value);
+
+  submit(FrameType::MPut, payload_, [on_done = std::move(on_done)](const Reply& reply) mutable {
+    if (reply.status == CallStatus::Ok && reply.frame.header.type != FrameType::MPutResult) {
+      on_done(CallStatus::Error);
+      return;
+    }
+    on_done(reply.status);
+  });
+}
+
+void Client::scan(std::string_view start, std::string_view end, EntryFn on_entry, DoneFn on_done)
+{
+  payload_.clear();
+  append_u32(payload_, static_cast<std::uint32_t>(start.size()));
+  append_bytes(payload_, start);
+  append_u32(payload_, static_cast<std::uint32_t>(end.size()));
+  append_bytes(payload_, end);
+  append_u32(payload_, std::max<std::uint32_t>(config_.scan_credits, 1));
+
+  submit(FrameType::Scan,
+    payload_,
+    [on_entry = std::move(on_entry), on_done = std::move(on_done), bad = false](
+      const Reply& reply) mutable {
+      if (reply.status == CallStatus::Ok) {
+        PayloadReader in(reply.frame.payload);
+        for (std::uint32_t n = in.u32(); n > 0 && in.ok(); --n) {
+          const std::uint32_t    klen  = in.u32();
+          const std::uint32_t    vlen  = in.u32();
+          const std::string_view key   = in.bytes(klen);
+          const std::string_view value = in.bytes(vlen);
+          if (in.ok()) {
+            on_entry(key, value);
+          }
+        }
+        bad = bad || reply.frame.header.type != FrameType::ScanBatch || !in.done();
+      }
+      if (reply.last) {
+        on_done(bad && reply.status == CallStatus::Ok ? CallStatus::Error : reply.status);
+      }
+    });
+}
+
+void Client::poll(int timeout_ms)
+{
+  now_tick_ = read_tick();
+  dispatch();
+  for (std::size_t c = 0; c < connections_.size(); ++c) {
+    if (connections_[c].tx_sent < connections_[c].tx.size()) {
+      flush(c);
+    }
+  }
+  arm_timer_fd();
+
+  std::array<epoll_event, EVENT_BATCH> events;
+
+  int nevents;
+  do {
+    nevents = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), timeout_ms);
+  } while (nevents == -1 && errno == EINTR);
+
+  now_tick_ = read_tick();
+
+  for (int i = 0; i < nevents; ++i) {
+    const std::uint64_t tag = events[static_cast<std::size_t>(i)].data.u64;
+    if (tag == TIMER_TAG) {
+      std::uint64_t expirations;
+      (void)::read(timer_fd_, &expirations, sizeof expirations);
+      continue;
+    }
+    on_connection_event(tag - 1, events[static_cast<std::size_t>(i)].events);
+  }
+
+  timers_.advance(now_tick_, [this](Timer& timer) { on_timeout(timer); });
+}
+
+// milliseconds since clock_epoch_
+std::uint64_t Client::read_tick() const noexcept
+{
+  timespec ts;
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  const auto now = std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+  return static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::milliseconds>(now - clock_epoch_).count());
+}
+
+// The connection with the fewest requests in flight, among those below depth (and already open,
+// or at least connecting, if open_only).
+std::size_t Client::pick_connection(bool open_only) const noexcept
+{
+  std::size_t best = NO_CONNECTION;
+  for (std::size_t c = 0; c < connections_.size(); ++c) {
+    const Connection& conn = connections_[c];
+    if (conn.in_flight >= config_.depth || (open_only && conn.fd == -1)) {
+      continue;
+    }
+    if (best == NO_CONNECTION || conn.in_flight < connections_[best].in_flight) {
+      best = c;
+    }
+  }
+  return best;
+}
+
+bool Client::open_connection(std::size_t c) noexcept
+{
+  const int fd = start_connect(config_.host.c_str(), config_.port, config_.socket);
+  if (fd == -1) {
+    return false;
+  }
+
+  // writable once the connect completes
+  epoll_event ev{.events = EPOLLIN | EPOLLOUT, .data = {.u64 = c + 1}};
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1) {
+    TSKV_LOG_WARN("epoll add client_fd = {} failed: errno={}", fd, errno);
+    ::close(fd);
+    return false;
+  }
+
+  Connection& conn     = connections_[c];
+  conn.fd              = fd;
+  conn.connecting      = true;
+  conn.writable_wanted = true;
+  return true;
+}
+
+void Client::close_connection(std::size_t c)
+{
+  Connection& conn = connections_[c];
+  (void)epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+  ::close(conn.fd);
+  conn.fd              = -1;
+  conn.connecting      = false;
+  conn.writable_wanted = false;
+  conn.tx.clear();
+  conn.tx_sent = 0;
+  conn.rx_size = 0;
+
+  // closed first, so requests submitted from the callbacks go elsewhere (or reconnect)
+  std::vector<std::uint32_t> lost;
+  for (const auto& [id, call] : calls_) {
+    if (call->connection == c) {
+      lost.push_back(id);
+    }
+  }
+  for (const std::uint32_t id : lost) {
+    if (const auto it = calls_.find(id); it != calls_.end()) {
+      complete(it, Reply{CallStatus::Disconnected, {}, true});
+    }
+  }
+  conn.in_flight = 0;
+}
+
+void Client::set_writable_wanted(std::size_t c, bool wanted) noexcept
+{
+  Connection& conn = connections_[c];
+  if (conn.writable_wanted == wanted) {
+    return;
+  }
+  epoll_event ev{.events = EPOLLIN | (wanted ? EPOLLOUT : 0u), .data = {.u64 = c + 1}};
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev) == -1) {
+    TSKV_LOG_WARN("epoll mod client_fd = {} failed: errno={}", conn.fd, errno);
+    return;
+  }
+  conn.writable_wanted = wanted;
+}
+
+void Client::assign(Call& call, std::size_t c)
+{
+  Connection& conn = connections_[c];
+  conn.tx.insert(conn.tx.end(), call.frame.begin(), call.frame.end());
+  call.frame      = {};
+  call.connection = c;
+  ++conn.in_flight;
+}
+
+// Moves queued requests onto connections with room, opening connections as needed.
+void Client::dispatch()
+{
+  while (!queued_.empty()) {
+    const auto it = calls_.find(queued_.front());
+    if (it == calls_.end()) {
+      queued_.pop_front(); // timed out while queued
+      continue;
+    }
+
+    const std::size_t c = pick_connection(false);
+    if (c == NO_CONNECTION) {
+      return; // every connection is at depth
+    }
+    if (connections_[c].fd == -1 && !open_connection(c)) {
+      // the server cannot be reached right now: fail everything waiting for it
+      std::vector<std::uint32_t> queued(queued_.begin(), queued_.end());
+      queued_.clear();
+      for (const std::uint32_t id : queued) {
+        if (const auto lost = calls_.find(id); lost != calls_.end()) {
+          complete(lost, Reply{CallStatus::Disconnected, {}, true});
+        }
+      }
+      continue;
+    }
+
+    queued_.pop_front();
+    assign(*it->second, c);
+  }
+}
+
+void Client::flush(std::size_t c)
+{
+  Connection& conn = connections_[c];
+  if (conn.fd == -1 || conn.connecting) {
+    return;
+  }
+
+  while (conn.tx_sent < conn.tx.size()) {
+    const ssize_t n = ::send(
+      conn.fd, conn.tx.data() + conn.tx_sent, conn.tx.size() - conn.tx_sent, MSG_NOSIGNAL);
+    if (n > 0) {
+      conn.tx_sent += static_cast<std::size_t>(n);
+      continue;
+    }
+    if (n == -1 && errno == EINTR) {
+      continue;
+    }
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      set_writable_wanted(c, true);
+      return;
+    }
+    TSKV_LOG_WARN("send failed on client_fd = {}: errno={}", conn.fd, errno);
+    close_connection(c);
+    return;
+  }
+
+  conn.tx.clear();
+  conn.tx_sent = 0;
+  set_writable_wanted(c, false);
+}
+
+void Client::on_connection_event(std::size_t c, std::uint32_t event_mask)
+{
+  Connection& conn = connections_[c];
+  if (conn.fd == -1) {
+    return; // closed earlier in this batch
+  }
+
+  if (conn.connecting) {
+    if ((event_mask & (EPOLLOUT | EPOLLERR | EPOLLHUP)) == 0) {
+      return;
+    }
+    int       err = 0;
+    socklen_t len = sizeof err;
+    if (getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1 || err != 0) {
+      TSKV_LOG_WARN("connect to {}:{} failed: errno={}", config_.host, config_.port, err);
+      close_connection(c);
+      return;
+    }
+    conn.connecting = false;
+  }
+
+  if ((event_mask & EPOLLOUT) != 0) {
+    flush(c);
+  }
+  if (conn.fd != -1 && (event_mask & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0) {
+    read_replies(c);
+  }
+}
+
+// One recv() per event (epoll is level-triggered), then every whole frame received is delivered.
+void Client::read_replies(std::size_t c)
+{
+  Connection& conn = connections_[c];
+  if (conn.rx.size() < conn.rx_size + RX_CHUNK) {
+    conn.rx.resize(conn.rx_size + RX_CHUNK);
+  }
+
+  const ssize_t n =
+    ::recv(conn.fd, conn.rx.data() + conn.rx_size, conn.rx.size() - conn.rx_size, 0);
+  if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+    return;
+  }
+  if (n <= 0) {
+    if (n == -1) {
+      TSKV_LOG_WARN("recv failed on client_fd = {}: errno={}", conn.fd, errno);
+    }
+    close_connection(c);
+    return;
+  }
+  conn.rx_size += static_cast<std::size_t>(n);
+
+  std::size_t offset = 0;
+  for (;;) {
+    const std::span<const std::byte> unread(conn.rx.data() + offset, conn.rx_size - offset);
+    const FrameParse                 parsed = parse_frame(unread, config_.max_payload);
+    if (parsed.status == FrameStatus::Incomplete) {
+      break;
+    }
+    if (parsed.status != FrameStatus::Complete) {
+      TSKV_LOG_WARN("bad reply frame ({}) on client_fd = {}, closing",
+        tc::to_string(parsed.status),
+        conn.fd);
+      close_connection(c);
+      return;
+    }
+    offset += parsed.size;
+    on_reply(c, parsed.frame);
+  }
+
+  std::copy(conn.rx.begin() + static_cast<std::ptrdiff_t>(offset),
+    conn.rx.begin() + static_cast<std::ptrdiff_t>(conn.rx_size),
+    conn.rx.begin());
+  conn.rx_size -= offset;
+}
+
+void Client::on_reply(std::size_t c, const FrameView& frame)
+{
+  const auto it = calls_.find(frame.header.id);
+  if (it == calls_.end() || it->second->connection != c) {
+    return; // its request timed out
+  }
+  Call& call = *it->second;
+
+  const bool failed = frame.header.type == FrameType::Error;
+  const bool last = failed || !streamed(call.type) || (frame.header.flags & FRAME_FLAG_END) != 0;
+  if (last) {
+    complete(it, Reply{failed ? CallStatus::Error : CallStatus::Ok, frame, true});
+    return;
+  }
+
+  if (config_.timeout_ms != 0) {
+    timers_.schedule(call.timer, now_tick_ + config_.timeout_ms);
+  }
+  std::vector<std::byte>& tx = connections_[c].tx;
+  const auto              at = tx.size();
+  tx.resize(at + FRAME_HEADER_SIZE);
+  encode_frame_header({FrameType::ScanCredit, 0, sizeof(std::uint32_t), frame.header.id},
+    std::span(tx).subspan(at).first<FRAME_HEADER_SIZE>());
+  append_u32(tx, 1);
+
+  call.on_reply(Reply{CallStatus::Ok, frame, false});
+}
+
+void Client::on_timeout(Timer& timer)
+{
+  const auto id = static_cast<std::uint32_t>(timer.cookie);
+  const auto it = calls_.find(id);
+  if (it == calls_.end()) {
+    return;
+  }
+
+  // don't leave the server streaming to nobody (its final batch will be dropped)
+  const Call& call = *it->second;
+  if (call.connection != NO_CONNECTION && streamed(call.type)) {
+    std::vector<std::byte>& tx = connections_[call.connection].tx;
+    const auto              at = tx.size();
+    tx.resize(at + FRAME_HEADER_SIZE);
+    encode_frame_header(
+      {FrameType::ScanCancel, 0, 0, id}, std::span(tx).subspan(at).first<FRAME_HEADER_SIZE>());
+  }
+  complete(it, Reply{CallStatus::Timeout, {}, true});
+}
+
+// Forgets the request, then hands it its last reply.
+void Client::complete(Calls::iterator it, const Reply& reply)
+{
+  std::unique_ptr<Call> call = std::move(it->second);
+  calls_.erase(it);
+  timers_.cancel(call->timer);
+  if (call->connection != NO_CONNECTION) {
+    --connections_[call->connection].in_flight;
+  }
+  call->on_reply(reply);
+}
+
+void Client::arm_timer_fd() noexcept
+{
+  const std::uint64_t due = timers_.next_due().value_or(TIMER_NOT_ARMED);
+
+  // as in Reactor: a pending earlier expiry costs at most one spurious wakeup
+  if (timer_armed_tick_ > now_tick_ && due >= timer_armed_tick_) {
+    return;
+  }
+
+  itimerspec spec{}; // all-zero it_value disarms
+  if (due != TIMER_NOT_ARMED) {
+    spec.it_value = tc::to_timespec(clock_epoch_ + std::chrono::milliseconds(due));
+  }
+
+  if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) == -1) [[unlikely]] {
+    TSKV_LOG_WARN("timerfd_settime failed: errno={}", errno);
+    return;
+  }
+
+  timer_armed_tick_ = due;
+}
+
+} // namespace tskv::net
@@ -0,0 +1,139 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.net.completion_queue
+// Summary: lock-free MPSC queue carrying responses from worker threads back to a reactor
+//
+//  - any thread may post(); only the owning reactor thread may drain()
+//    * post() is one CAS onto an intrusive stack; drain() takes the whole stack with a single
+//      exchange and hands it out oldest first (FIFO per producer)
+//  - wakeups are coalesced: only the post() that finds the queue empty writes the eventfd, so a
+//    burst of completions costs the reactor one wakeup no matter how many producers took part
+//    * drain() resets the eventfd before taking the batch, so a post() racing with it either
+//      lands in this batch or wakes the reactor again; no completion is ever left unannounced
+//  - a Completion addresses its channel by event tag (see make_event_tag), so responses for a
+//    connection that has closed in the meantime, or whose fd was reused, are recognised and dropped
+//------------------------------------------------------------------------------
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <utility>
+
+#include "tskv/common/logging.hpp"
+
+export module tskv.net.completion_queue;
+
+import tskv.common.logging;
+import tskv.net.tx_queue;
+
+export namespace tskv::net {
+
+struct Completion {
+  Completion*   next = nullptr; // owned by the queue while posted
+  std::uint64_t tag  = 0;       // event tag of the channel the response belongs to
+  TxSegment     payload;        // bytes queued on that channel's TX, as by tx_enqueue
+};
+
+class CompletionQueue {
+  // newest first; nullptr <=> empty (and the consumer is owed a wakeup by the next post)
+  alignas(64) std::atomic<Completion*> head_{nullptr};
+
+  int wakeup_fd_ = -1;
+
+public:
+  CompletionQueue()
+  {
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    TSKV_DEMAND(wakeup_fd_ != -1, "CompletionQueue: eventfd failed");
+  }
+
+  ~CompletionQueue()
+  {
+    Completion* node = head_.exchange(nullptr, std::memory_order_acquire);
+    while (node != nullptr) {
+      delete std::exchange(node, node->next);
+    }
+    ::close(wakeup_fd_);
+  }
+
+  CompletionQueue(const CompletionQueue&)            = delete;
+  CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+  // Readable whenever completions are waiting; register it with the reactor's poller.
+  [[nodiscard]] int wakeup_fd() const noexcept { return wakeup_fd_; }
+
+  // Thread-safe. Returns true if this call woke the consumer (the queue was empty).
+  bool post(std::unique_ptr<Completion> completion) noexcept
+  {
+    Completion* node = completion.release();
+    Completion* head = head_.load(std::memory_order_relaxed);
+    do {
+      node->next = head;
+    } while (!head_.compare_exchange_weak(
+      head, node, std::memory_order_release, std::memory_order_relaxed));
+
+    if (head != nullptr) {
+      return false; // a wakeup for the pending batch is already on its way
+    }
+
+    const std::uint64_t one = 1;
+    (void)::write(wakeup_fd_, &one, sizeof one);
+    return true;
+  }
+
+  bool post(std::uint64_t tag, TxSegment payload)
+  {
+    return post(std::make_unique<Completion>(Completion{nullptr, tag, std::move(payload)}));
+  }
+
+  // Consumer only. Calls fn(Completion&) for everything posted so far, oldest first, and frees
+  // each completion afterwards (fn may move the payload out). Returns the batch size.
+  template <typename Fn>
+  std::size_t drain(Fn&& fn)
+  {
+    std::uint64_t count;
+    (void)::read(wakeup_fd_, &count, sizeof count); // re-arm before looking at the queue
+
+    Completion* node = head_.exchange(nullptr, std::memory_order_acquire);
+
+    // reverse the stack into posting order
+    Completion* oldest = nullptr;
+    while (node != nullptr) {
+      Completion* next = node->next;
+      node->next       = oldest;
+      oldest           = node;
+      node             = next;
+    }
+
+    std::size_t n = 0;
+    while (oldest != nullptr) {
+      std::unique_ptr<Completion> completion(std::exchange(oldest, oldest->next));
+      fn(*completion);
+      ++n;
+    }
+    return n;
+  }
+
+  // Advisory only: another thread may post right after this returns true.
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return head_.load(std::memory_order_relaxed) == nullptr;
+  }
+};
+
+// Where a worker thread sends the response for a request it took from a channel; obtained on the
+// reactor thread with ChannelIO::completion_target() and safe to copy to any thread.
+struct CompletionTarget {
+  CompletionQueue* queue = nullptr;
+  std::uint64_t    tag   = 0;
+
+  [[nodiscard]] explicit operator bool() const noexcept { return queue != nullptr; }
+
+  bool post(TxSegment payload) const { return queue->post(tag, std::move(payload)); }
+};
+
+} // namespace tskv::net
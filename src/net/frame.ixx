@@ -0,0 +1,254 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.net.frame
+// Summary: length-prefixed binary framing used by the tskv wire protocol
+//
+//  - a frame is a fixed 12-byte header followed by `length` payload bytes
+//    * header: magic (u8) | version (u8) | type (u8) | flags (u8) | length (u32) | id (u32)
+//    * integers are little-endian; the header has no alignment requirements
+//  - parse_frame() reads a header straight out of received bytes and returns views into them
+//    * nothing is copied: a FrameView is only valid until the bytes it points at are consumed
+//    * oversized frames are rejected as soon as their header has arrived, before the payload
+//  - `id` is chosen by the client and echoed in the response, so requests can be pipelined
+//  - batch payloads (MGet/MPut and their results) are u32 counts and lengths followed by raw bytes;
+//    PayloadReader decodes them in place with bounds checks, append_u32/append_bytes
+//    (tskv.common.bytes) encode them
+//    * timestamps and samples (Aggregate) are 8-byte fields: u64() / f64() and append_u64 /
+//      append_f64
+//------------------------------------------------------------------------------
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+export module tskv.net.frame;
+
+export import tskv.common.bytes;
+import tskv.common.enum_traits;
+
+namespace tc = tskv::common;
+
+export namespace tskv::net {
+
+inline constexpr std::uint8_t FRAME_MAGIC       = 0x74; // 't'
+inline constexpr std::uint8_t FRAME_VERSION     = 1;
+inline constexpr std::size_t  FRAME_HEADER_SIZE = 12;
+
+enum class FrameType : std::uint8_t {
+  Ping  = 1, // payload is echoed back in the Pong
+  Pong  = 2,
+  Error = 3, // payload: FrameError code (u8), then a human-readable message
+
+  // Batch payloads; all counts and lengths are u32:
+  MGet       = 4, // count, then count * [klen | key]
+  MGetResult = 5, // count, then count * [vlen | value]; vlen == FRAME_NO_VALUE for a missing key
+  MPut       = 6, // count, then count * [klen | vlen | key | value]; later duplicates win
+  MPutResult = 7, // count of points stored (all of them: a batch is applied whole or not at all)
+
+  // Streaming scan; the ScanCredit/ScanCancel id is the Scan's:
+  Scan       = 8, // start_len | start | end_len | end (exclusive, empty: none) | credits
+  ScanBatch  = 9, // count, then count * [klen | vlen | key | value]; FRAME_FLAG_END on the last
+  ScanCredit = 10, // credits: how many more ScanBatch frames the client will take
+  ScanCancel = 11, // end the scan early; answered with an empty ScanBatch flagged FRAME_FLAG_END
+
+  // Time-bucketed aggregation of one series (tskv.storage.series). Timestamps and the width are
+  // i64, fns is a u32 mask of AggregateFn bits, and a bucket carries one 8-byte field per requested
+  // function in bit order (count is a u64, the others f64):
+  Aggregate      = 12, // series_len | series | from | to (exclusive) | width | fns
+  AggregateBatch = 13, // count, then count * [bucket start | fields]; FRAME_FLAG_END on the last
+
+  // Points of one series as a columnar block (tskv.storage.point_codec: the series once,
+  // delta-of-delta timestamps, XOR-compressed values). ScanPoints streams like Scan, and takes
+  // ScanCredit / ScanCancel the same way:
+  PutPoints       = 14, // one point block
+  PutPointsResult = 15, // count of points stored
+  ScanPoints      = 16, // series_len | series | from (i64) | to (i64, exclusive) | credits
+  PointsBatch     = 17, // one point block, in time order; FRAME_FLAG_END on the last
+};
+
+inline constexpr std::uint32_t FRAME_NO_VALUE = 0xFFFF'FFFF;
+inline constexpr std::uint8_t  FRAME_FLAG_END = 0x01; // last frame of a streamed response
+
+// Codes carried by an Error frame.
+enum class FrameError : std::uint8_t {
+  Malformed   = 1, // bad magic or version; the connection is closed
+  TooLarge    = 2, // payload above the server's limit; the connection is closed
+  UnknownType = 3, // the frame was skipped; the connection stays usable
+  BadPayload  = 4, // the payload does not match its type's layout; the connection stays usable
+  WriteFailed = 5, // the storage engine could not log the batch; none of it was applied
+  Busy        = 6, // a Scan or Aggregate is already streaming on this connection; frame skipped
+};
+
+struct FrameHeader {
+  FrameType     type   = FrameType::Ping;
+  std::uint8_t  flags  = 0;
+  std::uint32_t length = 0; // payload bytes, excluding the header
+  std::uint32_t id     = 0;
+};
+
+struct FrameView {
+  FrameHeader                header;
+  std::span<const std::byte> payload;
+};
+
+enum class FrameStatus : std::uint8_t {
+  Complete, // header and payload are both present
+  Incomplete, // need more bytes
+  BadMagic,
+  BadVersion,
+  TooLarge, // header.length > max_payload
+};
+
+struct FrameParse {
+  FrameStatus status = FrameStatus::Incomplete;
+  FrameView   frame;    // header valid unless Incomplete/BadMagic/BadVersion; payload if Complete
+  std::size_t size = 0; // bytes taken by the whole frame if Complete
+};
+
+// The payload encoders are shared with the WAL (tskv.common.bytes).
+using tskv::common::append_bytes;
+using tskv::common::append_f64;
+using tskv::common::append_u32;
+using tskv::common::append_u64;
+using tskv::common::patch_u32;
+
+// Bounds-checked cursor over a payload. A read past the end yields 0 / an empty view and clears
+// ok(); views point into the payload.
+class PayloadReader {
+public:
+  explicit PayloadReader(std::span<const std::byte> bytes) noexcept : bytes_(bytes) {}
+
+  [[nodiscard]] std::uint32_t u32() noexcept
+  {
+    if (remaining() < sizeof(std::uint32_t)) {
+      ok_ = false;
+      return 0;
+    }
+    const auto v = tc::load_le<std::uint32_t>(bytes_.data() + offset_);
+    offset_ += sizeof v;
+    return v;
+  }
+
+  [[nodiscard]] std::uint64_t u64() noexcept
+  {
+    if (remaining() < sizeof(std::uint64_t)) {
+      ok_ = false;
+      return 0;
+    }
+    const auto v = tc::load_le<std::uint64_t>(bytes_.data() + offset_);
+    offset_ += sizeof v;
+    return v;
+  }
+
+  [[nodiscard]] double f64() noexcept { return std::bit_cast<double>(u64()); }
+
+  [[nodiscard]] std::string_view bytes(std::size_t n) noexcept
+  {
+    if (remaining() < n) {
+      ok_ = false;
+      return {};
+    }
+    const std::string_view out(reinterpret_cast<const char*>(bytes_.data() + offset_), n);
+    offset_ += n;
+    return out;
+  }
+
+  [[nodiscard]] std::size_t remaining() const noexcept { return bytes_.size() - offset_; }
+  [[nodiscard]] bool        ok() const noexcept { return ok_; }
+
+  // every read succeeded and the whole payload was read
+  [[nodiscard]] bool done() const noexcept { return ok_ && offset_ == bytes_.size(); }
+
+private:
+  std::span<const std::byte> bytes_;
+  std::size_t                offset_ = 0;
+  bool                       ok_     = true;
+};
+
+// Parse the frame at the front of `bytes`, which may hold any number of further frames.
+[[nodiscard]] FrameParse parse_frame(
+  std::span<const std::byte> bytes, std::size_t max_payload) noexcept
+{
+  FrameParse result;
+
+  if (bytes.size() < FRAME_HEADER_SIZE) {
+    // a bad first byte can be reported before the rest of the header arrives
+    if (!bytes.empty() && std::to_integer<std::uint8_t>(bytes[0]) != FRAME_MAGIC) {
+      result.status = FrameStatus::BadMagic;
+    }
+    return result;
+  }
+
+  const std::byte* p = bytes.data();
+  if (std::to_integer<std::uint8_t>(p[0]) != FRAME_MAGIC) {
+    result.status = FrameStatus::BadMagic;
+    return result;
+  }
+  if (std::to_integer<std::uint8_t>(p[1]) != FRAME_VERSION) {
+    result.status = FrameStatus::BadVersion;
+    return result;
+  }
+
+  FrameHeader& header = result.frame.header;
+  header.type         = static_cast<FrameType>(p[2]);
+  header.flags        = std::to_integer<std::uint8_t>(p[3]);
+  header.length       = tc::load_le<std::uint32_t>(p + 4);
+  header.id           = tc::load_le<std::uint32_t>(p + 8);
+
+  if (header.length > max_payload) {
+    result.status = FrameStatus::TooLarge;
+    return result;
+  }
+
+  if (bytes.size() - FRAME_HEADER_SIZE < header.length) {
+    return result; // Incomplete, header already decoded
+  }
+
+  result.status        = FrameStatus::Complete;
+  result.frame.payload = bytes.subspan(FRAME_HEADER_SIZE, header.length);
+  result.size          = FRAME_HEADER_SIZE + header.length;
+  return result;
+}
+
+void encode_frame_header(const FrameHeader& header, std::span<std::byte, FRAME_HEADER_SIZE> out)
+{
+  out[0] = std::byte{FRAME_MAGIC};
+  out[1] = std::byte{FRAME_VERSION};
+  out[2] = static_cast<std::byte>(header.type);
+  out[3] = std::byte{header.flags};
+  tc::store_le(out.data() + 4, header.length);
+  tc::store_le(out.data() + 8, header.id);
+}
+
+[[nodiscard]] std::array<std::byte, FRAME_HEADER_SIZE> encode_frame_header(
+  const FrameHeader& header)
+{
+  std::array<std::byte, FRAME_HEADER_SIZE> out;
+  encode_frame_header(header, out);
+  return out;
+}
+
+} // namespace tskv::net
+
+namespace tn = tskv::net;
+
+export namespace tskv::common {
+
+template <>
+struct enum_traits<tn::FrameStatus> {
+  static constexpr std::array<std::pair<tn::FrameStatus, std::string_view>, 5> entries{{
+    {tn::FrameStatus::Complete, "complete"},
+    {tn::FrameStatus::Incomplete, "incomplete"},
+    {tn::FrameStatus::BadMagic, "bad_magic"},
+    {tn::FrameStatus::BadVersion, "bad_version"},
+    {tn::FrameStatus::TooLarge, "too_large"},
+  }};
+};
+
+} // namespace tskv::common
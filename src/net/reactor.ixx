@@ -1,8 +1,14 @@
 module;
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <ctime>
+#include <string>
 #include <errno.h>
 #include <fcntl.h>
 #include <signal.h>
@@ -12,6 +18,7 @@ module;
 #include <sys/socket.h>
 #include <sys/timerfd.h>
 #include <unistd.h>
+#include <utility>
 #include <vector>
 
 #include "tskv/common/logging.hpp"
@@ -20,79 +27,159 @@ export module tskv.net.reactor;
 
 import tskv.common.logging;
 import tskv.common.metrics;
+import tskv.common.time;
 import tskv.net.channel;
+import tskv.net.completion_queue;
 import tskv.net.server;
 import tskv.net.socket;
+import tskv.net.timer_wheel;
 
+namespace tc      = tskv::common;
 namespace metrics = tskv::common::metrics;
 
-// https://copyconstruct.medium.com/the-method-to-epolls-madness-d9d2d6378642
-
-/*
-int register_epoll_timer(
-  int epfd, std::chrono::nanoseconds initial, std::chrono::nanoseconds interval)
-{
-  int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
-  TSKV_DEMAND(timer_fd != -1, "failed to create epoll timer");
-
-  struct itimerspec new_value;
-  new_value.it_value    = tc::to_timespec(initial);
-  new_value.it_interval = tc::to_timespec(interval);
+using namespace std::chrono_literals;
 
-  bool timer_configure_success = timerfd_settime(timer_fd, 0, &new_value, NULL) != -1;
-  TSKV_DEMAND(timer_configure_success, "failed to configure epoll timer");
-
-  struct epoll_event timer_event;
-  timer_event.events  = EPOLLIN; // monitor for readability (timer expiration)
-  timer_event.data.fd = timer_fd;
-
-  bool timer_register_success = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd, &timer_event) != -1;
-  TSKV_DEMAND(timer_register_success, "failed to register epoll timer");
-
-  return timer_fd;
-}
-
-void Reactor<Proto>::on_timer_event()
-{
-  uint64_t expirations;
-  ssize_t  s = read(timer_fd_, &expirations, sizeof(uint64_t));
-  if (s != sizeof(uint64_t)) {
-    TSKV_LOG_WARN("failed to read timer");
-    return;
-  }
-
-  TSKV_LOG_INFO("Timer expired {} times", expirations);
-}
-*/
+// https://copyconstruct.medium.com/the-method-to-epolls-madness-d9d2d6378642
 
 export namespace tskv::net {
 
 template <Protocol Proto>
 struct Reactor {
 private:
-  static constexpr std::size_t EVENT_BUFSIZE = 128;
+  // The epoll_wait batch grows while batches come back full (fewer syscalls per event under load)
+  // and shrinks after a run of mostly-empty ones (see adapt_event_batch).
+  static constexpr std::size_t MIN_EVENT_BATCH    = 16;
+  static constexpr std::size_t MAX_EVENT_BATCH    = 1024;
+  static constexpr unsigned    BATCH_SHRINK_AFTER = 64; // consecutive batches at most 1/4 full
 
   ChannelPool<Proto> pool_;
 
-  epoll_event evt_buffer_[EVENT_BUFSIZE]{};
+  // Responses from worker threads (see ChannelIO::completion_target). Drained in one batch per
+  // wakeup; the channels it touches are flushed by the ready-list pass of the same loop turn.
+  CompletionQueue completions_;
+
+  epoll_event evt_buffer_[MAX_EVENT_BATCH]{};
+  std::size_t event_batch_    = 128;
+  unsigned    sparse_batches_ = 0;
+
+  // Busy-poll mode: after the last event, keep calling epoll_wait with a zero timeout for up to
+  // busy_poll_ns_ before blocking again, trading CPU for wakeup latency. 0: always block.
+  std::uint64_t busy_poll_ns_     = 0;
+  std::uint32_t busy_poll_us_     = 0; // also applied to accepted sockets as SO_BUSY_POLL
+  std::uint64_t last_event_ns_    = 0;
+  bool          busy_poll_warned_ = false;
+
+  SocketProfile socket_profile_; // applied to every accepted socket
+  bool          socket_profile_warned_ = false;
+
+  // Channels that ran out of IoBudget with work left over, as event tags (see make_event_tag).
+  // Serviced round-robin after each epoll_wait; new arrivals wait for the next pass.
+  std::vector<std::uint64_t> ready_;
+  std::vector<std::uint64_t> ready_servicing_;
+  IoBudget                   io_budget_;
+  std::size_t                tx_zerocopy_ = 0;
+
+  // Timeouts live on one TimerWheel counting 1 ms ticks since clock_epoch_ (CLOCK_MONOTONIC). A
+  // one-shot timerfd armed for the wheel's next_due() tick makes epoll_wait return in time.
+  enum class TimerKind : std::uint8_t { Idle, Deadline, MetricsFlush, AcceptRetry };
+
+  static constexpr std::uint64_t TIMER_NOT_ARMED     = UINT64_MAX;
+  static constexpr std::uint64_t METRICS_FLUSH_TICKS = 1000;
+
+  TimerWheel               timers_;
+  Timer                    metrics_timer_;
+  std::chrono::nanoseconds clock_epoch_{};
+  std::uint64_t            loop_ns_            = 0; // sampled once per poll_once()
+  std::uint64_t            loop_tick_          = 0; // loop_ns_ in ticks
+  std::uint64_t            timer_armed_tick_   = TIMER_NOT_ARMED;
+  std::uint64_t            idle_timeout_ticks_ = 0; // 0: connections never time out
+
+  // Admission control: at most max_channels_ connections. At capacity the listener stops reporting
+  // events and the kernel backlog holds further connections until a close makes room.
+  // Each wakeup accepts at most ACCEPT_BATCH, so a connection storm cannot starve established
+  // connections; the rest are accepted on following loop turns.
+  static constexpr std::size_t   ACCEPT_BATCH       = 64;
+  static constexpr std::uint64_t ACCEPT_RETRY_TICKS = 10;
+  std::size_t                    max_channels_      = 0;
+  bool                           listener_paused_   = false;
+  Timer                          accept_retry_timer_;
+  int                            reserve_fd_        = -1; // see shed_connection()
+
+  // The TCP listener, plus an AF_UNIX one for co-located clients (--unix-socket). Connections from
+  // either go through the same pool and protocol; admission control pauses both together.
+  struct Listener {
+    int  fd      = -1;
+    bool is_unix = false;
+    bool backlog = false; // last batch ended before EAGAIN
+  };
+
+  static constexpr std::size_t TCP_LISTENER  = 0;
+  static constexpr std::size_t UNIX_LISTENER = 1;
+
+  std::array<Listener, 2> listeners_;
+  std::string             unix_socket_path_; // unlinked when the unix listener closes
 
   int  epoll_fd_      = -1;
-  int  listener_fd_   = -1;
   int  wakeup_fd_     = -1;
   int  signal_fd_     = -1;
+  int  timer_fd_      = -1;
   bool shutting_down_ = false;
 
+  // set from other threads by notify_shutdown(), observed on the next wakeup event
+  std::atomic<bool> shutdown_notified_{false};
+
   Reactor(const Reactor&)            = delete;
   Reactor& operator=(const Reactor&) = delete;
 
   void on_channel_event(Channel<Proto>* channel, std::uint32_t event_mask) noexcept;
-  void on_listener_event() noexcept;
+  void finish_dispatch(Channel<Proto>* channel) noexcept;
+  void on_listener_event(Listener& listener) noexcept;
+  int  shed_connection(int listen_fd) noexcept;
+  void set_listener_paused(bool paused) noexcept;
+  void register_listener(const Listener& listener) noexcept;
+
+  [[nodiscard]] Listener* find_listener(int fd) noexcept
+  {
+    for (Listener& listener : listeners_) {
+      if (listener.fd == fd) {
+        return &listener;
+      }
+    }
+    return nullptr;
+  }
+  void service_ready_list() noexcept;
+
+  void adapt_event_batch(int nevents) noexcept;
+
+  [[nodiscard]] std::uint64_t read_clock_ns() const noexcept;
+  void                        run_timers() noexcept;
+  void                        on_timer_expired(Timer& timer) noexcept;
+  void                        arm_timer_fd() noexcept;
+
+  void on_timer_event() noexcept
+  {
+    uint64_t expirations;
+    while (::read(timer_fd_, &expirations, sizeof expirations) == sizeof expirations)
+      continue; // drain; run_timers() does the work after every poll
+
+    // how late we got to run after the kernel fired the timer (scheduler / C-state exit)
+    const std::uint64_t due_ns = timer_armed_tick_ * 1'000'000;
+    if (timer_armed_tick_ != TIMER_NOT_ARMED && loop_ns_ >= due_ns) {
+      metrics::record_histogram<"net.wakeup_latency_ns">(loop_ns_ - due_ns);
+    }
+  }
+
+  void on_completion_event() noexcept;
 
   void on_wakeup_event()
   {
     uint64_t tmp;
     while (::read(wakeup_fd_, &tmp, sizeof tmp) == sizeof tmp)
       continue; // drain
+
+    if (shutdown_notified_.load(std::memory_order_acquire)) {
+      request_shutdown();
+    }
   }
 
   void on_signal_event()
@@ -106,20 +193,53 @@ private:
 
   void close_channel(Channel<Proto>* channel) noexcept;
   void sweep_closing_channels() noexcept;
-  void close_listener() noexcept;
+  void close_listeners() noexcept;
 
 public:
-  Reactor(const ServerConfig& config);
+  // handle_signals: install a signalfd for SIGINT/SIGTERM on the calling thread. Reactors running
+  //   inside a ReactorGroup leave this off and are stopped through notify_shutdown() instead.
+  Reactor(const ServerConfig& config, bool handle_signals = true);
   ~Reactor();
 
   void poll_once() noexcept;
   void run();
   void request_shutdown() noexcept;
+
+  // Thread-safe: may be called from any thread to make this reactor begin its shutdown sequence.
+  void notify_shutdown() noexcept;
+
+  // Thread-safe to post to from any thread.
+  [[nodiscard]] CompletionQueue& completions() noexcept { return completions_; }
 };
 
 template <Protocol Proto>
-Reactor<Proto>::Reactor(const ServerConfig& config)
+Reactor<Proto>::Reactor(const ServerConfig& config, bool handle_signals)
 {
+  { // fairness
+    if (config.rx_budget_bytes != 0) {
+      io_budget_.rx_bytes = config.rx_budget_bytes;
+    }
+    if (config.tx_budget_bytes != 0) {
+      io_budget_.tx_bytes = config.tx_budget_bytes;
+    }
+  }
+
+  tx_zerocopy_        = config.tx_zerocopy;
+  idle_timeout_ticks_ = config.idle_timeout_ms;
+  busy_poll_us_       = config.busy_poll_us;
+  busy_poll_ns_       = std::uint64_t{config.busy_poll_us} * 1000;
+  socket_profile_     = config.socket;
+
+  { // admission control
+    max_channels_ = config.max_connections_per_reactor();
+    pool_.reserve_channels(max_channels_);
+
+    reserve_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    TSKV_DEMAND(reserve_fd_ != -1, "failed to open reserve fd");
+
+    accept_retry_timer_.kind = static_cast<std::uint8_t>(TimerKind::AcceptRetry);
+  }
+
   { // epoll
     epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
     TSKV_LOG_INFO("epoll_fd_ = {}", epoll_fd_);
@@ -127,32 +247,58 @@ Reactor<Proto>::Reactor(const ServerConfig& config)
   }
 
   { // listener
-    listener_fd_ = start_listener(config.host.c_str(), config.port);
-    TSKV_DEMAND(listener_fd_ != -1, "failed to bind/listen (IPv4)");
-
-    const int  flags        = fcntl(listener_fd_, F_GETFL, 0);
-    const bool non_blocking = (flags & O_NONBLOCK) != 0;
-    TSKV_DEMAND(flags != -1 && non_blocking, "invalid listener flags (blocking or broken)");
+    const bool reuse_port = config.io_threads > 1;
+    Listener&  listener   = listeners_[TCP_LISTENER];
 
-    struct epoll_event event{};
-    event.events  = EPOLLIN | EPOLLET;
-    event.data.fd = listener_fd_;
+    listener.fd = start_listener(config.host.c_str(), config.port, reuse_port, config.socket);
+    TSKV_DEMAND(listener.fd != -1, "failed to bind/listen on {}:{}", config.host, config.port);
+    register_listener(listener);
+  }
 
-    bool epoll_init_success = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listener_fd_, &event) != -1;
-    TSKV_LOG_INFO("listener_fd = {}", listener_fd_);
-    TSKV_DEMAND(epoll_init_success, "failed to register listener with epoll_ctl");
+  if (!config.unix_socket.empty()) { // unix listener
+    unix_socket_path_  = config.unix_socket.string();
+    Listener& listener = listeners_[UNIX_LISTENER];
+    listener.fd        = start_unix_listener(unix_socket_path_.c_str(), config.socket);
+    listener.is_unix   = true;
+    TSKV_DEMAND(listener.fd != -1, "failed to bind/listen on unix socket {}", unix_socket_path_);
+    register_listener(listener);
   }
 
   { // wakeup
     wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
     TSKV_DEMAND(wakeup_fd_ != -1, "eventfd failed");
 
-    epoll_event wev{.events = EPOLLIN, .data = {.fd = wakeup_fd_}};
+    epoll_event wev{.events = EPOLLIN, .data = {.u64 = make_event_tag(wakeup_fd_, 0)}};
     const int   wrc = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &wev);
     TSKV_DEMAND(wrc != -1, "epoll add wakeup_fd_ failed");
   }
 
-  { // signals
+  { // completions
+    const int   cfd = completions_.wakeup_fd();
+    epoll_event cev{.events = EPOLLIN, .data = {.u64 = make_event_tag(cfd, 0)}};
+    TSKV_DEMAND(
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, cfd, &cev) != -1, "epoll add completion fd failed");
+    pool_.set_completion_queue(&completions_);
+  }
+
+  { // timers
+    timespec ts;
+    TSKV_DEMAND(clock_gettime(CLOCK_MONOTONIC, &ts) == 0, "clock_gettime failed");
+    clock_epoch_ = std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    TSKV_DEMAND(timer_fd_ != -1, "timerfd_create failed");
+
+    epoll_event tev{.events = EPOLLIN, .data = {.u64 = make_event_tag(timer_fd_, 0)}};
+    const int   trc = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &tev);
+    TSKV_DEMAND(trc != -1, "epoll add timer_fd_ failed");
+
+    metrics_timer_.kind = static_cast<std::uint8_t>(TimerKind::MetricsFlush);
+    timers_.schedule(metrics_timer_, METRICS_FLUSH_TICKS);
+    arm_timer_fd();
+  }
+
+  if (handle_signals) { // signals
     sigset_t mask;
     sigemptyset(&mask);
     sigaddset(&mask, SIGINT);
@@ -162,7 +308,7 @@ Reactor<Proto>::Reactor(const ServerConfig& config)
     signal_fd_ = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
     TSKV_DEMAND(signal_fd_ != -1, "signalfd failed");
 
-    epoll_event ev{.events = EPOLLIN, .data = {.fd = signal_fd_}};
+    epoll_event ev{.events = EPOLLIN, .data = {.u64 = make_event_tag(signal_fd_, 0)}};
     TSKV_DEMAND(
       epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, signal_fd_, &ev) != -1, "epoll add signalfd failed");
   }
@@ -171,8 +317,13 @@ Reactor<Proto>::Reactor(const ServerConfig& config)
 template <Protocol Proto>
 Reactor<Proto>::~Reactor()
 {
-  if (listener_fd_ != -1) {
-    close_listener();
+  close_listeners();
+
+  timers_.cancel(metrics_timer_);
+  timers_.cancel(accept_retry_timer_);
+
+  if (reserve_fd_ != -1) {
+    ::close(reserve_fd_);
   }
 
   // TODO[@zmeadows][P1]: introduce owning wrapper (UniqueFd) around integer file descriptor
@@ -180,6 +331,10 @@ Reactor<Proto>::~Reactor()
     ::close(wakeup_fd_);
   }
 
+  if (timer_fd_ != -1) {
+    ::close(timer_fd_);
+  }
+
   if (signal_fd_ != -1) {
     ::close(signal_fd_);
   }
@@ -190,13 +345,38 @@ Reactor<Proto>::~Reactor()
 }
 
 template <Protocol Proto>
-void Reactor<Proto>::close_listener() noexcept
+void Reactor<Proto>::register_listener(const Listener& listener) noexcept
 {
-  if (listener_fd_ != -1) {
+  const int  flags        = fcntl(listener.fd, F_GETFL, 0);
+  const bool non_blocking = (flags & O_NONBLOCK) != 0;
+  TSKV_DEMAND(flags != -1 && non_blocking, "invalid listener flags (blocking or broken)");
+
+  struct epoll_event event{};
+  event.events   = EPOLLIN | EPOLLET;
+  event.data.u64 = make_event_tag(listener.fd, 0);
+
+  bool epoll_init_success = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listener.fd, &event) != -1;
+  TSKV_LOG_INFO("listener_fd = {}", listener.fd);
+  TSKV_DEMAND(epoll_init_success, "failed to register listener with epoll_ctl");
+}
+
+template <Protocol Proto>
+void Reactor<Proto>::close_listeners() noexcept
+{
+  for (Listener& listener : listeners_) {
+    if (listener.fd == -1) {
+      continue;
+    }
+
     epoll_event ev{};
-    (void)epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, listener_fd_, &ev);
-    ::close(listener_fd_);
-    listener_fd_ = -1;
+    (void)epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, listener.fd, &ev);
+    ::close(listener.fd);
+    listener.fd      = -1;
+    listener.backlog = false;
+
+    if (listener.is_unix) {
+      (void)::unlink(unix_socket_path_.c_str());
+    }
   }
 }
 
@@ -213,10 +393,10 @@ void Reactor<Proto>::request_shutdown() noexcept
   shutting_down_ = true;
 
   // 1) stop accepting new connections
-  close_listener();
+  close_listeners();
 
-  // 2) flip all channels to Draining (stop reading, flush any pending TX)
-  pool_.for_each([&](auto* ch) { ch->begin_shutdown(); });
+  // 2) flip all running channels to Draining (stop reading, flush any pending TX)
+  pool_.for_each_in(ChannelState::Running, [](auto* ch) { ch->begin_shutdown(); });
 
   // 3) wake epoll immediately
   uint64_t one = 1;
@@ -226,11 +406,23 @@ void Reactor<Proto>::request_shutdown() noexcept
   sweep_closing_channels();
 }
 
+template <Protocol Proto>
+void Reactor<Proto>::notify_shutdown() noexcept
+{
+  shutdown_notified_.store(true, std::memory_order_release);
+
+  uint64_t one = 1;
+  (void)::write(wakeup_fd_, &one, sizeof one);
+}
+
 template <Protocol Proto>
 void Reactor<Proto>::close_channel(Channel<Proto>* channel) noexcept
 {
   channel->notify_close();
 
+  timers_.cancel(channel->idle_timer());
+  timers_.cancel(channel->deadline_timer());
+
   const int client_fd = channel->fd();
 
   struct epoll_event ev{};
@@ -245,26 +437,55 @@ void Reactor<Proto>::close_channel(Channel<Proto>* channel) noexcept
   ::close(client_fd);
 
   TSKV_LOG_INFO("closed client_fd = {}", client_fd);
+
+  if (listener_paused_ && pool_.size() < max_channels_) {
+    set_listener_paused(false);
+  }
 }
 
 template <Protocol Proto>
 void Reactor<Proto>::on_channel_event(Channel<Proto>* channel, std::uint32_t event_mask) noexcept
 {
-  const int client_fd = channel->fd();
+  channel->set_last_active_tick(loop_tick_);
+  channel->handle_events(event_mask, io_budget_);
+  finish_dispatch(channel);
+}
 
-  channel->handle_events(event_mask);
+// Reconcile reactor state with whatever the channel (and its protocol) just did.
+template <Protocol Proto>
+void Reactor<Proto>::finish_dispatch(Channel<Proto>* channel) noexcept
+{
+  const int client_fd = channel->fd();
 
   if (channel->should_close()) {
     close_channel(channel);
     return;
   }
 
+  if (const auto deadline = channel->take_deadline_request(); deadline.has_value()) {
+    Timer& timer = channel->deadline_timer();
+    if (*deadline > 0ms) {
+      timer.kind   = static_cast<std::uint8_t>(TimerKind::Deadline);
+      timer.cookie = pool_.event_tag(client_fd);
+      timers_.schedule(timer, loop_tick_ + static_cast<std::uint64_t>(deadline->count()));
+    }
+    else {
+      timers_.cancel(timer);
+    }
+  }
+
+  if (channel->deferred_events() != 0 && !channel->is_ready_queued()) {
+    metrics::inc_counter<"net.budget_deferrals">();
+    channel->set_ready_queued(true);
+    ready_.push_back(pool_.event_tag(client_fd));
+  }
+
   const std::uint32_t new_mask = channel->desired_events() | EPOLLET | EPOLLRDHUP;
 
   if (channel->get_last_event_mask() != new_mask) {
     struct epoll_event event{};
-    event.events  = new_mask;
-    event.data.fd = client_fd;
+    event.events   = new_mask;
+    event.data.u64 = pool_.event_tag(client_fd);
 
     if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, client_fd, &event) != -1) {
       channel->set_last_event_mask(new_mask);
@@ -276,24 +497,42 @@ void Reactor<Proto>::on_channel_event(Channel<Proto>* channel, std::uint32_t eve
 }
 
 template <Protocol Proto>
-void Reactor<Proto>::on_listener_event() noexcept
+void Reactor<Proto>::on_listener_event(Listener& listener) noexcept
 {
-  while (true) {
+  listener.backlog = false;
+
+  for (std::size_t naccepted = 0;; ++naccepted) {
+    if (pool_.size() >= max_channels_) {
+      set_listener_paused(true);
+      return;
+    }
+
+    if (naccepted == ACCEPT_BATCH) {
+      listener.backlog = true; // edge already consumed; come back next turn
+      return;
+    }
+
     sockaddr_storage client_addr{};
     socklen_t        client_addr_size = sizeof client_addr;
 
     int client_fd = accept4(
-      listener_fd_, (sockaddr*)&client_addr, &client_addr_size, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      listener.fd, (sockaddr*)&client_addr, &client_addr_size, SOCK_NONBLOCK | SOCK_CLOEXEC);
 
     if (client_fd == -1) {
-      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      const int err = errno;
+
+      if (err == EAGAIN || err == EWOULDBLOCK) {
         // done processing new channels, try again later
         return;
       }
 
-      TSKV_LOG_WARN("failed to accept new channel: errno={}", errno);
+      if (err == ECONNABORTED || err == EINTR) {
+        continue; // that one is gone; the backlog may still hold others
+      }
+
+      TSKV_LOG_WARN("failed to accept new channel: errno={}", err);
 
-      switch (errno) {
+      switch (err) {
         case EMFILE:
           metrics::inc_counter<"net.accept_error.emfile">();
           break;
@@ -308,15 +547,52 @@ void Reactor<Proto>::on_listener_event() noexcept
           break;
       }
 
+      if (err == EMFILE || err == ENFILE) {
+        const int shed_err = shed_connection(listener.fd);
+        if (shed_err == 0) {
+          continue;
+        }
+        if (shed_err == EAGAIN || shed_err == EWOULDBLOCK) {
+          return; // backlog drained; the next connection brings a new edge
+        }
+      }
+
+      // The backlog is still readable, but with edge-triggering no new edge will report it.
+      // Retry shortly instead of spinning on the failure.
+      if (!accept_retry_timer_.armed()) {
+        timers_.schedule(accept_retry_timer_, loop_tick_ + ACCEPT_RETRY_TICKS);
+      }
       return;
     }
 
     Channel<Proto>* channel = pool_.acquire(client_fd);
     channel->attach(client_fd);
+    channel->set_last_active_tick(loop_tick_);
+    if (tx_zerocopy_ != 0) {
+      (void)channel->enable_zerocopy(tx_zerocopy_);
+    }
+    if (!listener.is_unix) { // TCP and NIC options; meaningless for AF_UNIX
+      if (busy_poll_us_ != 0 && !set_busy_poll(client_fd, busy_poll_us_) && !busy_poll_warned_) {
+        TSKV_LOG_WARN("SO_BUSY_POLL/SO_PREFER_BUSY_POLL rejected (needs CAP_NET_ADMIN above "
+                      "net.core.busy_read); spinning in epoll_wait only");
+        busy_poll_warned_ = true;
+      }
+      if (!apply_socket_profile(client_fd, socket_profile_) && !socket_profile_warned_) {
+        TSKV_LOG_WARN(
+          "some socket options were rejected on accepted connections (errno={})", errno);
+        socket_profile_warned_ = true;
+      }
+    }
+    if (idle_timeout_ticks_ != 0) {
+      Timer& idle = channel->idle_timer();
+      idle.kind   = static_cast<std::uint8_t>(TimerKind::Idle);
+      idle.cookie = pool_.event_tag(client_fd);
+      timers_.schedule(idle, loop_tick_ + idle_timeout_ticks_);
+    }
 
     struct epoll_event event{};
-    event.events  = channel->desired_events() | EPOLLET | EPOLLRDHUP;
-    event.data.fd = client_fd;
+    event.events   = channel->desired_events() | EPOLLET | EPOLLRDHUP;
+    event.data.u64 = pool_.event_tag(client_fd);
     TSKV_LOG_INFO("added client_fd = {}", client_fd);
 
     bool add_client_success = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_fd, &event) != -1;
@@ -327,25 +603,110 @@ void Reactor<Proto>::on_listener_event() noexcept
   }
 }
 
+// Out of descriptors: release the spare one, accept and immediately close a pending connection
+// (so its client sees a reset instead of hanging in the backlog), then take the spare back.
+// Returns 0 if a connection was shed, otherwise the errno of the failed accept.
+template <Protocol Proto>
+int Reactor<Proto>::shed_connection(int listen_fd) noexcept
+{
+  if (reserve_fd_ == -1) {
+    reserve_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return EMFILE;
+  }
+
+  ::close(reserve_fd_);
+  const int fd  = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+  const int err = fd == -1 ? errno : 0;
+  if (fd != -1) {
+    ::close(fd);
+    metrics::inc_counter<"net.accept_shed">();
+  }
+  reserve_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+  return err;
+}
+
+// Paused: the listeners stay registered with an empty event mask. Resuming with EPOLL_CTL_MOD makes
+// epoll re-check readiness, so connections that queued up meanwhile still produce an event.
+template <Protocol Proto>
+void Reactor<Proto>::set_listener_paused(bool paused) noexcept
+{
+  if (listener_paused_ == paused || listeners_[TCP_LISTENER].fd == -1) {
+    return;
+  }
+
+  for (const Listener& listener : listeners_) {
+    if (listener.fd == -1) {
+      continue;
+    }
+
+    epoll_event event{};
+    event.events   = paused ? 0 : (EPOLLIN | EPOLLET);
+    event.data.u64 = make_event_tag(listener.fd, 0);
+
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, listener.fd, &event) == -1) {
+      TSKV_LOG_WARN("epoll_ctl MOD failed for listener_fd={}", listener.fd);
+      return;
+    }
+  }
+
+  listener_paused_ = paused;
+
+  if (paused) {
+    TSKV_LOG_INFO("at capacity ({} connections), pausing accepts", pool_.size());
+    metrics::inc_counter<"net.listener_pauses">();
+  }
+}
+
 template <Protocol Proto>
 void Reactor<Proto>::poll_once() noexcept
 {
+  // timeout == -1 => wait until an event (the timerfd bounds this); only peek if channels or
+  // accepts are already pending, or while busy-poll mode is still inside its spin window
+  const bool spinning   = busy_poll_ns_ != 0 && loop_ns_ - last_event_ns_ < busy_poll_ns_;
+  const bool backlog    = std::ranges::any_of(listeners_, &Listener::backlog);
+  const bool busy       = !ready_.empty() || backlog;
+  const int  timeout_ms = (busy || spinning) ? 0 : -1;
+
   int nevents;
   do {
-    // timeout == -1 => wait forever (or until interrupt)
-    nevents = epoll_wait(epoll_fd_, evt_buffer_, EVENT_BUFSIZE, -1);
+    nevents = epoll_wait(epoll_fd_, evt_buffer_, static_cast<int>(event_batch_), timeout_ms);
   } while (nevents == -1 && errno == EINTR);
 
+  loop_ns_   = read_clock_ns();
+  loop_tick_ = loop_ns_ / 1'000'000;
+
+  if (nevents > 0) {
+    last_event_ns_ = loop_ns_;
+  }
+  adapt_event_batch(nevents);
+
+  std::array<bool, 2> listener_serviced{};
+
   for (int ievent = 0; ievent < nevents; ++ievent) {
     const epoll_event&  evt        = evt_buffer_[ievent];
-    const int           event_fd   = evt.data.fd;
+    const std::uint64_t event_tag  = evt.data.u64;
+    const int           event_fd   = event_tag_fd(event_tag);
     const std::uint32_t event_mask = evt.events;
 
-    if (Channel<Proto>* channel = pool_.lookup(event_fd); channel != nullptr) [[likely]] {
-      on_channel_event(channel, event_mask);
+    if (event_tag_generation(event_tag) != 0) [[likely]] {
+      if (Channel<Proto>* channel = pool_.lookup_tagged(event_tag); channel != nullptr) [[likely]] {
+        on_channel_event(channel, event_mask);
+      }
+      else {
+        // fd was closed earlier in this batch (and possibly already reused by a new channel)
+        metrics::inc_counter<"net.stale_events">();
+      }
+    }
+    else if (Listener* listener = find_listener(event_fd); listener != nullptr) {
+      on_listener_event(*listener);
+      listener_serviced[static_cast<std::size_t>(listener - listeners_.data())] = true;
     }
-    else if (event_fd == listener_fd_) {
-      on_listener_event();
+    else if (event_fd == timer_fd_) {
+      on_timer_event();
+    }
+    else if (event_fd == completions_.wakeup_fd()) {
+      on_completion_event();
     }
     else if (event_fd == wakeup_fd_) [[unlikely]] {
       on_wakeup_event();
@@ -359,31 +720,207 @@ void Reactor<Proto>::poll_once() noexcept
       TSKV_LOG_WARN("unknown event file descriptor encountered: {}", event_fd);
     }
   }
+
+  for (std::size_t i = 0; i < listeners_.size(); ++i) {
+    if (listeners_[i].backlog && !listener_serviced[i]) {
+      on_listener_event(listeners_[i]);
+    }
+  }
+
+  const bool did_work = nevents > 0 || !ready_.empty();
+
+  service_ready_list();
+  run_timers();
+
+  // empty spins would swamp the distribution; only iterations that handled something count
+  if (did_work) {
+    metrics::record_histogram<"net.loop_iteration_ns">(read_clock_ns() - loop_ns_);
+  }
 }
 
 template <Protocol Proto>
-void Reactor<Proto>::sweep_closing_channels() noexcept
+void Reactor<Proto>::adapt_event_batch(int nevents) noexcept
+{
+  const auto n = static_cast<std::size_t>(std::max(nevents, 0));
+
+  if (n == event_batch_ && event_batch_ < MAX_EVENT_BATCH) {
+    event_batch_ *= 2; // more events were probably left queued
+    sparse_batches_ = 0;
+  }
+  else if (n <= event_batch_ / 4 && event_batch_ > MIN_EVENT_BATCH) {
+    if (++sparse_batches_ == BATCH_SHRINK_AFTER) {
+      event_batch_ /= 2;
+      sparse_batches_ = 0;
+    }
+  }
+  else {
+    sparse_batches_ = 0;
+  }
+}
+
+// nanoseconds since clock_epoch_
+template <Protocol Proto>
+std::uint64_t Reactor<Proto>::read_clock_ns() const noexcept
+{
+  timespec ts;
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  const auto now = std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+  return static_cast<std::uint64_t>((now - clock_epoch_).count());
+}
+
+template <Protocol Proto>
+void Reactor<Proto>::run_timers() noexcept
+{
+  timers_.advance(loop_tick_, [this](Timer& timer) { on_timer_expired(timer); });
+  arm_timer_fd();
+}
+
+template <Protocol Proto>
+void Reactor<Proto>::on_timer_expired(Timer& timer) noexcept
+{
+  if (static_cast<TimerKind>(timer.kind) == TimerKind::MetricsFlush) {
+    metrics::flush_thread(0ms);
+    timers_.schedule(metrics_timer_, loop_tick_ + METRICS_FLUSH_TICKS);
+    return;
+  }
+
+  if (static_cast<TimerKind>(timer.kind) == TimerKind::AcceptRetry) {
+    for (Listener& listener : listeners_) {
+      if (listener.fd != -1 && !listener_paused_) {
+        on_listener_event(listener);
+      }
+    }
+    return;
+  }
+
+  Channel<Proto>* channel = pool_.lookup_tagged(timer.cookie);
+  if (channel == nullptr) [[unlikely]] {
+    return; // channel timers are cancelled on close, so this should not happen
+  }
+
+  switch (static_cast<TimerKind>(timer.kind)) {
+    case TimerKind::Idle: {
+      // activity only stamps the channel; push the timer out lazily here instead
+      const std::uint64_t idle_until = channel->last_active_tick() + idle_timeout_ticks_;
+      if (idle_until > loop_tick_) {
+        timers_.schedule(timer, idle_until);
+        return;
+      }
+
+      TSKV_LOG_INFO("closing idle client_fd = {}", channel->fd());
+      metrics::inc_counter<"net.idle_timeouts">();
+      channel->abort();
+      close_channel(channel);
+      break;
+    }
+    case TimerKind::Deadline:
+      metrics::inc_counter<"net.deadline_timeouts">();
+      channel->expire_deadline();
+      finish_dispatch(channel);
+      break;
+    case TimerKind::MetricsFlush:
+    case TimerKind::AcceptRetry:
+      break;
+  }
+}
+
+template <Protocol Proto>
+void Reactor<Proto>::arm_timer_fd() noexcept
 {
-  thread_local std::vector<Channel<Proto>*> channels_to_close;
-  channels_to_close.clear();
+  const std::uint64_t due = timers_.next_due().value_or(TIMER_NOT_ARMED);
+
+  // An earlier expiry still pending costs at most one spurious wakeup, which is cheaper than a
+  // timerfd_settime() every time the head of the wheel moves out (e.g. idle timers re-arming).
+  if (timer_armed_tick_ > loop_tick_ && due >= timer_armed_tick_) {
+    return;
+  }
+
+  itimerspec spec{}; // all-zero it_value disarms
+  if (due != TIMER_NOT_ARMED) {
+    spec.it_value = tc::to_timespec(clock_epoch_ + std::chrono::milliseconds(due));
+  }
+
+  if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) == -1) [[unlikely]] {
+    TSKV_LOG_WARN("timerfd_settime failed: errno={}", errno);
+    return;
+  }
+
+  timer_armed_tick_ = due;
+}
+
+template <Protocol Proto>
+void Reactor<Proto>::service_ready_list() noexcept
+{
+  if (ready_.empty()) {
+    return;
+  }
+
+  // one budgeted turn per channel; channels deferring again rejoin at the back of ready_
+  ready_servicing_.swap(ready_);
+
+  for (const std::uint64_t tag : ready_servicing_) {
+    Channel<Proto>* channel = pool_.lookup_tagged(tag);
+    if (channel == nullptr) {
+      continue; // closed since it was queued
+    }
+
+    channel->set_ready_queued(false);
+
+    if (const std::uint32_t deferred = channel->deferred_events(); deferred != 0) {
+      on_channel_event(channel, deferred);
+    }
+  }
+
+  ready_servicing_.clear();
+}
+
+template <Protocol Proto>
+void Reactor<Proto>::on_completion_event() noexcept
+{
+  const std::size_t ncompleted = completions_.drain([this](Completion& completion) {
+    Channel<Proto>* channel = pool_.lookup_tagged(completion.tag);
+    if (channel == nullptr) {
+      metrics::inc_counter<"net.stale_completions">(); // connection closed while it waited
+      return;
+    }
+
+    channel->deliver_completion(std::move(completion.payload));
 
-  pool_.for_each([&](auto* channel) {
     if (channel->should_close()) {
-      channels_to_close.push_back(channel);
+      close_channel(channel);
+    }
+    else if (channel->deferred_events() != 0 && !channel->is_ready_queued()) {
+      channel->set_ready_queued(true);
+      ready_.push_back(completion.tag);
     }
   });
 
-  for (auto* ch : channels_to_close) {
-    close_channel(ch);
+  if (ncompleted > 0) {
+    metrics::inc_counter<"net.completion_batches">();
+    metrics::add_counter<"net.completions">(ncompleted);
   }
 }
 
+template <Protocol Proto>
+void Reactor<Proto>::sweep_closing_channels() noexcept
+{
+  // only channels on their way out can be ready to close; running ones are never visited
+  pool_.for_each_in(ChannelState::Aborting, [&](auto* channel) { close_channel(channel); });
+
+  pool_.for_each_in(ChannelState::Draining, [&](auto* channel) {
+    if (channel->should_close()) {
+      close_channel(channel);
+    }
+  });
+}
+
 template <Protocol Proto>
 void Reactor<Proto>::run()
 {
   while (true) {
     if (shutting_down_ && pool_.empty()) {
       TSKV_LOG_INFO("Shutdown succeeded...");
+      metrics::flush_thread(0ms);
       return;
     }
     poll_once();
@@ -0,0 +1,106 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.net.reactor_group
+// Summary: run N independent reactors, one per I/O thread
+//
+//  - each reactor owns its own epoll fd, ChannelPool, and SO_REUSEPORT listener
+//    * the kernel spreads incoming connections across the listeners
+//    * reactors share nothing, so the hot path needs no synchronization
+//    * the AF_UNIX listener (--unix-socket) cannot be shared that way; only reactor 0 opens it
+//  - reactors are constructed on the thread that runs them (first-touch locality)
+//  - SIGINT/SIGTERM are blocked in every thread and consumed by the owning thread,
+//    which then fans out notify_shutdown() to each reactor and joins them
+//------------------------------------------------------------------------------
+
+#include <concepts>
+#include <cstdint>
+#include <latch>
+#include <memory>
+#include <pthread.h>
+#include <signal.h>
+#include <thread>
+#include <vector>
+
+#include "tskv/common/logging.hpp"
+
+export module tskv.net.reactor_group;
+
+import tskv.common.logging;
+import tskv.net.server;
+
+export namespace tskv::net {
+
+template <class R>
+concept ShardableReactor =
+  std::constructible_from<R, const ServerConfig&, bool> && requires(R& r) {
+    { r.run() } -> std::same_as<void>;
+    { r.notify_shutdown() } noexcept -> std::same_as<void>;
+  };
+
+template <ShardableReactor R>
+class ReactorGroup {
+  ServerConfig                    config_;
+  std::vector<std::unique_ptr<R>> reactors_;
+
+public:
+  explicit ReactorGroup(const ServerConfig& config) : config_(config) {}
+
+  ReactorGroup(const ReactorGroup&)            = delete;
+  ReactorGroup& operator=(const ReactorGroup&) = delete;
+
+  // Blocks until SIGINT/SIGTERM is received and every reactor has finished shutting down.
+  void run();
+};
+
+template <ShardableReactor R>
+void ReactorGroup<R>::run()
+{
+  const std::uint32_t nthreads = config_.io_threads;
+  TSKV_DEMAND(nthreads > 0, "ReactorGroup requires at least one io thread");
+
+  // Block before spawning so every io thread inherits the mask
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+  reactors_.resize(nthreads);
+
+  std::latch                ready(nthreads);
+  std::vector<std::jthread> threads;
+  threads.reserve(nthreads);
+
+  for (std::uint32_t i = 0; i < nthreads; ++i) {
+    ServerConfig config = config_;
+    if (i != 0) {
+      config.unix_socket.clear();
+    }
+
+    threads.emplace_back([this, i, config, &ready] {
+      reactors_[i] = std::make_unique<R>(config, /*handle_signals=*/false);
+      ready.count_down();
+      reactors_[i]->run();
+    });
+  }
+
+  ready.wait();
+  TSKV_LOG_INFO("{} io threads running", nthreads);
+
+  int signo = 0;
+  while (sigwait(&mask, &signo) != 0) {
+    continue;
+  }
+
+  TSKV_LOG_INFO("received signal {}, stopping io threads...", signo);
+
+  for (auto& reactor : reactors_) {
+    reactor->notify_shutdown();
+  }
+
+  threads.clear(); // join
+  reactors_.clear();
+}
+
+} // namespace tskv::net
@@ -0,0 +1,693 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.net.resp
+// Summary: Redis-compatible (RESP2/RESP3) front end onto the storage engine
+//
+//  - requests are RESP arrays of bulk strings, as every Redis client sends them; inline commands
+//    (space separated, one per line) are accepted too, for telnet/nc
+//  - parse_resp_command() frames one command in place: argv views point into RX, nothing is copied
+//    * *<n> and $<n> length lines are read with tc::parse_int_line (SWAR digit scan and value)
+//    * an inline command line is found with tc::find_crlf (the runtime-dispatched SSE2/AVX2
+//      kernel); only the bytes before the CRLF are checked for a bare LF, which nc sends
+//  - RespProtocol::on_read runs every complete command in RX in one pass
+//    * replies are appended to a thread-local scratch string and handed to TX with one tx_send
+//      at the end of the pass, so a pipeline of N commands costs one copy and one flush
+//    * argv and the reply scratch are thread-local and keep their capacity, so steady-state
+//      pipelines do no per-command heap allocation in the protocol layer
+//    * the pass stops once the replies fill the room left in TX (or TX is backpressured); the
+//      rest of the pipeline stays in RX and the channel hands it back once TX drains
+//  - a command must fit in RX whole; malformed or oversized requests get an error reply and the
+//    connection is closed, as Redis does
+//  - HELLO 2|3 switches the connection's reply encoding; RESP3 only changes how nulls and the
+//    HELLO map itself are encoded, since no other command here returns a RESP3-only type
+//  - SCAN cursors are key based: "0" starts (and ends) an iteration, any other cursor is '@'
+//    followed by the key to resume at; clients must pass cursors back verbatim
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tskv/common/logging.hpp"
+
+export module tskv.net.resp;
+
+import tskv.common.buffer;
+import tskv.common.bytes;
+import tskv.common.logging;
+import tskv.common.metrics;
+import tskv.common.scan;
+import tskv.net.channel;
+import tskv.net.tx_queue;
+import tskv.storage.engine;
+import tskv.storage.memtable;
+
+namespace tc      = tskv::common;
+namespace metrics = tskv::common::metrics;
+namespace ts      = tskv::storage;
+
+export namespace tskv::net {
+
+inline constexpr std::size_t RESP_MAX_ARGS = 1024 * 1024;
+
+enum class RespStatus : std::uint8_t {
+  Complete, // argv holds the command (possibly empty: a blank inline line or "*0")
+  Incomplete, // need more bytes
+  Malformed, // error names the problem
+  TooLarge, // an argument exceeds max_arg_size
+};
+
+struct RespParse {
+  RespStatus       status = RespStatus::Incomplete;
+  std::size_t      size   = 0; // bytes taken by the command if Complete
+  std::string_view error;
+};
+
+namespace detail {
+
+enum class IntParse : std::uint8_t { Ok, Incomplete, Bad };
+
+// Reads "<digits>\r\n" at bytes[pos], advancing pos past the CRLF.
+[[nodiscard]] inline IntParse read_line_int(
+  std::string_view bytes, std::size_t& pos, std::int64_t& value) noexcept
+{
+  const tc::IntLine line = tc::parse_int_line(std::as_bytes(std::span(bytes).subspan(pos)));
+  switch (line.status) {
+    case tc::IntLineStatus::Incomplete:
+      return IntParse::Incomplete;
+    case tc::IntLineStatus::Bad:
+      return IntParse::Bad;
+    case tc::IntLineStatus::Ok:
+      break;
+  }
+  value = line.value;
+  pos += line.size;
+  return IntParse::Ok;
+}
+
+[[nodiscard]] inline RespParse parse_inline(
+  std::string_view bytes, std::vector<std::string_view>& argv, std::size_t max_size)
+{
+  // the line ends at its first LF: at the first CRLF, unless a bare LF comes before it
+  const std::size_t crlf = tc::find_crlf(std::as_bytes(std::span(bytes)));
+  const std::size_t nl   = std::min(bytes.substr(0, crlf).find('\n'), crlf + 1);
+  if (nl >= bytes.size()) {
+    if (bytes.size() > max_size) {
+      return {RespStatus::TooLarge, 0, "too big inline request"};
+    }
+    return {};
+  }
+
+  std::string_view line = bytes.substr(0, nl);
+  if (line.ends_with('\r')) {
+    line.remove_suffix(1);
+  }
+
+  std::size_t pos = 0;
+  while (pos < line.size()) {
+    const std::size_t begin = line.find_first_not_of(' ', pos);
+    if (begin == std::string_view::npos) {
+      break;
+    }
+    const std::size_t end = std::min(line.find(' ', begin), line.size());
+    argv.push_back(line.substr(begin, end - begin));
+    pos = end;
+  }
+
+  return {RespStatus::Complete, nl + 1, {}};
+}
+
+} // namespace detail
+
+// Frames the command at the front of `bytes` into argv (views into `bytes`). `bytes` may hold any
+// number of further commands.
+[[nodiscard]] RespParse parse_resp_command(std::string_view bytes,
+  std::vector<std::string_view>&                          argv,
+  std::size_t                                             max_arg_size)
+{
+  argv.clear();
+
+  if (bytes.empty()) {
+    return {};
+  }
+  if (bytes[0] != '*') {
+    return detail::parse_inline(bytes, argv, max_arg_size);
+  }
+
+  std::size_t  pos   = 1;
+  std::int64_t count = 0;
+  switch (detail::read_line_int(bytes, pos, count)) {
+    case detail::IntParse::Incomplete:
+      return {};
+    case detail::IntParse::Bad:
+      return {RespStatus::Malformed, 0, "invalid multibulk length"};
+    case detail::IntParse::Ok:
+      break;
+  }
+  if (count > static_cast<std::int64_t>(RESP_MAX_ARGS)) {
+    return {RespStatus::Malformed, 0, "invalid multibulk length"};
+  }
+  if (count <= 0) {
+    return {RespStatus::Complete, pos, {}}; // "*0" and "*-1" are no-ops
+  }
+
+  for (std::int64_t i = 0; i < count; ++i) {
+    if (pos == bytes.size()) {
+      return {};
+    }
+    if (bytes[pos] != '$') {
+      return {RespStatus::Malformed, 0, "expected '$'"};
+    }
+    ++pos;
+
+    std::int64_t len = 0;
+    switch (detail::read_line_int(bytes, pos, len)) {
+      case detail::IntParse::Incomplete:
+        return {};
+      case detail::IntParse::Bad:
+        return {RespStatus::Malformed, 0, "invalid bulk length"};
+      case detail::IntParse::Ok:
+        break;
+    }
+    if (len < 0) {
+      return {RespStatus::Malformed, 0, "invalid bulk length"};
+    }
+    if (static_cast<std::uint64_t>(len) > max_arg_size) {
+      return {RespStatus::TooLarge, 0, "bulk argument too large"};
+    }
+
+    const std::size_t n = static_cast<std::size_t>(len);
+    if (bytes.size() - pos < n + 2) {
+      return {};
+    }
+    if (bytes[pos + n] != '\r' || bytes[pos + n + 1] != '\n') {
+      return {RespStatus::Malformed, 0, "expected CRLF after bulk argument"};
+    }
+    argv.push_back(bytes.substr(pos, n));
+    pos += n + 2;
+  }
+
+  return {RespStatus::Complete, pos, {}};
+}
+
+// Redis-style glob: '*', '?', '[...]' (with ranges and '^' negation) and '\' escapes.
+[[nodiscard]] bool glob_match(std::string_view pattern, std::string_view str) noexcept
+{
+  std::size_t p = 0;
+  std::size_t s = 0;
+
+  std::size_t star_p = std::string_view::npos; // pattern position after the last '*'
+  std::size_t star_s = 0;                      // where that '*' currently stops matching
+
+  while (s < str.size()) {
+    if (p < pattern.size()) {
+      const char c = pattern[p];
+
+      if (c == '*') {
+        star_p = ++p;
+        star_s = s;
+        continue;
+      }
+
+      bool        matched = false;
+      std::size_t next    = p + 1;
+      if (c == '?') {
+        matched = true;
+      }
+      else if (c == '[') {
+        std::size_t i      = p + 1;
+        const bool  negate = i < pattern.size() && pattern[i] == '^';
+        i += negate ? 1 : 0;
+        bool in_set = false;
+        for (; i < pattern.size() && pattern[i] != ']'; ++i) {
+          if (pattern[i] == '\\' && i + 1 < pattern.size()) {
+            in_set |= pattern[++i] == str[s];
+          }
+          else if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+            const auto [lo, hi] = std::minmax(pattern[i], pattern[i + 2]);
+            in_set |= lo <= str[s] && str[s] <= hi;
+            i += 2;
+          }
+          else {
+            in_set |= pattern[i] == str[s];
+          }
+        }
+        matched = in_set != negate;
+        next    = std::min(i + 1, pattern.size());
+      }
+      else if (c == '\\' && p + 1 < pattern.size()) {
+        matched = pattern[p + 1] == str[s];
+        next    = p + 2;
+      }
+      else {
+        matched = c == str[s];
+      }
+
+      if (matched) {
+        p = next;
+        ++s;
+        continue;
+      }
+    }
+
+    if (star_p == std::string_view::npos) {
+      return false;
+    }
+    p = star_p; // let the last '*' swallow one more character
+    s = ++star_s;
+  }
+
+  while (p < pattern.size() && pattern[p] == '*') {
+    ++p;
+  }
+  return p == pattern.size();
+}
+
+// The literal part of a glob pattern before its first special character.
+[[nodiscard]] std::string_view glob_prefix(std::string_view pattern) noexcept
+{
+  return pattern.substr(0, std::min(pattern.find_first_of("*?[\\"), pattern.size()));
+}
+
+class RespProtocol;
+
+template <>
+struct channel_traits<RespProtocol> {
+  using rx_buffer = tc::PooledBuffer<65536>;
+  using tx_buffer = tc::PooledBuffer<65536>; // room for the replies to a deep pipeline
+};
+
+class RespProtocol {
+public:
+  using IO = ChannelIO<RespProtocol>;
+
+  static constexpr std::size_t RX_CAPACITY = channel_traits<RespProtocol>::rx_buffer::capacity();
+
+  // The engine every RespProtocol instance serves. Must outlive all connections using it.
+  static void bind_engine(ts::Engine* engine) noexcept { engine_ = engine; }
+
+  void on_read(IO& io)
+  {
+    const std::string_view rx = tc::as_chars(io.rx_span());
+
+    std::vector<std::string_view>& argv = scratch_argv();
+    std::string&                   out  = scratch_out();
+    out.clear();
+
+    const std::size_t room      = io.tx_room();
+    std::size_t       consumed  = 0;
+    std::size_t       ncommands = 0;
+    bool              closing   = false;
+
+    while (!closing && out.size() < room && !io.backpressured()) {
+      const RespParse parsed = parse_resp_command(rx.substr(consumed), argv, RX_CAPACITY);
+
+      if (parsed.status == RespStatus::Incomplete) {
+        if (consumed == 0 && rx.size() == RX_CAPACITY) [[unlikely]] {
+          reject(out, "request larger than the receive buffer");
+          consumed = rx.size();
+          closing  = true;
+        }
+        break;
+      }
+
+      if (parsed.status != RespStatus::Complete) [[unlikely]] {
+        reject(out, parsed.error);
+        consumed = rx.size(); // nothing after a broken request can be trusted
+        closing  = true;
+        break;
+      }
+
+      consumed += parsed.size;
+      if (!argv.empty()) {
+        ++ncommands;
+        closing = !execute(argv, out);
+      }
+    }
+
+    flush(io, out);
+    io.rx_consume(consumed);
+
+    if (closing) {
+      io.shutdown();
+    }
+    if (ncommands > 0) {
+      metrics::add_counter<"resp.commands">(ncommands);
+    }
+  }
+
+  void on_error(IO&, int) {}
+  void on_close(IO&) {}
+
+private:
+  inline static ts::Engine* engine_ = nullptr;
+
+  bool resp3_ = false;
+
+  static std::vector<std::string_view>& scratch_argv()
+  {
+    thread_local std::vector<std::string_view> argv;
+    return argv;
+  }
+
+  static std::vector<ts::KeyValue>& scratch_batch()
+  {
+    thread_local std::vector<ts::KeyValue> batch;
+    return batch;
+  }
+
+  static std::string& scratch_out()
+  {
+    thread_local std::string out;
+    return out;
+  }
+
+  static void flush(IO& io, const std::string& out)
+  {
+    if (out.empty()) {
+      return;
+    }
+    const std::span<const std::byte> bytes = std::as_bytes(std::span(out));
+
+    const std::size_t sent = io.tx_send(bytes).first;
+    if (sent < bytes.size()) {
+      // a single large reply overshot the room left in TX; queue the tail behind it
+      (void)io.tx_enqueue(TxSegment::copy_of(bytes.subspan(sent)));
+    }
+  }
+
+  static void reject(std::string& out, std::string_view why)
+  {
+    TSKV_LOG_WARN("RESP protocol error ({}), closing connection", why);
+    metrics::inc_counter<"resp.protocol_errors">();
+    append_error(out, "ERR Protocol error: ", why);
+  }
+
+  // -- reply encoding ---------------------------------------------------------
+
+  static void append_crlf(std::string& out) { out.append("\r\n", 2); }
+
+  static void append_prefixed_int(std::string& out, char prefix, std::int64_t value)
+  {
+    char buf[24];
+    buf[0] = prefix;
+
+    char* end = std::to_chars(buf + 1, buf + sizeof buf, value).ptr;
+    out.append(buf, end);
+    append_crlf(out);
+  }
+
+  static void append_simple(std::string& out, std::string_view s)
+  {
+    out.push_back('+');
+    out.append(s);
+    append_crlf(out);
+  }
+
+  static void append_error(std::string& out, std::string_view s, std::string_view detail = {})
+  {
+    metrics::inc_counter<"resp.errors">();
+    out.push_back('-');
+    out.append(s);
+    out.append(detail);
+    append_crlf(out);
+  }
+
+  static void append_int(std::string& out, std::int64_t value)
+  {
+    append_prefixed_int(out, ':', value);
+  }
+
+  static void append_bulk(std::string& out, std::string_view s)
+  {
+    append_prefixed_int(out, '$', static_cast<std::int64_t>(s.size()));
+    out.append(s);
+    append_crlf(out);
+  }
+
+  static void append_array(std::string& out, std::size_t n)
+  {
+    append_prefixed_int(out, '*', static_cast<std::int64_t>(n));
+  }
+
+  void append_null(std::string& out) const
+  {
+    if (resp3_) {
+      out.append("_\r\n", 3);
+    }
+    else {
+      out.append("$-1\r\n", 5);
+    }
+  }
+
+  void append_map(std::string& out, std::size_t n) const
+  {
+    if (resp3_) {
+      append_prefixed_int(out, '%', static_cast<std::int64_t>(n));
+    }
+    else {
+      append_array(out, 2 * n);
+    }
+  }
+
+  // -- commands ---------------------------------------------------------------
+
+  [[nodiscard]] static bool is(std::string_view name, std::string_view lower) noexcept
+  {
+    return name.size() == lower.size() && std::ranges::equal(name, lower, [](char a, char b) {
+      return (a >= 'A' && a <= 'Z' ? static_cast<char>(a - 'A' + 'a') : a) == b;
+    });
+  }
+
+  // (command names are not echoed back: they are client bytes and could contain CRLF)
+  static void wrong_arity(std::string& out)
+  {
+    append_error(out, "ERR wrong number of arguments for command");
+  }
+
+  // Returns false if the connection should be closed once the reply is out.
+  bool execute(std::span<const std::string_view> argv, std::string& out)
+  {
+    const std::string_view name = argv[0];
+    const std::size_t      argc = argv.size();
+
+    if (is(name, "get")) {
+      if (argc != 2) {
+        wrong_arity(out);
+      }
+      else if (!engine_->get(argv[1], [&](std::string_view value) { append_bulk(out, value); })) {
+        append_null(out);
+      }
+    }
+    else if (is(name, "set")) {
+      if (argc != 3) {
+        wrong_arity(out);
+      }
+      else if (engine_->put(argv[1], argv[2])) {
+        append_simple(out, "OK");
+      }
+      else {
+        append_error(out, "ERR write failed");
+      }
+    }
+    else if (is(name, "mget")) {
+      if (argc < 2) {
+        wrong_arity(out);
+      }
+      else {
+        append_array(out, argc - 1);
+        engine_->get_many(argv.subspan(1), [&](std::optional<std::string_view> value) {
+          if (value) {
+            append_bulk(out, *value);
+          }
+          else {
+            append_null(out);
+          }
+        });
+      }
+    }
+    else if (is(name, "mset")) {
+      if (argc < 3 || argc % 2 == 0) {
+        wrong_arity(out);
+      }
+      else {
+        std::vector<ts::KeyValue>& batch = scratch_batch();
+        batch.clear();
+        for (std::size_t i = 1; i < argc; i += 2) {
+          batch.push_back({argv[i], argv[i + 1]});
+        }
+        if (engine_->put_batch(batch)) {
+          append_simple(out, "OK");
+        }
+        else {
+          append_error(out, "ERR write failed");
+        }
+      }
+    }
+    else if (is(name, "del")) {
+      if (argc < 2) {
+        wrong_arity(out);
+      }
+      else {
+        std::int64_t n = 0;
+        for (const std::string_view key : argv.subspan(1)) {
+          n += engine_->erase(key) ? 1 : 0;
+        }
+        append_int(out, n);
+      }
+    }
+    else if (is(name, "exists")) {
+      if (argc < 2) {
+        wrong_arity(out);
+      }
+      else {
+        std::int64_t n = 0;
+        for (const std::string_view key : argv.subspan(1)) {
+          n += engine_->get(key, [](std::string_view) {}) ? 1 : 0;
+        }
+        append_int(out, n);
+      }
+    }
+    else if (is(name, "scan")) {
+      scan(argv, out);
+    }
+    else if (is(name, "dbsize")) {
+      append_int(out, static_cast<std::int64_t>(engine_->size()));
+    }
+    else if (is(name, "ping")) {
+      if (argc == 1) {
+        append_simple(out, "PONG");
+      }
+      else if (argc == 2) {
+        append_bulk(out, argv[1]);
+      }
+      else {
+        wrong_arity(out);
+      }
+    }
+    else if (is(name, "echo")) {
+      if (argc != 2) {
+        wrong_arity(out);
+      }
+      else {
+        append_bulk(out, argv[1]);
+      }
+    }
+    else if (is(name, "hello")) {
+      hello(argv, out);
+    }
+    else if (is(name, "command")) {
+      append_array(out, 0); // no command table; clients fall back to their built-in one
+    }
+    else if (is(name, "quit")) {
+      append_simple(out, "OK");
+      return false;
+    }
+    else {
+      append_error(out, "ERR unknown command");
+    }
+    return true;
+  }
+
+  void hello(std::span<const std::string_view> argv, std::string& out)
+  {
+    if (argv.size() >= 2) {
+      if (argv[1] == "2" || argv[1] == "3") {
+        resp3_ = argv[1] == "3";
+      }
+      else {
+        append_error(out, "NOPROTO unsupported protocol version");
+        return;
+      }
+    }
+
+    append_map(out, 3);
+    append_bulk(out, "server");
+    append_bulk(out, "tskv");
+    append_bulk(out, "proto");
+    append_int(out, resp3_ ? 3 : 2);
+    append_bulk(out, "mode");
+    append_bulk(out, "standalone");
+  }
+
+  // SCAN cursor [MATCH pattern] [COUNT n]; COUNT bounds the keys examined, not returned.
+  void scan(std::span<const std::string_view> argv, std::string& out)
+  {
+    if (argv.size() < 2 || argv.size() % 2 != 0) {
+      wrong_arity(out);
+      return;
+    }
+
+    std::string_view start;
+    if (argv[1] != "0") {
+      if (!argv[1].starts_with('@')) {
+        append_error(out, "ERR invalid cursor");
+        return;
+      }
+      start = argv[1].substr(1);
+    }
+
+    std::string_view pattern = "*";
+    std::size_t      count   = 10;
+    for (std::size_t i = 2; i < argv.size(); i += 2) {
+      if (is(argv[i], "match")) {
+        pattern = argv[i + 1];
+      }
+      else if (is(argv[i], "count")) {
+        const std::string_view v = argv[i + 1];
+
+        const auto [ptr, ec] = std::from_chars(v.data(), v.data() + v.size(), count);
+        if (ec != std::errc{} || ptr != v.data() + v.size() || count == 0) {
+          append_error(out, "ERR value is not an integer or out of range");
+          return;
+        }
+      }
+      else {
+        append_error(out, "ERR syntax error");
+        return;
+      }
+    }
+
+    // everything matching the pattern sorts at or after its literal prefix
+    const std::string_view prefix = glob_prefix(pattern);
+    start                         = std::max(start, prefix);
+
+    thread_local std::string keys;
+    keys.clear();
+    std::size_t nkeys = 0;
+
+    const std::optional<std::string> next =
+      engine_->scan(start, count, [&](std::string_view key, std::string_view) {
+        if (!key.starts_with(prefix)) {
+          return false; // past every key the pattern could match
+        }
+        if (glob_match(pattern, key)) {
+          append_bulk(keys, key);
+          ++nkeys;
+        }
+        return true;
+      });
+
+    append_array(out, 2);
+    if (next) {
+      append_prefixed_int(out, '$', static_cast<std::int64_t>(next->size() + 1));
+      out.push_back('@');
+      out.append(*next);
+      append_crlf(out);
+    }
+    else {
+      append_bulk(out, "0");
+    }
+    append_array(out, nkeys);
+    out.append(keys);
+  }
+};
+
+} // namespace tskv::net
@@ -0,0 +1,840 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.net.rpc
+// Summary: server side of the framed tskv wire protocol (see tskv.net.frame)
+//
+//  - RpcProtocol parses frames in place out of ChannelIO::rx_span()
+//    * every complete frame in RX is dispatched per on_read call; a partial frame stays in RX
+//      until the rest arrives
+//    * RX is consumed once per call, after the last dispatched frame, not once per frame
+//  - a frame too large for RX is streamed: its header is consumed, and the payload is received
+//    (ChannelIO::rx_stream) into a buffer sized for it, then dispatched from on_body
+//    * the buffer is allocated per frame and freed once it has been answered, so idle
+//      connections keep nothing; MAX_PAYLOAD bounds what one connection can pin
+//    * it starts at BODY_CHUNK bytes and doubles each time it fills, so what a connection pins
+//      is at most twice what it has actually sent, not what its header claims
+//  - a response is never split: a request whose response does not fit into TX yet is left in RX
+//    (with everything after it) and retried once TX drains
+//  - MGet / MPut reach the storage engine as one batch each (Engine::get_many / put_batch: one
+//    lock, one WAL record, one memtable pass), and the result frame is built in one contiguous
+//    scratch buffer that is copied into TX, or handed over whole as a TxSegment if it is larger
+//    * the payload is decoded in place; keys and values are views into RX (or the body buffer)
+//    * MPut waits for TX room for its result before it is applied, so a retried request is
+//      never applied twice; an MGet result has no known size up front, so only its smallest
+//      possible size is waited for
+//    * latency per batch, decode to queued result, goes to rpc.mget_batch_ns / rpc.mput_batch_ns
+//  - Scan streams a key range back as ScanBatch frames, one scan at a time per connection
+//    * batches are cut from the engine with a key cursor (Engine::scan_range), at most
+//      SCAN_BATCH_BYTES each, and only while the client has credits (one per batch, granted in
+//      the Scan and topped up with ScanCredit) and TX is not backpressured; the channel calls
+//      on_writable as TX drains to produce the next one. So the server holds one batch and a
+//      resume key per scan however long the range is, and the kernel socket buffer, not the
+//      process, queues what is in flight
+//    * a batch larger than TX is queued as one segment (no copy); TX backpressures only at
+//      TX_HIGH_WATERMARK (several batches), and on_writable queues batches until it gets there,
+//      so consecutive batches leave in one sendmsg() when the TX budget allows
+//    * frames after a Scan are answered as usual, interleaved with its batches: behind queued
+//      batches TX room counts against TX_HIGH_WATERMARK, so a small result waits only for TX to
+//      fall below the watermark, not for the scan to end
+//  - PutPoints / ScanPoints carry one series' points as a columnar block (tskv.storage.point_codec)
+//    * a PutPoints block is expanded into point keys and samples in scratch space before the
+//      engine lock is taken, then logged to the WAL exactly as received (Engine::put_points)
+//    * ScanPoints is a Scan over one series' time range whose batches are re-encoded as blocks of
+//      at most SCAN_BATCH_POINTS points; credits and cancellation work as for Scan
+//  - Aggregate folds one series' points into time buckets inside the engine (Engine::aggregate)
+//    and streams back only the buckets, as AggregateBatch frames of AGGREGATE_BATCH_BUCKETS each
+//    * produced from on_writable like scan batches, but paced by TX alone: a bucket result is
+//      tiny next to the points behind it, so there are no credits
+//    * one engine call visits at most AGGREGATE_BATCH_ENTRIES points; a bucket with more is
+//      folded over several calls, with on_writable yielding to the reactor between the ones that
+//      complete no bucket, so a huge bucket does not stall the io thread
+//    * it shares the scan's slot: one Scan or Aggregate streams per connection at a time
+//  - a frame that cannot be parsed gets an Error frame and the connection is closed, since the
+//    stream has lost its frame boundaries; an unknown frame type only gets an Error frame
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "tskv/common/logging.hpp"
+
+export module tskv.net.rpc;
+
+import tskv.common.buffer;
+import tskv.common.enum_traits;
+import tskv.common.logging;
+import tskv.common.metrics;
+import tskv.net.channel;
+import tskv.net.frame;
+import tskv.net.tx_queue;
+import tskv.storage.engine;
+import tskv.storage.memtable;
+import tskv.storage.point_codec;
+import tskv.storage.series;
+
+namespace tc      = tskv::common;
+namespace metrics = tskv::common::metrics;
+namespace ts      = tskv::storage;
+
+export namespace tskv::net {
+
+class RpcProtocol;
+
+template <>
+struct channel_traits<RpcProtocol> {
+  using rx_buffer = tc::PooledBuffer<65536>;
+  using tx_buffer = tc::PooledBuffer<4096>;
+  // scan and aggregate batches are queued as segments, not copied into tx_buffer; room for four
+  static constexpr std::size_t tx_high_watermark = std::size_t{256} << 10;
+};
+
+class RpcProtocol {
+public:
+  using IO = ChannelIO<RpcProtocol>;
+
+  // Frames that fit in RX whole, header included, are handled in place; larger ones up to
+  // MAX_PAYLOAD are streamed.
+  static constexpr std::size_t MAX_INLINE_PAYLOAD =
+    channel_traits<RpcProtocol>::rx_buffer::capacity() - FRAME_HEADER_SIZE;
+  static constexpr std::size_t MAX_PAYLOAD = std::size_t{64} << 20;
+
+  // A streamed payload is received into a buffer of this size first, then one twice as large.
+  static constexpr std::size_t BODY_CHUNK = std::size_t{64} << 10;
+
+  // A ScanBatch is cut once it holds this many bytes (a single larger entry goes out alone).
+  static constexpr std::size_t SCAN_BATCH_BYTES = std::size_t{64} << 10;
+
+  // A PointsBatch is cut once it holds this many points.
+  static constexpr std::size_t SCAN_BATCH_POINTS = 4096;
+
+  // An AggregateBatch carries at most this many buckets (48 KiB with every function requested).
+  static constexpr std::size_t AGGREGATE_BATCH_BUCKETS = 1024;
+
+  // One Engine::aggregate call, and so one on_writable turn, visits at most this many entries.
+  static constexpr std::size_t AGGREGATE_BATCH_ENTRIES = std::size_t{64} << 10;
+
+  // Scratch space for an expanded point block is kept between frames up to this size; a larger
+  // block's is freed once it has been applied.
+  static constexpr std::size_t SCRATCH_KEEP_BYTES = std::size_t{1} << 20;
+
+  // The engine MGet/MPut go to; without one they are answered as unknown frame types. Must
+  // outlive all connections using it.
+  static void bind_engine(ts::Engine* engine) noexcept { engine_ = engine; }
+
+  void on_read(IO& io)
+  {
+    if (body_ != nullptr) {
+      return; // a filled body chunk is still to be delivered (on_body), and RX comes after it
+    }
+
+    const std::span<const std::byte> rx = io.rx_span();
+
+    std::size_t consumed = 0;
+    std::size_t nframes  = 0;
+    bool        stream   = false;
+
+    while (!io.backpressured()) {
+      const FrameParse parsed = parse_frame(rx.subspan(consumed), MAX_PAYLOAD);
+
+      if (parsed.status == FrameStatus::Incomplete) {
+        // with the header in hand, a payload that can never fit in RX is received into its own
+        // buffer instead
+        if (rx.size() - consumed >= FRAME_HEADER_SIZE &&
+            parsed.frame.header.length > MAX_INLINE_PAYLOAD) {
+          body_header_ = parsed.frame.header;
+          consumed += FRAME_HEADER_SIZE;
+          stream = true;
+        }
+        break;
+      }
+
+      if (parsed.status != FrameStatus::Complete) [[unlikely]] {
+        reject(io, parsed);
+        consumed = rx.size(); // nothing after a broken header can be trusted
+        break;
+      }
+
+      if (!dispatch(io, parsed.frame)) {
+        break; // no room for the response yet
+      }
+
+      consumed += parsed.size;
+      ++nframes;
+    }
+
+    io.rx_consume(consumed);
+
+    if (stream) {
+      body_capacity_ = std::min<std::size_t>(body_header_.length, BODY_CHUNK);
+      body_          = std::make_unique_for_overwrite<std::byte[]>(body_capacity_);
+      io.rx_stream({body_.get(), body_capacity_});
+    }
+
+    if (nframes > 0) {
+      metrics::add_counter<"rpc.frames">(nframes);
+    }
+  }
+
+  // The body buffer has filled: grow it for the rest of the payload, or, once the whole payload
+  // has arrived, dispatch it. Its response cannot wait in RX for TX space like an in-place one,
+  // so it is queued regardless.
+  void on_body(IO& io)
+  {
+    if (body_capacity_ < body_header_.length) {
+      const std::size_t received = body_capacity_;
+      body_capacity_ = std::min<std::size_t>(body_header_.length, 2 * body_capacity_);
+      auto grown     = std::make_unique_for_overwrite<std::byte[]>(body_capacity_);
+      std::memcpy(grown.get(), body_.get(), received);
+      body_ = std::move(grown);
+      io.rx_stream({body_.get() + received, body_capacity_ - received});
+      return;
+    }
+
+    const FrameView frame{body_header_, {body_.get(), body_header_.length}};
+    (void)dispatch(io, frame, false);
+    body_.reset();
+    body_capacity_ = 0;
+
+    metrics::inc_counter<"rpc.frames">();
+    metrics::inc_counter<"rpc.streamed_frames">();
+  }
+
+  // TX has room again while a stream is running (and a scan has credits left): queue its next
+  // batches, until TX reaches its high watermark. An aggregation still folding a large bucket
+  // queues nothing and yields instead; the channel calls back on the reactor's next turn.
+  void on_writable(IO& io)
+  {
+    while (!io.backpressured()) {
+      if (scan_ != nullptr && scan_->credits > 0) {
+        send_scan_batch(io);
+      }
+      else if (aggregate_ != nullptr) {
+        if (!send_aggregate_batch(io)) {
+          break;
+        }
+      }
+      else {
+        break;
+      }
+    }
+    if ((scan_ != nullptr && scan_->credits > 0) || aggregate_ != nullptr) {
+      io.request_writable();
+    }
+  }
+
+  void on_error(IO&, int) {}
+
+  void on_close(IO&)
+  {
+    body_.reset();
+    scan_.reset();
+    aggregate_.reset();
+  }
+
+private:
+  static constexpr std::size_t TX_CAPACITY = channel_traits<RpcProtocol>::tx_buffer::capacity();
+
+  inline static ts::Engine* engine_ = nullptr;
+
+  // The running scan: where to resume and how many more batches the client will take.
+  struct ScanState {
+    std::uint32_t id = 0;
+    std::string   next; // resume key
+    std::string   end; // exclusive bound, empty for none
+    std::uint32_t credits = 0;
+    std::string   series; // set for a ScanPoints, whose batches are point blocks
+  };
+
+  // The running aggregation: the query, and where to resume, possibly inside a bucket.
+  struct AggregateState {
+    std::uint32_t       id = 0;
+    std::string         series;
+    std::int64_t        next  = 0;
+    std::int64_t        to    = 0; // exclusive
+    std::int64_t        width = 0;
+    std::uint32_t       fns   = 0;
+    ts::BucketAggregate open; // the bucket `next` falls in, as far as it is folded
+  };
+
+  // Streams only exist while they run, so idle connections keep nothing.
+  FrameHeader                     body_header_; // of the frame being streamed
+  std::unique_ptr<std::byte[]>    body_; // its payload so far; body_capacity_ bytes, filling up
+  std::size_t                     body_capacity_ = 0;
+  std::unique_ptr<ScanState>      scan_;
+  std::unique_ptr<AggregateState> aggregate_;
+
+  [[nodiscard]] bool streaming() const noexcept
+  {
+    return scan_ != nullptr || aggregate_ != nullptr;
+  }
+
+  // Returns false, sending nothing, if the response must wait for TX to drain (and may_wait).
+  bool dispatch(IO& io, const FrameView& frame, bool may_wait = true)
+  {
+    switch (frame.header.type) {
+      case FrameType::Ping:
+        return send_frame(io, FrameType::Pong, frame.header.id, frame.payload, {}, may_wait);
+      case FrameType::MGet:
+        if (engine_ != nullptr) {
+          return mget(io, frame, may_wait);
+        }
+        break;
+      case FrameType::MPut:
+        if (engine_ != nullptr) {
+          return mput(io, frame, may_wait);
+        }
+        break;
+      case FrameType::Scan:
+        if (engine_ != nullptr) {
+          return start_scan(io, frame, may_wait);
+        }
+        break;
+      case FrameType::ScanCredit:
+        return add_scan_credits(io, frame, may_wait);
+      case FrameType::ScanCancel:
+        cancel_scan(io, frame);
+        return true;
+      case FrameType::PutPoints:
+        if (engine_ != nullptr) {
+          return put_points(io, frame, may_wait);
+        }
+        break;
+      case FrameType::ScanPoints:
+        if (engine_ != nullptr) {
+          return start_scan_points(io, frame, may_wait);
+        }
+        break;
+      case FrameType::Aggregate:
+        if (engine_ != nullptr) {
+          return start_aggregate(io, frame, may_wait);
+        }
+        break;
+      default:
+        break;
+    }
+    metrics::inc_counter<"rpc.unknown_frames">();
+    return send_error(io, frame.header.id, FrameError::UnknownType, "unknown frame type", may_wait);
+  }
+
+  static bool mget(IO& io, const FrameView& frame, bool may_wait)
+  {
+    const auto start = std::chrono::steady_clock::now();
+
+    PayloadReader       in(frame.payload);
+    const std::uint32_t count = in.u32();
+    if (count > in.remaining() / sizeof(std::uint32_t)) {
+      return bad_payload(io, frame, may_wait);
+    }
+
+    std::vector<std::string_view>& keys = scratch_keys();
+    keys.clear();
+    keys.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+      keys.push_back(in.bytes(in.u32()));
+    }
+    if (!in.done()) {
+      return bad_payload(io, frame, may_wait);
+    }
+
+    // every key missing is the smallest result; if even that cannot fit yet, wait for TX
+    const std::size_t min_result = FRAME_HEADER_SIZE + sizeof(std::uint32_t) * (1 + count);
+    if (may_wait && min_result <= TX_CAPACITY && min_result > io.tx_room()) {
+      return false;
+    }
+
+    std::vector<std::byte>& out = scratch_frame();
+    out.resize(FRAME_HEADER_SIZE);
+    append_u32(out, count);
+    engine_->get_many(keys, [&](std::optional<std::string_view> value) {
+      if (value) {
+        append_u32(out, static_cast<std::uint32_t>(value->size()));
+        append_bytes(out, *value);
+      }
+      else {
+        append_u32(out, FRAME_NO_VALUE);
+      }
+    });
+    send_encoded(io, FrameType::MGetResult, frame.header.id, out);
+
+    metrics::add_counter<"rpc.mget_keys">(count);
+    metrics::record_histogram<"rpc.batch_size">(count);
+    metrics::record_histogram<"rpc.mget_batch_ns">(elapsed_ns(start));
+    return true;
+  }
+
+  static bool mput(IO& io, const FrameView& frame, bool may_wait)
+  {
+    constexpr std::size_t RESULT_SIZE = FRAME_HEADER_SIZE + sizeof(std::uint32_t);
+    if (may_wait && io.tx_room() < RESULT_SIZE) {
+      return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    PayloadReader       in(frame.payload);
+    const std::uint32_t count = in.u32();
+    if (count > in.remaining() / (2 * sizeof(std::uint32_t))) {
+      return bad_payload(io, frame, may_wait);
+    }
+
+    std::vector<ts::KeyValue>& batch = scratch_batch();
+    batch.clear();
+    batch.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+      const std::uint32_t klen = in.u32();
+      const std::uint32_t vlen = in.u32();
+      const auto          key  = in.bytes(klen);
+      batch.push_back({key, in.bytes(vlen)});
+    }
+    if (!in.done()) {
+      return bad_payload(io, frame, may_wait);
+    }
+
+    // from here on the batch may have been applied, so nothing below waits
+    if (!engine_->put_batch(batch)) {
+      return send_error(io, frame.header.id, FrameError::WriteFailed, "write failed", false);
+    }
+
+    std::vector<std::byte>& out = scratch_frame();
+    out.resize(FRAME_HEADER_SIZE);
+    append_u32(out, count);
+    send_encoded(io, FrameType::MPutResult, frame.header.id, out);
+
+    metrics::add_counter<"rpc.mput_points">(count);
+    metrics::record_histogram<"rpc.batch_size">(count);
+    metrics::record_histogram<"rpc.mput_batch_ns">(elapsed_ns(start));
+    return true;
+  }
+
+  bool start_scan(IO& io, const FrameView& frame, bool may_wait)
+  {
+    if (streaming()) {
+      return busy(io, frame, may_wait);
+    }
+
+    PayloadReader          in(frame.payload);
+    const std::string_view start   = in.bytes(in.u32());
+    const std::string_view end     = in.bytes(in.u32());
+    const std::uint32_t    credits = in.u32();
+    if (!in.done()) {
+      return bad_payload(io, frame, may_wait);
+    }
+
+    scan_ = std::make_unique<ScanState>(
+      ScanState{frame.header.id, std::string(start), std::string(end), credits, {}});
+    metrics::inc_counter<"rpc.scans">();
+    if (credits > 0) {
+      io.request_writable();
+    }
+    return true;
+  }
+
+  static bool put_points(IO& io, const FrameView& frame, bool may_wait)
+  {
+    constexpr std::size_t RESULT_SIZE = FRAME_HEADER_SIZE + sizeof(std::uint32_t);
+    if (may_wait && io.tx_room() < RESULT_SIZE) {
+      return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<ts::KeyValue>& batch = scratch_batch();
+    if (!ts::expand_points(frame.payload, scratch_arena(), batch)) {
+      return bad_payload(io, frame, may_wait);
+    }
+    if (!engine_->put_points(frame.payload, batch)) {
+      return send_error(io, frame.header.id, FrameError::WriteFailed, "write failed", false);
+    }
+
+    const auto              count = static_cast<std::uint32_t>(batch.size());
+    std::vector<std::byte>& out   = scratch_frame();
+    out.resize(FRAME_HEADER_SIZE);
+    append_u32(out, count);
+    send_encoded(io, FrameType::PutPointsResult, frame.header.id, out);
+
+    metrics::add_counter<"rpc.points_written">(count);
+    metrics::record_histogram<"rpc.batch_size">(count);
+    metrics::record_histogram<"rpc.put_points_batch_ns">(elapsed_ns(start));
+
+    if (scratch_arena().capacity() > SCRATCH_KEEP_BYTES) {
+      scratch_arena() = {};
+      batch           = {};
+    }
+    return true;
+  }
+
+  bool start_scan_points(IO& io, const FrameView& frame, bool may_wait)
+  {
+    if (streaming()) {
+      return busy(io, frame, may_wait);
+    }
+
+    PayloadReader          in(frame.payload);
+    const std::string_view series  = in.bytes(in.u32());
+    const auto             from    = static_cast<std::int64_t>(in.u64());
+    const auto             to      = static_cast<std::int64_t>(in.u64());
+    const std::uint32_t    credits = in.u32();
+    if (!in.done() || !ts::valid_series(series)) {
+      return bad_payload(io, frame, may_wait);
+    }
+
+    scan_ = std::make_unique<ScanState>(ScanState{frame.header.id,
+      ts::point_key(series, from),
+      ts::point_key(series, to),
+      credits,
+      std::string(series)});
+    metrics::inc_counter<"rpc.scans">();
+    if (credits > 0) {
+      io.request_writable();
+    }
+    return true;
+  }
+
+  bool start_aggregate(IO& io, const FrameView& frame, bool may_wait)
+  {
+    if (streaming()) {
+      return busy(io, frame, may_wait);
+    }
+
+    PayloadReader          in(frame.payload);
+    const std::string_view series = in.bytes(in.u32());
+    const auto             from   = static_cast<std::int64_t>(in.u64());
+    const auto             to     = static_cast<std::int64_t>(in.u64());
+    const auto             width  = static_cast<std::int64_t>(in.u64());
+    const std::uint32_t    fns    = in.u32();
+    if (!in.done() || !ts::valid_series(series) || width <= 0 || fns == 0 ||
+        (fns & ~ts::AGGREGATE_FNS_ALL) != 0) {
+      return bad_payload(io, frame, may_wait);
+    }
+
+    aggregate_ = std::make_unique<AggregateState>(
+      AggregateState{frame.header.id, std::string(series), from, to, width, fns, {}});
+    metrics::inc_counter<"rpc.aggregates">();
+    io.request_writable();
+    return true;
+  }
+
+  static bool busy(IO& io, const FrameView& frame, bool may_wait)
+  {
+    return send_error(
+      io, frame.header.id, FrameError::Busy, "a Scan or Aggregate is already streaming", may_wait);
+  }
+
+  // Credits for a scan that has already ended are dropped: they may cross its last batch.
+  bool add_scan_credits(IO& io, const FrameView& frame, bool may_wait)
+  {
+    PayloadReader       in(frame.payload);
+    const std::uint32_t credits = in.u32();
+    if (!in.done()) {
+      return bad_payload(io, frame, may_wait);
+    }
+    if (scan_ != nullptr && scan_->id == frame.header.id) {
+      const std::uint32_t room = std::numeric_limits<std::uint32_t>::max() - scan_->credits;
+      scan_->credits += std::min(credits, room);
+      if (scan_->credits > 0) {
+        io.request_writable();
+      }
+    }
+    return true;
+  }
+
+  void cancel_scan(IO& io, const FrameView& frame)
+  {
+    if (scan_ == nullptr || scan_->id != frame.header.id) {
+      return;
+    }
+    std::vector<std::byte>& out = scratch_frame();
+    out.resize(FRAME_HEADER_SIZE);
+    if (scan_->series.empty()) {
+      append_u32(out, 0);
+      send_encoded(io, FrameType::ScanBatch, frame.header.id, out, FRAME_FLAG_END);
+    }
+    else {
+      ts::encode_points(out, scan_->series, {});
+      send_encoded(io, FrameType::PointsBatch, frame.header.id, out, FRAME_FLAG_END);
+    }
+    scan_.reset();
+  }
+
+  // Cuts the next batch off the scan and queues it, using up one credit. Ends the scan with the
+  // batch that exhausts its range.
+  void send_scan_batch(IO& io)
+  {
+    if (!scan_->series.empty()) {
+      send_points_batch(io);
+      return;
+    }
+
+    std::vector<std::byte>& out = scratch_frame();
+    out.resize(FRAME_HEADER_SIZE);
+    append_u32(out, 0); // count, filled in below
+
+    std::uint32_t count = 0;
+    const auto    take  = [&](std::string_view key, std::string_view value) {
+      const std::size_t entry = 2 * sizeof(std::uint32_t) + key.size() + value.size();
+      if (count > 0 && out.size() + entry > SCAN_BATCH_BYTES) {
+        return false;
+      }
+      append_u32(out, static_cast<std::uint32_t>(key.size()));
+      append_u32(out, static_cast<std::uint32_t>(value.size()));
+      append_bytes(out, key);
+      append_bytes(out, value);
+      ++count;
+      return true;
+    };
+    const std::optional<std::string> next = engine_->scan_range(scan_->next, scan_->end, take);
+
+    patch_u32(out, FRAME_HEADER_SIZE, count);
+    send_encoded(io, FrameType::ScanBatch, scan_->id, out, next ? 0 : FRAME_FLAG_END);
+
+    metrics::inc_counter<"rpc.scan_batches">();
+    metrics::add_counter<"rpc.scan_entries">(count);
+
+    if (next) {
+      scan_->next = *next;
+      --scan_->credits;
+    }
+    else {
+      scan_.reset();
+    }
+  }
+
+  // send_scan_batch for a ScanPoints: the batch is a point block. Entries in the range that are not
+  // samples of the scanned series (raw keys that merely sort inside it) are skipped.
+  void send_points_batch(IO& io)
+  {
+    std::vector<ts::Point>& points = scratch_points();
+    points.clear();
+    const auto take = [&](std::string_view key, std::string_view value) {
+      if (points.size() == SCAN_BATCH_POINTS) {
+        return false;
+      }
+      const std::optional<ts::PointKey> point  = ts::parse_point_key(key);
+      const std::optional<double>       sample = ts::decode_sample(value);
+      if (point && point->series == scan_->series && sample) {
+        points.push_back({point->timestamp, *sample});
+      }
+      return true;
+    };
+    const std::optional<std::string> next = engine_->scan_range(scan_->next, scan_->end, take);
+
+    std::vector<std::byte>& out = scratch_frame();
+    out.resize(FRAME_HEADER_SIZE);
+    ts::encode_points(out, scan_->series, points);
+    send_encoded(io, FrameType::PointsBatch, scan_->id, out, next ? 0 : FRAME_FLAG_END);
+
+    metrics::inc_counter<"rpc.scan_batches">();
+    metrics::add_counter<"rpc.points_scanned">(points.size());
+
+    if (next) {
+      scan_->next = *next;
+      --scan_->credits;
+    }
+    else {
+      scan_.reset();
+    }
+  }
+
+  // Folds up to AGGREGATE_BATCH_BUCKETS buckets, visiting at most AGGREGATE_BATCH_ENTRIES points,
+  // and queues the ones completed. Ends the aggregation with the batch that exhausts its range (an
+  // empty one if the range holds no points). Returns false if it queued nothing: the call stopped
+  // inside a bucket, which stays open in aggregate_->open.
+  bool send_aggregate_batch(IO& io)
+  {
+    AggregateState& query = *aggregate_;
+
+    std::vector<std::byte>& out = scratch_frame();
+    out.resize(FRAME_HEADER_SIZE);
+    append_u32(out, 0); // count, filled in below
+
+    std::uint32_t count  = 0;
+    std::uint64_t points = 0;
+    const auto    put    = [&](const ts::BucketAggregate& bucket) {
+      append_u64(out, static_cast<std::uint64_t>(bucket.start));
+      if (ts::wants(query.fns, ts::AggregateFn::Min)) {
+        append_f64(out, bucket.min);
+      }
+      if (ts::wants(query.fns, ts::AggregateFn::Max)) {
+        append_f64(out, bucket.max);
+      }
+      if (ts::wants(query.fns, ts::AggregateFn::Sum)) {
+        append_f64(out, bucket.sum);
+      }
+      if (ts::wants(query.fns, ts::AggregateFn::Count)) {
+        append_u64(out, bucket.count);
+      }
+      if (ts::wants(query.fns, ts::AggregateFn::Avg)) {
+        append_f64(out, bucket.avg());
+      }
+      ++count;
+      points += bucket.count;
+    };
+    const std::optional<std::int64_t> next = engine_->aggregate(query.series,
+      query.next,
+      query.to,
+      query.width,
+      AGGREGATE_BATCH_BUCKETS,
+      AGGREGATE_BATCH_ENTRIES,
+      query.open,
+      put);
+    if (next) {
+      query.next = *next;
+    }
+    if (count == 0 && next) {
+      return false;
+    }
+
+    patch_u32(out, FRAME_HEADER_SIZE, count);
+    send_encoded(io, FrameType::AggregateBatch, query.id, out, next ? 0 : FRAME_FLAG_END);
+
+    metrics::add_counter<"rpc.aggregate_buckets">(count);
+    metrics::add_counter<"rpc.aggregate_points">(points);
+
+    if (!next) {
+      aggregate_.reset();
+    }
+    return true;
+  }
+
+  static bool bad_payload(IO& io, const FrameView& frame, bool may_wait)
+  {
+    metrics::inc_counter<"rpc.bad_payloads">();
+    return send_error(io, frame.header.id, FrameError::BadPayload, "malformed payload", may_wait);
+  }
+
+  // `out` holds a frame whose payload follows FRAME_HEADER_SIZE reserved bytes. Fills in the
+  // header, then copies the frame into TX if it fits the TX buffer and there is room, else queues
+  // the buffer itself.
+  static void send_encoded(IO& io,
+    FrameType                  type,
+    std::uint32_t              id,
+    std::vector<std::byte>&    out,
+    std::uint8_t               flags = 0)
+  {
+    const auto length = static_cast<std::uint32_t>(out.size() - FRAME_HEADER_SIZE);
+    encode_frame_header({type, flags, length, id}, std::span(out).first<FRAME_HEADER_SIZE>());
+
+    if (out.size() <= std::min(io.tx_room(), TX_CAPACITY)) [[likely]] {
+      (void)io.tx_send(out);
+      return;
+    }
+    (void)io.tx_enqueue(TxSegment::from_vector(std::move(out)));
+    out = {};
+  }
+
+  [[nodiscard]] static std::uint64_t elapsed_ns(std::chrono::steady_clock::time_point start)
+  {
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+
+  // thread-local scratch space; it keeps its capacity, so steady-state batches do not allocate
+  static std::vector<std::string_view>& scratch_keys()
+  {
+    thread_local std::vector<std::string_view> keys;
+    return keys;
+  }
+
+  static std::vector<ts::Point>& scratch_points()
+  {
+    thread_local std::vector<ts::Point> points;
+    return points;
+  }
+
+  // backing bytes for the keys and values of a scratch_batch() expanded from a point block
+  static std::string& scratch_arena()
+  {
+    thread_local std::string arena;
+    return arena;
+  }
+
+  static std::vector<ts::KeyValue>& scratch_batch()
+  {
+    thread_local std::vector<ts::KeyValue> batch;
+    return batch;
+  }
+
+  static std::vector<std::byte>& scratch_frame()
+  {
+    thread_local std::vector<std::byte> frame;
+    return frame;
+  }
+
+  // Queue one whole frame, or nothing. Frames too large to ever fit in the TX buffer, and frames
+  // that may not wait for TX space, go out as a single segment instead.
+  static bool send_frame(IO&   io,
+    FrameType                  type,
+    std::uint32_t              id,
+    std::span<const std::byte> payload,
+    std::span<const std::byte> payload_tail = {},
+    bool                       may_wait     = true)
+  {
+    const std::size_t length = payload.size() + payload_tail.size();
+    const auto        header =
+      encode_frame_header({type, 0, static_cast<std::uint32_t>(length), id});
+
+    if (FRAME_HEADER_SIZE + length <= std::min(io.tx_room(), TX_CAPACITY)) [[likely]] {
+      (void)io.tx_send(header);
+      (void)io.tx_send(payload);
+      (void)io.tx_send(payload_tail);
+      return true;
+    }
+
+    if (FRAME_HEADER_SIZE + length <= TX_CAPACITY && may_wait) {
+      return false;
+    }
+
+    std::vector<std::byte> bytes;
+    bytes.reserve(FRAME_HEADER_SIZE + length);
+    bytes.insert(bytes.end(), header.begin(), header.end());
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+    bytes.insert(bytes.end(), payload_tail.begin(), payload_tail.end());
+    (void)io.tx_enqueue(TxSegment::from_vector(std::move(bytes)));
+    return true;
+  }
+
+  static bool send_error(IO& io,
+    std::uint32_t            id,
+    FrameError               code,
+    std::string_view         message,
+    bool                     may_wait = true)
+  {
+    const std::byte code_byte = static_cast<std::byte>(code);
+    return send_frame(io,
+      FrameType::Error,
+      id,
+      {&code_byte, 1},
+      std::as_bytes(std::span(message)),
+      may_wait);
+  }
+
+  static void reject(IO& io, const FrameParse& parsed)
+  {
+    TSKV_LOG_WARN("rejecting frame ({}), closing connection", tc::to_string(parsed.status));
+    metrics::inc_counter<"rpc.frame_errors">();
+
+    if (parsed.status == FrameStatus::TooLarge) {
+      (void)send_error(io, parsed.frame.header.id, FrameError::TooLarge, "frame too large");
+    }
+    else {
+      (void)send_error(io, parsed.frame.header.id, FrameError::Malformed, "malformed frame");
+    }
+
+    io.shutdown();
+  }
+};
+
+} // namespace tskv::net
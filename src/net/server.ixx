@@ -1,10 +1,13 @@
 module;
 
+#include <array>
 #include <cassert>
+#include <cstddef>
 #include <filesystem>
 #include <netdb.h>
 #include <print>
 #include <string>
+#include <string_view>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -24,25 +27,86 @@ namespace fs = std::filesystem;
 
 export namespace tskv::net {
 
+// Event-loop implementation used by each io thread
+enum class IoBackend : uint8_t { Epoll, Uring };
+
+// What the server speaks on its connections
+enum class WireProtocol : uint8_t { Echo, Frame, Resp };
+
 struct ServerConfig {
   std::string       host            = "localhost";
   uint16_t          port            = 7070;
+  fs::path          unix_socket;              // extra AF_UNIX listener at this path, empty = off
   fs::path          data_dir        = "./data";
   ts::WALSyncPolicy wal_sync_policy = ts::WALSyncPolicy::Append;
   uint64_t          memtable_bytes  = 67108864;
   uint32_t          max_connections = 1024;
+  uint32_t          io_threads      = 1;
+  IoBackend         io_backend      = IoBackend::Epoll;
+  WireProtocol      protocol        = WireProtocol::Echo;
+  uint32_t          rx_budget_bytes = 65536;  // per channel per dispatch, 0 = unlimited
+  uint32_t          tx_budget_bytes = 65536;  // per channel per dispatch, 0 = unlimited
+  uint32_t          tx_zerocopy     = 0;      // MSG_ZEROCOPY for queued segments >= this, 0 = off
+  uint32_t          idle_timeout_ms = 300000; // close connections silent this long, 0 = never
+  uint32_t          busy_poll_us    = 0;      // spin this long before blocking, 0 = off
+  SocketProfile     socket;                   // listener and per-connection socket options
+
+  // Each io thread admits an equal share of max_connections (rounded up).
+  [[nodiscard]] std::size_t max_connections_per_reactor() const noexcept
+  {
+    return (std::size_t{max_connections} + io_threads - 1) / io_threads;
+  }
 
   void print() const
   {
     std::print("tskv server CFG ::");
     std::print(" host={}", this->host);
     std::print(" port={}", this->port);
+    std::print(" unix-socket={}", this->unix_socket.string());
     std::print(" data-dir={}", this->data_dir.string());
     std::print(" wal-sync={}", tc::to_string(this->wal_sync_policy));
     std::print(" memtable-bytes={}", this->memtable_bytes);
     std::print(" max-connections={}", this->max_connections);
+    std::print(" io-threads={}", this->io_threads);
+    std::print(" io-backend={}", tc::to_string(this->io_backend));
+    std::print(" protocol={}", tc::to_string(this->protocol));
+    std::print(" rx-budget={}", this->rx_budget_bytes);
+    std::print(" tx-budget={}", this->tx_budget_bytes);
+    std::print(" tx-zerocopy={}", this->tx_zerocopy);
+    std::print(" idle-timeout={}", this->idle_timeout_ms);
+    std::print(" busy-poll={}", this->busy_poll_us);
+    std::print(" backlog={}", this->socket.backlog);
+    std::print(" tcp-nodelay={}", this->socket.tcp_nodelay);
+    std::print(" tcp-defer-accept={}", this->socket.defer_accept_s);
+    std::print(" so-rcvbuf={}", this->socket.rcvbuf_bytes);
+    std::print(" so-sndbuf={}", this->socket.sndbuf_bytes);
+    std::print(" tcp-notsent-lowat={}", this->socket.notsent_lowat);
+    std::print(" tcp-user-timeout={}", this->socket.user_timeout_ms);
     std::print("\n");
   }
 };
 
 } // namespace tskv::net
+
+namespace tn = tskv::net;
+
+export namespace tskv::common {
+
+template <>
+struct enum_traits<tn::IoBackend> {
+  static constexpr std::array<std::pair<tn::IoBackend, std::string_view>, 2> entries{{
+    {tn::IoBackend::Epoll, "epoll"},
+    {tn::IoBackend::Uring, "uring"},
+  }};
+};
+
+template <>
+struct enum_traits<tn::WireProtocol> {
+  static constexpr std::array<std::pair<tn::WireProtocol, std::string_view>, 3> entries{{
+    {tn::WireProtocol::Echo, "echo"},
+    {tn::WireProtocol::Frame, "frame"},
+    {tn::WireProtocol::Resp, "resp"},
+  }};
+};
+
+} // namespace tskv::common
@@ -1,14 +1,20 @@
 module;
 
 #include <cassert>
+#include <cerrno>
 #include <charconv>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
 #include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include "tskv/common/logging.hpp"
@@ -19,13 +25,54 @@ import tskv.common.logging;
 
 export namespace tskv::net {
 
-int start_listener(const char* const host, std::uint16_t port)
+// Socket options for the listener and the connections it accepts. Zero leaves the kernel default
+// (or its sysctl) in place.
+struct SocketProfile {
+  std::uint32_t backlog         = SOMAXCONN; // listen() queue, capped by net.core.somaxconn
+  bool          tcp_nodelay     = true;      // send small replies at once, no Nagle batching
+  std::uint32_t defer_accept_s  = 0;         // TCP_DEFER_ACCEPT: accept once data has arrived
+  std::uint32_t rcvbuf_bytes    = 0;         // SO_RCVBUF (the kernel doubles it); 0: autotuned
+  std::uint32_t sndbuf_bytes    = 0;         // SO_SNDBUF (the kernel doubles it); 0: autotuned
+  std::uint32_t notsent_lowat   = 0;         // TCP_NOTSENT_LOWAT: unsent bytes kept in the kernel
+  std::uint32_t user_timeout_ms = 0;         // TCP_USER_TIMEOUT: drop peers that stop acking
+};
+
+namespace detail {
+
+bool set_int_option(int fd, int level, int name, std::uint32_t value) noexcept
+{
+  const int v = static_cast<int>(value);
+  return setsockopt(fd, level, name, &v, sizeof v) == 0;
+}
+
+// listener options are best effort: a rejected one is logged, not fatal
+void tune_listener(int fd, int level, int name, std::uint32_t value, const char* what) noexcept
+{
+  if (value != 0 && !set_int_option(fd, level, name, value)) {
+    TSKV_LOG_WARN("setsockopt({}={}) failed on listener: errno={}", what, value, errno);
+  }
+}
+
+} // namespace detail
+
+// Listening socket bound to the first usable address of `host`. IPv4 addresses are preferred when
+// the name resolves to both families; IPv6 listeners are dual-stack (e.g. "::" also accepts IPv4).
+// reuse_port: allow several listeners (one per reactor) to bind the same address via SO_REUSEPORT,
+//   letting the kernel spread incoming connections across them
+// The listener-level parts of `profile` are applied here: buffer sizes before listen(), so that
+// accepted connections inherit them and advertise a matching TCP window scale, plus the backlog
+// and TCP_DEFER_ACCEPT. They are best effort; failures are logged.
+int start_listener(const char* const host,
+  std::uint16_t                      port,
+  bool                               reuse_port = false,
+  const SocketProfile&               profile    = {})
 {
   addrinfo  hints{};
   addrinfo* servinfo = nullptr;
 
   hints.ai_family   = AF_UNSPEC;
   hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags    = AI_PASSIVE;
 
   char portbuf[8]{};
   auto [ptr, ec] = std::to_chars(portbuf, portbuf + 8, port);
@@ -40,34 +87,56 @@ int start_listener(const char* const host, std::uint16_t port)
 
   int listen_fd = -1;
 
-  for (addrinfo* p = servinfo; p != NULL; p = p->ai_next) {
-    if (p->ai_family != AF_INET) {
-      continue;
-    }
+  for (const int family : {AF_INET, AF_INET6}) {
+    for (addrinfo* p = servinfo; p != NULL && listen_fd == -1; p = p->ai_next) {
+      if (p->ai_family != family) {
+        continue;
+      }
 
-    int fd = socket(p->ai_family, p->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, p->ai_protocol);
-    if (fd == -1) {
-      continue;
-    }
+      int fd = socket(p->ai_family, p->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, p->ai_protocol);
+      if (fd == -1) {
+        continue;
+      }
 
-    int yes = 1;
-    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes) == -1) {
-      ::close(fd);
-      continue;
-    }
+      int yes = 1;
+      if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes) == -1) {
+        ::close(fd);
+        continue;
+      }
 
-    if (bind(fd, p->ai_addr, p->ai_addrlen) == -1) {
-      ::close(fd);
-      continue;
-    }
+      if (reuse_port && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof yes) == -1) {
+        ::close(fd);
+        continue;
+      }
+
+      int no = 0;
+      if (family == AF_INET6 && setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &no, sizeof no) == -1) {
+        TSKV_LOG_WARN("could not make IPv6 listener dual-stack: errno={}", errno);
+      }
+
+      detail::tune_listener(fd, SOL_SOCKET, SO_RCVBUF, profile.rcvbuf_bytes, "SO_RCVBUF");
+      detail::tune_listener(fd, SOL_SOCKET, SO_SNDBUF, profile.sndbuf_bytes, "SO_SNDBUF");
+
+      if (bind(fd, p->ai_addr, p->ai_addrlen) == -1) {
+        ::close(fd);
+        continue;
+      }
 
-    listen_fd = fd;
-    break;
+      detail::tune_listener(
+        fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, profile.defer_accept_s, "TCP_DEFER_ACCEPT");
+
+      listen_fd = fd;
+    }
   }
 
   freeaddrinfo(servinfo);
 
-  if (listen(listen_fd, SOMAXCONN) == -1) {
+  if (listen_fd == -1) {
+    TSKV_LOG_ERROR("Failed to bind {}:{}", host, port);
+    return -1;
+  }
+
+  if (listen(listen_fd, static_cast<int>(profile.backlog)) == -1) {
     TSKV_LOG_ERROR("Failed to listen on listen_fd = {}", listen_fd);
     ::close(listen_fd);
     return -1;
@@ -76,4 +145,148 @@ int start_listener(const char* const host, std::uint16_t port)
   return listen_fd;
 }
 
+// Non-blocking AF_UNIX stream listener bound to the filesystem path `path`, for clients on the
+// same host. A socket file left behind by a previous run is replaced, but only if nothing is
+// listening on it any more. Of `profile`, only the backlog applies. The caller unlinks `path` when
+// it closes the listener.
+int start_unix_listener(const char* const path, const SocketProfile& profile = {})
+{
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+
+  const std::size_t len = std::strlen(path);
+  if (len == 0 || len >= sizeof addr.sun_path) {
+    TSKV_LOG_ERROR("unix socket path must be 1..{} bytes: {}", sizeof addr.sun_path - 1, path);
+    return -1;
+  }
+  std::memcpy(addr.sun_path, path, len + 1);
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd == -1) {
+    TSKV_LOG_ERROR("failed to create unix socket: errno={}", errno);
+    return -1;
+  }
+
+  struct stat st{};
+  if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+    const int  probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    const bool live  =
+      probe != -1 && connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == 0;
+    if (probe != -1) {
+      ::close(probe);
+    }
+    if (!live) {
+      (void)::unlink(path); // stale, from a server that did not shut down cleanly
+    }
+  }
+
+  if (bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == -1) {
+    TSKV_LOG_ERROR("Failed to bind unix socket {}: errno={}", path, errno);
+    ::close(fd);
+    return -1;
+  }
+
+  if (listen(fd, static_cast<int>(profile.backlog)) == -1) {
+    TSKV_LOG_ERROR("Failed to listen on unix socket {}: errno={}", path, errno);
+    ::close(fd);
+    (void)::unlink(path);
+    return -1;
+  }
+
+  return fd;
+}
+
+// Per-connection parts of `profile`, for a socket returned by accept(). Buffer sizes are
+// inherited from the listener and not set again. Returns false if any option was rejected.
+bool apply_socket_profile(int fd, const SocketProfile& profile) noexcept
+{
+  bool ok = true;
+
+  if (profile.tcp_nodelay) {
+    ok = detail::set_int_option(fd, IPPROTO_TCP, TCP_NODELAY, 1) && ok;
+  }
+  if (profile.notsent_lowat != 0) {
+    ok = detail::set_int_option(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, profile.notsent_lowat) && ok;
+  }
+  if (profile.user_timeout_ms != 0) {
+    ok = detail::set_int_option(fd, IPPROTO_TCP, TCP_USER_TIMEOUT, profile.user_timeout_ms) && ok;
+  }
+
+  return ok;
+}
+
+// Ask the kernel to busy-poll the device queue for up to `usecs` on blocking reads of this socket
+// (SO_BUSY_POLL), and to prefer busy polling over interrupt-driven processing while the
+// application keeps polling (SO_PREFER_BUSY_POLL). Raising SO_BUSY_POLL above the
+// net.core.busy_read sysctl needs CAP_NET_ADMIN. Returns false if either option was rejected.
+bool set_busy_poll(int fd, std::uint32_t usecs)
+{
+  const int busy_poll = static_cast<int>(usecs);
+  const int prefer    = 1;
+
+  const bool busy_ok = setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof busy_poll) == 0;
+  const bool pref_ok = setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof prefer) == 0;
+
+  return busy_ok && pref_ok;
+}
+
+// Non-blocking client socket connecting to the first address of `host` that accepts a connect()
+// attempt (IPv4 first, as for listeners). The connect is usually still in progress on return: the
+// socket turns writable once it completes, and SO_ERROR then tells whether it succeeded. Of
+// `profile`, the per-connection options apply (TCP_NODELAY by default). -1 if nothing could be
+// attempted.
+int start_connect(const char* const host, std::uint16_t port, const SocketProfile& profile = {})
+{
+  addrinfo  hints{};
+  addrinfo* servinfo = nullptr;
+
+  hints.ai_family   = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  char portbuf[8]{};
+  auto [ptr, ec] = std::to_chars(portbuf, portbuf + 8, port);
+  TSKV_DEMAND(ec == std::errc{}, "failed to convert port number ({}) to string", port);
+  *ptr = '\0';
+
+  if (int status = getaddrinfo(host, portbuf, &hints, &servinfo); status != 0) {
+    TSKV_LOG_ERROR("getaddrinfo failure: {}", gai_strerror(status));
+    return -1;
+  }
+
+  int conn_fd = -1;
+
+  for (const int family : {AF_INET, AF_INET6}) {
+    for (addrinfo* p = servinfo; p != NULL && conn_fd == -1; p = p->ai_next) {
+      if (p->ai_family != family) {
+        continue;
+      }
+
+      int fd = socket(p->ai_family, p->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, p->ai_protocol);
+      if (fd == -1) {
+        continue;
+      }
+
+      if (connect(fd, p->ai_addr, p->ai_addrlen) == -1 && errno != EINPROGRESS) {
+        ::close(fd);
+        continue;
+      }
+
+      conn_fd = fd;
+    }
+  }
+
+  freeaddrinfo(servinfo);
+
+  if (conn_fd == -1) {
+    TSKV_LOG_ERROR("Failed to connect to {}:{}", host, port);
+    return -1;
+  }
+
+  if (!apply_socket_profile(conn_fd, profile)) {
+    TSKV_LOG_WARN("socket options rejected on client_fd = {}", conn_fd);
+  }
+
+  return conn_fd;
+}
+
 } // namespace tskv::net
@@ -0,0 +1,243 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.net.timer_wheel
+// Summary: hierarchical timing wheel for reactor-owned timeouts
+//
+//  - time is an abstract tick count (the reactor uses 1 ms ticks); nothing here reads a clock
+//  - Timer is an intrusive node embedded in whatever owns the timeout
+//    * schedule() / cancel() are O(1) and never allocate
+//    * a Timer must be cancelled (or have fired) before it is destroyed
+//  - LEVELS wheels of SLOTS slots; a level-L slot spans SLOTS^L ticks and is cascaded into the
+//    lower levels when the wheel reaches it
+//  - next_due() reports the next tick at which advance() has work, so a single one-shot timerfd
+//    can drive the whole wheel
+//  - not thread-safe
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+export module tskv.net.timer_wheel;
+
+export namespace tskv::net {
+
+namespace detail {
+
+struct TimerLink {
+  TimerLink* prev = nullptr;
+  TimerLink* next = nullptr;
+};
+
+} // namespace detail
+
+class TimerWheel;
+
+class Timer : private detail::TimerLink {
+  friend class TimerWheel;
+
+  static constexpr std::uint16_t NO_SLOT = UINT16_MAX;
+
+  std::uint64_t expires_ = 0;
+  std::uint16_t slot_    = NO_SLOT; // index into TimerWheel::slots_ while armed
+
+public:
+  // owner data, untouched by the wheel (e.g. what fired, and an event tag to find its channel)
+  std::uint8_t  kind   = 0;
+  std::uint64_t cookie = 0;
+
+  Timer() = default;
+
+  Timer(const Timer&)            = delete;
+  Timer& operator=(const Timer&) = delete;
+
+  ~Timer() { assert(!armed() && "Timer destroyed while still scheduled"); }
+
+  [[nodiscard]] bool          armed() const noexcept { return next != nullptr; }
+  [[nodiscard]] std::uint64_t expires() const noexcept { return expires_; }
+};
+
+class TimerWheel {
+public:
+  static constexpr unsigned    SLOT_BITS = 6;
+  static constexpr std::size_t SLOTS     = std::size_t{1} << SLOT_BITS;
+  static constexpr std::size_t LEVELS    = 8; // 48 bits of ticks: ~8900 years of 1 ms ticks
+
+  // Expiries farther out are clamped, i.e. fire early. Callers that compare against their own
+  // deadline on expiry (as idle timeouts do) simply reschedule.
+  static constexpr std::uint64_t MAX_DELAY = std::uint64_t{1} << (SLOT_BITS * LEVELS - 1);
+
+private:
+  detail::TimerLink slots_[LEVELS * SLOTS];
+  std::uint64_t     occupied_[LEVELS]{}; // bit i set <=> slot i of that level is non-empty
+
+  std::uint64_t now_  = 0;
+  std::size_t   size_ = 0;
+
+  [[nodiscard]] static bool slot_empty(const detail::TimerLink& head) noexcept
+  {
+    return head.next == &head;
+  }
+
+  void link(Timer& t) noexcept
+  {
+    // The highest 6-bit group in which expires and now differ picks the level; within it the slot
+    // is strictly ahead of now's, so it is reached (and cascaded) before the timer is due.
+    const std::uint64_t diff  = t.expires_ ^ now_;
+    const unsigned      level = diff == 0 ? 0 : (std::bit_width(diff) - 1) / SLOT_BITS;
+    assert(level < LEVELS);
+
+    const std::size_t  index = (t.expires_ >> (level * SLOT_BITS)) & (SLOTS - 1);
+    detail::TimerLink& head  = slots_[level * SLOTS + index];
+
+    t.prev          = head.prev;
+    t.next          = &head;
+    head.prev->next = &t;
+    head.prev       = &t;
+    t.slot_         = static_cast<std::uint16_t>(level * SLOTS + index);
+
+    occupied_[level] |= std::uint64_t{1} << index;
+  }
+
+  void unlink(Timer& t) noexcept
+  {
+    t.prev->next = t.next;
+    t.next->prev = t.prev;
+    t.prev       = nullptr;
+    t.next       = nullptr;
+
+    if (slot_empty(slots_[t.slot_])) {
+      occupied_[t.slot_ / SLOTS] &= ~(std::uint64_t{1} << (t.slot_ % SLOTS));
+    }
+    t.slot_ = Timer::NO_SLOT;
+  }
+
+  [[nodiscard]] static Timer& first_in(detail::TimerLink& head) noexcept
+  {
+    return static_cast<Timer&>(*head.next);
+  }
+
+public:
+  explicit TimerWheel(std::uint64_t now = 0) noexcept : now_(now)
+  {
+    assert(now < MAX_DELAY && "INVALID ARGS: wheel epoch too far out");
+    for (detail::TimerLink& head : slots_) {
+      head.prev = &head;
+      head.next = &head;
+    }
+  }
+
+  // slot heads point at themselves
+  TimerWheel(const TimerWheel&)            = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  ~TimerWheel()
+  {
+    for (detail::TimerLink& head : slots_) {
+      while (!slot_empty(head)) {
+        unlink(first_in(head));
+      }
+    }
+  }
+
+  [[nodiscard]] std::uint64_t now() const noexcept { return now_; }
+  [[nodiscard]] std::size_t   size() const noexcept { return size_; }
+  [[nodiscard]] bool          empty() const noexcept { return size_ == 0; }
+
+  // (Re)arm t to fire at tick `expires`. Ticks not after now() fire on the next advance().
+  void schedule(Timer& t, std::uint64_t expires) noexcept
+  {
+    if (t.armed()) {
+      unlink(t);
+    }
+    else {
+      ++size_;
+    }
+
+    t.expires_ = std::clamp(expires, now_ + 1, now_ + MAX_DELAY);
+    link(t);
+  }
+
+  void cancel(Timer& t) noexcept
+  {
+    if (t.armed()) {
+      unlink(t);
+      --size_;
+    }
+  }
+
+  // Earliest tick at which advance() will have something to do: a timer expiry, or a cascade of
+  // a higher-level slot (which may turn out to fire nothing yet). nullopt if no timers are armed.
+  [[nodiscard]] std::optional<std::uint64_t> next_due() const noexcept
+  {
+    std::optional<std::uint64_t> due;
+
+    for (std::size_t level = 0; level < LEVELS; ++level) {
+      if (occupied_[level] == 0) {
+        continue;
+      }
+
+      const unsigned      shift   = level * SLOT_BITS;
+      const std::uint64_t current = (now_ >> shift) & (SLOTS - 1);
+      const std::uint64_t ahead   = occupied_[level] & ~((std::uint64_t{2} << current) - 1);
+      assert(ahead != 0 && "TimerWheel: timer left behind in a passed slot");
+
+      const std::uint64_t rotation = now_ & ~((std::uint64_t{1} << (shift + SLOT_BITS)) - 1);
+      const std::uint64_t tick     = rotation | (std::uint64_t(std::countr_zero(ahead)) << shift);
+
+      due = due ? std::min(*due, tick) : tick;
+    }
+
+    return due;
+  }
+
+  // Move time forward to `now`, calling on_expire(Timer&) for every timer that came due, in
+  // expiry order. Timers are disarmed before the callback, which may schedule or cancel any
+  // timer (including the one passed to it). Returns the number of timers fired.
+  template <typename Fn>
+  std::size_t advance(std::uint64_t now, Fn&& on_expire)
+  {
+    std::size_t nfired = 0;
+
+    for (;;) {
+      const std::optional<std::uint64_t> due = next_due();
+      if (!due || *due > now) {
+        now_ = std::max(now_, now);
+        return nfired;
+      }
+
+      now_ = *due;
+
+      // higher levels first: their timers may land in lower-level slots that are due right now
+      for (std::size_t level = LEVELS - 1; level > 0; --level) {
+        const unsigned shift = level * SLOT_BITS;
+        if ((now_ & ((std::uint64_t{1} << shift) - 1)) != 0) {
+          continue;
+        }
+
+        detail::TimerLink& head = slots_[level * SLOTS + ((now_ >> shift) & (SLOTS - 1))];
+        while (!slot_empty(head)) {
+          Timer& t = first_in(head);
+          unlink(t);
+          link(t);
+        }
+      }
+
+      // nothing scheduled from inside on_expire can land in this slot (expiries are > now_)
+      detail::TimerLink& head = slots_[now_ & (SLOTS - 1)];
+      while (!slot_empty(head)) {
+        Timer& t = first_in(head);
+        unlink(t);
+        --size_;
+        ++nfired;
+        on_expire(t);
+      }
+    }
+  }
+};
+
+} // namespace tskv::net
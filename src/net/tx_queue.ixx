@@ -0,0 +1,204 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.net.tx_queue
+// Summary: refcounted transmit segments and the per-channel queue that holds them
+//
+//  - TxSegment is a byte view plus a shared owner that keeps those bytes alive
+//    * protocols hand large responses to a Channel without copying them into its TX buffer
+//    * sub-segments share the owner, so one allocation can back many queued views
+//  - TxQueue is a FIFO of segments, flushed by the Channel with scatter-gather sendmsg()
+//    * gather() fills an iovec batch from the head; consume() retires sent bytes
+//    * the retired prefix is dropped once it is half the queue, so a queue that never empties (a
+//      scan refilling behind its own sends) holds O(pending) entries
+//  - ZeroCopyTracker pins segments handed to sendmsg(MSG_ZEROCOPY) until the kernel reports
+//    their completion on the socket error queue
+//  - none of the types are thread-safe
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <sys/uio.h>
+#include <utility>
+#include <vector>
+
+export module tskv.net.tx_queue;
+
+export namespace tskv::net {
+
+struct TxSegment {
+  std::shared_ptr<const void> owner; // keeps `bytes` alive while queued or in flight
+  std::span<const std::byte>  bytes;
+
+  [[nodiscard]] std::size_t size() const noexcept { return bytes.size(); }
+  [[nodiscard]] bool        empty() const noexcept { return bytes.empty(); }
+
+  // A view of [offset, offset + len) sharing this segment's owner.
+  [[nodiscard]] TxSegment subsegment(std::size_t offset, std::size_t len) const noexcept
+  {
+    assert(offset + len <= bytes.size() && "INVALID ARGS: subsegment out of range");
+    return TxSegment{owner, bytes.subspan(offset, len)};
+  }
+
+  [[nodiscard]] static TxSegment from_vector(std::vector<std::byte>&& data)
+  {
+    auto owned = std::make_shared<const std::vector<std::byte>>(std::move(data));
+    return TxSegment{owned, std::span<const std::byte>(*owned)};
+  }
+
+  [[nodiscard]] static TxSegment from_string(std::string&& data)
+  {
+    auto owned = std::make_shared<const std::string>(std::move(data));
+    return TxSegment{owned, std::as_bytes(std::span(*owned))};
+  }
+
+  [[nodiscard]] static TxSegment copy_of(std::span<const std::byte> data)
+  {
+    return from_vector(std::vector<std::byte>(data.begin(), data.end()));
+  }
+};
+
+class TxQueue {
+  // segments_[head_..] are pending; the retired prefix is dropped once it is half of segments_
+  std::vector<TxSegment> segments_;
+  std::size_t            head_  = 0;
+  std::size_t            bytes_ = 0;
+
+public:
+  [[nodiscard]] bool        empty() const noexcept { return head_ == segments_.size(); }
+  [[nodiscard]] std::size_t bytes() const noexcept { return bytes_; }
+
+  // entries held, retired ones not yet dropped included
+  [[nodiscard]] std::size_t slots() const noexcept { return segments_.size(); }
+
+  [[nodiscard]] const TxSegment& front() const noexcept
+  {
+    assert(!empty());
+    return segments_[head_];
+  }
+
+  void push(TxSegment segment)
+  {
+    if (segment.empty()) {
+      return;
+    }
+    bytes_ += segment.size();
+    segments_.push_back(std::move(segment));
+  }
+
+  // Fill `iov` with pending segments, starting at the head, until it is full or max_bytes is
+  // covered. Stops before the first segment for which stop_before(segment) holds. Returns the
+  // number of iovecs written.
+  template <typename Pred>
+  [[nodiscard]] std::size_t gather(std::span<iovec> iov, std::size_t max_bytes, Pred&& stop_before)
+    const noexcept
+  {
+    std::size_t niov = 0;
+
+    for (std::size_t i = head_; i < segments_.size() && niov < iov.size() && max_bytes > 0; ++i) {
+      const TxSegment& seg = segments_[i];
+      if (stop_before(seg)) {
+        break;
+      }
+
+      const std::size_t len = std::min(seg.size(), max_bytes);
+      iov[niov++]           = iovec{const_cast<std::byte*>(seg.bytes.data()), len};
+      max_bytes -= len;
+    }
+
+    return niov;
+  }
+
+  // Retire nbytes from the head of the queue (partially sent segments are trimmed in place).
+  void consume(std::size_t nbytes) noexcept
+  {
+    assert(nbytes <= bytes_);
+    bytes_ -= nbytes;
+
+    while (nbytes > 0) {
+      TxSegment& seg = segments_[head_];
+      if (nbytes < seg.size()) {
+        seg.bytes = seg.bytes.subspan(nbytes);
+        break;
+      }
+      nbytes -= seg.size();
+      seg.owner.reset();
+      ++head_;
+    }
+
+    if (head_ * 2 >= segments_.size()) { // amortized O(1) per retired segment
+      segments_.erase(segments_.begin(), segments_.begin() + static_cast<std::ptrdiff_t>(head_));
+      head_ = 0;
+    }
+  }
+
+  void clear() noexcept
+  {
+    segments_.clear();
+    head_  = 0;
+    bytes_ = 0;
+  }
+};
+
+// MSG_ZEROCOPY bookkeeping for one socket. The kernel numbers successful zerocopy sendmsg() calls
+// 0, 1, 2, ... and later reports finished ranges [lo, hi] on the error queue; until then the
+// pages backing each send must not be freed or modified.
+class ZeroCopyTracker {
+  struct InFlight {
+    std::uint32_t               seq;
+    std::shared_ptr<const void> owner;
+  };
+
+  // in_flight_[head_..] are unfinished; the released prefix is dropped like TxQueue's
+  std::vector<InFlight> in_flight_;
+  std::size_t           head_     = 0;
+  std::uint32_t         next_seq_ = 0;
+
+public:
+  [[nodiscard]] bool idle() const noexcept { return head_ == in_flight_.size(); }
+
+  // entries held, released ones not yet dropped included
+  [[nodiscard]] std::size_t slots() const noexcept { return in_flight_.size(); }
+
+  // call once per successful sendmsg(MSG_ZEROCOPY)
+  void on_send(std::shared_ptr<const void> owner)
+  {
+    in_flight_.push_back(InFlight{next_seq_++, std::move(owner)});
+  }
+
+  // Release every send numbered up to and including hi. Returns the number released.
+  std::size_t on_completion(std::uint32_t hi) noexcept
+  {
+    std::size_t nreleased = 0;
+
+    // sequence numbers wrap at 2^32; compare by signed distance
+    while (!idle() && static_cast<std::int32_t>(hi - in_flight_[head_].seq) >= 0) {
+      in_flight_[head_].owner.reset();
+      ++head_;
+      ++nreleased;
+    }
+
+    if (head_ * 2 >= in_flight_.size()) {
+      in_flight_.erase(in_flight_.begin(), in_flight_.begin() + static_cast<std::ptrdiff_t>(head_));
+      head_ = 0;
+    }
+
+    return nreleased;
+  }
+
+  // Forget everything (socket closed). Sequence numbering restarts with the next socket.
+  void reset() noexcept
+  {
+    in_flight_.clear();
+    head_     = 0;
+    next_seq_ = 0;
+  }
+};
+
+} // namespace tskv::net
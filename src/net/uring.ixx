@@ -0,0 +1,321 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.net.uring
+// Summary: minimal io_uring bindings on raw syscalls (no liburing)
+//
+//  - IoUring owns the ring fd and the mmap'd SQ/CQ rings
+//    * get_sqe() hands out zeroed SQEs; nothing reaches the kernel until submit*()
+//    * submit_and_wait() publishes every queued SQE in a single io_uring_enter
+//    * for_each_cqe() visits all ready completions, then releases them in one head store
+//  - ProvidedBufferRing is a registered group of equally sized receive buffers
+//    * the kernel picks a buffer per completion (IOSQE_BUFFER_SELECT)
+//    * buffers are handed back with recycle() once the bytes have been consumed
+//  - single-issuer: neither type is thread-safe
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <span>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "tskv/common/logging.hpp"
+
+export module tskv.net.uring;
+
+import tskv.common.logging;
+
+inline int sys_io_uring_setup(unsigned entries, io_uring_params* params)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+inline int sys_io_uring_enter(
+  int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+  return static_cast<int>(
+    ::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+inline int sys_io_uring_register(int ring_fd, unsigned opcode, const void* arg, unsigned nr_args)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+template <typename T>
+inline T load_acquire(const T* p) noexcept
+{
+  return std::atomic_ref<const T>(*p).load(std::memory_order_acquire);
+}
+
+template <typename T>
+inline void store_release(T* p, T v) noexcept
+{
+  std::atomic_ref<T>(*p).store(v, std::memory_order_release);
+}
+
+export namespace tskv::net {
+
+class ProvidedBufferRing {
+  io_uring_buf_ring* ring_     = nullptr;
+  std::byte*         bufs_     = nullptr;
+  std::size_t        map_size_ = 0;
+  std::uint32_t      nbufs_    = 0;
+  std::uint32_t      buf_size_ = 0;
+  std::uint16_t      tail_     = 0;
+
+public:
+  // CONTRACT: nbufs is a power of two <= 32768
+  ProvidedBufferRing(std::uint32_t nbufs, std::uint32_t buf_size)
+    : nbufs_(nbufs), buf_size_(buf_size)
+  {
+    TSKV_DEMAND(nbufs != 0 && (nbufs & (nbufs - 1)) == 0 && nbufs <= 32768,
+      "provided buffer count must be a power of two <= 32768 (got {})",
+      nbufs);
+
+    // ring entries first (page aligned by mmap), followed by the buffers themselves
+    const std::size_t ring_bytes = sizeof(io_uring_buf) * nbufs;
+    map_size_                    = ring_bytes + std::size_t{buf_size} * nbufs;
+
+    void* mem =
+      ::mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TSKV_DEMAND(mem != MAP_FAILED, "mmap for provided buffer ring failed: errno={}", errno);
+
+    ring_ = static_cast<io_uring_buf_ring*>(mem);
+    bufs_ = static_cast<std::byte*>(mem) + ring_bytes;
+
+    for (std::uint32_t bid = 0; bid < nbufs_; ++bid) {
+      stage(static_cast<std::uint16_t>(bid), static_cast<std::uint16_t>(bid));
+    }
+    tail_ = static_cast<std::uint16_t>(nbufs_);
+    store_release(&ring_->tail, tail_);
+  }
+
+  ~ProvidedBufferRing()
+  {
+    if (ring_ != nullptr) {
+      ::munmap(ring_, map_size_);
+    }
+  }
+
+  ProvidedBufferRing(const ProvidedBufferRing&)            = delete;
+  ProvidedBufferRing& operator=(const ProvidedBufferRing&) = delete;
+
+  [[nodiscard]] io_uring_buf_ring* ring() const noexcept { return ring_; }
+  [[nodiscard]] std::uint32_t      size() const noexcept { return nbufs_; }
+
+  [[nodiscard]] std::span<const std::byte> buffer(std::uint16_t bid, std::size_t len) const noexcept
+  {
+    return {bufs_ + std::size_t{bid} * buf_size_, len};
+  }
+
+  // Give buffer `bid` back to the kernel.
+  void recycle(std::uint16_t bid) noexcept
+  {
+    stage(tail_, bid);
+    store_release(&ring_->tail, ++tail_);
+  }
+
+private:
+  void stage(std::uint16_t slot, std::uint16_t bid) noexcept
+  {
+    // NOTE: not ring_->bufs[]: in C++ the empty struct inside __DECLARE_FLEX_ARRAY has size 1,
+    //       which shifts that member by 8 bytes relative to the kernel's layout
+    io_uring_buf& buf = reinterpret_cast<io_uring_buf*>(ring_)[slot & (nbufs_ - 1)];
+    buf.addr          = reinterpret_cast<std::uint64_t>(bufs_ + std::size_t{bid} * buf_size_);
+    buf.len           = buf_size_;
+    buf.bid           = bid;
+  }
+};
+
+class IoUring {
+  int ring_fd_ = -1;
+
+  void*       sq_map_      = MAP_FAILED;
+  std::size_t sq_map_size_ = 0;
+  void*       cq_map_      = MAP_FAILED;
+  std::size_t cq_map_size_ = 0;
+
+  io_uring_sqe* sqes_           = nullptr;
+  std::size_t   sqes_map_size_ = 0;
+
+  unsigned* sq_head_    = nullptr;
+  unsigned* sq_tail_    = nullptr;
+  unsigned  sq_mask_    = 0;
+  unsigned  sq_entries_ = 0;
+
+  unsigned*     cq_head_ = nullptr;
+  unsigned*     cq_tail_ = nullptr;
+  unsigned      cq_mask_ = 0;
+  io_uring_cqe* cqes_    = nullptr;
+
+  unsigned sqe_tail_      = 0; // SQEs handed out by get_sqe()
+  unsigned sqe_submitted_ = 0; // SQEs already published to the kernel
+
+public:
+  explicit IoUring(unsigned entries)
+  {
+    io_uring_params params{};
+    params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER;
+
+    ring_fd_ = sys_io_uring_setup(entries, &params);
+    if (ring_fd_ < 0 && errno == EINVAL) { // older kernel, retry without the optional flags
+      params   = io_uring_params{};
+      ring_fd_ = sys_io_uring_setup(entries, &params);
+    }
+    TSKV_DEMAND(ring_fd_ >= 0, "io_uring_setup failed: errno={}", errno);
+
+    sq_map_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_map_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_map_size_ = cq_map_size_ = std::max(sq_map_size_, cq_map_size_);
+    }
+
+    sq_map_ = ::mmap(nullptr,
+      sq_map_size_,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      ring_fd_,
+      IORING_OFF_SQ_RING);
+    TSKV_DEMAND(sq_map_ != MAP_FAILED, "mmap of io_uring SQ ring failed: errno={}", errno);
+
+    if (single_mmap) {
+      cq_map_ = sq_map_;
+    }
+    else {
+      cq_map_ = ::mmap(nullptr,
+        cq_map_size_,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        ring_fd_,
+        IORING_OFF_CQ_RING);
+      TSKV_DEMAND(cq_map_ != MAP_FAILED, "mmap of io_uring CQ ring failed: errno={}", errno);
+    }
+
+    sqes_map_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes     = ::mmap(nullptr,
+      sqes_map_size_,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      ring_fd_,
+      IORING_OFF_SQES);
+    TSKV_DEMAND(sqes != MAP_FAILED, "mmap of io_uring SQEs failed: errno={}", errno);
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    auto* sq    = static_cast<std::byte*>(sq_map_);
+    sq_head_    = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_    = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_    = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+
+    // identity mapping: SQE slot i always lives at index i of the indirection array
+    auto* sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sq_entries_; ++i) {
+      sq_array[i] = i;
+    }
+
+    auto* cq = static_cast<std::byte*>(cq_map_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_    = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    sqe_tail_ = sqe_submitted_ = *sq_tail_;
+  }
+
+  ~IoUring()
+  {
+    if (sqes_ != nullptr) {
+      ::munmap(sqes_, sqes_map_size_);
+    }
+    if (cq_map_ != MAP_FAILED && cq_map_ != sq_map_) {
+      ::munmap(cq_map_, cq_map_size_);
+    }
+    if (sq_map_ != MAP_FAILED) {
+      ::munmap(sq_map_, sq_map_size_);
+    }
+    if (ring_fd_ != -1) {
+      ::close(ring_fd_);
+    }
+  }
+
+  IoUring(const IoUring&)            = delete;
+  IoUring& operator=(const IoUring&) = delete;
+
+  // Returns a zeroed SQE, flushing queued SQEs to the kernel first if the SQ is full.
+  [[nodiscard]] io_uring_sqe* get_sqe() noexcept
+  {
+    if (sqe_tail_ - load_acquire(sq_head_) >= sq_entries_) [[unlikely]] {
+      (void)submit_and_wait(0);
+      if (sqe_tail_ - load_acquire(sq_head_) >= sq_entries_) {
+        return nullptr;
+      }
+    }
+
+    io_uring_sqe* sqe = &sqes_[sqe_tail_ & sq_mask_];
+    std::memset(sqe, 0, sizeof *sqe);
+    ++sqe_tail_;
+    return sqe;
+  }
+
+  // Publishes all queued SQEs and blocks until at least `wait_nr` completions are ready.
+  // Returns the number of SQEs consumed by the kernel, or -errno.
+  int submit_and_wait(unsigned wait_nr) noexcept
+  {
+    const unsigned to_submit = sqe_tail_ - sqe_submitted_;
+    store_release(sq_tail_, sqe_tail_);
+
+    const unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0u;
+
+    int rc;
+    do {
+      rc = sys_io_uring_enter(ring_fd_, to_submit, wait_nr, flags);
+    } while (rc == -1 && errno == EINTR);
+
+    if (rc < 0) {
+      return -errno;
+    }
+
+    sqe_submitted_ += static_cast<unsigned>(rc);
+    return rc;
+  }
+
+  // Calls fn(const io_uring_cqe&) for every ready completion, then releases them.
+  template <typename Fn>
+  unsigned for_each_cqe(Fn&& fn)
+  {
+    unsigned       head = *cq_head_;
+    const unsigned tail = load_acquire(cq_tail_);
+
+    const unsigned count = tail - head;
+
+    for (; head != tail; ++head) {
+      fn(cqes_[head & cq_mask_]);
+    }
+
+    store_release(cq_head_, head);
+    return count;
+  }
+
+  void register_buffer_ring(const ProvidedBufferRing& bufs, std::uint16_t group_id)
+  {
+    io_uring_buf_reg reg{};
+    reg.ring_addr    = reinterpret_cast<std::uint64_t>(bufs.ring());
+    reg.ring_entries = bufs.size();
+    reg.bgid         = group_id;
+
+    const int rc = sys_io_uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1);
+    TSKV_DEMAND(rc == 0, "IORING_REGISTER_PBUF_RING failed: errno={}", errno);
+  }
+};
+
+} // namespace tskv::net
@@ -0,0 +1,1078 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.net.uring_reactor
+// Summary: io_uring backend implementing the same contract as tskv.net.reactor
+//
+//  - one multishot accept per listener (TCP, plus AF_UNIX with --unix-socket); one multishot
+//    recv per connection
+//    * received bytes land in a shared ProvidedBufferRing and are copied into the
+//      Channel's RX via Channel::deliver_rx()
+//    * bytes the protocol could not take yet stay parked in their ring buffer until
+//      TX drains, and recv is not re-armed while anything is parked (bounded memory)
+//    * a recv that finds the ring empty (-ENOBUFS) is not re-armed until a buffer comes back;
+//      each recycled buffer re-arms the connection that has waited longest
+//    * at capacity both accepts are cancelled and the kernel backlog holds new connections until
+//      a close makes room (like the epoll Reactor pausing its listeners)
+//  - sends are collected while processing a batch of completions and submitted together
+//    with the next io_uring_enter; at most one send is in flight per connection
+//  - a protocol that yields with TX empty (Channel::refill_pending) has no completion coming to
+//    resume it, so it goes on a ready list serviced once per loop, which then does not block
+//  - user_data packs (op, generation, fd); the generation rejects completions that
+//    belong to a previous connection on a reused fd
+//  - a connection is closed only once none of its operations are in flight
+//  - worker responses arrive through a CompletionQueue whose eventfd is watched with a multishot
+//    poll, and are sent with the rest of the batch
+//  - idle timeouts, request deadlines and the periodic metrics flush run on a TimerWheel, like the
+//    epoll Reactor's; a single absolute IORING_OP_TIMEOUT stands in for its timerfd
+//------------------------------------------------------------------------------
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <linux/io_uring.h>
+#include <optional>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "tskv/common/logging.hpp"
+
+export module tskv.net.uring_reactor;
+
+import tskv.common.logging;
+import tskv.common.metrics;
+import tskv.common.time;
+import tskv.net.channel;
+import tskv.net.completion_queue;
+import tskv.net.server;
+import tskv.net.socket;
+import tskv.net.timer_wheel;
+import tskv.net.uring;
+
+namespace tc      = tskv::common;
+namespace metrics = tskv::common::metrics;
+
+using namespace std::chrono_literals;
+
+export namespace tskv::net {
+
+template <Protocol Proto>
+class UringReactor {
+  static constexpr unsigned      RING_ENTRIES   = 4096;
+  static constexpr std::uint32_t RECV_BUF_COUNT = 4096;
+  static constexpr std::uint32_t RECV_BUF_SIZE  = 4096;
+  static constexpr std::uint16_t RECV_GROUP_ID  = 0;
+
+  enum class Op : std::uint8_t {
+    Accept = 1,
+    Recv,
+    Send,
+    Cancel,
+    Wakeup,
+    Signal,
+    Completion,
+    Timer,
+  };
+
+  static constexpr std::uint64_t pack(Op op, std::uint32_t gen, int fd) noexcept
+  {
+    return (std::uint64_t(op) << 56) | (std::uint64_t(gen & 0xFFFFFF) << 32) |
+           std::uint64_t(std::uint32_t(fd));
+  }
+
+  static constexpr Op unpack_op(std::uint64_t ud) noexcept { return Op(ud >> 56); }
+  static constexpr std::uint32_t unpack_gen(std::uint64_t ud) noexcept
+  {
+    return std::uint32_t(ud >> 32) & 0xFFFFFF;
+  }
+  static constexpr int unpack_fd(std::uint64_t ud) noexcept { return int(std::uint32_t(ud)); }
+
+  // received bytes still sitting in provided buffer `bid`, waiting for the channel to take them
+  struct ParkedRx {
+    std::uint16_t bid;
+    std::uint32_t offset;
+    std::uint32_t len;
+  };
+
+  // per-fd completion bookkeeping (the Channel itself lives in the ChannelPool)
+  struct Conn {
+    std::uint32_t         gen           = 0;
+    bool                  recv_armed    = false;
+    bool                  send_inflight = false;
+    bool                  tx_dirty      = false;
+    bool                  closing       = false;
+    bool                  nobufs_wait   = false; // on nobufs_waiters_, recv not re-armed
+    std::vector<ParkedRx> parked;
+  };
+
+  // NOTE: declared before ring_ so the ring is torn down first
+  ProvidedBufferRing recv_bufs_{RECV_BUF_COUNT, RECV_BUF_SIZE};
+  IoUring            ring_{RING_ENTRIES};
+
+  // Provided buffers handed to us by recv completions and not yet recycled; while all of them
+  // are, the ring is empty and a recv failing with -ENOBUFS waits (by event tag) for one back.
+  std::uint32_t             recv_bufs_held_ = 0;
+  std::deque<std::uint64_t> nobufs_waiters_;
+
+  ChannelPool<Proto> pool_;
+  std::vector<Conn>  conns_; // indexed by fd
+  std::vector<int>   tx_dirty_;
+  std::size_t        max_channels_ = 0;
+  CompletionQueue    completions_;
+
+  // event tags of channels that yielded with TX empty (Channel::refill_pending), refilled next turn
+  std::vector<std::uint64_t> ready_;
+  std::vector<std::uint64_t> ready_servicing_;
+
+  SocketProfile socket_profile_; // applied to every accepted socket
+  bool          socket_profile_warned_ = false;
+
+  // Timeouts live on one TimerWheel counting 1 ms ticks since clock_epoch_ (CLOCK_MONOTONIC), as
+  // on the epoll Reactor. One absolute IORING_OP_TIMEOUT is in flight while any timer is armed;
+  // it is moved earlier in place (IORING_TIMEOUT_UPDATE) and re-submitted once it has fired.
+  enum class TimerKind : std::uint8_t { Idle, Deadline, MetricsFlush };
+
+  static constexpr std::uint64_t TIMER_NOT_ARMED     = UINT64_MAX;
+  static constexpr std::uint64_t METRICS_FLUSH_TICKS = 1000;
+
+  TimerWheel               timers_;
+  Timer                    metrics_timer_;
+  std::chrono::nanoseconds clock_epoch_{};
+  std::uint64_t            loop_ns_            = 0; // sampled once per poll_once()
+  std::uint64_t            loop_tick_          = 0; // loop_ns_ in ticks
+  std::uint64_t            timer_armed_tick_   = TIMER_NOT_ARMED;
+  std::uint64_t            idle_timeout_ticks_ = 0; // 0: connections never time out
+  __kernel_timespec        timer_ts_{};             // expiry of the in-flight IORING_OP_TIMEOUT
+
+  // Admission control: at most max_channels_ connections. The multishot accepts are cancelled when
+  // the pool fills and re-armed, under a new generation, once a close makes room; completions of
+  // an older generation never re-arm. Connections accepted before a cancellation lands are closed.
+  bool          accept_paused_ = false;
+  std::uint32_t accept_gen_    = 0;
+
+  int         listener_fd_      = -1;
+  int         unix_listener_fd_ = -1;
+  std::string unix_socket_path_; // unlinked when the unix listener closes
+
+  int  wakeup_fd_     = -1;
+  int  signal_fd_     = -1;
+  bool shutting_down_ = false;
+
+  std::atomic<bool> shutdown_notified_{false};
+
+  UringReactor(const UringReactor&)            = delete;
+  UringReactor& operator=(const UringReactor&) = delete;
+
+  [[nodiscard]] io_uring_sqe* next_sqe() noexcept
+  {
+    io_uring_sqe* sqe = ring_.get_sqe();
+    TSKV_DEMAND(sqe != nullptr, "io_uring submission queue exhausted");
+    return sqe;
+  }
+
+  Conn& conn(int fd)
+  {
+    if (static_cast<std::size_t>(fd) >= conns_.size()) [[unlikely]] {
+      conns_.resize(static_cast<std::size_t>(fd) + 1);
+    }
+    return conns_[static_cast<std::size_t>(fd)];
+  }
+
+  void arm_accept(int listen_fd) noexcept;
+  void arm_poll(int fd, Op op) noexcept;
+  void arm_recv(int fd, Conn& c) noexcept;
+  void recycle_recv_buf(std::uint16_t bid) noexcept;
+  void queue_sends() noexcept;
+  void mark_tx_dirty(int fd, Conn& c) noexcept;
+
+  void on_cqe(const io_uring_cqe& cqe) noexcept;
+  void on_accept(const io_uring_cqe& cqe) noexcept;
+  void on_recv(int fd, Conn& c, const io_uring_cqe& cqe) noexcept;
+  void on_send(int fd, Conn& c, const io_uring_cqe& cqe) noexcept;
+  void on_wakeup_event() noexcept;
+  void on_signal_event() noexcept;
+  void on_completion_event() noexcept;
+
+  void deliver_parked(Channel<Proto>* channel, Conn& c) noexcept;
+  void after_io(int fd, Conn& c, Channel<Proto>* channel) noexcept;
+  void service_ready_list() noexcept;
+  void begin_close(int fd, Conn& c) noexcept;
+  void maybe_finalize_close(int fd, Conn& c) noexcept;
+  void close_listeners() noexcept;
+  void cancel_accept(int listen_fd) noexcept;
+  void set_accept_paused(bool paused) noexcept;
+
+  [[nodiscard]] std::uint64_t read_clock_ns() const noexcept;
+  void                        run_timers() noexcept;
+  void                        on_timer_expired(Timer& timer) noexcept;
+  void                        arm_timer() noexcept;
+  void                        on_timer_cqe(const io_uring_cqe& cqe) noexcept;
+
+public:
+  // handle_signals: see Reactor
+  UringReactor(const ServerConfig& config, bool handle_signals = true);
+  ~UringReactor();
+
+  void poll_once() noexcept;
+  void run();
+  void request_shutdown() noexcept;
+
+  // Thread-safe: may be called from any thread to make this reactor begin its shutdown sequence.
+  void notify_shutdown() noexcept;
+
+  // Thread-safe to post to from any thread.
+  [[nodiscard]] CompletionQueue& completions() noexcept { return completions_; }
+};
+
+template <Protocol Proto>
+UringReactor<Proto>::UringReactor(const ServerConfig& config, bool handle_signals)
+{
+  ring_.register_buffer_ring(recv_bufs_, RECV_GROUP_ID);
+
+  max_channels_ = config.max_connections_per_reactor();
+  pool_.reserve_channels(max_channels_);
+  conns_.reserve(max_channels_);
+
+  idle_timeout_ticks_ = config.idle_timeout_ms;
+
+  { // listener
+    const bool reuse_port = config.io_threads > 1;
+    socket_profile_       = config.socket;
+    listener_fd_          =
+      start_listener(config.host.c_str(), config.port, reuse_port, config.socket);
+    TSKV_DEMAND(listener_fd_ != -1, "failed to bind/listen on {}:{}", config.host, config.port);
+    TSKV_LOG_INFO("listener_fd = {}", listener_fd_);
+    arm_accept(listener_fd_);
+  }
+
+  if (!config.unix_socket.empty()) { // unix listener
+    unix_socket_path_ = config.unix_socket.string();
+    unix_listener_fd_ = start_unix_listener(unix_socket_path_.c_str(), config.socket);
+    TSKV_DEMAND(
+      unix_listener_fd_ != -1, "failed to bind/listen on unix socket {}", unix_socket_path_);
+    TSKV_LOG_INFO("unix listener_fd = {}", unix_listener_fd_);
+    arm_accept(unix_listener_fd_);
+  }
+
+  { // wakeup
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    TSKV_DEMAND(wakeup_fd_ != -1, "eventfd failed");
+    arm_poll(wakeup_fd_, Op::Wakeup);
+  }
+
+  { // completions
+    arm_poll(completions_.wakeup_fd(), Op::Completion);
+    pool_.set_completion_queue(&completions_);
+  }
+
+  { // timers
+    timespec ts;
+    TSKV_DEMAND(clock_gettime(CLOCK_MONOTONIC, &ts) == 0, "clock_gettime failed");
+    clock_epoch_ = std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+
+    metrics_timer_.kind = static_cast<std::uint8_t>(TimerKind::MetricsFlush);
+    timers_.schedule(metrics_timer_, METRICS_FLUSH_TICKS);
+    arm_timer();
+  }
+
+  if (handle_signals) { // signals
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+    signal_fd_ = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    TSKV_DEMAND(signal_fd_ != -1, "signalfd failed");
+    arm_poll(signal_fd_, Op::Signal);
+  }
+
+  const int rc = ring_.submit_and_wait(0);
+  TSKV_DEMAND(rc >= 0, "initial io_uring submit failed: errno={}", -rc);
+}
+
+template <Protocol Proto>
+UringReactor<Proto>::~UringReactor()
+{
+  close_listeners();
+
+  timers_.cancel(metrics_timer_);
+
+  if (wakeup_fd_ != -1) {
+    ::close(wakeup_fd_);
+  }
+
+  if (signal_fd_ != -1) {
+    ::close(signal_fd_);
+  }
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::arm_accept(int listen_fd) noexcept
+{
+  io_uring_sqe* sqe = next_sqe();
+  sqe->opcode       = IORING_OP_ACCEPT;
+  sqe->fd           = listen_fd;
+  sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+  sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+  sqe->user_data    = pack(Op::Accept, accept_gen_, listen_fd);
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::cancel_accept(int listen_fd) noexcept
+{
+  io_uring_sqe* sqe = next_sqe();
+  sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+  sqe->addr         = pack(Op::Accept, accept_gen_, listen_fd);
+  sqe->user_data    = pack(Op::Cancel, 0, listen_fd);
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::arm_poll(int fd, Op op) noexcept
+{
+  io_uring_sqe* sqe  = next_sqe();
+  sqe->opcode        = IORING_OP_POLL_ADD;
+  sqe->fd            = fd;
+  sqe->len           = IORING_POLL_ADD_MULTI;
+  sqe->poll32_events = POLLIN;
+  sqe->user_data     = pack(op, 0, fd);
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::arm_recv(int fd, Conn& c) noexcept
+{
+  io_uring_sqe* sqe = next_sqe();
+  sqe->opcode       = IORING_OP_RECV;
+  sqe->fd           = fd;
+  sqe->ioprio       = IORING_RECV_MULTISHOT;
+  sqe->flags        = IOSQE_BUFFER_SELECT;
+  sqe->buf_group    = RECV_GROUP_ID;
+  sqe->user_data    = pack(Op::Recv, c.gen, fd);
+  c.recv_armed      = true;
+}
+
+// Gives buffer `bid` back to the ring, and a recv to the connection that has waited longest for
+// one, if any.
+template <Protocol Proto>
+void UringReactor<Proto>::recycle_recv_buf(std::uint16_t bid) noexcept
+{
+  recv_bufs_.recycle(bid);
+  --recv_bufs_held_;
+
+  while (!nobufs_waiters_.empty()) {
+    Channel<Proto>* channel = pool_.lookup_tagged(nobufs_waiters_.front());
+    nobufs_waiters_.pop_front();
+    if (channel == nullptr) {
+      continue; // closed while it waited
+    }
+
+    const int fd = channel->fd();
+    Conn&     c  = conns_[static_cast<std::size_t>(fd)];
+
+    c.nobufs_wait = false;
+    if (!c.closing && !c.recv_armed && c.parked.empty() &&
+        (channel->desired_events() & EPOLLIN) != 0) {
+      arm_recv(fd, c);
+      return;
+    }
+  }
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::mark_tx_dirty(int fd, Conn& c) noexcept
+{
+  if (!c.tx_dirty) {
+    c.tx_dirty = true;
+    tx_dirty_.push_back(fd);
+  }
+}
+
+// One SEND per connection with pending TX, all submitted by the next io_uring_enter.
+template <Protocol Proto>
+void UringReactor<Proto>::queue_sends() noexcept
+{
+  for (const int fd : tx_dirty_) {
+    Conn& c    = conns_[static_cast<std::size_t>(fd)];
+    c.tx_dirty = false;
+
+    Channel<Proto>* channel = pool_.lookup(fd);
+    if (channel == nullptr || c.send_inflight || c.closing) {
+      continue;
+    }
+
+    const std::span<const std::byte> tx = channel->tx_pending();
+    if (tx.empty()) {
+      continue;
+    }
+
+    io_uring_sqe* sqe = next_sqe();
+    sqe->opcode       = IORING_OP_SEND;
+    sqe->fd           = fd;
+    sqe->addr         = reinterpret_cast<std::uint64_t>(tx.data());
+    sqe->len          = static_cast<std::uint32_t>(tx.size());
+    sqe->msg_flags    = MSG_NOSIGNAL;
+    sqe->user_data    = pack(Op::Send, c.gen, fd);
+    c.send_inflight   = true;
+  }
+
+  tx_dirty_.clear();
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::close_listeners() noexcept
+{
+  for (int* fd : {&listener_fd_, &unix_listener_fd_}) {
+    if (*fd == -1) {
+      continue;
+    }
+
+    // the in-flight multishot accept holds its own file reference; cancel it explicitly
+    if (!accept_paused_) {
+      cancel_accept(*fd);
+    }
+
+    ::close(*fd);
+    *fd = -1;
+  }
+
+  if (!unix_socket_path_.empty()) {
+    (void)::unlink(unix_socket_path_.c_str());
+    unix_socket_path_.clear();
+  }
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::set_accept_paused(bool paused) noexcept
+{
+  if (accept_paused_ == paused || listener_fd_ == -1) {
+    return;
+  }
+
+  if (!paused) {
+    ++accept_gen_; // whatever the cancelled accepts still complete with must not re-arm them
+  }
+
+  for (const int fd : {listener_fd_, unix_listener_fd_}) {
+    if (fd == -1) {
+      continue;
+    }
+    if (paused) {
+      cancel_accept(fd);
+    }
+    else {
+      arm_accept(fd);
+    }
+  }
+
+  accept_paused_ = paused;
+
+  if (paused) {
+    TSKV_LOG_INFO("at capacity ({} connections), pausing accepts", pool_.size());
+    metrics::inc_counter<"net.listener_pauses">();
+  }
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::request_shutdown() noexcept
+{
+  if (shutting_down_) {
+    return;
+  }
+
+  TSKV_LOG_INFO("Shutdown requested...");
+
+  shutting_down_ = true;
+
+  // 1) stop accepting new connections
+  close_listeners();
+
+  // 2) flip all running channels to Draining (stop reading, flush any pending TX)
+  pool_.for_each_in(ChannelState::Running, [](auto* ch) { ch->begin_shutdown(); });
+
+  thread_local std::vector<int> fds_to_close;
+  fds_to_close.clear();
+
+  const auto collect = [&](auto* ch) {
+    if (ch->should_close()) {
+      fds_to_close.push_back(ch->fd());
+    }
+  };
+  pool_.for_each_in(ChannelState::Draining, collect);
+  pool_.for_each_in(ChannelState::Aborting, collect);
+
+  // 3) close already-finished sockets now
+  for (const int fd : fds_to_close) {
+    begin_close(fd, conns_[static_cast<std::size_t>(fd)]);
+  }
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::notify_shutdown() noexcept
+{
+  shutdown_notified_.store(true, std::memory_order_release);
+
+  uint64_t one = 1;
+  (void)::write(wakeup_fd_, &one, sizeof one);
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::on_wakeup_event() noexcept
+{
+  uint64_t tmp;
+  while (::read(wakeup_fd_, &tmp, sizeof tmp) == sizeof tmp)
+    continue; // drain
+
+  if (shutdown_notified_.load(std::memory_order_acquire)) {
+    request_shutdown();
+  }
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::on_signal_event() noexcept
+{
+  signalfd_siginfo si;
+  while (::read(signal_fd_, &si, sizeof si) == sizeof si) {
+    // Treat SIGINT/SIGTERM as shutdown
+    request_shutdown();
+  }
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::on_completion_event() noexcept
+{
+  const std::size_t ncompleted = completions_.drain([this](Completion& completion) {
+    Channel<Proto>* channel = pool_.lookup_tagged(completion.tag);
+    if (channel == nullptr) {
+      metrics::inc_counter<"net.stale_completions">(); // connection closed while it waited
+      return;
+    }
+
+    channel->deliver_completion(std::move(completion.payload));
+
+    const int fd = channel->fd();
+    Conn&     c  = conns_[static_cast<std::size_t>(fd)];
+    if (!c.closing) {
+      after_io(fd, c, channel);
+    }
+  });
+
+  if (ncompleted > 0) {
+    metrics::inc_counter<"net.completion_batches">();
+    metrics::add_counter<"net.completions">(ncompleted);
+  }
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::begin_close(int fd, Conn& c) noexcept
+{
+  if (c.closing) {
+    return;
+  }
+  c.closing = true;
+
+  if (Channel<Proto>* channel = pool_.lookup(fd); channel != nullptr) {
+    timers_.cancel(channel->idle_timer());
+    timers_.cancel(channel->deadline_timer());
+  }
+
+  if (c.recv_armed) {
+    io_uring_sqe* sqe = next_sqe();
+    sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+    sqe->addr         = pack(Op::Recv, c.gen, fd);
+    sqe->user_data    = pack(Op::Cancel, c.gen, fd);
+  }
+
+  maybe_finalize_close(fd, c);
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::maybe_finalize_close(int fd, Conn& c) noexcept
+{
+  if (!c.closing || c.recv_armed || c.send_inflight) {
+    return; // wait for the remaining completions
+  }
+
+  for (const ParkedRx& p : c.parked) {
+    recycle_recv_buf(p.bid);
+  }
+  c.parked.clear();
+  c.closing     = false;
+  c.nobufs_wait = false; // its entry on nobufs_waiters_ is stale now
+  ++c.gen;
+
+  Channel<Proto>* channel = pool_.lookup(fd);
+  channel->notify_close();
+  channel->detach();
+  pool_.release(fd);
+
+  ::close(fd);
+
+  TSKV_LOG_INFO("closed client_fd = {}", fd);
+
+  if (accept_paused_ && pool_.size() < max_channels_) {
+    set_accept_paused(false);
+  }
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::after_io(int fd, Conn& c, Channel<Proto>* channel) noexcept
+{
+  if (channel->should_close()) {
+    begin_close(fd, c);
+    return;
+  }
+
+  if (const auto deadline = channel->take_deadline_request(); deadline.has_value()) {
+    Timer& timer = channel->deadline_timer();
+    if (*deadline > 0ms) {
+      timer.kind   = static_cast<std::uint8_t>(TimerKind::Deadline);
+      timer.cookie = pool_.event_tag(fd);
+      timers_.schedule(timer, loop_tick_ + static_cast<std::uint64_t>(deadline->count()));
+    }
+    else {
+      timers_.cancel(timer);
+    }
+  }
+
+  if (!channel->tx_pending().empty()) {
+    mark_tx_dirty(fd, c);
+  }
+  else if (channel->refill_pending() && !channel->is_ready_queued()) {
+    channel->set_ready_queued(true);
+    ready_.push_back(pool_.event_tag(fd));
+  }
+
+  const bool wants_rx = (channel->desired_events() & EPOLLIN) != 0;
+  if (!c.recv_armed && c.parked.empty() && !c.nobufs_wait && wants_rx) {
+    arm_recv(fd, c);
+  }
+}
+
+// One refill per queued channel; channels yielding again rejoin at the back of ready_.
+template <Protocol Proto>
+void UringReactor<Proto>::service_ready_list() noexcept
+{
+  ready_servicing_.swap(ready_);
+
+  for (const std::uint64_t tag : ready_servicing_) {
+    Channel<Proto>* channel = pool_.lookup_tagged(tag);
+    if (channel == nullptr) {
+      continue; // closed since it was queued
+    }
+
+    channel->set_ready_queued(false);
+
+    const int fd = channel->fd();
+    Conn&     c  = conns_[static_cast<std::size_t>(fd)];
+    if (c.closing) {
+      continue;
+    }
+    deliver_parked(channel, c); // ends in deliver_rx(), which refills TX
+    after_io(fd, c, channel);
+  }
+
+  ready_servicing_.clear();
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::deliver_parked(Channel<Proto>* channel, Conn& c) noexcept
+{
+  std::size_t ndone = 0;
+
+  for (ParkedRx& p : c.parked) {
+    const std::span<const std::byte> data = recv_bufs_.buffer(p.bid, p.offset + p.len);
+    const std::size_t                n    = channel->deliver_rx(data.subspan(p.offset));
+
+    if (n < p.len) {
+      p.offset += static_cast<std::uint32_t>(n);
+      p.len -= static_cast<std::uint32_t>(n);
+      break;
+    }
+
+    recycle_recv_buf(p.bid);
+    ++ndone;
+  }
+
+  c.parked.erase(c.parked.begin(), c.parked.begin() + static_cast<std::ptrdiff_t>(ndone));
+
+  if (c.parked.empty()) {
+    (void)channel->deliver_rx({}); // let the protocol revisit whatever is still in RX
+  }
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::on_accept(const io_uring_cqe& cqe) noexcept
+{
+  const int  listen_fd = unpack_fd(cqe.user_data);
+  const bool is_unix   = listen_fd == unix_listener_fd_;
+  const bool current   = unpack_gen(cqe.user_data) == (accept_gen_ & 0xFFFFFF) && !accept_paused_;
+
+  if (!(cqe.flags & IORING_CQE_F_MORE) && current && (listen_fd == listener_fd_ || is_unix)) {
+    arm_accept(listen_fd);
+  }
+
+  if (cqe.res < 0) {
+    if (cqe.res == -ECANCELED) {
+      return;
+    }
+
+    TSKV_LOG_WARN("failed to accept new channel: errno={}", -cqe.res);
+
+    switch (-cqe.res) {
+      case EMFILE:
+        metrics::inc_counter<"net.accept_error.emfile">();
+        break;
+      case ENFILE:
+        metrics::inc_counter<"net.accept_error.enfile">();
+        break;
+      case ENOBUFS:
+        metrics::inc_counter<"net.accept_error.enobufs">();
+        break;
+      default:
+        metrics::inc_counter<"net.accept_error.other">();
+        break;
+    }
+    return;
+  }
+
+  const int client_fd = cqe.res;
+
+  if (shutting_down_) { // raced with the accept cancellation
+    ::close(client_fd);
+    return;
+  }
+
+  // accepted before the cancellation took effect
+  if (pool_.size() >= max_channels_) {
+    ::close(client_fd);
+    metrics::inc_counter<"net.accept_shed">();
+    return;
+  }
+
+  // TCP options; meaningless for AF_UNIX
+  if (!is_unix && !apply_socket_profile(client_fd, socket_profile_) && !socket_profile_warned_) {
+    TSKV_LOG_WARN("some socket options were rejected on accepted connections (errno={})", errno);
+    socket_profile_warned_ = true;
+  }
+
+  Channel<Proto>* channel = pool_.acquire(client_fd);
+  channel->attach(client_fd);
+  channel->set_last_active_tick(loop_tick_);
+  if (idle_timeout_ticks_ != 0) {
+    Timer& idle = channel->idle_timer();
+    idle.kind   = static_cast<std::uint8_t>(TimerKind::Idle);
+    idle.cookie = pool_.event_tag(client_fd);
+    timers_.schedule(idle, loop_tick_ + idle_timeout_ticks_);
+  }
+  TSKV_LOG_INFO("added client_fd = {}", client_fd);
+
+  arm_recv(client_fd, conn(client_fd));
+
+  if (pool_.size() >= max_channels_) {
+    set_accept_paused(true);
+  }
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::on_recv(int fd, Conn& c, const io_uring_cqe& cqe) noexcept
+{
+  if (!(cqe.flags & IORING_CQE_F_MORE)) {
+    c.recv_armed = false;
+  }
+
+  Channel<Proto>* channel = pool_.lookup(fd);
+  channel->set_last_active_tick(loop_tick_);
+
+  if (cqe.res > 0) {
+    const auto bid = static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    const auto len = static_cast<std::uint32_t>(cqe.res);
+
+    if (c.closing) {
+      recycle_recv_buf(bid);
+    }
+    else if (!c.parked.empty()) {
+      c.parked.push_back({bid, 0, len}); // keep byte order behind what is already parked
+    }
+    else {
+      const std::size_t n = channel->deliver_rx(recv_bufs_.buffer(bid, len));
+      if (n < len) {
+        const auto taken = static_cast<std::uint32_t>(n);
+        c.parked.push_back({bid, taken, len - taken});
+      }
+      else {
+        recycle_recv_buf(bid);
+      }
+    }
+  }
+  else if (cqe.res == 0) {
+    channel->on_peer_eof();
+  }
+  else if (cqe.res == -ENOBUFS) {
+    metrics::inc_counter<"net.uring.recv_nobufs">();
+    // ring ran dry; re-arming now would only fail again. If a buffer came back since, it was too
+    // late for this recv but is there for the next, so after_io() re-arms right away.
+    if (!c.recv_armed && !c.closing && recv_bufs_held_ == RECV_BUF_COUNT) {
+      c.nobufs_wait = true;
+      nobufs_waiters_.push_back(pool_.event_tag(fd));
+    }
+  }
+  else if (cqe.res != -ECANCELED) {
+    channel->on_io_error(-cqe.res);
+  }
+
+  if (c.closing) {
+    maybe_finalize_close(fd, c);
+    return;
+  }
+
+  after_io(fd, c, channel);
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::on_send(int fd, Conn& c, const io_uring_cqe& cqe) noexcept
+{
+  c.send_inflight = false;
+
+  Channel<Proto>* channel = pool_.lookup(fd);
+  channel->set_last_active_tick(loop_tick_);
+
+  if (cqe.res >= 0) {
+    channel->tx_complete(static_cast<std::size_t>(cqe.res));
+    if (!c.closing) {
+      deliver_parked(channel, c);
+    }
+  }
+  else {
+    channel->on_io_error(-cqe.res);
+  }
+
+  if (c.closing) {
+    maybe_finalize_close(fd, c);
+    return;
+  }
+
+  after_io(fd, c, channel);
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::on_cqe(const io_uring_cqe& cqe) noexcept
+{
+  const Op  op = unpack_op(cqe.user_data);
+  const int fd = unpack_fd(cqe.user_data);
+
+  switch (op) {
+    case Op::Accept:
+      on_accept(cqe);
+      return;
+    case Op::Recv:
+    case Op::Send: {
+      if (cqe.flags & IORING_CQE_F_BUFFER) {
+        ++recv_bufs_held_;
+      }
+      Conn& c = conn(fd);
+      if (unpack_gen(cqe.user_data) != (c.gen & 0xFFFFFF)) [[unlikely]] {
+        // stale completion for a previous connection on this fd
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+          recycle_recv_buf(static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+        }
+        return;
+      }
+      if (op == Op::Recv) {
+        on_recv(fd, c, cqe);
+      }
+      else {
+        on_send(fd, c, cqe);
+      }
+      return;
+    }
+    case Op::Cancel:
+      return;
+    case Op::Wakeup:
+      on_wakeup_event();
+      if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        arm_poll(wakeup_fd_, Op::Wakeup);
+      }
+      return;
+    case Op::Signal:
+      on_signal_event();
+      if (!(cqe.flags & IORING_CQE_F_MORE) && signal_fd_ != -1) {
+        arm_poll(signal_fd_, Op::Signal);
+      }
+      return;
+    case Op::Completion:
+      on_completion_event();
+      if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        arm_poll(completions_.wakeup_fd(), Op::Completion);
+      }
+      return;
+    case Op::Timer:
+      on_timer_cqe(cqe);
+      return;
+  }
+
+  TSKV_LOG_WARN("unknown io_uring completion: user_data={}", cqe.user_data);
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::poll_once() noexcept
+{
+  queue_sends();
+
+  // blocks until a completion, unless a channel waits on the ready list; the in-flight
+  // IORING_OP_TIMEOUT bounds the wait
+  const int rc = ring_.submit_and_wait(ready_.empty() ? 1 : 0);
+  if (rc < 0 && rc != -EBUSY) [[unlikely]] {
+    TSKV_LOG_WARN("io_uring_enter failed: errno={}", -rc);
+  }
+
+  loop_ns_   = read_clock_ns();
+  loop_tick_ = loop_ns_ / 1'000'000;
+
+  ring_.for_each_cqe([this](const io_uring_cqe& cqe) { on_cqe(cqe); });
+
+  service_ready_list();
+  run_timers();
+}
+
+// nanoseconds since clock_epoch_
+template <Protocol Proto>
+std::uint64_t UringReactor<Proto>::read_clock_ns() const noexcept
+{
+  timespec ts;
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  const auto now = std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+  return static_cast<std::uint64_t>((now - clock_epoch_).count());
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::run_timers() noexcept
+{
+  timers_.advance(loop_tick_, [this](Timer& timer) { on_timer_expired(timer); });
+  arm_timer();
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::on_timer_expired(Timer& timer) noexcept
+{
+  if (static_cast<TimerKind>(timer.kind) == TimerKind::MetricsFlush) {
+    metrics::flush_thread(0ms);
+    timers_.schedule(metrics_timer_, loop_tick_ + METRICS_FLUSH_TICKS);
+    return;
+  }
+
+  Channel<Proto>* channel = pool_.lookup_tagged(timer.cookie);
+  if (channel == nullptr) [[unlikely]] {
+    return; // channel timers are cancelled on close, so this should not happen
+  }
+
+  const int fd = channel->fd();
+  Conn&     c  = conns_[static_cast<std::size_t>(fd)];
+
+  switch (static_cast<TimerKind>(timer.kind)) {
+    case TimerKind::Idle: {
+      // activity only stamps the channel; push the timer out lazily here instead
+      const std::uint64_t idle_until = channel->last_active_tick() + idle_timeout_ticks_;
+      if (idle_until > loop_tick_) {
+        timers_.schedule(timer, idle_until);
+        return;
+      }
+
+      TSKV_LOG_INFO("closing idle client_fd = {}", fd);
+      metrics::inc_counter<"net.idle_timeouts">();
+      channel->abort();
+      begin_close(fd, c);
+      break;
+    }
+    case TimerKind::Deadline:
+      metrics::inc_counter<"net.deadline_timeouts">();
+      channel->expire_deadline();
+      after_io(fd, c, channel);
+      break;
+    case TimerKind::MetricsFlush:
+      break;
+  }
+}
+
+// Keeps the in-flight IORING_OP_TIMEOUT at or before the wheel's next_due() tick. A timeout
+// already armed earlier is left alone (at most one spurious wakeup, as with the timerfd); one
+// armed later is moved with IORING_TIMEOUT_UPDATE. If that races with it firing, the update
+// fails with -ENOENT and the -ETIME completion, seen next, re-arms from scratch.
+template <Protocol Proto>
+void UringReactor<Proto>::arm_timer() noexcept
+{
+  const std::optional<std::uint64_t> due = timers_.next_due();
+  if (!due || (timer_armed_tick_ != TIMER_NOT_ARMED && *due >= timer_armed_tick_)) {
+    return; // an idle wheel lets the armed timeout, if any, fire once more for nothing
+  }
+
+  const timespec ts = tc::to_timespec(clock_epoch_ + std::chrono::milliseconds(*due));
+  timer_ts_.tv_sec  = ts.tv_sec;
+  timer_ts_.tv_nsec = ts.tv_nsec;
+
+  // absolute CLOCK_MONOTONIC expiry; the kernel copies timer_ts_ when it takes the SQE
+  io_uring_sqe* sqe = next_sqe();
+  if (timer_armed_tick_ == TIMER_NOT_ARMED) {
+    sqe->opcode        = IORING_OP_TIMEOUT;
+    sqe->addr          = reinterpret_cast<std::uint64_t>(&timer_ts_);
+    sqe->len           = 1;
+    sqe->timeout_flags = IORING_TIMEOUT_ABS;
+    sqe->user_data     = pack(Op::Timer, 0, 0);
+  }
+  else {
+    sqe->opcode        = IORING_OP_TIMEOUT_REMOVE;
+    sqe->addr          = pack(Op::Timer, 0, 0);
+    sqe->addr2         = reinterpret_cast<std::uint64_t>(&timer_ts_);
+    sqe->timeout_flags = IORING_TIMEOUT_UPDATE | IORING_TIMEOUT_ABS;
+    sqe->user_data     = pack(Op::Cancel, 0, 0);
+  }
+
+  timer_armed_tick_ = *due;
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::on_timer_cqe(const io_uring_cqe& cqe) noexcept
+{
+  if (cqe.res != -ETIME) [[unlikely]] {
+    if (cqe.res != -ECANCELED) {
+      TSKV_LOG_WARN("io_uring timeout failed: errno={}", -cqe.res);
+    }
+    timer_armed_tick_ = TIMER_NOT_ARMED;
+    return;
+  }
+
+  // how late we got to run after the kernel fired the timeout (scheduler / C-state exit)
+  const std::uint64_t due_ns = timer_armed_tick_ * 1'000'000;
+  if (timer_armed_tick_ != TIMER_NOT_ARMED && loop_ns_ >= due_ns) {
+    metrics::record_histogram<"net.wakeup_latency_ns">(loop_ns_ - due_ns);
+  }
+
+  timer_armed_tick_ = TIMER_NOT_ARMED; // run_timers() after this batch arms the next one
+}
+
+template <Protocol Proto>
+void UringReactor<Proto>::run()
+{
+  while (true) {
+    if (shutting_down_ && pool_.empty()) {
+      TSKV_LOG_INFO("Shutdown succeeded...");
+      metrics::flush_thread(0ms);
+      return;
+    }
+    poll_once();
+  }
+}
+
+} // namespace tskv::net
@@ -1,9 +1,240 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.storage.engine
+// Summary: the storage engine the network protocols call into
+//
+//  - v0: a single Memtable behind a reader/writer lock, optionally logged to a WAL in the data
+//    directory (replayed on startup); no SSTables yet, so the log grows without bound
+//    * a default-constructed Engine has no WAL and lives only as long as the process
+//  - shared by every io thread; reads take the lock shared, writes exclusive
+//  - scan_range() is the building block for streaming scans: a key-based cursor that releases the
+//    lock between pieces, so a long scan never pins memory or stalls writers
+//  - aggregate() folds a series' points (tskv.storage.series) into time buckets where they are
+//    stored, so only bucket results leave the engine; it resumes like scan_range(), and visits a
+//    bounded number of entries per call even inside one bucket, whose partial fold the caller
+//    carries over to the next call
+//  - put_batch() is one engine operation: one lock acquisition, one WAL record and one memtable
+//    pass for the whole batch; a write the WAL could not log is not applied (returns false)
+//    * put_points() is the same for a columnar point block, which the WAL logs still encoded
+//    * the WAL append, fdatasync included under WALSyncPolicy::FDataSync, runs under the
+//      exclusive lock, on the calling io thread: with fdatasync every write stalls that reactor
+//      and every other io thread's reads and writes for one device flush (no group commit yet)
+//  - values are handed to callbacks as std::string_view while the lock is held, so callers can
+//    serialize them straight into a reply without an intermediate copy
+//    * callbacks must not call back into the Engine (the lock is not recursive)
+//------------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "tskv/common/logging.hpp"
+
 export module tskv.storage.engine;
 
+import tskv.common.logging;
+import tskv.storage.memtable;
+import tskv.storage.series;
+import tskv.storage.wal;
+
+namespace fs = std::filesystem;
+
 export namespace tskv::storage {
 
-inline void engine_stub()
-{
-}
+class Engine {
+public:
+  Engine() = default;
+
+  // Logs every write to `data_dir`/wal.log, after replaying what is already there.
+  Engine(const fs::path& data_dir, WALSyncPolicy sync_policy)
+  {
+    std::error_code ec;
+    fs::create_directories(data_dir, ec);
+    TSKV_REQUIRE(!ec, "cannot create data dir {}: {}", data_dir.string(), ec.message());
+
+    wal_.emplace(data_dir / "wal.log", sync_policy);
+    const std::size_t records = wal_->replay(memtable_);
+    TSKV_LOG_INFO("WAL: replayed {} records, {} keys", records, memtable_.size());
+  }
+
+  // Calls fn(value) if `key` is present. Returns whether it was.
+  template <typename Fn>
+  bool get(std::string_view key, Fn&& fn) const
+  {
+    std::shared_lock lock(mutex_);
+    const std::string* value = memtable_.find(key);
+    if (value == nullptr) {
+      return false;
+    }
+    fn(std::string_view(*value));
+    return true;
+  }
+
+  // Calls fn(value) for each key in order, with std::nullopt for missing ones, under one lock.
+  template <typename Fn>
+  void get_many(std::span<const std::string_view> keys, Fn&& fn) const
+  {
+    std::shared_lock lock(mutex_);
+    for (const std::string_view key : keys) {
+      const std::string* value = memtable_.find(key);
+      fn(value ? std::optional<std::string_view>(*value) : std::nullopt);
+    }
+  }
+
+  bool put(std::string_view key, std::string_view value)
+  {
+    const KeyValue kv{key, value};
+    return put_batch({&kv, 1});
+  }
+
+  // Later entries win over earlier ones with the same key. Returns false, applying nothing, if the
+  // WAL append failed. Under WALSyncPolicy::FDataSync this includes an fdatasync() with the
+  // exclusive lock held, so it blocks the calling thread and every other reader and writer until
+  // the device has flushed; one large batch amortizes that where many small ones do not.
+  bool put_batch(std::span<const KeyValue> batch)
+  {
+    if (batch.empty()) {
+      return true;
+    }
+    std::unique_lock lock(mutex_);
+    if (wal_ && !wal_->append(batch)) {
+      return false;
+    }
+    memtable_.put_batch(batch);
+    return true;
+  }
+
+  // Stores the points of a columnar block: `points` is what expand_points() made of `block`. The
+  // block is logged as it is, so the WAL record costs what the wire did. Returns false, applying
+  // nothing, if the WAL append failed. Syncs under the lock like put_batch().
+  bool put_points(std::span<const std::byte> block, std::span<const KeyValue> points)
+  {
+    std::unique_lock lock(mutex_);
+    if (wal_ && !wal_->append_points(block)) {
+      return false;
+    }
+    memtable_.put_batch(points);
+    return true;
+  }
+
+  // False if `key` was absent (or its erase could not be logged).
+  bool erase(std::string_view key)
+  {
+    std::unique_lock lock(mutex_);
+    if (memtable_.find(key) == nullptr || (wal_ && !wal_->append_erase(key))) {
+      return false;
+    }
+    return memtable_.erase(key);
+  }
+
+  // Visits up to `limit` entries with keys >= `start`, in key order, while fn(key, value) returns
+  // true. Returns the key to resume from, or std::nullopt once the end is reached (or fn stopped).
+  template <typename Fn>
+  std::optional<std::string> scan(std::string_view start, std::size_t limit, Fn&& fn) const
+  {
+    std::shared_lock lock(mutex_);
+    auto             it = memtable_.lower_bound(start);
+    for (std::size_t n = 0; it != memtable_.end(); ++it, ++n) {
+      if (n == limit) {
+        return it->first;
+      }
+      if (!fn(std::string_view(it->first), std::string_view(it->second))) {
+        return std::nullopt;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Visits entries with start <= key < end (no upper bound if `end` is empty), in key order, until
+  // fn(key, value) returns false, which declines that entry. Returns the declined entry's key, to
+  // resume at, or std::nullopt once the range is exhausted. Between calls nothing is held, so a
+  // caller can walk a range of any size one bounded piece at a time without blocking writers.
+  template <typename Fn>
+  std::optional<std::string> scan_range(std::string_view start, std::string_view end, Fn&& fn) const
+  {
+    std::shared_lock lock(mutex_);
+    for (auto it = memtable_.lower_bound(start); it != memtable_.end(); ++it) {
+      if (!end.empty() && it->first >= end) {
+        break;
+      }
+      if (!fn(std::string_view(it->first), std::string_view(it->second))) {
+        return it->first;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Folds the samples of `series` with from <= timestamp < to into buckets `width` (> 0) apart,
+  // aligned as bucket_start() does, and calls fn(const BucketAggregate&) for each non-empty one in
+  // time order. A call stops after `max_buckets` buckets or `max_entries` (> 0) visited entries,
+  // so a bucket over millions of points is folded across several calls: `bucket` holds the one
+  // still open in between (start with an empty one, then pass it back with the returned
+  // timestamp). Returns the timestamp to resume from, or std::nullopt once the range is exhausted.
+  // Entries that do not hold a sample are skipped; they count as visited, but a call only stops
+  // at a sample.
+  template <typename Fn>
+  std::optional<std::int64_t> aggregate(std::string_view series,
+    std::int64_t                                         from,
+    std::int64_t                                         to,
+    std::int64_t                                         width,
+    std::size_t                                          max_buckets,
+    std::size_t                                          max_entries,
+    BucketAggregate&                                     bucket,
+    Fn&&                                                 fn) const
+  {
+    const std::string first = point_key(series, from);
+    const std::string last  = point_key(series, to);
+
+    std::shared_lock lock(mutex_);
+    std::size_t      emitted = 0;
+    std::size_t      visited = 0;
+    for (auto it = memtable_.lower_bound(first); it != memtable_.end() && it->first < last;
+      ++it, ++visited) {
+      const std::optional<PointKey> point  = parse_point_key(it->first);
+      const std::optional<double>   sample = decode_sample(it->second);
+      if (!point || point->series != series || !sample) {
+        continue;
+      }
+      if (visited >= max_entries) {
+        return point->timestamp; // `bucket` stays open
+      }
+      const std::int64_t start = bucket_start(point->timestamp, width);
+      if (bucket.count > 0 && bucket.start != start) {
+        fn(std::as_const(bucket));
+        bucket = BucketAggregate{};
+        if (++emitted == max_buckets) {
+          return point->timestamp;
+        }
+      }
+      bucket.start = start;
+      bucket.add(*sample);
+    }
+    if (bucket.count > 0) {
+      fn(std::as_const(bucket));
+      bucket = BucketAggregate{};
+    }
+    return std::nullopt;
+  }
+
+  [[nodiscard]] std::size_t size() const
+  {
+    std::shared_lock lock(mutex_);
+    return memtable_.size();
+  }
+
+private:
+  mutable std::shared_mutex mutex_;
+  Memtable                  memtable_;
+  std::optional<Wal>        wal_;
+};
 
 } // namespace tskv::storage
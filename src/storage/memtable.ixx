@@ -0,0 +1,108 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.storage.memtable
+// Summary: in-memory, sorted key/value table that receives every write (roadmap v0.8)
+//
+//  - v0 is a std::map with heterogeneous lookup, so reads take std::string_view keys without
+//    building a std::string
+//  - iteration is in key order, which is what SCAN and the future SSTable flush rely on
+//  - not synchronized; the Engine owning it serializes writers against readers
+//  - put_batch() inserts a whole batch in one pass; when keys arrive in ascending order (points of
+//    one series, in time order) each insert starts from the previous one instead of the root
+//  - bytes() counts key and value bytes only (no node overhead); it is what memtable_bytes will
+//    be compared against once flushing exists
+//------------------------------------------------------------------------------
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+
+export module tskv.storage.memtable;
+
+export namespace tskv::storage {
+
+struct KeyValue {
+  std::string_view key;
+  std::string_view value;
+};
+
+class Memtable {
+public:
+  using Map = std::map<std::string, std::string, std::less<>>;
+
+  // nullptr if absent; valid until the next write to this key
+  [[nodiscard]] const std::string* find(std::string_view key) const
+  {
+    const auto it = map_.find(key);
+    return it == map_.end() ? nullptr : &it->second;
+  }
+
+  void put(std::string_view key, std::string_view value)
+  {
+    put_at(map_.lower_bound(key), key, value);
+  }
+
+  // Later entries win over earlier ones with the same key.
+  void put_batch(std::span<const KeyValue> batch)
+  {
+    auto prev = map_.end();
+    for (const auto& [key, value] : batch) {
+      auto it = map_.end();
+      if (prev != map_.end() && prev->first < key) {
+        it = std::next(prev);
+        if (it != map_.end() && it->first < key) {
+          it = map_.lower_bound(key); // not the next key along; search from the root
+        }
+      }
+      else {
+        it = map_.lower_bound(key);
+      }
+      prev = put_at(it, key, value);
+    }
+  }
+
+  bool erase(std::string_view key)
+  {
+    const auto it = map_.find(key);
+    if (it == map_.end()) {
+      return false;
+    }
+    bytes_ -= it->first.size() + it->second.size();
+    map_.erase(it);
+    return true;
+  }
+
+  // first entry with a key >= `key`
+  [[nodiscard]] Map::const_iterator lower_bound(std::string_view key) const
+  {
+    return map_.lower_bound(key);
+  }
+
+  [[nodiscard]] Map::const_iterator end() const noexcept { return map_.end(); }
+
+  [[nodiscard]] std::size_t size() const noexcept { return map_.size(); }
+  [[nodiscard]] std::size_t bytes() const noexcept { return bytes_; }
+
+private:
+  // `it` is map_.lower_bound(key)
+  Map::iterator put_at(Map::iterator it, std::string_view key, std::string_view value)
+  {
+    if (it != map_.end() && it->first == key) {
+      bytes_ = bytes_ - it->second.size() + value.size();
+      it->second.assign(value); // reuses the old value's capacity when it can
+      return it;
+    }
+    bytes_ += key.size() + value.size();
+    return map_.emplace_hint(it, key, value);
+  }
+
+  Map         map_;
+  std::size_t bytes_ = 0;
+};
+
+} // namespace tskv::storage
@@ -0,0 +1,386 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.storage.point_codec
+// Summary: columnar, delta-encoded batches of one series' points (the PutPoints / ScanPoints
+//          payload, and a WAL record kind)
+//
+//  - a block names its series once and stores the timestamps and the values as two columns:
+//    * block: series_len (varint) | series | count (varint) | ts_bytes (varint) | timestamps |
+//      values
+//    * timestamps: t0, then t1 - t0, then one delta-of-delta per point, each a zigzag LEB128
+//      varint; points at a steady interval cost one byte each
+//    * values: XOR-compressed doubles (as in Facebook's Gorilla), a bit stream written MSB first
+//      and zero-padded to a byte: v0 as 64 raw bits, then for each value x = v ^ previous:
+//      '0' if x == 0; '10' + the meaningful bits if they fit the previous value's leading/trailing
+//      zero window; else '11' + leading zeros (5 bits) + meaningful length - 1 (6 bits) + bits
+//  - decoding is bounds-checked throughout; a truncated or inconsistent block fails as a whole
+//  - expand_points() turns a block straight into the KeyValue form the memtable stores (point
+//    keys and 8-byte samples, tskv.storage.series) in one pass over caller-owned scratch, so a
+//    block can be validated before the engine lock is taken and logged to the WAL as received
+//  - in-house; the project takes no third-party libraries
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module tskv.storage.point_codec;
+
+import tskv.storage.memtable;
+import tskv.storage.series;
+
+export namespace tskv::storage {
+
+struct Point {
+  std::int64_t timestamp = 0;
+  double       value     = 0.0;
+};
+
+// Upper bound on points per block, so a decoder can size scratch space before trusting a count.
+inline constexpr std::size_t MAX_BLOCK_POINTS = std::size_t{1} << 20;
+
+// Upper bound on what expand_points() makes of one block (keys and samples), the largest frame a
+// block can arrive in: a few bytes of block expand to a key per point, so the block's own size
+// does not bound it.
+inline constexpr std::size_t MAX_EXPANDED_BYTES = std::size_t{64} << 20;
+
+} // namespace tskv::storage
+
+namespace tskv::storage::detail {
+
+inline void put_varint(std::vector<std::byte>& out, std::uint64_t v)
+{
+  while (v >= 0x80) {
+    out.push_back(static_cast<std::byte>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<std::byte>(v));
+}
+
+// Reads the LEB128 varint at `offset`, advancing it; std::nullopt if it runs off the end.
+[[nodiscard]] inline std::optional<std::uint64_t> get_varint(
+  std::span<const std::byte> bytes, std::size_t& offset) noexcept
+{
+  std::uint64_t v = 0;
+  for (unsigned shift = 0; shift < 64 && offset < bytes.size(); shift += 7) {
+    const auto b = std::to_integer<std::uint64_t>(bytes[offset++]);
+    v |= (b & 0x7f) << shift;
+    if ((b & 0x80) == 0) {
+      return v;
+    }
+  }
+  return std::nullopt;
+}
+
+[[nodiscard]] constexpr std::uint64_t zigzag(std::uint64_t v) noexcept
+{
+  return (v << 1) ^ (0 - (v >> 63)); // v is a two's complement int64
+}
+
+[[nodiscard]] constexpr std::uint64_t unzigzag(std::uint64_t v) noexcept
+{
+  return (v >> 1) ^ (0 - (v & 1));
+}
+
+class BitWriter {
+public:
+  explicit BitWriter(std::vector<std::byte>& out) noexcept : out_(out) {}
+
+  // The low `n` (1..64) bits of v, most significant first.
+  void put(std::uint64_t v, unsigned n)
+  {
+    while (n > 0) {
+      if (used_ == 8) {
+        out_.push_back(std::byte{0});
+        used_ = 0;
+      }
+      const unsigned take  = std::min(n, 8 - used_);
+      const auto     chunk = static_cast<unsigned>((v >> (n - take)) & ((1u << take) - 1));
+      out_.back() |= static_cast<std::byte>(chunk << (8 - used_ - take));
+      used_ += take;
+      n -= take;
+    }
+  }
+
+private:
+  std::vector<std::byte>& out_;
+  unsigned                used_ = 8; // bits used in out_.back(); 8 means start a new byte
+};
+
+class BitReader {
+public:
+  explicit BitReader(std::span<const std::byte> bytes) noexcept : bytes_(bytes) {}
+
+  // The next `n` (1..64) bits; clears ok() if the stream is shorter.
+  [[nodiscard]] std::uint64_t get(unsigned n) noexcept
+  {
+    if (n > bytes_.size() * 8 - bit_) {
+      ok_ = false;
+      return 0;
+    }
+    const std::size_t at   = bit_ / 8;
+    const auto        skip = static_cast<unsigned>(bit_ % 8);
+    if (at + 8 <= bytes_.size()) {
+      // one big-endian word, plus a ninth byte when the bits straddle it (the check above
+      // guarantees it exists)
+      std::uint64_t word;
+      std::memcpy(&word, bytes_.data() + at, sizeof word);
+      if constexpr (std::endian::native == std::endian::little) {
+        word = std::byteswap(word);
+      }
+      std::uint64_t v = (word << skip) >> (64 - n);
+      if (skip + n > 64) {
+        const unsigned extra = skip + n - 64;
+        v |= std::to_integer<std::uint64_t>(bytes_[at + 8]) >> (8 - extra);
+      }
+      bit_ += n;
+      return v;
+    }
+
+    std::uint64_t v = 0;
+    while (n > 0) {
+      const auto     byte  = std::to_integer<unsigned>(bytes_[bit_ / 8]);
+      const unsigned used  = static_cast<unsigned>(bit_ % 8);
+      const unsigned take  = std::min(n, 8 - used);
+      const unsigned chunk = (byte >> (8 - used - take)) & ((1u << take) - 1);
+      v = (v << take) | chunk;
+      bit_ += take;
+      n -= take;
+    }
+    return v;
+  }
+
+  [[nodiscard]] bool ok() const noexcept { return ok_; }
+
+  // what is left is padding only
+  [[nodiscard]] bool done() const noexcept { return ok_ && (bit_ + 7) / 8 == bytes_.size(); }
+
+private:
+  std::span<const std::byte> bytes_;
+  std::size_t                bit_ = 0;
+  bool                       ok_  = true;
+};
+
+} // namespace tskv::storage::detail
+
+export namespace tskv::storage {
+
+// Appends the block of `points` (in any order, though time order encodes best) of `series`.
+void encode_points(
+  std::vector<std::byte>& out, std::string_view series, std::span<const Point> points)
+{
+  detail::put_varint(out, series.size());
+  const auto* name = reinterpret_cast<const std::byte*>(series.data());
+  out.insert(out.end(), name, name + series.size());
+  detail::put_varint(out, points.size());
+
+  // timestamps go into their own buffer first: the column is prefixed with its size
+  thread_local std::vector<std::byte> column;
+  column.clear();
+  std::uint64_t prev  = 0;
+  std::uint64_t delta = 0;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const auto t = static_cast<std::uint64_t>(points[i].timestamp);
+    if (i == 0) {
+      detail::put_varint(column, detail::zigzag(t));
+    }
+    else {
+      const std::uint64_t d = t - prev; // wraps like the int64 arithmetic it stands for
+      detail::put_varint(column, detail::zigzag(i == 1 ? d : d - delta));
+      delta = d;
+    }
+    prev = t;
+  }
+  detail::put_varint(out, column.size());
+  out.insert(out.end(), column.begin(), column.end());
+
+  detail::BitWriter bits(out);
+  std::uint64_t     prev_bits = 0;
+  unsigned          leading   = 64; // previous window; 64 means none yet
+  unsigned          trailing  = 0;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const auto v = std::bit_cast<std::uint64_t>(points[i].value);
+    if (i == 0) {
+      bits.put(v, 64);
+      prev_bits = v;
+      continue;
+    }
+    const std::uint64_t x = v ^ prev_bits;
+    prev_bits             = v;
+    if (x == 0) {
+      bits.put(0, 1);
+      continue;
+    }
+    const auto lz = std::min(static_cast<unsigned>(std::countl_zero(x)), 31u);
+    const auto tz = static_cast<unsigned>(std::countr_zero(x));
+    if (leading != 64 && lz >= leading && tz >= trailing) {
+      bits.put(0b10, 2);
+      bits.put(x >> trailing, 64 - leading - trailing);
+    }
+    else {
+      leading                = lz;
+      trailing               = tz;
+      const unsigned meaning = 64 - lz - tz;
+      bits.put(0b11, 2);
+      bits.put(lz, 5);
+      bits.put(meaning - 1, 6);
+      bits.put(x >> tz, meaning);
+    }
+  }
+}
+
+// Reads a block back, point by point. Check ok() (or done() after the last point) before trusting
+// what was read: a malformed block reads as zeros from the point it breaks on.
+class PointDecoder {
+public:
+  explicit PointDecoder(std::span<const std::byte> block) noexcept
+  {
+    std::size_t offset     = 0;
+    const auto  series_len = detail::get_varint(block, offset);
+    if (!series_len || *series_len > block.size() - offset) {
+      return;
+    }
+    series_ = {reinterpret_cast<const char*>(block.data() + offset), *series_len};
+    offset += *series_len;
+
+    // every point takes at least one timestamp byte and one value bit (the first one 64), which
+    // bounds a count before it is trusted
+    const auto count    = detail::get_varint(block, offset);
+    const auto ts_bytes = detail::get_varint(block, offset);
+    if (!count || !ts_bytes || *ts_bytes > block.size() - offset || *count > *ts_bytes ||
+        *count > MAX_BLOCK_POINTS) {
+      return;
+    }
+    const std::size_t value_bits = (block.size() - offset - *ts_bytes) * 8;
+    if (*count > 0 && 64 + (*count - 1) > value_bits) {
+      return;
+    }
+    count_      = *count;
+    timestamps_ = block.subspan(offset, *ts_bytes);
+    values_     = detail::BitReader(block.subspan(offset + *ts_bytes));
+    ok_         = true;
+  }
+
+  [[nodiscard]] std::string_view series() const noexcept { return series_; }
+  [[nodiscard]] std::size_t      count() const noexcept { return count_; }
+  [[nodiscard]] bool             ok() const noexcept { return ok_ && values_.ok(); }
+
+  // every point was read and nothing is left over
+  [[nodiscard]] bool done() const noexcept
+  {
+    return ok() && read_ == count_ && ts_offset_ == timestamps_.size() && values_.done();
+  }
+
+  // The next point, or std::nullopt after the last one (or once the block has proven malformed).
+  [[nodiscard]] std::optional<Point> next() noexcept
+  {
+    if (!ok() || read_ == count_) {
+      return std::nullopt;
+    }
+    const std::optional<std::uint64_t> stamp = detail::get_varint(timestamps_, ts_offset_);
+    if (!stamp) {
+      ok_ = false;
+      return std::nullopt;
+    }
+    if (read_ == 0) {
+      prev_ts_ = detail::unzigzag(*stamp);
+    }
+    else {
+      delta_ = read_ == 1 ? detail::unzigzag(*stamp) : delta_ + detail::unzigzag(*stamp);
+      prev_ts_ += delta_;
+    }
+
+    if (read_ == 0) {
+      prev_bits_ = values_.get(64);
+    }
+    else if (values_.get(1) == 1) {
+      if (values_.get(1) == 1) {
+        leading_               = static_cast<unsigned>(values_.get(5));
+        const unsigned meaning = static_cast<unsigned>(values_.get(6)) + 1;
+        if (meaning > 64 - leading_) {
+          ok_ = false;
+          return std::nullopt;
+        }
+        trailing_ = 64 - leading_ - meaning;
+      }
+      else if (leading_ == 64) {
+        ok_ = false; // a window reused before one was set
+        return std::nullopt;
+      }
+      prev_bits_ ^= values_.get(64 - leading_ - trailing_) << trailing_;
+    }
+    if (!values_.ok()) {
+      return std::nullopt;
+    }
+
+    ++read_;
+    return Point{static_cast<std::int64_t>(prev_ts_), std::bit_cast<double>(prev_bits_)};
+  }
+
+private:
+  std::string_view           series_;
+  std::size_t                count_ = 0;
+  std::span<const std::byte> timestamps_;
+  std::size_t                ts_offset_ = 0;
+  detail::BitReader          values_{{}};
+  bool                       ok_ = false;
+
+  std::size_t   read_      = 0;
+  std::uint64_t prev_ts_   = 0;
+  std::uint64_t delta_     = 0;
+  std::uint64_t prev_bits_ = 0;
+  unsigned      leading_   = 64;
+  unsigned      trailing_  = 0;
+};
+
+// Decodes `block` into `batch` (replacing its contents) as point keys and stored samples, whose
+// bytes live in `arena`; both stay valid until the next call with the same scratch. Returns the
+// series, or std::nullopt (leaving the scratch unspecified) if the block is malformed, names an
+// invalid series or would expand past MAX_EXPANDED_BYTES; the scratch is only sized once the
+// block's header has passed those checks.
+[[nodiscard]] std::optional<std::string_view> expand_points(std::span<const std::byte> block,
+  std::string&                                                                         arena,
+  std::vector<KeyValue>&                                                               batch)
+{
+  PointDecoder decoder(block);
+  if (!decoder.ok() || !valid_series(decoder.series())) {
+    return std::nullopt;
+  }
+  const std::string_view series   = decoder.series();
+  const std::size_t      key_size = series.size() + POINT_KEY_SUFFIX;
+  const std::size_t      stride   = key_size + SAMPLE_SIZE;
+  if (decoder.count() > MAX_EXPANDED_BYTES / stride) {
+    return std::nullopt;
+  }
+
+  // sized up front so the views handed out below never move
+  arena.resize(decoder.count() * stride);
+  batch.clear();
+  batch.reserve(decoder.count());
+
+  std::string key;
+  std::string sample;
+  char*       p = arena.data();
+  while (const std::optional<Point> point = decoder.next()) {
+    point_key(key, series, point->timestamp);
+    encode_sample(sample, point->value);
+    key.copy(p, key_size);
+    sample.copy(p + key_size, SAMPLE_SIZE);
+    batch.push_back({{p, key_size}, {p + key_size, SAMPLE_SIZE}});
+    p += stride;
+  }
+  if (!decoder.done()) {
+    return std::nullopt;
+  }
+  return series;
+}
+
+} // namespace tskv::storage
@@ -0,0 +1,162 @@
+module;
+
+//------------------------------------------------------------------------------
+// Module: tskv.storage.series
+// Summary: how time-series points map onto engine keys, and the per-bucket aggregates over them
+//
+//  - a point is one key/value entry
+//    * key: series | 0x00 | timestamp (i64, big-endian with the sign bit flipped)
+//    * value: the sample as an IEEE-754 double (8 bytes, little-endian like the wire format)
+//    * keys sort by series, then by timestamp, so a series' points over a time range are one
+//      contiguous run of memtable entries
+//    * series names are 1..MAX_SERIES_LEN bytes and contain no 0x00; timestamps carry no unit of
+//      their own
+//  - BucketAggregate folds samples into min/max/sum/count (avg is sum / count); buckets are aligned
+//    to multiples of their width (bucket_start), so every query with one width agrees on them
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+
+export module tskv.storage.series;
+
+export namespace tskv::storage {
+
+inline constexpr std::size_t POINT_KEY_SUFFIX = 9; // separator + timestamp
+inline constexpr std::size_t SAMPLE_SIZE      = sizeof(double);
+
+// A series name is repeated in every one of its point keys, so its length multiplies whatever is
+// sized per point.
+inline constexpr std::size_t MAX_SERIES_LEN = 256;
+
+// Aggregate functions, as bits of a mask (the order is the order results are encoded in).
+enum class AggregateFn : std::uint8_t {
+  Min   = 1 << 0,
+  Max   = 1 << 1,
+  Sum   = 1 << 2,
+  Count = 1 << 3,
+  Avg   = 1 << 4,
+};
+
+inline constexpr std::uint32_t AGGREGATE_FNS_ALL = 0x1f;
+
+[[nodiscard]] constexpr bool wants(std::uint32_t fns, AggregateFn fn) noexcept
+{
+  return (fns & static_cast<std::uint32_t>(fn)) != 0;
+}
+
+[[nodiscard]] constexpr bool valid_series(std::string_view series) noexcept
+{
+  return !series.empty() && series.size() <= MAX_SERIES_LEN &&
+         series.find('\0') == std::string_view::npos;
+}
+
+// Replaces `out` with the key of the point of `series` at `timestamp`.
+void point_key(std::string& out, std::string_view series, std::int64_t timestamp)
+{
+  std::uint64_t ordered = static_cast<std::uint64_t>(timestamp) ^ (std::uint64_t{1} << 63);
+  if constexpr (std::endian::native == std::endian::little) {
+    ordered = std::byteswap(ordered);
+  }
+  out.assign(series);
+  out.push_back('\0');
+  out.append(reinterpret_cast<const char*>(&ordered), sizeof ordered);
+}
+
+[[nodiscard]] std::string point_key(std::string_view series, std::int64_t timestamp)
+{
+  std::string out;
+  point_key(out, series, timestamp);
+  return out;
+}
+
+struct PointKey {
+  std::string_view series;
+  std::int64_t     timestamp = 0;
+};
+
+// std::nullopt if `key` is not a point key.
+[[nodiscard]] std::optional<PointKey> parse_point_key(std::string_view key) noexcept
+{
+  if (key.size() <= POINT_KEY_SUFFIX || key[key.size() - POINT_KEY_SUFFIX] != '\0') {
+    return std::nullopt;
+  }
+  std::uint64_t ordered;
+  std::memcpy(&ordered, key.data() + key.size() - sizeof ordered, sizeof ordered);
+  if constexpr (std::endian::native == std::endian::little) {
+    ordered = std::byteswap(ordered);
+  }
+  return PointKey{key.substr(0, key.size() - POINT_KEY_SUFFIX),
+    static_cast<std::int64_t>(ordered ^ (std::uint64_t{1} << 63))};
+}
+
+// Replaces `out` with the stored form of `sample`.
+void encode_sample(std::string& out, double sample)
+{
+  auto bits = std::bit_cast<std::uint64_t>(sample);
+  if constexpr (std::endian::native == std::endian::big) {
+    bits = std::byteswap(bits);
+  }
+  out.assign(reinterpret_cast<const char*>(&bits), sizeof bits);
+}
+
+// std::nullopt if `value` is not a stored sample.
+[[nodiscard]] std::optional<double> decode_sample(std::string_view value) noexcept
+{
+  if (value.size() != SAMPLE_SIZE) {
+    return std::nullopt;
+  }
+  std::uint64_t bits;
+  std::memcpy(&bits, value.data(), sizeof bits);
+  if constexpr (std::endian::native == std::endian::big) {
+    bits = std::byteswap(bits);
+  }
+  return std::bit_cast<double>(bits);
+}
+
+// Start of the bucket `timestamp` falls in: the largest multiple of `width` (> 0) not above it,
+// or INT64_MIN for the partial bucket at the bottom of the range whose multiple is below it.
+[[nodiscard]] constexpr std::int64_t bucket_start(
+  std::int64_t timestamp, std::int64_t width) noexcept
+{
+  constexpr std::int64_t MIN = std::numeric_limits<std::int64_t>::min();
+
+  std::int64_t offset = timestamp % width; // into the bucket, 0..width-1 once fixed up
+  if (offset < 0) {
+    offset += width;
+  }
+  if (timestamp < MIN + offset) {
+    return MIN;
+  }
+  return timestamp - offset;
+}
+
+struct BucketAggregate {
+  std::int64_t  start = 0;
+  double        min   = std::numeric_limits<double>::infinity();
+  double        max   = -std::numeric_limits<double>::infinity();
+  double        sum   = 0.0;
+  std::uint64_t count = 0;
+
+  void add(double sample) noexcept
+  {
+    min = std::min(min, sample);
+    max = std::max(max, sample);
+    sum += sample;
+    ++count;
+  }
+
+  [[nodiscard]] double avg() const noexcept
+  {
+    return count == 0 ? 0.0 : sum / static_cast<double>(count);
+  }
+};
+
+} // namespace tskv::storage
@@ -1,18 +1,268 @@
 module;
 
+//------------------------------------------------------------------------------
+// Module: tskv.storage.wal
+// Summary: append-only write-ahead log in front of the memtable
+//
+//  - one record per write batch, written with a single write() on an O_APPEND descriptor, so a
+//    batch of N points costs one syscall (and one fdatasync under WALSyncPolicy::FDataSync)
+//    * record: length (u32, bytes after this header) | count (u32) | count entries
+//    * entry:  klen (u32) | vlen (u32) | key | value; vlen == WAL_TOMBSTONE marks an erase and
+//      has no value bytes
+//    * integers are little-endian, like the wire format (tskv.common.bytes)
+//    * count == WAL_POINT_BLOCK instead marks a record whose body is one columnar point block
+//      (tskv.storage.point_codec), logged exactly as the client sent it
+//  - replay() applies every whole record to a Memtable in order and truncates a torn tail (a crash
+//    in the middle of an append), so new records follow the last good one
+//    * v0: no checksums, no segment rotation, and the log is never trimmed (no SSTable flush yet)
+//  - not synchronized; the Engine owning it holds its write lock across append + memtable update,
+//    so the log order is the memtable order
+//------------------------------------------------------------------------------
+
 #include <array>
+#include <cerrno>
+#include <cstddef>
 #include <cstdint>
+#include <fcntl.h>
+#include <filesystem>
+#include <span>
+#include <string>
 #include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "tskv/common/logging.hpp"
 
 export module tskv.storage.wal;
 
+import tskv.common.bytes;
 import tskv.common.enum_traits;
-namespace tc = tskv::common;
+import tskv.common.logging;
+import tskv.common.metrics;
+import tskv.storage.memtable;
+import tskv.storage.point_codec;
+
+namespace tc      = tskv::common;
+namespace fs      = std::filesystem;
+namespace metrics = tskv::common::metrics;
 
 export namespace tskv::storage {
 
 enum class WALSyncPolicy : uint8_t { Append, FDataSync };
 
+inline constexpr std::uint32_t WAL_TOMBSTONE      = 0xFFFF'FFFF;
+inline constexpr std::uint32_t WAL_POINT_BLOCK    = 0xFFFF'FFFF;
+inline constexpr std::size_t   WAL_RECORD_HEADER  = 8;
+inline constexpr std::size_t   WAL_ENTRY_OVERHEAD = 8;
+
+} // namespace tskv::storage
+
+namespace tskv::storage::detail {
+
+// Applies the record at the front of `bytes` to `memtable`. Returns its size, or 0 (applying
+// nothing) if `bytes` does not start with a whole, well-formed record.
+[[nodiscard]] inline std::size_t apply_record(std::span<const std::byte> bytes, Memtable& memtable)
+{
+  if (bytes.size() < WAL_RECORD_HEADER) {
+    return 0;
+  }
+  const std::size_t length = tc::load_le<std::uint32_t>(bytes.data());
+  const std::size_t count  = tc::load_le<std::uint32_t>(bytes.data() + 4);
+  if (bytes.size() - WAL_RECORD_HEADER < length) {
+    return 0;
+  }
+  const std::span<const std::byte> body = bytes.subspan(WAL_RECORD_HEADER, length);
+
+  if (count == WAL_POINT_BLOCK) {
+    thread_local std::string           arena;
+    thread_local std::vector<KeyValue> batch;
+    if (!expand_points(body, arena, batch)) {
+      return 0;
+    }
+    memtable.put_batch(batch);
+    return WAL_RECORD_HEADER + length;
+  }
+
+  // validate the whole record before applying any of it
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (body.size() - offset < WAL_ENTRY_OVERHEAD) {
+      return 0;
+    }
+    const std::size_t   klen  = tc::load_le<std::uint32_t>(body.data() + offset);
+    const std::uint32_t vlen  = tc::load_le<std::uint32_t>(body.data() + offset + 4);
+    const std::size_t   entry = WAL_ENTRY_OVERHEAD + klen + (vlen == WAL_TOMBSTONE ? 0 : vlen);
+    if (body.size() - offset < entry) {
+      return 0;
+    }
+    offset += entry;
+  }
+  if (offset != body.size()) {
+    return 0;
+  }
+
+  for (offset = 0; offset < body.size();) {
+    const std::size_t   klen = tc::load_le<std::uint32_t>(body.data() + offset);
+    const std::uint32_t vlen = tc::load_le<std::uint32_t>(body.data() + offset + 4);
+    const std::byte*    key  = body.data() + offset + WAL_ENTRY_OVERHEAD;
+    if (vlen == WAL_TOMBSTONE) {
+      (void)memtable.erase(tc::as_chars({key, klen}));
+      offset += WAL_ENTRY_OVERHEAD + klen;
+    }
+    else {
+      memtable.put(tc::as_chars({key, klen}), tc::as_chars({key + klen, vlen}));
+      offset += WAL_ENTRY_OVERHEAD + klen + vlen;
+    }
+  }
+  return WAL_RECORD_HEADER + length;
+}
+
+} // namespace tskv::storage::detail
+
+export namespace tskv::storage {
+
+class Wal {
+public:
+  // Opens (creating it if needed) the log at `path`. Exits if it cannot be opened.
+  Wal(const fs::path& path, WALSyncPolicy policy) : policy_(policy)
+  {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    TSKV_REQUIRE(fd_ != -1, "cannot open WAL {}: errno={}", path.string(), errno);
+
+    struct stat st{};
+    TSKV_REQUIRE(::fstat(fd_, &st) == 0, "cannot stat WAL {}: errno={}", path.string(), errno);
+    size_ = static_cast<std::size_t>(st.st_size);
+  }
+
+  ~Wal()
+  {
+    if (fd_ != -1) {
+      ::close(fd_);
+    }
+  }
+
+  Wal(const Wal&)            = delete;
+  Wal& operator=(const Wal&) = delete;
+  Wal(Wal&&)                 = delete;
+  Wal& operator=(Wal&&)      = delete;
+
+  // Applies every whole record in the log to `memtable`, drops anything after the last one, and
+  // returns how many records were applied. Call once, before the first append.
+  std::size_t replay(Memtable& memtable)
+  {
+    std::vector<std::byte> bytes(size_);
+    std::size_t            have = 0;
+    while (have < bytes.size()) {
+      const ssize_t n = ::pread(fd_, bytes.data() + have, bytes.size() - have, have);
+      TSKV_REQUIRE(n > 0, "cannot read WAL: errno={}", errno);
+      have += static_cast<std::size_t>(n);
+    }
+
+    std::size_t records = 0;
+    size_               = 0;
+    while (const std::size_t n = detail::apply_record(std::span(bytes).subspan(size_), memtable)) {
+      size_ += n;
+      ++records;
+    }
+
+    if (size_ < bytes.size()) {
+      TSKV_LOG_WARN("WAL: dropping {} bytes of torn tail after {} records",
+        bytes.size() - size_,
+        records);
+      TSKV_REQUIRE(::ftruncate(fd_, static_cast<off_t>(size_)) == 0,
+        "cannot truncate WAL: errno={}",
+        errno);
+    }
+    return records;
+  }
+
+  // Logs `batch` as one record. Returns false, logging nothing, on an I/O error.
+  [[nodiscard]] bool append(std::span<const KeyValue> batch)
+  {
+    std::vector<std::byte>& record = begin_record();
+    for (const auto& [key, value] : batch) {
+      tc::append_u32(record, static_cast<std::uint32_t>(key.size()));
+      tc::append_u32(record, static_cast<std::uint32_t>(value.size()));
+      tc::append_bytes(record, key);
+      tc::append_bytes(record, value);
+    }
+    return write_record(record, batch.size());
+  }
+
+  // Logs a point block as it is; the caller has checked it decodes.
+  [[nodiscard]] bool append_points(std::span<const std::byte> block)
+  {
+    std::vector<std::byte>& record = begin_record();
+    record.insert(record.end(), block.begin(), block.end());
+    return write_record(record, WAL_POINT_BLOCK);
+  }
+
+  [[nodiscard]] bool append_erase(std::string_view key)
+  {
+    std::vector<std::byte>& record = begin_record();
+    tc::append_u32(record, static_cast<std::uint32_t>(key.size()));
+    tc::append_u32(record, WAL_TOMBSTONE);
+    tc::append_bytes(record, key);
+    return write_record(record, 1);
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+private:
+  int           fd_ = -1;
+  WALSyncPolicy policy_;
+  std::size_t   size_ = 0; // bytes in the file, all of them whole records once replayed
+
+  // Scratch space for the record being written, with room left for its header.
+  static std::vector<std::byte>& begin_record()
+  {
+    thread_local std::vector<std::byte> record;
+    record.assign(WAL_RECORD_HEADER, std::byte{0});
+    return record;
+  }
+
+  bool write_record(std::vector<std::byte>& record, std::size_t count)
+  {
+    const std::size_t length = record.size() - WAL_RECORD_HEADER;
+    tc::store_le(record.data(), static_cast<std::uint32_t>(length));
+    tc::store_le(record.data() + 4, static_cast<std::uint32_t>(count));
+
+    std::size_t written = 0;
+    while (written < record.size()) {
+      const ssize_t n = ::write(fd_, record.data() + written, record.size() - written);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return fail("write");
+      }
+      written += static_cast<std::size_t>(n);
+    }
+
+    if (policy_ == WALSyncPolicy::FDataSync && ::fdatasync(fd_) != 0) {
+      return fail("fdatasync");
+    }
+
+    size_ += record.size();
+    metrics::inc_counter<"wal.appends">();
+    metrics::add_counter<"wal.bytes">(record.size());
+    return true;
+  }
+
+  // Cuts a partially written record off again, so the next append starts on a record boundary.
+  bool fail(std::string_view what)
+  {
+    TSKV_LOG_ERROR("WAL {} failed: errno={}", what, errno);
+    metrics::inc_counter<"wal.errors">();
+    if (::ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+      TSKV_LOG_ERROR("WAL truncate after a failed append failed: errno={}", errno);
+    }
+    return false;
+  }
+};
+
 } // namespace tskv::storage
 
 namespace ts = tskv::storage;
@@ -21,7 +271,7 @@ export namespace tskv::common {
 
 template <>
 struct enum_traits<ts::WALSyncPolicy> {
-  static constexpr std::array<std::pair<ts::WALSyncPolicy, std::string_view>, 3> entries{{
+  static constexpr std::array<std::pair<ts::WALSyncPolicy, std::string_view>, 2> entries{{
     {ts::WALSyncPolicy::Append, "append"},
     {ts::WALSyncPolicy::FDataSync, "fdatasync"},
   }};
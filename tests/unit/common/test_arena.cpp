@@ -0,0 +1,65 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <doctest.h>
+
+import tskv.common.arena;
+namespace tc = tskv::common;
+
+namespace { // helper functions
+
+bool aligned_to(const void* p, std::size_t align)
+{
+  return reinterpret_cast<std::uintptr_t>(p) % align == 0;
+}
+
+} // namespace
+
+TEST_SUITE("common.arena")
+{
+  TEST_CASE("bump_allocation")
+  {
+    tc::PageArena arena({.huge_pages = tc::HugePages::Off});
+    CHECK(arena.regions() == 0);
+    CHECK(arena.mapped_bytes() == 0);
+
+    auto* a = static_cast<std::byte*>(arena.allocate(100, 8));
+    auto* b = static_cast<std::byte*>(arena.allocate(10, 64));
+    auto* c = static_cast<std::byte*>(arena.allocate(1, 1));
+
+    CHECK(aligned_to(a, tc::PageArena::REGION_BYTES)); // fresh regions start huge-page aligned
+    CHECK(aligned_to(b, 64));
+    CHECK(b >= a + 100);
+    CHECK(c >= b + 10);
+    CHECK(arena.regions() == 1);
+    CHECK(arena.mapped_bytes() == tc::PageArena::REGION_BYTES);
+
+    // memory is usable
+    std::memset(a, 0xAB, 100);
+    std::memset(b, 0xCD, 10);
+    CHECK(a[99] == std::byte{0xAB});
+  }
+
+  TEST_CASE("region_overflow")
+  {
+    tc::PageArena arena({.huge_pages = tc::HugePages::Transparent});
+
+    (void)arena.allocate(tc::PageArena::REGION_BYTES - 16, 16);
+    auto* big = arena.allocate(tc::PageArena::REGION_BYTES + 1, 64);
+
+    CHECK(aligned_to(big, tc::PageArena::REGION_BYTES));
+    CHECK(arena.regions() == 2);
+    CHECK(arena.mapped_bytes() == 3 * tc::PageArena::REGION_BYTES); // 2 MiB + 4 MiB
+    std::memset(big, 0, tc::PageArena::REGION_BYTES + 1);
+  }
+
+  TEST_CASE("numa_placement")
+  {
+    tc::PageArena local;
+    CHECK(local.options().numa_node == tc::current_numa_node());
+
+    tc::PageArena unbound({.numa_node = tc::ArenaOptions::NUMA_NONE});
+    (void)unbound.allocate(64, 64);
+    CHECK(unbound.numa_bound_regions() == 0);
+  }
+}
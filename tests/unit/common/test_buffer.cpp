@@ -1,12 +1,15 @@
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <doctest.h>
 #include <span>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 import tskv.common.buffer;
+import tskv.common.buffer_pool;
 namespace tc = tskv::common;
 
 namespace { // helper functions
@@ -18,15 +21,15 @@ inline std::span<const std::byte> as_bytes(std::string_view s)
 }
 
 // Write a whole string into the buffer; returns bytes written.
-template <std::size_t N>
-std::size_t write_string(tc::SimpleBuffer<N>& buf, std::string_view s)
+template <tc::Buffer B>
+std::size_t write_string(B& buf, std::string_view s)
 {
   return buf.write_from(as_bytes(s));
 }
 
 // Read up to max_len bytes from the buffer into a std::string.
-template <std::size_t N>
-std::string read_string(tc::SimpleBuffer<N>& buf, std::size_t max_len = N)
+template <tc::Buffer B>
+std::string read_string(B& buf, std::size_t max_len = B::capacity())
 {
   std::vector<std::byte> tmp(max_len);
   std::span<std::byte>   dst(tmp.data(), tmp.size());
@@ -40,8 +43,8 @@ std::string read_string(std::span<const std::byte> bytes)
 }
 
 // Non-consuming peek via readable_span.
-template <std::size_t N>
-std::string peek_string(const tc::SimpleBuffer<N>& buf, std::size_t max_len)
+template <tc::Buffer B>
+std::string peek_string(const B& buf, std::size_t max_len)
 {
   auto src = buf.readable_span(max_len);
   return std::string(reinterpret_cast<const char*>(src.data()), src.size());
@@ -193,4 +196,249 @@ TEST_SUITE("common.buffer")
     CHECK(buf.used_space() == 3);
     CHECK(peek_string(buf, 3) == "xyz");
   }
+
+  TEST_CASE("mirrored_default_state")
+  {
+    tc::MirroredBuffer<4096> buf;
+
+    CHECK(buf.capacity() == 4096);
+    CHECK(buf.used_space() == 0);
+    CHECK(buf.free_space() == 4096);
+    CHECK(buf.empty());
+    CHECK_FALSE(buf.full());
+    CHECK(buf.writable_span().size() == 4096);
+    CHECK(buf.readable_span().empty());
+  }
+
+  TEST_CASE("mirrored_write_read_roundtrip")
+  {
+    tc::MirroredBuffer<4096> buf;
+
+    CHECK(write_string(buf, "hello") == 5);
+    CHECK(buf.used_space() == 5);
+    CHECK(peek_string(buf, 16) == "hello");
+    CHECK(read_string(buf) == "hello");
+    CHECK(buf.empty());
+  }
+
+  TEST_CASE("mirrored_write_truncates_on_overflow")
+  {
+    tc::MirroredBuffer<4096> buf;
+
+    const std::string input(5000, 'x');
+    CHECK(write_string(buf, input) == 4096);
+    CHECK(buf.full());
+    CHECK(buf.writable_span().empty());
+    CHECK(write_string(buf, "Z") == 0);
+  }
+
+  TEST_CASE("mirrored_spans_stay_contiguous_across_wrap")
+  {
+    tc::MirroredBuffer<4096> buf;
+
+    // advance the read position close to the end of the ring
+    const std::string filler(4090, '.');
+    CHECK(write_string(buf, filler) == filler.size());
+    buf.consume(4090 - 2); // 2 bytes left, head at 4088
+    CHECK(buf.used_space() == 2);
+
+    // this write physically wraps around to the start of the ring
+    CHECK(write_string(buf, "abcdefghij") == 10);
+    CHECK(buf.used_space() == 12);
+
+    auto r = buf.readable_span();
+    CHECK(r.size() == 12);
+    CHECK(read_string(r) == "..abcdefghij");
+
+    // writable span also crosses the wrap point in one piece
+    auto w = buf.writable_span();
+    CHECK(w.size() == 4096 - 12);
+    std::memset(w.data(), 'q', w.size());
+    buf.commit(w.size());
+    CHECK(buf.full());
+
+    buf.consume(2);
+    CHECK(peek_string(buf, 10) == "abcdefghij");
+  }
+
+  TEST_CASE("mirrored_commit_and_consume_clamp")
+  {
+    tc::MirroredBuffer<4096> buf;
+
+    auto w = buf.writable_span(3);
+    CHECK(w.size() == 3);
+    std::memcpy(w.data(), "abc", 3);
+    buf.commit(3);
+    CHECK(peek_string(buf, 3) == "abc");
+
+    buf.consume(0);
+    CHECK(buf.used_space() == 3);
+
+    buf.consume(100);
+    CHECK(buf.empty());
+    CHECK(buf.free_space() == buf.capacity());
+  }
+
+  TEST_CASE("mirrored_matches_reference_under_pipelined_traffic")
+  {
+    tc::MirroredBuffer<4096> buf;
+
+    // stream a deterministic byte sequence through the ring in odd-sized writes and reads
+    std::uint8_t next_in    = 0;
+    std::uint8_t next_out   = 0;
+    std::size_t  total      = 0;
+    std::size_t  mismatches = 0;
+
+    for (std::size_t round = 0; round < 10'000; ++round) {
+      const std::size_t nwrite = (round * 131) % 977 + 1;
+
+      auto w = buf.writable_span(nwrite);
+      for (std::byte& b : w) {
+        b = static_cast<std::byte>(next_in++);
+      }
+      buf.commit(w.size());
+
+      const std::size_t nread = (round * 89) % 613 + 1;
+
+      auto r = buf.readable_span(nread);
+      for (const std::byte b : r) {
+        mismatches += b != static_cast<std::byte>(next_out++);
+      }
+      buf.consume(r.size());
+      total += r.size();
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(total > 4 * buf.capacity()); // wrapped many times
+  }
+
+  TEST_CASE("mirrored_move")
+  {
+    tc::MirroredBuffer<4096> a;
+    write_string(a, "payload");
+
+    tc::MirroredBuffer<4096> b(std::move(a));
+    CHECK(peek_string(b, 16) == "payload");
+
+    tc::MirroredBuffer<4096> c;
+    write_string(c, "old");
+    c = std::move(b);
+    CHECK(peek_string(c, 16) == "payload");
+
+    a = std::move(c); // moved-from buffers can be assigned to
+    CHECK(read_string(a) == "payload");
+  }
+
+  TEST_CASE("mirrored_clear_resets_state")
+  {
+    tc::MirroredBuffer<4096> buf;
+
+    write_string(buf, std::string(4000, 'x'));
+    buf.consume(3999);
+    buf.clear();
+    CHECK(buf.empty());
+    CHECK(buf.writable_span().size() == buf.capacity());
+
+    write_string(buf, "xyz");
+    CHECK(peek_string(buf, 3) == "xyz");
+  }
+
+  TEST_CASE("pooled_holds_no_memory_while_empty")
+  {
+    tc::BufferPool&   pool   = tc::BufferPool::local();
+    const std::size_t before = pool.leased_bytes();
+
+    tc::PooledBuffer<65536> buf;
+    CHECK(buf.empty());
+    CHECK(buf.leased_bytes() == 0);
+    CHECK(buf.readable_span().empty());
+
+    CHECK(write_string(buf, "hello") == 5);
+    CHECK(buf.leased_bytes() == 4096);
+    CHECK(pool.leased_bytes() == before + 4096);
+
+    CHECK(read_string(buf) == "hello");
+    CHECK(buf.leased_bytes() == 0);
+    CHECK(pool.leased_bytes() == before);
+
+    // a writable_span/commit(0) pair (a recv() that hit EAGAIN) gives the block straight back
+    CHECK(buf.writable_span().size() == 4096);
+    buf.commit(0);
+    CHECK(buf.leased_bytes() == 0);
+    CHECK(pool.leased_bytes() == before);
+  }
+
+  TEST_CASE("pooled_grows_through_tiers_up_to_capacity")
+  {
+    tc::PooledBuffer<65536> buf;
+
+    std::string src(70000, '\0');
+    for (std::size_t i = 0; i < src.size(); ++i) {
+      src[i] = static_cast<char>('a' + i % 26);
+    }
+
+    CHECK(write_string(buf, std::string_view(src).substr(0, 5000)) == 5000);
+    CHECK(buf.leased_bytes() == 16384);
+
+    // truncates at capacity(), keeping everything written so far in order
+    CHECK(write_string(buf, std::string_view(src).substr(5000)) == 65536 - 5000);
+    CHECK(buf.full());
+    CHECK(buf.leased_bytes() == 65536);
+    CHECK(buf.writable_span().empty());
+    CHECK(peek_string(buf, 65536) == src.substr(0, 65536));
+
+    buf.consume(65535);
+    CHECK(peek_string(buf, 1) == src.substr(65535, 1));
+    CHECK(buf.leased_bytes() == 65536); // partially drained buffers keep their block
+
+    buf.clear();
+    CHECK(buf.leased_bytes() == 0);
+  }
+
+  TEST_CASE("pooled_writable_span_only_grows_a_full_block")
+  {
+    tc::PooledBuffer<16384> buf;
+
+    write_string(buf, std::string(4000, 'x'));
+    CHECK(buf.writable_span().size() == 96); // room left in the 4 KiB block
+    CHECK(buf.leased_bytes() == 4096);
+
+    auto w = buf.writable_span();
+    std::memset(w.data(), 'y', w.size());
+    buf.commit(w.size());
+
+    CHECK(buf.writable_span(100).size() == 100); // now moved up to 16 KiB
+    buf.commit(0);
+    CHECK(buf.leased_bytes() == 16384);
+    CHECK(peek_string(buf, 4096) == std::string(4000, 'x') + std::string(96, 'y'));
+  }
+
+  TEST_CASE("pooled_move_and_block_reuse")
+  {
+    tc::BufferPool&   pool   = tc::BufferPool::local();
+    const std::size_t before = pool.leased_bytes();
+    {
+      tc::PooledBuffer<4096> a;
+      write_string(a, "payload");
+
+      tc::PooledBuffer<4096> b(std::move(a));
+      CHECK(a.leased_bytes() == 0);
+      CHECK(peek_string(b, 16) == "payload");
+
+      tc::PooledBuffer<4096> c;
+      write_string(c, "old");
+      c = std::move(b);
+      CHECK(peek_string(c, 16) == "payload");
+      CHECK(pool.leased_bytes() == before + 4096);
+    }
+    CHECK(pool.leased_bytes() == before);
+
+    // released blocks are handed out again rather than growing the pool
+    const std::size_t reserved = pool.reserved_bytes();
+    for (int i = 0; i < 1000; ++i) {
+      tc::PooledBuffer<4096> buf;
+      write_string(buf, "x");
+    }
+    CHECK(pool.reserved_bytes() == reserved);
+  }
 }
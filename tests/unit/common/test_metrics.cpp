@@ -4,6 +4,8 @@
 #include <array>
 #include <barrier>
 #include <chrono>
+#include <cstdint>
+#include <limits>
 #include <random>
 #include <thread>
 #include <vector>
@@ -147,4 +149,119 @@ TEST_SUITE("tskv.common.metrics")
     metrics::global_reset();
     CHECK(metrics::get_gauge<"testg.foo_mt">() == 0);
   }
+
+  TEST_CASE("additive_gauges.relative_updates")
+  {
+    metrics::global_reset();
+
+    metrics::add_gauge<"testg.foo_st">(5);
+    metrics::sub_gauge<"testg.foo_st">(2);
+    CHECK(metrics::get_gauge<"testg.foo_st">() == 3);
+
+    // each thread adds 3 and removes 1; the shards only meet in the global sum
+    constexpr std::size_t nthreads = 4;
+
+    auto worker = [&] {
+      for (int i = 0; i < 3; ++i) {
+        metrics::add_gauge<"testg.foo_mt">(1);
+      }
+      metrics::sub_gauge<"testg.foo_mt">(1);
+      metrics::flush_thread(0ms);
+    };
+
+    {
+      std::vector<std::jthread> threads;
+      for (std::size_t i = 0; i < nthreads; ++i) {
+        threads.emplace_back(worker);
+      }
+    }
+
+    CHECK(metrics::get_gauge<"testg.foo_mt">() == nthreads * 2);
+
+    // a shard going "negative" still sums correctly
+    metrics::sub_gauge<"testg.foo_mt">(1);
+    metrics::flush_thread(0ms);
+    CHECK(metrics::get_gauge<"testg.foo_mt">() == nthreads * 2 - 1);
+
+    metrics::global_reset();
+  }
+
+  TEST_CASE("histograms.bucketing")
+  {
+    using H = metrics::Histogram;
+
+    // exact below 16, then contiguous log-linear buckets
+    for (std::uint64_t v = 0; v < 16; ++v) {
+      CHECK(H::bucket_of(v) == v);
+    }
+    for (std::size_t b = 1; b < H::NBUCKETS; ++b) {
+      CHECK(H::bucket_of(H::bucket_upper(b - 1) + 1) == b);
+      CHECK(H::bucket_of(H::bucket_upper(b)) == b);
+    }
+    CHECK(H::bucket_of(std::numeric_limits<std::uint64_t>::max()) == H::NBUCKETS - 1);
+
+    // relative bucket width stays within 1/16
+    for (std::size_t b = 16; b < H::NBUCKETS; ++b) {
+      const std::uint64_t lo = H::bucket_upper(b - 1) + 1;
+      CHECK((H::bucket_upper(b) - lo) <= lo / 16);
+    }
+  }
+
+  TEST_CASE("histograms.quantiles_single_threaded")
+  {
+    metrics::global_reset();
+
+    CHECK(metrics::get_histogram<"testh.foo_st">().quantile(0.99) == 0);
+
+    for (std::uint64_t v = 1; v <= 1000; ++v) {
+      metrics::record_histogram<"testh.foo_st">(v * 1000);
+    }
+
+    const metrics::Histogram h = metrics::get_histogram<"testh.foo_st">();
+    CHECK(h.count == 1000);
+    CHECK(h.max == 1'000'000);
+    CHECK(h.sum == 1000 * 1001 / 2 * 1000);
+
+    const auto near = [](std::uint64_t got, std::uint64_t want) {
+      return got >= want && got <= want + want / 16;
+    };
+    CHECK(near(h.quantile(0.5), 500'000));
+    CHECK(near(h.quantile(0.99), 990'000));
+    CHECK(h.quantile(1.0) == 1'000'000);
+    CHECK(h.quantile(0.0) == 1023); // first bucket holding 1000
+
+    metrics::global_reset();
+  }
+
+  TEST_CASE("histograms.multi_threaded")
+  {
+    metrics::global_reset();
+
+    constexpr std::size_t nthreads = 4;
+
+    auto worker = [&] {
+      for (std::uint64_t v = 0; v < 10000; ++v) {
+        metrics::record_histogram<"testh.foo_mt">(v % 100);
+        if (v % 1000 == 0) {
+          metrics::flush_thread(0ms);
+        }
+      }
+      metrics::flush_thread(0ms);
+    };
+
+    {
+      std::vector<std::jthread> threads;
+      for (std::size_t i = 0; i < nthreads; ++i) {
+        threads.emplace_back(worker);
+      }
+    }
+
+    const metrics::Histogram h = metrics::get_histogram<"testh.foo_mt">();
+    CHECK(h.count == nthreads * 10000);
+    CHECK(h.max == 99);
+    CHECK(h.quantile(0.5) >= 49);
+    CHECK(h.quantile(0.5) <= 51);
+
+    metrics::global_reset();
+  }
 }
@@ -0,0 +1,99 @@
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+
+import tskv.common.enum_traits;
+import tskv.common.scan;
+namespace tc = tskv::common;
+
+namespace { // helper functions
+
+inline std::span<const std::byte> as_bytes(std::string_view s)
+{
+  return {reinterpret_cast<const std::byte*>(s.data()), s.size()};
+}
+
+constexpr tc::ScanIsa ALL_ISAS[] = {tc::ScanIsa::Scalar, tc::ScanIsa::Sse2, tc::ScanIsa::Avx2};
+
+} // namespace
+
+TEST_SUITE("tskv.common.scan")
+{
+  TEST_CASE("kernels_agree")
+  {
+    const tc::ScanKernels& scalar = tc::scan_kernels(tc::ScanIsa::Scalar);
+
+    // mostly CR, LF and digits, so matches land at every offset relative to the vector width
+    std::mt19937 rng(42);
+    const char   alphabet[] = "\r\n0123456789$*x";
+    for (int round = 0; round < 2000; ++round) {
+      std::string s(rng() % 80, ' ');
+      for (char& c : s) {
+        c = alphabet[rng() % (sizeof alphabet - 1)];
+      }
+      const auto bytes = as_bytes(s);
+
+      for (const tc::ScanIsa isa : ALL_ISAS) {
+        const tc::ScanKernels& kernels = tc::scan_kernels(isa);
+        CAPTURE(tc::to_string(kernels.isa));
+        CHECK(kernels.find_crlf(bytes) == scalar.find_crlf(bytes));
+      }
+    }
+
+    const std::string digits(40, '7');
+    for (const tc::ScanIsa isa : ALL_ISAS) {
+      CHECK(tc::scan_kernels(isa).find_crlf(as_bytes(digits + "\r")) == 41);
+      CHECK(tc::scan_kernels(isa).find_crlf(as_bytes(digits + "\r\n")) == 40);
+    }
+  }
+
+  TEST_CASE("set_scan_isa")
+  {
+    const tc::ScanIsa previous = tc::set_scan_isa(tc::ScanIsa::Scalar);
+    CHECK(tc::scan_isa() == tc::ScanIsa::Scalar);
+    CHECK(tc::find_crlf(as_bytes("GET\r\n")) == 3);
+    CHECK(tc::set_scan_isa(previous) == tc::ScanIsa::Scalar);
+    CHECK(tc::scan_isa() == previous);
+    CHECK(tc::find_crlf(as_bytes("GET\r\n")) == 3);
+  }
+
+  TEST_CASE("parse_int_line")
+  {
+    const auto parse = [](std::string_view s) { return tc::parse_int_line(as_bytes(s)); };
+
+    tc::IntLine line = parse("3\r\n$3\r\nSET");
+    CHECK(line.status == tc::IntLineStatus::Ok);
+    CHECK(line.size == 3);
+    CHECK(line.value == 3);
+
+    line = parse("-1\r\n");
+    CHECK(line.status == tc::IntLineStatus::Ok);
+    CHECK(line.value == -1);
+
+    // the short path (fewer than 8 bytes left) and each SWAR chunk split
+    for (const std::string_view digits :
+         {"7", "12345678", "123456789", "1234567890123456", "123456789012345678"}) {
+      const std::string text = std::string(digits) + "\r\n";
+      line                   = parse(text);
+      CHECK(line.status == tc::IntLineStatus::Ok);
+      CHECK(line.value == std::stoll(std::string(digits)));
+      CHECK(parse(text + "*2\r\n$4\r\nPING\r\n").value == line.value);
+    }
+
+    for (const std::string_view partial : {"", "-", "12", "12\r"}) {
+      CHECK(parse(partial).status == tc::IntLineStatus::Incomplete);
+    }
+    for (const std::string_view bad :
+         {"\r\n", "-\r\n", "+1\r\n", "1x\r\n", "1\rx", "12:\r\n5678", "9/\r\n5678"}) {
+      CHECK(parse(bad).status == tc::IntLineStatus::Bad);
+    }
+    CHECK(parse("1234567890123456789\r\n").status == tc::IntLineStatus::Bad); // 19 digits
+    for (const std::string_view bad : {"\xff\r\n", "1\xfa\r\n"}) {
+      CHECK(parse(bad).status == tc::IntLineStatus::Bad);
+    }
+  }
+}
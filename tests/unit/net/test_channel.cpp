@@ -0,0 +1,775 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <doctest.h>
+#include <memory>
+#include <netinet/in.h>
+#include <poll.h>
+#include <span>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+import tskv.common.buffer;
+import tskv.common.metrics;
+import tskv.net.channel;
+import tskv.net.completion_queue;
+import tskv.net.tx_queue;
+namespace tc      = tskv::common;
+namespace metrics = tskv::common::metrics;
+namespace tn      = tskv::net;
+
+// Echo protocol opting into mirrored ring buffers via channel_traits.
+struct MirroredEcho {
+  void on_read(tn::ChannelIO<MirroredEcho>& io)
+  {
+    const auto [bytes_sent, result] = io.tx_send(io.rx_span());
+    io.rx_consume(bytes_sent);
+  }
+
+  void on_error(tn::ChannelIO<MirroredEcho>&, int) {}
+  void on_close(tn::ChannelIO<MirroredEcho>&) {}
+};
+
+template <>
+struct tskv::net::channel_traits<MirroredEcho> {
+  using rx_buffer = tc::MirroredBuffer<4096>;
+  using tx_buffer = tc::MirroredBuffer<4096>;
+};
+
+using Pool = tn::ChannelPool<tn::EchoProtocol>;
+
+namespace { // helper functions
+
+// Release every active fd so the pool destructor's emptiness check holds.
+void release_all(Pool& pool)
+{
+  std::vector<int> fds;
+  pool.for_each([&](auto* ch) { fds.push_back(ch->fd()); });
+  for (const int fd : fds) {
+    pool.lookup(fd)->detach();
+    pool.release(fd);
+  }
+}
+
+// Read whatever is available on a nonblocking fd, appending it to `out`.
+void drain_into(int fd, std::string& out)
+{
+  char    chunk[1 << 16];
+  ssize_t n;
+  while ((n = ::read(fd, chunk, sizeof chunk)) > 0) {
+    out.append(chunk, static_cast<std::size_t>(n));
+  }
+}
+
+// Sends a small header with tx_send and a large body with tx_enqueue, as a protocol serving
+// big values would.
+struct Streamer {
+  std::string                  header = "HDR:";
+  std::shared_ptr<std::string> body;
+  std::vector<tn::SendResult>  results;
+
+  void on_read(tn::ChannelIO<Streamer>& io)
+  {
+    io.rx_consume(io.rx_span().size());
+    results.push_back(io.tx_send(std::as_bytes(std::span(header))).second);
+
+    const tn::TxSegment seg{body, std::as_bytes(std::span(*body))};
+    results.push_back(io.tx_enqueue(seg.subsegment(0, body->size() / 2)));
+    results.push_back(io.tx_enqueue(seg.subsegment(body->size() / 2, body->size() / 2)));
+    body.reset(); // the queued segments own it now
+
+    // anything sent now would have to wait behind the body
+    results.push_back(io.tx_send(std::as_bytes(std::span(header))).second);
+  }
+  void on_error(tn::ChannelIO<Streamer>&, int) {}
+  void on_close(tn::ChannelIO<Streamer>&) {}
+};
+
+// Bounds each request with a deadline and answers late ones itself.
+struct Deadlined {
+  int timeouts = 0;
+
+  void on_read(tn::ChannelIO<Deadlined>& io)
+  {
+    io.rx_consume(io.rx_span().size());
+    io.set_deadline(50ms);
+  }
+  void on_timeout(tn::ChannelIO<Deadlined>& io)
+  {
+    ++timeouts;
+    const std::string msg = "TIMEOUT";
+    (void)io.tx_send(std::as_bytes(std::span(msg)));
+    io.clear_deadline();
+  }
+  void on_error(tn::ChannelIO<Deadlined>&, int) {}
+  void on_close(tn::ChannelIO<Deadlined>&) {}
+};
+
+// Hands every request off to "another thread" (the test) and answers through a CompletionTarget.
+struct Offloading {
+  std::vector<tn::CompletionTarget> targets;
+
+  void on_read(tn::ChannelIO<Offloading>& io)
+  {
+    io.rx_consume(io.rx_span().size());
+    targets.push_back(io.completion_target());
+  }
+  void on_error(tn::ChannelIO<Offloading>&, int) {}
+  void on_close(tn::ChannelIO<Offloading>&) {}
+};
+
+// Messages are a u32 length, then that many bytes; bodies are received with rx_stream into a
+// buffer of their own, whatever their size. Replies with the byte sum of each body.
+struct BodyReader {
+  std::vector<std::byte>   body;
+  std::vector<std::size_t> sizes;
+
+  void on_read(tn::ChannelIO<BodyReader>& io)
+  {
+    const auto rx = io.rx_span();
+    if (rx.size() < 4) {
+      return;
+    }
+    std::uint32_t length = 0;
+    std::memcpy(&length, rx.data(), sizeof length);
+    io.rx_consume(4);
+
+    body.resize(length);
+    io.rx_stream(body);
+  }
+  void on_body(tn::ChannelIO<BodyReader>& io)
+  {
+    CHECK(io.rx_stream_remaining() == 0);
+    sizes.push_back(body.size());
+
+    std::uint64_t sum = 0;
+    for (const std::byte b : body) {
+      sum += std::to_integer<std::uint8_t>(b);
+    }
+    (void)io.tx_send(std::as_bytes(std::span(&sum, 1)));
+  }
+  void on_error(tn::ChannelIO<BodyReader>&, int) {}
+  void on_close(tn::ChannelIO<BodyReader>&) {}
+};
+
+// Length-prefixed message with a patterned body, as BodyReader expects.
+std::vector<std::byte> body_message(std::size_t size, std::uint64_t& sum)
+{
+  std::vector<std::byte> out(4 + size);
+  const auto             length = static_cast<std::uint32_t>(size);
+  std::memcpy(out.data(), &length, sizeof length);
+  sum = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    out[4 + i] = static_cast<std::byte>(i * 13);
+    sum += static_cast<std::uint8_t>(i * 13);
+  }
+  return out;
+}
+
+} // namespace
+
+TEST_SUITE("tskv.net.channel")
+{
+  TEST_CASE("event_tag.roundtrip")
+  {
+    const std::uint64_t tag = tn::make_event_tag(12345, 0xDEADBEEF);
+    CHECK(tn::event_tag_fd(tag) == 12345);
+    CHECK(tn::event_tag_generation(tag) == 0xDEADBEEF);
+
+    CHECK(tn::make_event_tag(7, 0) == 7);
+  }
+
+  TEST_CASE("pool.acquire_lookup_release")
+  {
+    Pool pool;
+    CHECK(pool.empty());
+    CHECK(pool.lookup(3) == nullptr);
+    CHECK(pool.lookup(1 << 20) == nullptr);
+
+    auto* ch = pool.acquire(3);
+    REQUIRE(ch != nullptr);
+    ch->attach(3);
+
+    CHECK_FALSE(pool.empty());
+    CHECK(pool.size() == 1);
+    CHECK(pool.lookup(3) == ch);
+    CHECK(pool.lookup(2) == nullptr);
+    CHECK(pool.lookup(4) == nullptr);
+
+    ch->detach();
+    pool.release(3);
+    CHECK(pool.empty());
+    CHECK(pool.lookup(3) == nullptr);
+  }
+
+  TEST_CASE("pool.stale_tags")
+  {
+    Pool pool;
+
+    (void)pool.acquire(5);
+    const std::uint64_t old_tag = pool.event_tag(5);
+    CHECK(tn::event_tag_fd(old_tag) == 5);
+    CHECK(tn::event_tag_generation(old_tag) != 0);
+    CHECK(pool.lookup_tagged(old_tag) == pool.lookup(5));
+
+    pool.release(5);
+    CHECK(pool.lookup_tagged(old_tag) == nullptr);
+
+    auto* reused = pool.acquire(5);
+    REQUIRE(reused != nullptr);
+    const std::uint64_t new_tag = pool.event_tag(5);
+
+    CHECK(new_tag != old_tag);
+    CHECK(pool.lookup_tagged(old_tag) == nullptr);
+    CHECK(pool.lookup_tagged(new_tag) == reused);
+
+    // generation 0 is reserved for reactor-owned descriptors
+    CHECK(pool.lookup_tagged(tn::make_event_tag(5, 0)) == nullptr);
+
+    pool.release(5);
+  }
+
+  TEST_CASE("pool.for_each")
+  {
+    Pool pool;
+
+    for (int fd = 0; fd < 1000; ++fd) {
+      pool.acquire(fd)->attach(fd);
+    }
+
+    // release every third fd, exercising swap-removal from the middle of the active list
+    for (int fd = 0; fd < 1000; fd += 3) {
+      pool.lookup(fd)->detach();
+      pool.release(fd);
+    }
+
+    std::vector<int> visited;
+    pool.for_each([&](auto* ch) { visited.push_back(ch->fd()); });
+    std::ranges::sort(visited);
+
+    std::vector<int> expected;
+    for (int fd = 0; fd < 1000; ++fd) {
+      if (fd % 3 != 0) {
+        expected.push_back(fd);
+      }
+    }
+
+    CHECK(visited == expected);
+    CHECK(pool.size() == expected.size());
+
+    release_all(pool);
+    CHECK(pool.empty());
+  }
+
+  TEST_CASE("pool.state_lists")
+  {
+    using tn::ChannelState;
+
+    // fds nothing in this process has open: aborting a channel shuts its socket down
+    constexpr int BASE = 900;
+
+    Pool pool;
+    for (int fd = BASE; fd < BASE + 10; ++fd) {
+      pool.acquire(fd)->attach(fd);
+    }
+    CHECK(pool.count_in(ChannelState::Running) == 10);
+    CHECK(pool.count_in(ChannelState::Draining) == 0);
+
+    pool.lookup(BASE + 3)->begin_shutdown();
+    pool.lookup(BASE + 4)->on_peer_eof();
+    pool.lookup(BASE + 5)->on_io_error(ECONNRESET);
+    pool.lookup(BASE + 6)->on_io_error(ECONNRESET);
+    pool.lookup(BASE + 6)->begin_shutdown(); // aborting wins; no transition
+    CHECK(pool.count_in(ChannelState::Running) == 6);
+    CHECK(pool.count_in(ChannelState::Draining) == 2);
+    CHECK(pool.count_in(ChannelState::Aborting) == 2);
+
+    std::vector<int> draining;
+    pool.for_each_in(ChannelState::Draining, [&](auto* ch) { draining.push_back(ch->fd()); });
+    std::ranges::sort(draining);
+    CHECK(draining == std::vector<int>{BASE + 3, BASE + 4});
+
+    // the visitor may close what it visits, as the reactor's sweep does
+    pool.for_each_in(ChannelState::Aborting, [&](auto* ch) {
+      const int fd = ch->fd();
+      ch->detach();
+      pool.release(fd);
+    });
+    CHECK(pool.count_in(ChannelState::Aborting) == 0);
+    CHECK(pool.size() == 8);
+
+    // a slot released without detach() must not leave a dangling link behind
+    pool.release(BASE + 7);
+    CHECK(pool.count_in(ChannelState::Running) == 5);
+    pool.acquire(BASE + 7)->attach(BASE + 7);
+    CHECK(pool.count_in(ChannelState::Running) == 6);
+    CHECK(pool.count_backpressured() == 0);
+
+    release_all(pool);
+    CHECK(pool.count_in(ChannelState::Running) == 0);
+    CHECK(pool.count_in(ChannelState::Draining) == 0);
+  }
+
+  TEST_CASE("channel_traits.buffers")
+  {
+    tn::ChannelPool<MirroredEcho> pool;
+
+    auto* ch = pool.acquire(9);
+    REQUIRE(ch != nullptr);
+    ch->attach(9);
+
+    std::vector<std::byte> stream(6000);
+    for (std::size_t i = 0; i < stream.size(); ++i) {
+      stream[i] = static_cast<std::byte>(i * 7);
+    }
+    const std::span<const std::byte> src(stream);
+
+    CHECK(ch->deliver_rx(src.first(3000)) == 3000);
+    REQUIRE(ch->tx_pending().size() == 3000);
+    ch->tx_complete(1000);
+
+    // 2000 bytes still queued at offset 1000: the next 2096 echoed bytes wrap past the end
+    CHECK(ch->deliver_rx(src.subspan(3000)) == 3000);
+
+    const auto pending = ch->tx_pending();
+    REQUIRE(pending.size() == 4096);
+    CHECK(std::ranges::equal(pending, src.subspan(1000, 4096)));
+
+    // the remainder waited in RX for TX space; the backend re-runs the protocol once TX drains
+    ch->tx_complete(pending.size());
+    CHECK(ch->deliver_rx({}) == 0);
+    REQUIRE(ch->tx_pending().size() == 904);
+    CHECK(std::ranges::equal(ch->tx_pending(), src.subspan(5096)));
+
+    ch->detach();
+    pool.release(9);
+  }
+
+  TEST_CASE("io_budget.deferral")
+  {
+    int sv[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    const int fd   = sv[0];
+    const int peer = sv[1];
+
+    Pool pool;
+    auto* ch = pool.acquire(fd);
+    REQUIRE(ch != nullptr);
+    ch->attach(fd);
+
+    const std::vector<char> payload(3000, 'z');
+    REQUIRE(::write(peer, payload.data(), payload.size()) == 3000);
+
+    // each pass reads (and echoes) at most 1000 bytes, then asks to be called again
+    std::size_t passes = 0;
+    ch->handle_events(EPOLLIN, tn::IoBudget{.rx_bytes = 1000});
+    while (ch->deferred_events() != 0) {
+      CHECK(ch->deferred_events() == EPOLLIN);
+      ch->handle_events(ch->deferred_events(), tn::IoBudget{.rx_bytes = 1000});
+      ++passes;
+    }
+    CHECK(passes == 3); // the third replay is the one that finally observes EAGAIN
+
+    std::vector<char> echoed(4096);
+    CHECK(::read(peer, echoed.data(), echoed.size()) == 3000);
+
+    // unlimited budget: everything in one pass, nothing deferred
+    REQUIRE(::write(peer, payload.data(), payload.size()) == 3000);
+    ch->handle_events(EPOLLIN);
+    CHECK(ch->deferred_events() == 0);
+    CHECK(::read(peer, echoed.data(), echoed.size()) == 3000);
+
+    ch->detach();
+    pool.release(fd);
+    ::close(fd);
+    ::close(peer);
+  }
+
+  TEST_CASE("backpressure.pauses_reads")
+  {
+    metrics::flush_thread(0ms); // drop whatever earlier cases left in this thread's shard
+    metrics::global_reset();
+
+    int sv[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    const int fd   = sv[0];
+    const int peer = sv[1];
+
+    // fill the socket's send path so nothing the channel queues can be flushed
+    const int small = 4096;
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &small, sizeof small);
+    std::vector<char> junk(1 << 16, 'j');
+    while (::write(fd, junk.data(), junk.size()) > 0) {
+    }
+
+    Pool pool;
+    auto* ch = pool.acquire(fd);
+    REQUIRE(ch != nullptr);
+    ch->attach(fd);
+
+    // the echo can't leave TX, so TX crosses its high watermark and reading stops
+    const std::vector<char> payload(4000, 'e');
+    REQUIRE(::write(peer, payload.data(), payload.size()) == 4000);
+    ch->handle_events(EPOLLIN);
+
+    CHECK(ch->backpressured());
+    CHECK(pool.count_backpressured() == 1);
+    CHECK((ch->desired_events() & EPOLLIN) == 0);
+    CHECK((ch->desired_events() & EPOLLOUT) != 0);
+
+    metrics::flush_thread(0ms);
+    CHECK(metrics::get_counter<"net.backpressure_events_total">() == 1);
+    CHECK(metrics::get_gauge<"net.backpressured_connections">() == 1);
+
+    // peer catches up: TX drains below the low watermark and reading resumes
+    std::vector<char> sink(1 << 16);
+    while (::read(peer, sink.data(), sink.size()) > 0) {
+    }
+    ch->handle_events(EPOLLOUT);
+
+    CHECK_FALSE(ch->backpressured());
+    CHECK(pool.count_backpressured() == 0);
+    CHECK((ch->desired_events() & EPOLLIN) != 0);
+
+    metrics::flush_thread(0ms);
+    CHECK(metrics::get_gauge<"net.backpressured_connections">() == 0);
+
+    ch->detach();
+    pool.release(fd);
+    ::close(fd);
+    ::close(peer);
+    metrics::global_reset();
+  }
+
+  TEST_CASE("tx_send.backpressure")
+  {
+    std::vector<std::byte> chunk(1024);
+
+    // Drives tx_send from inside the protocol, the only place ChannelIO is available.
+    struct Probe {
+      std::span<const std::byte>  chunk;
+      std::vector<tn::SendResult> results;
+      std::vector<bool>           flags;
+
+      void on_read(tn::ChannelIO<Probe>& io)
+      {
+        for (int i = 0; i < 5; ++i) {
+          results.push_back(io.tx_send(chunk).second);
+          flags.push_back(io.backpressured());
+        }
+        io.rx_consume(io.rx_span().size());
+      }
+      void on_error(tn::ChannelIO<Probe>&, int) {}
+      void on_close(tn::ChannelIO<Probe>&) {}
+    };
+
+    tn::ChannelPool<Probe> pool;
+    auto* ch = pool.acquire(11);
+    ch->attach(11);
+    ch->proto().chunk = chunk;
+
+    const std::byte one{1};
+    (void)ch->deliver_rx(std::span(&one, 1));
+
+    // 4 KiB TX, high watermark at 3 KiB
+    const auto& p = ch->proto();
+    REQUIRE(p.results.size() == 5);
+    CHECK(p.results[0] == tn::SendResult::Full);
+    CHECK(p.results[1] == tn::SendResult::Full);
+    CHECK(p.results[2] == tn::SendResult::Backpressured);
+    CHECK(p.results[3] == tn::SendResult::Backpressured);
+    CHECK(p.results[4] == tn::SendResult::Blocked);
+    CHECK(p.flags == std::vector<bool>{false, false, true, true, true});
+
+    ch->detach();
+    pool.release(11);
+  }
+
+  TEST_CASE("tx_order")
+  {
+    int sv[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    const int fd   = sv[0];
+    const int peer = sv[1];
+
+    tn::ChannelPool<Streamer> pool;
+    auto* ch = pool.acquire(fd);
+    ch->attach(fd);
+    ch->proto().body = std::make_shared<std::string>(std::string(256 * 1024, 'b'));
+
+    std::weak_ptr<std::string> body = ch->proto().body;
+
+    const char one = '?';
+    REQUIRE(::write(peer, &one, 1) == 1);
+    ch->handle_events(EPOLLIN);
+
+    const auto& results = ch->proto().results;
+    REQUIRE(results.size() == 4);
+    CHECK(results[0] == tn::SendResult::Full);
+    CHECK(results[1] == tn::SendResult::Backpressured);
+    CHECK(results[2] == tn::SendResult::Backpressured);
+    CHECK(results[3] == tn::SendResult::Blocked);
+    CHECK(ch->backpressured());
+
+    // the socket takes the body in pieces; the segments stay alive until the last byte is sent
+    std::string received;
+    for (int i = 0; i < 1000 && received.size() < 4 + 256 * 1024; ++i) {
+      drain_into(peer, received);
+      ch->handle_events(EPOLLOUT);
+    }
+    drain_into(peer, received);
+
+    REQUIRE(received.size() == 4 + 256 * 1024);
+    CHECK(received.starts_with("HDR:"));
+    CHECK(received.find_first_not_of('b', 4) == std::string::npos);
+    CHECK(body.expired());
+    CHECK_FALSE(ch->backpressured());
+
+    ch->detach();
+    pool.release(fd);
+    ::close(fd);
+    ::close(peer);
+  }
+
+  TEST_CASE("zerocopy.pinned_until_complete")
+  {
+    metrics::flush_thread(0ms);
+    metrics::global_reset();
+
+    // MSG_ZEROCOPY is TCP/UDP only, so use a loopback connection
+    const int lfd = ::socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(lfd != -1);
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len        = sizeof addr;
+    REQUIRE(::bind(lfd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0);
+    REQUIRE(::listen(lfd, 1) == 0);
+    REQUIRE(::getsockname(lfd, reinterpret_cast<sockaddr*>(&addr), &len) == 0);
+
+    const int peer = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    (void)::connect(peer, reinterpret_cast<sockaddr*>(&addr), sizeof addr);
+    const int fd = ::accept4(lfd, nullptr, nullptr, SOCK_NONBLOCK);
+    REQUIRE(fd != -1);
+
+    tn::ChannelPool<Streamer> pool;
+    auto* ch = pool.acquire(fd);
+    ch->attach(fd);
+    if (!ch->enable_zerocopy(16 * 1024)) {
+      MESSAGE("SO_ZEROCOPY unsupported here; skipping");
+    }
+    else {
+      ch->proto().body = std::make_shared<std::string>(std::string(128 * 1024, 'z'));
+      std::weak_ptr<std::string> body = ch->proto().body;
+
+      const char one = '?';
+      REQUIRE(::write(peer, &one, 1) == 1);
+      REQUIRE(::poll(std::array{pollfd{fd, POLLIN, 0}}.data(), 1, 1000) == 1);
+      ch->handle_events(EPOLLIN);
+
+      std::string received;
+      for (int i = 0; i < 1000 && received.size() < 4 + 128 * 1024; ++i) {
+        drain_into(peer, received);
+        ch->handle_events(EPOLLOUT);
+      }
+      drain_into(peer, received);
+      REQUIRE(received.size() == 4 + 128 * 1024);
+
+      // completions arrive on the error queue; EPOLLERR is routine here, not a failure
+      for (int i = 0; i < 100 && !body.expired(); ++i) {
+        pollfd pfd{fd, 0, 0};
+        (void)::poll(&pfd, 1, 10);
+        if (pfd.revents & POLLERR) {
+          ch->handle_events(EPOLLERR);
+        }
+      }
+
+      CHECK(body.expired());
+      CHECK_FALSE(ch->should_close());
+
+      metrics::flush_thread(0ms);
+      CHECK(metrics::get_counter<"net.zerocopy_sends">() >= 2);
+    }
+
+    ch->detach();
+    pool.release(fd);
+    ::close(fd);
+    ::close(peer);
+    ::close(lfd);
+    metrics::global_reset();
+  }
+
+  TEST_CASE("deadlines")
+  {
+    int sv[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+
+    tn::ChannelPool<Deadlined> pool;
+    auto* ch = pool.acquire(sv[0]);
+    ch->attach(sv[0]);
+    CHECK_FALSE(ch->take_deadline_request().has_value());
+
+    const char one = '?';
+    REQUIRE(::write(sv[1], &one, 1) == 1);
+    ch->handle_events(EPOLLIN);
+    CHECK(ch->take_deadline_request() == 50ms);
+    CHECK_FALSE(ch->take_deadline_request().has_value()); // taken
+
+    ch->expire_deadline();
+    CHECK(ch->proto().timeouts == 1);
+    CHECK(ch->take_deadline_request() == 0ms);
+    CHECK_FALSE(ch->should_close());
+
+    ch->handle_events(EPOLLOUT);
+    std::string reply;
+    drain_into(sv[1], reply);
+    CHECK(reply == "TIMEOUT");
+
+    ch->detach();
+    pool.release(sv[0]);
+
+    // EchoProtocol has no on_timeout
+    Pool echo_pool;
+    auto* echo = echo_pool.acquire(sv[0]);
+    echo->attach(sv[0]);
+    echo->expire_deadline();
+    CHECK(echo->should_close());
+
+    echo->detach();
+    echo_pool.release(sv[0]);
+    ::close(sv[0]);
+    ::close(sv[1]);
+  }
+
+  TEST_CASE("completion_outlives_eof")
+  {
+    int sv[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    const int fd   = sv[0];
+    const int peer = sv[1];
+
+    tn::CompletionQueue         queue;
+    tn::ChannelPool<Offloading> pool;
+    pool.set_completion_queue(&queue);
+
+    auto* ch = pool.acquire(fd);
+    ch->attach(fd);
+
+    // request, then half-close: the response is still owed
+    REQUIRE(::write(peer, "GET", 3) == 3);
+    REQUIRE(::shutdown(peer, SHUT_WR) == 0);
+    ch->handle_events(EPOLLIN | EPOLLRDHUP);
+
+    REQUIRE(ch->proto().targets.size() == 1);
+    const tn::CompletionTarget target = ch->proto().targets.front();
+    REQUIRE(target);
+    CHECK(target.tag == pool.event_tag(fd));
+    CHECK_FALSE(ch->should_close());
+
+    CHECK(target.post(tn::TxSegment::from_string("VALUE")));
+    CHECK(queue.drain([&](tn::Completion& c) {
+      auto* owner = pool.lookup_tagged(c.tag);
+      REQUIRE(owner == ch);
+      owner->deliver_completion(std::move(c.payload));
+    }) == 1);
+
+    // the reactor replays the deferred EPOLLOUT to flush it; then the channel may close
+    CHECK(ch->deferred_events() == EPOLLOUT);
+    ch->handle_events(ch->deferred_events());
+    std::string reply;
+    drain_into(peer, reply);
+    CHECK(reply == "VALUE");
+    CHECK(ch->should_close());
+
+    // once the channel is gone, its tag no longer resolves
+    const std::uint64_t stale = target.tag;
+    ch->detach();
+    pool.release(fd);
+    CHECK(pool.lookup_tagged(stale) == nullptr);
+
+    // without a queue there is nothing to hand off to
+    tn::ChannelPool<Offloading> no_queue;
+    auto* other = no_queue.acquire(fd);
+    other->attach(fd);
+    tn::ChannelIO<Offloading> io(*other);
+    CHECK_FALSE(io.completion_target());
+    other->detach();
+    no_queue.release(fd);
+
+    ::close(fd);
+    ::close(peer);
+  }
+
+  TEST_CASE("body_stream.direct")
+  {
+    int sv[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    const int fd   = sv[0];
+    const int peer = sv[1];
+
+    tn::ChannelPool<BodyReader> pool;
+    auto*                       ch = pool.acquire(fd);
+    ch->attach(fd);
+
+    // a 1 MiB body (16x RX), pipelined with a small message behind it
+    std::uint64_t          big_sum   = 0;
+    std::uint64_t          small_sum = 0;
+    std::vector<std::byte> stream    = body_message(1 << 20, big_sum);
+    const auto             small     = body_message(10, small_sum);
+    stream.insert(stream.end(), small.begin(), small.end());
+
+    std::size_t written = 0;
+    while (written < stream.size()) {
+      const ssize_t n = ::write(peer, stream.data() + written, stream.size() - written);
+      if (n > 0) {
+        written += static_cast<std::size_t>(n);
+      }
+      ch->handle_events(EPOLLIN);
+    }
+
+    CHECK(ch->proto().sizes == std::vector<std::size_t>{1 << 20, 10});
+    std::uint64_t sums[2] = {};
+    CHECK(::read(peer, sums, sizeof sums) == sizeof sums);
+    CHECK(sums[0] == big_sum);
+    CHECK(sums[1] == small_sum);
+
+    ch->detach();
+    pool.release(fd);
+    ::close(fd);
+    ::close(peer);
+  }
+
+  TEST_CASE("body_stream.deliver_rx")
+  {
+    tn::ChannelPool<BodyReader> pool;
+    auto*                       ch = pool.acquire(9);
+    ch->attach(9);
+
+    std::uint64_t          sum    = 0;
+    std::vector<std::byte> stream = body_message(200'000, sum);
+    stream.insert(stream.end(), stream.begin(), stream.end()); // the same message twice
+
+    // chunks that split the length prefix, and ones that straddle the end of a body
+    const std::span<const std::byte> src(stream);
+    for (std::size_t offset = 0, chunk = 3; offset < src.size(); chunk = chunk * 7 % 65521 + 1) {
+      const std::size_t n = std::min(chunk, src.size() - offset);
+      CHECK(ch->deliver_rx(src.subspan(offset, n)) == n);
+      offset += n;
+      ch->tx_complete(ch->tx_pending().size());
+    }
+
+    CHECK(ch->proto().sizes == std::vector<std::size_t>{200'000, 200'000});
+
+    ch->detach();
+    pool.release(9);
+  }
+}
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <doctest.h>
+#include <latch>
+#include <memory>
+#include <netinet/in.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+import tskv.net.client;
+import tskv.net.frame;
+import tskv.net.reactor;
+import tskv.net.rpc;
+import tskv.net.server;
+import tskv.net.socket;
+import tskv.storage.engine;
+namespace tn = tskv::net;
+namespace ts = tskv::storage;
+
+using namespace std::chrono_literals;
+
+namespace { // helper functions
+
+// A port nothing listens on (for now).
+std::uint16_t free_tcp_port()
+{
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  const int fd  = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  socklen_t len = sizeof addr;
+  REQUIRE(bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == 0);
+  REQUIRE(getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) == 0);
+  ::close(fd);
+  return ntohs(addr.sin_port);
+}
+
+// Reactor<RpcProtocol> over `engine` on its own thread until destroyed.
+class Server {
+  std::unique_ptr<tn::Reactor<tn::RpcProtocol>> reactor_;
+  std::jthread                                  thread_;
+
+public:
+  std::uint16_t port = free_tcp_port();
+
+  explicit Server(ts::Engine& engine)
+  {
+    tn::RpcProtocol::bind_engine(&engine);
+
+    tn::ServerConfig config;
+    config.host            = "127.0.0.1";
+    config.port            = port;
+    config.idle_timeout_ms = 0;
+
+    std::latch ready(1);
+    thread_ = std::jthread([&] {
+      reactor_ = std::make_unique<tn::Reactor<tn::RpcProtocol>>(config, false);
+      ready.count_down();
+      reactor_->run();
+    });
+    ready.wait();
+  }
+
+  ~Server()
+  {
+    reactor_->notify_shutdown();
+    thread_.join();
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  Server(const Server&)            = delete;
+  Server& operator=(const Server&) = delete;
+};
+
+} // namespace
+
+TEST_SUITE("tskv.net.client")
+{
+  TEST_CASE("pipelined_get_put")
+  {
+    ts::Engine   engine;
+    const Server server(engine);
+
+    tn::ClientConfig config;
+    config.port        = server.port;
+    config.connections = 3;
+    config.depth       = 4;
+    tn::Client client(config);
+
+    std::size_t stored = 0;
+    for (int i = 0; i < 500; ++i) {
+      client.put("key" + std::to_string(i), "value" + std::to_string(i), [&](tn::CallStatus s) {
+        stored += s == tn::CallStatus::Ok;
+      });
+    }
+    CHECK(client.pending() == 500);
+    client.run();
+    CHECK(stored == 500);
+    CHECK(engine.size() == 500);
+
+    std::size_t matched = 0;
+    for (int i = 0; i < 500; ++i) {
+      const std::string expected = "value" + std::to_string(i);
+      client.get("key" + std::to_string(i),
+        [&, expected](tn::CallStatus s, std::optional<std::string_view> value) {
+          matched += s == tn::CallStatus::Ok && value == expected;
+        });
+    }
+    bool missing = false;
+    client.get("nope", [&](tn::CallStatus s, std::optional<std::string_view> value) {
+      missing = s == tn::CallStatus::Ok && !value;
+    });
+    client.run();
+    CHECK(matched == 500);
+    CHECK(missing);
+
+    // a request the server rejects fails alone; the connection carries on
+    const std::byte junk[] = {std::byte{1}};
+    tn::CallStatus  status = tn::CallStatus::Ok;
+    tn::FrameType   type   = tn::FrameType::Ping;
+    client.submit(tn::FrameType::MGet, junk, [&](const tn::Reply& r) {
+      status = r.status;
+      type   = r.frame.header.type;
+    });
+    client.run();
+    CHECK(status == tn::CallStatus::Error);
+    CHECK(type == tn::FrameType::Error);
+  }
+
+  TEST_CASE("scan.credits")
+  {
+    ts::Engine        engine;
+    const std::string value(200, 'v');
+    for (int i = 0; i < 2000; ++i) { // about 6 batches of 64 KiB
+      char key[16];
+      std::snprintf(key, sizeof key, "k%05d", i);
+      engine.put(key, value);
+    }
+    const Server server(engine);
+
+    tn::ClientConfig config;
+    config.port         = server.port;
+    config.scan_credits = 1;
+    tn::Client client(config);
+
+    std::vector<std::string>      keys;
+    std::optional<tn::CallStatus> done;
+    client.scan(
+      "k00100",
+      "",
+      [&](std::string_view key, std::string_view v) {
+        keys.emplace_back(key);
+        CHECK(v == value);
+      },
+      [&](tn::CallStatus s) { done = s; });
+    client.run();
+
+    REQUIRE(done == tn::CallStatus::Ok);
+    REQUIRE(keys.size() == 1900);
+    CHECK(keys.front() == "k00100");
+    CHECK(keys.back() == "k01999");
+    CHECK(std::ranges::is_sorted(keys));
+  }
+
+  TEST_CASE("timeouts_and_unreachable")
+  {
+    // accepted by the kernel backlog, never read
+    const std::uint16_t port   = free_tcp_port();
+    const int           listen = tn::start_listener("127.0.0.1", port);
+    REQUIRE(listen != -1);
+
+    tn::ClientConfig config;
+    config.port       = port;
+    config.timeout_ms = 50;
+    {
+      tn::Client client(config);
+
+      std::vector<tn::CallStatus> statuses;
+      for (int i = 0; i < 3; ++i) {
+        client.put("k", "v", [&](tn::CallStatus s) { statuses.push_back(s); });
+      }
+      const auto start = std::chrono::steady_clock::now();
+      client.run();
+      CHECK(std::chrono::steady_clock::now() - start >= 50ms);
+      CHECK(statuses == std::vector<tn::CallStatus>(3, tn::CallStatus::Timeout));
+    }
+    ::close(listen);
+
+    config.port = free_tcp_port();
+    tn::Client     client(config);
+    tn::CallStatus status = tn::CallStatus::Ok;
+    client.get("k", [&](tn::CallStatus s, std::optional<std::string_view>) { status = s; });
+    client.run();
+    CHECK(status == tn::CallStatus::Disconnected);
+  }
+}
@@ -0,0 +1,125 @@
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <memory>
+#include <poll.h>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+import tskv.net.completion_queue;
+import tskv.net.tx_queue;
+namespace tn = tskv::net;
+
+namespace { // helper functions
+
+bool readable(int fd)
+{
+  pollfd pfd{.fd = fd, .events = POLLIN, .revents = 0};
+  return ::poll(&pfd, 1, 0) == 1;
+}
+
+std::string as_string(const tn::TxSegment& seg)
+{
+  return std::string(reinterpret_cast<const char*>(seg.bytes.data()), seg.size());
+}
+
+} // namespace
+
+TEST_SUITE("tskv.net.completion_queue")
+{
+  TEST_CASE("wakeup.only_on_empty")
+  {
+    tn::CompletionQueue queue;
+    CHECK(queue.empty());
+    CHECK_FALSE(readable(queue.wakeup_fd()));
+
+    CHECK(queue.post(1, tn::TxSegment::from_string("a")));
+    CHECK_FALSE(queue.post(2, tn::TxSegment::from_string("b")));
+    CHECK_FALSE(queue.post(3, tn::TxSegment::from_string("c")));
+    CHECK(readable(queue.wakeup_fd()));
+
+    std::vector<std::uint64_t> tags;
+    std::string                bytes;
+    const std::size_t          n = queue.drain([&](tn::Completion& c) {
+      tags.push_back(c.tag);
+      bytes += as_string(c.payload);
+    });
+
+    CHECK(n == 3);
+    CHECK(tags == std::vector<std::uint64_t>{1, 2, 3});
+    CHECK(bytes == "abc");
+    CHECK(queue.empty());
+    CHECK_FALSE(readable(queue.wakeup_fd()));
+
+    // the next post starts a new batch
+    CHECK(queue.post(4, tn::TxSegment::from_string("d")));
+    CHECK(readable(queue.wakeup_fd()));
+    CHECK(queue.drain([](tn::Completion&) {}) == 1);
+    CHECK(queue.drain([](tn::Completion&) {}) == 0);
+  }
+
+  TEST_CASE("multi_producer")
+  {
+    constexpr std::uint64_t PRODUCERS = 4;
+    constexpr std::uint64_t PER       = 20000;
+
+    tn::CompletionQueue queue;
+
+    std::vector<std::thread> producers;
+    std::vector<std::size_t> wakeups(PRODUCERS, 0);
+    for (std::uint64_t p = 0; p < PRODUCERS; ++p) {
+      producers.emplace_back([&, p] {
+        for (std::uint64_t i = 0; i < PER; ++i) {
+          wakeups[p] += queue.post((p << 32) | i, tn::TxSegment{}) ? 1 : 0;
+        }
+      });
+    }
+
+    // consume the way a reactor does: sleep on the eventfd, then take whatever has piled up
+    std::vector<std::uint64_t> next(PRODUCERS, 0);
+    std::uint64_t              received = 0;
+    std::size_t                batches  = 0;
+    bool                       in_order = true;
+    while (received < PRODUCERS * PER) {
+      pollfd pfd{.fd = queue.wakeup_fd(), .events = POLLIN, .revents = 0};
+      REQUIRE(::poll(&pfd, 1, 5000) == 1);
+
+      batches += queue.drain([&](tn::Completion& c) {
+        const std::uint64_t p = c.tag >> 32;
+        in_order              = in_order && (c.tag & 0xFFFFFFFF) == next[p];
+        ++next[p];
+        ++received;
+      }) > 0;
+    }
+
+    for (std::thread& t : producers) {
+      t.join();
+    }
+
+    CHECK(in_order);
+    CHECK(received == PRODUCERS * PER);
+
+    // every wakeup announced at least one completion, and every non-empty drain had one
+    std::size_t total_wakeups = 0;
+    for (const std::size_t w : wakeups) {
+      total_wakeups += w;
+    }
+    CHECK(total_wakeups >= batches);
+    CHECK(total_wakeups <= received);
+  }
+
+  TEST_CASE("destructor_frees_undrained")
+  {
+    const auto owner = std::make_shared<std::string>("payload");
+    {
+      tn::CompletionQueue queue;
+      const tn::TxSegment seg{owner, std::as_bytes(std::span(*owner))};
+      (void)queue.post(1, seg);
+      (void)queue.post(2, seg);
+      CHECK(owner.use_count() == 4); // ours, seg, and one per queued completion
+    }
+    CHECK(owner.use_count() == 1);
+  }
+}
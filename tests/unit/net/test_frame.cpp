@@ -0,0 +1,117 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <span>
+#include <vector>
+
+import tskv.net.frame;
+namespace tn = tskv::net;
+
+namespace { // helper functions
+
+void append_frame(std::vector<std::byte>& out,
+  tn::FrameType                            type,
+  std::uint32_t                            id,
+  std::size_t                              payload_size)
+{
+  const auto header =
+    tn::encode_frame_header({type, 0, static_cast<std::uint32_t>(payload_size), id});
+  out.insert(out.end(), header.begin(), header.end());
+  for (std::size_t i = 0; i < payload_size; ++i) {
+    out.push_back(static_cast<std::byte>(i));
+  }
+}
+
+} // namespace
+
+TEST_SUITE("tskv.net.frame")
+{
+  TEST_CASE("parse_frame.roundtrip")
+  {
+    std::vector<std::byte> bytes;
+    append_frame(bytes, tn::FrameType::Ping, 0xdeadbeef, 5);
+    REQUIRE(bytes.size() == tn::FRAME_HEADER_SIZE + 5);
+
+    // little-endian length and id
+    CHECK(bytes[4] == std::byte{5});
+    CHECK(bytes[8] == std::byte{0xef});
+    CHECK(bytes[11] == std::byte{0xde});
+
+    const tn::FrameParse parsed = tn::parse_frame(bytes, 1024);
+    REQUIRE(parsed.status == tn::FrameStatus::Complete);
+    CHECK(parsed.size == bytes.size());
+    CHECK(parsed.frame.header.type == tn::FrameType::Ping);
+    CHECK(parsed.frame.header.id == 0xdeadbeef);
+    CHECK(parsed.frame.header.length == 5);
+
+    // the payload is a view into the input, not a copy
+    CHECK(parsed.frame.payload.data() == bytes.data() + tn::FRAME_HEADER_SIZE);
+    CHECK(parsed.frame.payload.size() == 5);
+  }
+
+  TEST_CASE("parse_frame.incomplete_at_every_split")
+  {
+    std::vector<std::byte> bytes;
+    append_frame(bytes, tn::FrameType::Ping, 7, 20);
+
+    for (std::size_t n = 0; n < bytes.size(); ++n) {
+      const tn::FrameParse parsed = tn::parse_frame(std::span(bytes).first(n), 1024);
+      CHECK(parsed.status == tn::FrameStatus::Incomplete);
+      CHECK(parsed.size == 0);
+    }
+    CHECK(tn::parse_frame(bytes, 1024).status == tn::FrameStatus::Complete);
+  }
+
+  TEST_CASE("parse_frame.pipelined")
+  {
+    std::vector<std::byte> bytes;
+    append_frame(bytes, tn::FrameType::Ping, 1, 0);
+    append_frame(bytes, tn::FrameType::Ping, 2, 100);
+    append_frame(bytes, tn::FrameType::Pong, 3, 3);
+    append_frame(bytes, tn::FrameType::Ping, 4, 0);
+    bytes.resize(bytes.size() - 8); // only the start of the fourth frame has arrived
+
+    std::vector<std::uint32_t> ids;
+    std::size_t                offset = 0;
+    for (;;) {
+      const tn::FrameParse parsed = tn::parse_frame(std::span(bytes).subspan(offset), 1024);
+      if (parsed.status != tn::FrameStatus::Complete) {
+        CHECK(parsed.status == tn::FrameStatus::Incomplete);
+        break;
+      }
+      ids.push_back(parsed.frame.header.id);
+      offset += parsed.size;
+    }
+
+    CHECK(ids == std::vector<std::uint32_t>{1, 2, 3});
+    CHECK(bytes.size() - offset == 4);
+  }
+
+  TEST_CASE("parse_frame.rejects_bad_headers")
+  {
+    std::vector<std::byte> bytes;
+    append_frame(bytes, tn::FrameType::Ping, 9, 4000);
+    const std::span header = std::span(bytes).first(tn::FRAME_HEADER_SIZE);
+
+    SUBCASE("oversized")
+    {
+      const tn::FrameParse parsed = tn::parse_frame(header, 1024);
+      CHECK(parsed.status == tn::FrameStatus::TooLarge);
+      CHECK(parsed.frame.header.id == 9);
+    }
+
+    SUBCASE("bad magic, detected from the first byte")
+    {
+      bytes[0] = std::byte{'G'};
+      CHECK(tn::parse_frame(header.first(1), 8192).status == tn::FrameStatus::BadMagic);
+      CHECK(tn::parse_frame(header, 8192).status == tn::FrameStatus::BadMagic);
+    }
+
+    SUBCASE("bad version")
+    {
+      bytes[1] = std::byte{tn::FRAME_VERSION + 1};
+      CHECK(tn::parse_frame(header, 8192).status == tn::FrameStatus::BadVersion);
+    }
+  }
+}
@@ -0,0 +1,192 @@
+#include <cstddef>
+#include <doctest.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+import tskv.net.channel;
+import tskv.net.resp;
+import tskv.storage.engine;
+namespace tn = tskv::net;
+namespace ts = tskv::storage;
+
+using Pool = tn::ChannelPool<tn::RespProtocol>;
+
+namespace { // helper functions
+
+std::string command(std::initializer_list<std::string_view> args)
+{
+  std::string out = "*" + std::to_string(args.size()) + "\r\n";
+  for (const std::string_view arg : args) {
+    out += "$" + std::to_string(arg.size()) + "\r\n";
+    out += arg;
+    out += "\r\n";
+  }
+  return out;
+}
+
+// Sends `requests` through a RespProtocol channel and returns everything it replied.
+std::string round_trip(const std::string& requests)
+{
+  int sv[2];
+  REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+
+  Pool  pool;
+  auto* ch = pool.acquire(sv[0]);
+  REQUIRE(ch != nullptr);
+  ch->attach(sv[0]);
+
+  const ssize_t written = ::write(sv[1], requests.data(), requests.size());
+  REQUIRE(written == static_cast<ssize_t>(requests.size()));
+  ch->handle_events(EPOLLIN);
+
+  std::string   replies(1 << 16, '\0');
+  const ssize_t n = ::read(sv[1], replies.data(), replies.size());
+  replies.resize(n > 0 ? static_cast<std::size_t>(n) : 0);
+
+  ch->detach();
+  pool.release(sv[0]);
+  ::close(sv[0]);
+  ::close(sv[1]);
+  return replies;
+}
+
+} // namespace
+
+TEST_SUITE("tskv.net.resp")
+{
+  TEST_CASE("parse_resp_command.in_place")
+  {
+    const std::string bytes = command({"SET", "key", "hello world"}) + command({"GET", "key"});
+
+    std::vector<std::string_view> argv;
+    const tn::RespParse           parsed = tn::parse_resp_command(bytes, argv, 1024);
+    REQUIRE(parsed.status == tn::RespStatus::Complete);
+    CHECK(parsed.size == command({"SET", "key", "hello world"}).size());
+    REQUIRE(argv.size() == 3);
+    CHECK(argv[2] == "hello world");
+    CHECK(argv[2].data() >= bytes.data()); // a view into the input, not a copy
+    CHECK(argv[2].data() < bytes.data() + bytes.size());
+
+    const std::string_view rest = std::string_view(bytes).substr(parsed.size);
+    REQUIRE(tn::parse_resp_command(rest, argv, 1024).status == tn::RespStatus::Complete);
+    CHECK(argv == std::vector<std::string_view>{"GET", "key"});
+  }
+
+  TEST_CASE("parse_resp_command.incomplete_at_every_split")
+  {
+    const std::string bytes = command({"MSET", "a", "1", "bb", "22"});
+
+    std::vector<std::string_view> argv;
+    for (std::size_t n = 0; n < bytes.size(); ++n) {
+      CHECK(tn::parse_resp_command(bytes.substr(0, n), argv, 1024).status
+            == tn::RespStatus::Incomplete);
+    }
+    CHECK(tn::parse_resp_command(bytes, argv, 1024).status == tn::RespStatus::Complete);
+  }
+
+  TEST_CASE("parse_resp_command.rejects_malformed")
+  {
+    std::vector<std::string_view> argv;
+
+    const auto status_of = [&](std::string_view bytes) {
+      return tn::parse_resp_command(bytes, argv, 1024).status;
+    };
+
+    CHECK(status_of("*x\r\n") == tn::RespStatus::Malformed);
+    CHECK(status_of("*1\r\n:1\r\n") == tn::RespStatus::Malformed);
+    CHECK(status_of("*1\r\n$-2\r\n") == tn::RespStatus::Malformed);
+    CHECK(status_of("*1\r\n$1\r\nxyz") == tn::RespStatus::Malformed);
+    CHECK(status_of("*1\r\n$2000\r\n") == tn::RespStatus::TooLarge);
+  }
+
+  TEST_CASE("parse_resp_command.inline")
+  {
+    std::vector<std::string_view> argv;
+    const tn::RespParse           parsed = tn::parse_resp_command("PING  hello\r\nGET", argv, 1024);
+    CHECK(parsed.status == tn::RespStatus::Complete);
+    CHECK(parsed.size == 13);
+    CHECK(argv == std::vector<std::string_view>{"PING", "hello"});
+
+    // a bare LF ends a line too, even with a CRLF further on
+    const tn::RespParse bare = tn::parse_resp_command("GET a\nGET b\r\n", argv, 1024);
+    CHECK(bare.status == tn::RespStatus::Complete);
+    CHECK(bare.size == 6);
+    CHECK(argv == std::vector<std::string_view>{"GET", "a"});
+
+    CHECK(tn::parse_resp_command("GET a\r", argv, 1024).status == tn::RespStatus::Incomplete);
+  }
+
+  TEST_CASE("glob_match")
+  {
+    CHECK(tn::glob_match("*", ""));
+    CHECK(tn::glob_match("cpu.*.user", "cpu.host1.user"));
+    CHECK_FALSE(tn::glob_match("cpu.*.user", "cpu.host1.system"));
+    CHECK(tn::glob_match("h?llo", "hello"));
+    CHECK(tn::glob_match("h[ae]llo", "hallo"));
+    CHECK_FALSE(tn::glob_match("h[^e]llo", "hello"));
+    CHECK(tn::glob_match("h[a-c]llo", "hbllo"));
+    CHECK(tn::glob_match("a\\*b", "a*b"));
+    CHECK_FALSE(tn::glob_match("a\\*b", "axb"));
+    CHECK(tn::glob_prefix("cpu.*.user") == "cpu.");
+  }
+
+  TEST_CASE("pipeline.in_order")
+  {
+    ts::Engine engine;
+    tn::RespProtocol::bind_engine(&engine);
+
+    std::string requests;
+    requests += command({"SET", "k1", "v1"});
+    requests += command({"set", "k2", "v2"});
+    requests += command({"GET", "k1"});
+    requests += command({"GET", "missing"});
+    requests += command({"MGET", "k2", "missing"});
+    requests += command({"EXISTS", "k1", "k2", "missing"});
+    requests += command({"DEL", "k1"});
+    requests += command({"NOPE"});
+    requests += command({"PING"});
+
+    CHECK(round_trip(requests)
+          == "+OK\r\n+OK\r\n$2\r\nv1\r\n$-1\r\n*2\r\n$2\r\nv2\r\n$-1\r\n:2\r\n:1\r\n"
+             "-ERR unknown command\r\n+PONG\r\n");
+    CHECK(engine.size() == 1);
+
+    // RESP3 nulls after HELLO 3
+    CHECK(round_trip(command({"HELLO", "3"}) + command({"GET", "missing"})).ends_with("_\r\n"));
+
+    tn::RespProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("scan.cursor_and_match")
+  {
+    ts::Engine engine;
+    tn::RespProtocol::bind_engine(&engine);
+    for (const char* key : {"a", "cpu.1", "cpu.2", "cpu.3", "mem.1"}) {
+      engine.put(key, "x");
+    }
+
+    CHECK(round_trip(command({"SCAN", "0", "MATCH", "cpu.*", "COUNT", "2"}))
+          == "*2\r\n$6\r\n@cpu.3\r\n*2\r\n$5\r\ncpu.1\r\n$5\r\ncpu.2\r\n");
+    CHECK(round_trip(command({"SCAN", "@cpu.3", "MATCH", "cpu.*", "COUNT", "2"}))
+          == "*2\r\n$1\r\n0\r\n*1\r\n$5\r\ncpu.3\r\n");
+    CHECK(round_trip(command({"SCAN", "17"})).starts_with("-ERR invalid cursor"));
+
+    tn::RespProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("malformed_request_closes")
+  {
+    ts::Engine engine;
+    tn::RespProtocol::bind_engine(&engine);
+
+    CHECK(round_trip(command({"PING"}) + "*1\r\n$x\r\n")
+          == "+PONG\r\n-ERR Protocol error: invalid bulk length\r\n");
+
+    tn::RespProtocol::bind_engine(nullptr);
+  }
+}
@@ -0,0 +1,931 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+import tskv.common.metrics;
+import tskv.net.channel;
+import tskv.net.frame;
+import tskv.net.rpc;
+import tskv.storage.engine;
+import tskv.storage.point_codec;
+import tskv.storage.series;
+namespace metrics = tskv::common::metrics;
+namespace tn      = tskv::net;
+namespace ts      = tskv::storage;
+
+using Pool = tn::ChannelPool<tn::RpcProtocol>;
+
+namespace { // helper functions
+
+void append_frame(std::vector<std::byte>& out,
+  tn::FrameType                            type,
+  std::uint32_t                            id,
+  std::size_t                              payload_size)
+{
+  const auto header =
+    tn::encode_frame_header({type, 0, static_cast<std::uint32_t>(payload_size), id});
+  out.insert(out.end(), header.begin(), header.end());
+  out.insert(out.end(), payload_size, std::byte{'p'});
+}
+
+void append_batch_frame(std::vector<std::byte>& out,
+  tn::FrameType                                  type,
+  std::uint32_t                                  id,
+  const std::vector<std::byte>&                  payload)
+{
+  const auto header =
+    tn::encode_frame_header({type, 0, static_cast<std::uint32_t>(payload.size()), id});
+  out.insert(out.end(), header.begin(), header.end());
+  out.insert(out.end(), payload.begin(), payload.end());
+}
+
+std::vector<std::byte> mput_payload(
+  std::initializer_list<std::pair<std::string_view, std::string_view>> points)
+{
+  std::vector<std::byte> payload;
+  tn::append_u32(payload, static_cast<std::uint32_t>(points.size()));
+  for (const auto& [key, value] : points) {
+    tn::append_u32(payload, static_cast<std::uint32_t>(key.size()));
+    tn::append_u32(payload, static_cast<std::uint32_t>(value.size()));
+    tn::append_bytes(payload, key);
+    tn::append_bytes(payload, value);
+  }
+  return payload;
+}
+
+std::vector<std::byte> mget_payload(std::initializer_list<std::string_view> keys)
+{
+  std::vector<std::byte> payload;
+  tn::append_u32(payload, static_cast<std::uint32_t>(keys.size()));
+  for (const std::string_view key : keys) {
+    tn::append_u32(payload, static_cast<std::uint32_t>(key.size()));
+    tn::append_bytes(payload, key);
+  }
+  return payload;
+}
+
+std::vector<std::byte> scan_payload(
+  std::string_view start, std::string_view end, std::uint32_t credits)
+{
+  std::vector<std::byte> payload;
+  tn::append_u32(payload, static_cast<std::uint32_t>(start.size()));
+  tn::append_bytes(payload, start);
+  tn::append_u32(payload, static_cast<std::uint32_t>(end.size()));
+  tn::append_bytes(payload, end);
+  tn::append_u32(payload, credits);
+  return payload;
+}
+
+std::vector<std::byte> aggregate_payload(std::string_view series,
+  std::int64_t                                            from,
+  std::int64_t                                            to,
+  std::int64_t                                            width,
+  std::uint32_t                                           fns)
+{
+  std::vector<std::byte> payload;
+  tn::append_u32(payload, static_cast<std::uint32_t>(series.size()));
+  tn::append_bytes(payload, series);
+  tn::append_u64(payload, static_cast<std::uint64_t>(from));
+  tn::append_u64(payload, static_cast<std::uint64_t>(to));
+  tn::append_u64(payload, static_cast<std::uint64_t>(width));
+  tn::append_u32(payload, fns);
+  return payload;
+}
+
+std::vector<std::byte> scan_points_payload(
+  std::string_view series, std::int64_t from, std::int64_t to, std::uint32_t credits)
+{
+  std::vector<std::byte> payload;
+  tn::append_u32(payload, static_cast<std::uint32_t>(series.size()));
+  tn::append_bytes(payload, series);
+  tn::append_u64(payload, static_cast<std::uint64_t>(from));
+  tn::append_u64(payload, static_cast<std::uint64_t>(to));
+  tn::append_u32(payload, credits);
+  return payload;
+}
+
+std::vector<std::byte> credit_payload(std::uint32_t credits)
+{
+  std::vector<std::byte> payload;
+  tn::append_u32(payload, credits);
+  return payload;
+}
+
+void write_bytes(int fd, std::span<const std::byte> bytes)
+{
+  REQUIRE(::write(fd, bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size()));
+}
+
+// Read everything available on a nonblocking fd and split it into frames.
+std::vector<tn::FrameHeader> read_frames(int fd)
+{
+  std::vector<std::byte> bytes(1 << 16);
+  const ssize_t          n = ::read(fd, bytes.data(), bytes.size());
+  bytes.resize(n > 0 ? static_cast<std::size_t>(n) : 0);
+
+  std::vector<tn::FrameHeader> headers;
+  std::size_t                  offset = 0;
+  for (;;) {
+    const tn::FrameParse parsed = tn::parse_frame(std::span(bytes).subspan(offset), 1 << 16);
+    if (parsed.status != tn::FrameStatus::Complete) {
+      CHECK(offset == bytes.size()); // responses are never split
+      break;
+    }
+    headers.push_back(parsed.frame.header);
+    offset += parsed.size;
+  }
+  return headers;
+}
+
+// Read everything available on a nonblocking fd.
+std::vector<std::byte> read_all(int fd)
+{
+  std::vector<std::byte> bytes(1 << 20);
+  const ssize_t          n = ::read(fd, bytes.data(), bytes.size());
+  bytes.resize(n > 0 ? static_cast<std::size_t>(n) : 0);
+  return bytes;
+}
+
+struct ScanBatch {
+  std::uint32_t            id   = 0;
+  bool                     last = false;
+  std::vector<std::string> keys;
+};
+
+// Let the channel write until it stops making progress, reading as it goes, and return the bytes
+// that arrived.
+std::vector<std::byte> pump(tn::Channel<tn::RpcProtocol>& ch, int peer)
+{
+  std::vector<std::byte> replies;
+  for (int idle = 0; idle < 2;) {
+    ch.handle_events(EPOLLOUT);
+    const std::vector<std::byte> bytes = read_all(peer);
+    replies.insert(replies.end(), bytes.begin(), bytes.end());
+    idle = bytes.empty() ? idle + 1 : 0;
+  }
+  return replies;
+}
+
+// pump, split into the ScanBatch frames that arrived.
+std::vector<ScanBatch> pump_scan(tn::Channel<tn::RpcProtocol>& ch, int peer)
+{
+  const std::vector<std::byte> replies = pump(ch, peer);
+
+  std::vector<ScanBatch> batches;
+  std::size_t            offset = 0;
+  while (offset < replies.size()) {
+    const tn::FrameParse parsed = tn::parse_frame(std::span(replies).subspan(offset), 1 << 20);
+    REQUIRE(parsed.status == tn::FrameStatus::Complete);
+    REQUIRE(parsed.frame.header.type == tn::FrameType::ScanBatch);
+    offset += parsed.size;
+
+    ScanBatch batch;
+    batch.id   = parsed.frame.header.id;
+    batch.last = (parsed.frame.header.flags & tn::FRAME_FLAG_END) != 0;
+
+    tn::PayloadReader in(parsed.frame.payload);
+    for (std::uint32_t n = in.u32(); n > 0; --n) {
+      const std::uint32_t klen = in.u32();
+      const std::uint32_t vlen = in.u32();
+      batch.keys.emplace_back(in.bytes(klen));
+      (void)in.bytes(vlen);
+    }
+    CHECK(in.done());
+    batches.push_back(std::move(batch));
+  }
+  return batches;
+}
+
+struct Connection {
+  int                           fd   = -1;
+  int                           peer = -1;
+  Pool                          pool;
+  tn::Channel<tn::RpcProtocol>* ch = nullptr;
+
+  Connection()
+  {
+    int sv[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0);
+    fd   = sv[0];
+    peer = sv[1];
+    ch   = pool.acquire(fd);
+    REQUIRE(ch != nullptr);
+    ch->attach(fd);
+  }
+
+  ~Connection()
+  {
+    ch->detach();
+    pool.release(fd);
+    ::close(fd);
+    ::close(peer);
+  }
+
+  Connection(const Connection&)            = delete;
+  Connection& operator=(const Connection&) = delete;
+};
+
+} // namespace
+
+TEST_SUITE("tskv.net.rpc")
+{
+  TEST_CASE("ping.pipelined")
+  {
+    metrics::flush_thread(0ms);
+    metrics::global_reset();
+
+    Connection conn;
+
+    std::vector<std::byte> requests;
+    for (std::uint32_t id = 1; id <= 50; ++id) {
+      append_frame(requests, tn::FrameType::Ping, id, id * 10);
+    }
+    write_bytes(conn.peer, requests);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<tn::FrameHeader> responses = read_frames(conn.peer);
+    REQUIRE(responses.size() == 50);
+    for (std::uint32_t id = 1; id <= 50; ++id) {
+      CHECK(responses[id - 1].type == tn::FrameType::Pong);
+      CHECK(responses[id - 1].id == id);
+      CHECK(responses[id - 1].length == id * 10);
+    }
+
+    metrics::flush_thread(0ms);
+    CHECK(metrics::get_counter<"rpc.frames">() == 50);
+  }
+
+  TEST_CASE("partial_frame")
+  {
+    Connection conn;
+
+    std::vector<std::byte> request;
+    append_frame(request, tn::FrameType::Ping, 42, 300);
+
+    const std::span<const std::byte> bytes(request);
+    for (const std::size_t split : {std::size_t{5}, std::size_t{100}}) {
+      write_bytes(conn.peer, bytes.first(split));
+      conn.ch->handle_events(EPOLLIN);
+      CHECK(read_frames(conn.peer).empty());
+      request.erase(request.begin(), request.begin() + static_cast<std::ptrdiff_t>(split));
+    }
+    write_bytes(conn.peer, request);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<tn::FrameHeader> responses = read_frames(conn.peer);
+    REQUIRE(responses.size() == 1);
+    CHECK(responses[0].id == 42);
+    CHECK(responses[0].length == 300);
+  }
+
+  TEST_CASE("streamed_frame_body")
+  {
+    Connection conn;
+
+    constexpr std::size_t BIG = 3 * tn::RpcProtocol::MAX_INLINE_PAYLOAD;
+
+    std::vector<std::byte> requests;
+    append_frame(requests, tn::FrameType::Ping, 1, BIG);
+    append_frame(requests, tn::FrameType::Ping, 2, 16);
+
+    // the Pong is as large as the Ping, so keep reading while writing
+    const std::size_t      expected = 2 * tn::FRAME_HEADER_SIZE + BIG + 16;
+    std::vector<std::byte> replies;
+    std::size_t            written = 0;
+    while (replies.size() < expected) {
+      if (written < requests.size()) {
+        const ssize_t n = ::write(conn.peer, requests.data() + written, requests.size() - written);
+        written += n > 0 ? static_cast<std::size_t>(n) : 0;
+      }
+      conn.ch->handle_events(EPOLLIN | EPOLLOUT);
+
+      std::byte     chunk[1 << 16];
+      const ssize_t n = ::read(conn.peer, chunk, sizeof chunk);
+      if (n > 0) {
+        replies.insert(replies.end(), chunk, chunk + n);
+      }
+    }
+
+    const tn::FrameParse first = tn::parse_frame(replies, BIG);
+    REQUIRE(first.status == tn::FrameStatus::Complete);
+    CHECK(first.frame.header.type == tn::FrameType::Pong);
+    CHECK(first.frame.header.id == 1);
+    CHECK(first.frame.payload.size() == BIG);
+    const auto is_filler = [](std::byte b) { return b == std::byte{'p'}; };
+    CHECK(std::ranges::all_of(first.frame.payload, is_filler));
+
+    const tn::FrameParse second = tn::parse_frame(std::span(replies).subspan(first.size), BIG);
+    REQUIRE(second.status == tn::FrameStatus::Complete);
+    CHECK(second.frame.header.id == 2);
+    CHECK(first.size + second.size == replies.size());
+    CHECK_FALSE(conn.ch->should_close());
+  }
+
+  TEST_CASE("unknown_frame_type")
+  {
+    Connection conn;
+
+    std::vector<std::byte> requests;
+    append_frame(requests, static_cast<tn::FrameType>(0x7f), 1, 8);
+    append_frame(requests, tn::FrameType::Ping, 2, 0);
+    write_bytes(conn.peer, requests);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<tn::FrameHeader> responses = read_frames(conn.peer);
+    REQUIRE(responses.size() == 2);
+    CHECK(responses[0].type == tn::FrameType::Error);
+    CHECK(responses[0].id == 1);
+    CHECK(responses[1].type == tn::FrameType::Pong);
+    CHECK_FALSE(conn.ch->should_close());
+  }
+
+  TEST_CASE("malformed_frame_closes")
+  {
+    Connection conn;
+
+    std::vector<std::byte> requests;
+    append_frame(requests, tn::FrameType::Ping, 1, 0);
+
+    SUBCASE("bad magic")
+    {
+      requests.push_back(std::byte{'G'});
+    }
+
+    SUBCASE("too large")
+    {
+      append_frame(requests, tn::FrameType::Ping, 2, tn::RpcProtocol::MAX_PAYLOAD + 1);
+      requests.resize(requests.size() - tn::RpcProtocol::MAX_PAYLOAD - 1); // header only
+    }
+
+    write_bytes(conn.peer, requests);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<tn::FrameHeader> responses = read_frames(conn.peer);
+    REQUIRE(responses.size() == 2);
+    CHECK(responses[0].type == tn::FrameType::Pong);
+    CHECK(responses[1].type == tn::FrameType::Error);
+    CHECK(conn.pool.count_in(tn::ChannelState::Draining) == 1);
+    CHECK(conn.ch->should_close());
+  }
+
+  TEST_CASE("mput_mget.batched")
+  {
+    metrics::flush_thread(0ms);
+    metrics::global_reset();
+
+    ts::Engine engine;
+    tn::RpcProtocol::bind_engine(&engine);
+    Connection conn;
+
+    std::vector<std::byte> requests;
+    append_batch_frame(requests,
+      tn::FrameType::MPut,
+      1,
+      mput_payload({{"cpu.1", "10"}, {"cpu.2", "20"}, {"cpu.1", "11"}}));
+    append_batch_frame(requests, tn::FrameType::MGet, 2, mget_payload({"cpu.2", "nope", "cpu.1"}));
+    write_bytes(conn.peer, requests);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<std::byte> replies = read_all(conn.peer);
+    const tn::FrameParse         put     = tn::parse_frame(replies, 1 << 16);
+    REQUIRE(put.status == tn::FrameStatus::Complete);
+    CHECK(put.frame.header.type == tn::FrameType::MPutResult);
+    CHECK(put.frame.header.id == 1);
+    tn::PayloadReader put_result(put.frame.payload);
+    CHECK(put_result.u32() == 3);
+    CHECK(put_result.done());
+
+    const tn::FrameParse get = tn::parse_frame(std::span(replies).subspan(put.size), 1 << 16);
+    REQUIRE(get.status == tn::FrameStatus::Complete);
+    CHECK(get.frame.header.type == tn::FrameType::MGetResult);
+    CHECK(get.frame.header.id == 2);
+    CHECK(put.size + get.size == replies.size());
+
+    tn::PayloadReader values(get.frame.payload);
+    REQUIRE(values.u32() == 3);
+    CHECK(values.bytes(values.u32()) == "20");
+    CHECK(values.u32() == tn::FRAME_NO_VALUE);
+    CHECK(values.bytes(values.u32()) == "11"); // the later duplicate won
+    CHECK(values.done());
+
+    CHECK(engine.size() == 2);
+    metrics::flush_thread(0ms);
+    CHECK(metrics::get_counter<"rpc.mput_points">() == 3);
+    CHECK(metrics::get_counter<"rpc.mget_keys">() == 3);
+    CHECK(metrics::get_histogram<"rpc.mput_batch_ns">().count == 1);
+    CHECK(metrics::get_histogram<"rpc.mget_batch_ns">().count == 1);
+    CHECK(metrics::get_histogram<"rpc.batch_size">().max == 3);
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("mget.larger_than_tx")
+  {
+    ts::Engine engine;
+    tn::RpcProtocol::bind_engine(&engine);
+    const std::string big(3000, 'v');
+    engine.put("a", big);
+    engine.put("b", big);
+
+    Connection             conn;
+    std::vector<std::byte> requests;
+    append_batch_frame(requests, tn::FrameType::MGet, 7, mget_payload({"a", "b"}));
+    append_frame(requests, tn::FrameType::Ping, 8, 4);
+    write_bytes(conn.peer, requests);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<std::byte> replies = read_all(conn.peer);
+    const tn::FrameParse         get     = tn::parse_frame(replies, 1 << 16);
+    REQUIRE(get.status == tn::FrameStatus::Complete);
+    CHECK(get.frame.header.id == 7);
+    CHECK(get.frame.payload.size() == 4 + 2 * (4 + big.size()));
+
+    const tn::FrameParse pong = tn::parse_frame(std::span(replies).subspan(get.size), 1 << 16);
+    REQUIRE(pong.status == tn::FrameStatus::Complete);
+    CHECK(pong.frame.header.id == 8);
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("mput.malformed_payload")
+  {
+    ts::Engine engine;
+    tn::RpcProtocol::bind_engine(&engine);
+    Connection conn;
+
+    std::vector<std::byte> truncated = mput_payload({{"k", "v"}});
+    truncated.pop_back();
+    std::vector<std::byte> trailing = mget_payload({"k"});
+    trailing.push_back(std::byte{0});
+
+    std::vector<std::byte> requests;
+    append_batch_frame(requests, tn::FrameType::MPut, 1, truncated);
+    append_batch_frame(requests, tn::FrameType::MGet, 2, trailing);
+    append_batch_frame(requests, tn::FrameType::MGet, 3, {std::byte{0xff}, std::byte{0xff}});
+    append_frame(requests, tn::FrameType::Ping, 4, 0);
+    write_bytes(conn.peer, requests);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<tn::FrameHeader> responses = read_frames(conn.peer);
+    REQUIRE(responses.size() == 4);
+    for (std::size_t i = 0; i < 3; ++i) {
+      CHECK(responses[i].type == tn::FrameType::Error);
+    }
+    CHECK(responses[3].type == tn::FrameType::Pong);
+    CHECK(engine.size() == 0);
+    CHECK_FALSE(conn.ch->should_close());
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("scan.credited_batches")
+  {
+    metrics::flush_thread(0ms);
+    metrics::global_reset();
+
+    ts::Engine engine;
+    tn::RpcProtocol::bind_engine(&engine);
+    const std::string value(1000, 'v');
+    for (int i = 0; i < 300; ++i) {
+      engine.put("k" + std::to_string(1000 + i), value);
+    }
+    engine.put("z", value); // past the end bound
+
+    Connection             conn;
+    std::vector<std::byte> request;
+    append_batch_frame(request, tn::FrameType::Scan, 5, scan_payload("k1000", "k1300", 2));
+    write_bytes(conn.peer, request);
+    conn.ch->handle_events(EPOLLIN);
+
+    // two credits, two batches, then the scan waits however much TX has room
+    std::vector<ScanBatch> batches = pump_scan(*conn.ch, conn.peer);
+    REQUIRE(batches.size() == 2);
+    CHECK_FALSE(batches[1].last);
+
+    request.clear();
+    append_batch_frame(request, tn::FrameType::ScanCredit, 5, credit_payload(100));
+    append_frame(request, tn::FrameType::Ping, 6, 0);
+    write_bytes(conn.peer, request);
+    conn.ch->handle_events(EPOLLIN);
+
+    // the Pong is queued behind whatever batch is in flight
+    std::vector<std::byte> replies = read_all(conn.peer);
+    std::size_t            offset  = 0;
+    bool                   ponged  = false;
+    for (;;) {
+      const tn::FrameParse parsed = tn::parse_frame(std::span(replies).subspan(offset), 1 << 20);
+      if (parsed.status != tn::FrameStatus::Complete) {
+        break;
+      }
+      offset += parsed.size;
+      ponged = ponged || parsed.frame.header.type == tn::FrameType::Pong;
+    }
+    CHECK(offset == replies.size());
+    CHECK(ponged);
+    (void)pump_scan(*conn.ch, conn.peer);
+
+    // start over with credits to spare and check every batch
+    request.clear();
+    append_batch_frame(request, tn::FrameType::Scan, 7, scan_payload("k1000", "k1300", 100));
+    write_bytes(conn.peer, request);
+    conn.ch->handle_events(EPOLLIN);
+    batches = pump_scan(*conn.ch, conn.peer);
+
+    std::vector<std::string> keys;
+    for (const ScanBatch& batch : batches) {
+      CHECK(batch.id == 7);
+      CHECK(batch.keys.size() * (value.size() + 13) <= tn::RpcProtocol::SCAN_BATCH_BYTES);
+      keys.insert(keys.end(), batch.keys.begin(), batch.keys.end());
+    }
+    REQUIRE(batches.size() > 2);
+    CHECK(batches.back().last);
+    REQUIRE(keys.size() == 300);
+    CHECK(std::ranges::is_sorted(keys));
+    CHECK(keys.front() == "k1000");
+    CHECK(keys.back() == "k1299");
+    CHECK_FALSE(conn.ch->should_close());
+
+    metrics::flush_thread(0ms);
+    CHECK(metrics::get_counter<"rpc.scans">() == 2);
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("scan.one_at_a_time_and_cancel")
+  {
+    ts::Engine engine;
+    tn::RpcProtocol::bind_engine(&engine);
+    engine.put("a", "1");
+    engine.put("b", "2");
+
+    Connection             conn;
+    std::vector<std::byte> requests;
+    append_batch_frame(requests, tn::FrameType::Scan, 1, scan_payload("", "", 0));
+    append_batch_frame(requests, tn::FrameType::Scan, 2, scan_payload("", "", 1));
+    append_batch_frame(requests, tn::FrameType::ScanCancel, 1, {});
+    write_bytes(conn.peer, requests);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<std::byte> replies = read_all(conn.peer);
+    const tn::FrameParse         busy    = tn::parse_frame(replies, 1 << 16);
+    REQUIRE(busy.status == tn::FrameStatus::Complete);
+    CHECK(busy.frame.header.type == tn::FrameType::Error);
+    CHECK(busy.frame.header.id == 2);
+
+    const tn::FrameParse cancel = tn::parse_frame(std::span(replies).subspan(busy.size), 1 << 16);
+    REQUIRE(cancel.status == tn::FrameStatus::Complete);
+    CHECK(cancel.frame.header.type == tn::FrameType::ScanBatch);
+    CHECK(cancel.frame.header.id == 1);
+    CHECK((cancel.frame.header.flags & tn::FRAME_FLAG_END) != 0);
+    tn::PayloadReader in(cancel.frame.payload);
+    CHECK(in.u32() == 0);
+    CHECK(in.done());
+
+    // the connection is free for the next scan
+    requests.clear();
+    append_batch_frame(requests, tn::FrameType::Scan, 3, scan_payload("b", "", 1));
+    write_bytes(conn.peer, requests);
+    conn.ch->handle_events(EPOLLIN);
+    const std::vector<ScanBatch> batches = pump_scan(*conn.ch, conn.peer);
+    REQUIRE(batches.size() == 1);
+    CHECK(batches[0].last);
+    CHECK(batches[0].keys == std::vector<std::string>{"b"});
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("scan.small_request_not_held_behind")
+  {
+    ts::Engine engine;
+    tn::RpcProtocol::bind_engine(&engine);
+    const std::string value(1000, 'v');
+    for (int i = 0; i < 4000; ++i) {
+      engine.put("k" + std::to_string(10000 + i), value);
+    }
+    engine.put("small", "1");
+
+    // credits for the whole range, and a socket buffer well below TX_HIGH_WATERMARK: TX holds
+    // queued batches until the scan ends
+    Connection conn;
+    const int  sndbuf = 32 << 10;
+    REQUIRE(::setsockopt(conn.fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof sndbuf) == 0);
+
+    std::vector<std::byte> request;
+    append_batch_frame(request, tn::FrameType::Scan, 1, scan_payload("k", "l", 1000));
+    write_bytes(conn.peer, request);
+    conn.ch->handle_events(EPOLLIN);
+    REQUIRE(conn.ch->backpressured());
+
+    request.clear();
+    append_batch_frame(request, tn::FrameType::MGet, 2, mget_payload({"small"}));
+    write_bytes(conn.peer, request);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<std::byte> replies = pump(*conn.ch, conn.peer);
+    std::size_t                  offset  = 0;
+    std::size_t                  batches = 0;
+    std::size_t                  after   = 0; // batches behind the MGet result
+    bool                         got     = false;
+    bool                         ended   = false;
+    while (offset < replies.size()) {
+      const tn::FrameParse parsed = tn::parse_frame(std::span(replies).subspan(offset), 1 << 20);
+      REQUIRE(parsed.status == tn::FrameStatus::Complete);
+      offset += parsed.size;
+      if (parsed.frame.header.type == tn::FrameType::MGetResult) {
+        CHECK(parsed.frame.header.id == 2);
+        CHECK_FALSE(ended);
+        got = true;
+        continue;
+      }
+      REQUIRE(parsed.frame.header.type == tn::FrameType::ScanBatch);
+      ++batches;
+      after += got ? 1 : 0;
+      ended = (parsed.frame.header.flags & tn::FRAME_FLAG_END) != 0;
+    }
+    REQUIRE(got);
+    CHECK(ended);
+    // answered once TX fell below its high watermark, not once the scan was done
+    CHECK(after > batches / 2);
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("aggregate.requested_fns")
+  {
+    metrics::flush_thread(0ms);
+    metrics::global_reset();
+
+    ts::Engine engine;
+    tn::RpcProtocol::bind_engine(&engine);
+    std::string value;
+    for (std::int64_t t = 0; t < 3000; ++t) {
+      ts::encode_sample(value, static_cast<double>(t % 60));
+      engine.put(ts::point_key("cpu", t), value);
+    }
+
+    const std::uint32_t fns = static_cast<std::uint32_t>(ts::AggregateFn::Max) |
+                              static_cast<std::uint32_t>(ts::AggregateFn::Count);
+
+    Connection             conn;
+    std::vector<std::byte> request;
+    append_batch_frame(
+      request, tn::FrameType::Aggregate, 9, aggregate_payload("cpu", 0, 3000, 1, fns));
+    write_bytes(conn.peer, request);
+    conn.ch->handle_events(EPOLLIN);
+
+    // 3000 one-point buckets: two full batches and a short last one
+    std::vector<std::byte> replies;
+    for (int idle = 0; idle < 2;) {
+      conn.ch->handle_events(EPOLLOUT);
+      const std::vector<std::byte> bytes = read_all(conn.peer);
+      replies.insert(replies.end(), bytes.begin(), bytes.end());
+      idle = bytes.empty() ? idle + 1 : 0;
+    }
+
+    std::size_t offset  = 0;
+    std::size_t buckets = 0;
+    std::size_t frames  = 0;
+    bool        last    = false;
+    while (offset < replies.size()) {
+      const tn::FrameParse parsed = tn::parse_frame(std::span(replies).subspan(offset), 1 << 20);
+      REQUIRE(parsed.status == tn::FrameStatus::Complete);
+      CHECK(parsed.frame.header.type == tn::FrameType::AggregateBatch);
+      CHECK(parsed.frame.header.id == 9);
+      CHECK_FALSE(last);
+      last = (parsed.frame.header.flags & tn::FRAME_FLAG_END) != 0;
+      offset += parsed.size;
+      ++frames;
+
+      tn::PayloadReader in(parsed.frame.payload);
+      for (std::uint32_t n = in.u32(); n > 0; --n, ++buckets) {
+        CHECK(static_cast<std::int64_t>(in.u64()) == static_cast<std::int64_t>(buckets));
+        CHECK(in.f64() == static_cast<double>(buckets % 60)); // max
+        CHECK(in.u64() == 1); // count
+      }
+      CHECK(in.done());
+    }
+    CHECK(last);
+    CHECK(frames == 3);
+    CHECK(buckets == 3000);
+
+    // wider buckets fold the points where they are stored
+    request.clear();
+    append_batch_frame(request,
+      tn::FrameType::Aggregate,
+      10,
+      aggregate_payload("cpu", 0, 3000, 60, ts::AGGREGATE_FNS_ALL));
+    write_bytes(conn.peer, request);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<std::byte> reply = read_all(conn.peer);
+    const tn::FrameParse         batch = tn::parse_frame(reply, 1 << 20);
+    REQUIRE(batch.status == tn::FrameStatus::Complete);
+    CHECK(batch.size == reply.size());
+    CHECK((batch.frame.header.flags & tn::FRAME_FLAG_END) != 0);
+    tn::PayloadReader in(batch.frame.payload);
+    REQUIRE(in.u32() == 50);
+    CHECK(in.u64() == 0);
+    CHECK(in.f64() == 0.0); // min
+    CHECK(in.f64() == 59.0); // max
+    CHECK(in.f64() == 1770.0); // sum
+    CHECK(in.u64() == 60); // count
+    CHECK(in.f64() == 29.5); // avg
+    CHECK(batch.frame.payload.size() == 4 + 50 * 6 * 8);
+
+    metrics::flush_thread(0ms);
+    CHECK(metrics::get_counter<"rpc.aggregates">() == 2);
+    CHECK(metrics::get_counter<"rpc.aggregate_buckets">() == 3050);
+    CHECK(metrics::get_counter<"rpc.aggregate_points">() == 6000);
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("aggregate.bucket_over_entry_cap")
+  {
+    ts::Engine engine;
+    tn::RpcProtocol::bind_engine(&engine);
+    constexpr auto NPOINTS =
+      static_cast<std::int64_t>(2 * tn::RpcProtocol::AGGREGATE_BATCH_ENTRIES + 100);
+    std::string value;
+    ts::encode_sample(value, 1.0);
+    for (std::int64_t t = 0; t < NPOINTS; ++t) {
+      engine.put(ts::point_key("cpu", t), value);
+    }
+
+    const std::uint32_t    count = static_cast<std::uint32_t>(ts::AggregateFn::Count);
+    Connection             conn;
+    std::vector<std::byte> request;
+    append_batch_frame(
+      request, tn::FrameType::Aggregate, 3, aggregate_payload("cpu", 0, NPOINTS, NPOINTS, count));
+    write_bytes(conn.peer, request);
+
+    // one capped fold per turn; the channel yields in between instead of sending empty batches
+    conn.ch->handle_events(EPOLLIN);
+    std::size_t            turns = 1;
+    std::vector<std::byte> reply = read_all(conn.peer);
+    while (reply.empty()) {
+      REQUIRE(conn.ch->deferred_events() == EPOLLOUT);
+      conn.ch->handle_events(EPOLLOUT);
+      ++turns;
+      reply = read_all(conn.peer);
+    }
+    CHECK(turns == 3);
+    CHECK(conn.ch->deferred_events() == 0);
+
+    const tn::FrameParse batch = tn::parse_frame(reply, 1 << 20);
+    REQUIRE(batch.status == tn::FrameStatus::Complete);
+    CHECK(batch.size == reply.size());
+    CHECK(batch.frame.header.type == tn::FrameType::AggregateBatch);
+    CHECK((batch.frame.header.flags & tn::FRAME_FLAG_END) != 0);
+    tn::PayloadReader in(batch.frame.payload);
+    REQUIRE(in.u32() == 1);
+    CHECK(in.u64() == 0);
+    CHECK(in.u64() == static_cast<std::uint64_t>(NPOINTS));
+    CHECK(in.done());
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("aggregate.bad_query")
+  {
+    ts::Engine engine;
+    tn::RpcProtocol::bind_engine(&engine);
+    Connection conn;
+
+    const std::uint32_t    sum = static_cast<std::uint32_t>(ts::AggregateFn::Sum);
+    std::vector<std::byte> requests;
+    append_batch_frame(
+      requests, tn::FrameType::Aggregate, 1, aggregate_payload("cpu", 0, 100, 0, sum));
+    append_batch_frame(
+      requests, tn::FrameType::Aggregate, 2, aggregate_payload("cpu", 0, 100, 10, 0));
+    append_batch_frame(
+      requests, tn::FrameType::Aggregate, 3, aggregate_payload("", 0, 100, 10, sum));
+    append_batch_frame(requests, tn::FrameType::Scan, 4, scan_payload("", "", 0));
+    append_batch_frame(
+      requests, tn::FrameType::Aggregate, 5, aggregate_payload("cpu", 0, 100, 10, sum));
+    write_bytes(conn.peer, requests);
+    conn.ch->handle_events(EPOLLIN);
+
+    // the last one finds the scan still holding the stream slot
+    const std::vector<tn::FrameHeader> responses = read_frames(conn.peer);
+    REQUIRE(responses.size() == 4);
+    for (std::size_t i = 0; i < 4; ++i) {
+      CHECK(responses[i].type == tn::FrameType::Error);
+    }
+    CHECK(responses[3].id == 5);
+    CHECK_FALSE(conn.ch->should_close());
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("points.put_and_scan")
+  {
+    metrics::flush_thread(0ms);
+    metrics::global_reset();
+
+    ts::Engine engine;
+    tn::RpcProtocol::bind_engine(&engine);
+    std::string value;
+    ts::encode_sample(value, -1.0);
+    engine.put(ts::point_key("cpu.user", 0), value); // a neighbouring series
+    engine.put(ts::point_key("cpu", 15), "not a sample"); // skipped by the scan
+    // a raw key inside the range that parses as a point of another series ("cpu\0<20>" at 7)
+    engine.put(ts::point_key(ts::point_key("cpu", 20), 7), value);
+
+    // 6000 points: one full PointsBatch and a short last one
+    std::vector<ts::Point> points;
+    for (std::int64_t t = 0; t < 6000; ++t) {
+      points.push_back({t * 10, static_cast<double>(t % 100) * 0.25});
+    }
+    std::vector<std::byte> block;
+    ts::encode_points(block, "cpu", points);
+
+    Connection             conn;
+    std::vector<std::byte> request;
+    append_batch_frame(request, tn::FrameType::PutPoints, 1, block);
+    append_batch_frame(
+      request, tn::FrameType::ScanPoints, 2, scan_points_payload("cpu", 0, 60'000, 4));
+    write_bytes(conn.peer, request);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<std::byte> replies = pump(*conn.ch, conn.peer);
+    const tn::FrameParse         result  = tn::parse_frame(replies, 1 << 20);
+    REQUIRE(result.status == tn::FrameStatus::Complete);
+    CHECK(result.frame.header.type == tn::FrameType::PutPointsResult);
+    CHECK(tn::PayloadReader(result.frame.payload).u32() == 6000);
+    CHECK(engine.size() == 6003);
+
+    std::vector<ts::Point> scanned;
+    std::size_t            offset = result.size;
+    std::size_t            frames = 0;
+    bool                   last   = false;
+    while (offset < replies.size()) {
+      const tn::FrameParse parsed = tn::parse_frame(std::span(replies).subspan(offset), 1 << 20);
+      REQUIRE(parsed.status == tn::FrameStatus::Complete);
+      CHECK(parsed.frame.header.type == tn::FrameType::PointsBatch);
+      CHECK(parsed.frame.header.id == 2);
+      CHECK_FALSE(last);
+      last = (parsed.frame.header.flags & tn::FRAME_FLAG_END) != 0;
+      offset += parsed.size;
+      ++frames;
+
+      ts::PointDecoder decoder(parsed.frame.payload);
+      CHECK(decoder.series() == "cpu");
+      while (const std::optional<ts::Point> point = decoder.next()) {
+        scanned.push_back(*point);
+      }
+      CHECK(decoder.done());
+    }
+    CHECK(last);
+    CHECK(frames == 2);
+    REQUIRE(scanned.size() == points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      CHECK(scanned[i].timestamp == points[i].timestamp);
+      CHECK(scanned[i].value == points[i].value);
+    }
+
+    metrics::flush_thread(0ms);
+    CHECK(metrics::get_counter<"rpc.points_written">() == 6000);
+    CHECK(metrics::get_counter<"rpc.points_scanned">() == 6000);
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+
+  TEST_CASE("points.malformed_block")
+  {
+    ts::Engine engine;
+    tn::RpcProtocol::bind_engine(&engine);
+    Connection conn;
+
+    std::vector<std::byte> block;
+    ts::encode_points(block, "cpu", std::vector<ts::Point>{{1, 1.0}, {2, 2.0}, {3, 4.0}});
+    block.pop_back();
+
+    std::vector<std::byte> requests;
+    append_batch_frame(requests, tn::FrameType::PutPoints, 1, block);
+    append_batch_frame(requests, tn::FrameType::ScanPoints, 2, scan_points_payload("", 0, 1, 1));
+    write_bytes(conn.peer, requests);
+    conn.ch->handle_events(EPOLLIN);
+
+    const std::vector<tn::FrameHeader> responses = read_frames(conn.peer);
+    REQUIRE(responses.size() == 2);
+    CHECK(responses[0].type == tn::FrameType::Error);
+    CHECK(responses[1].type == tn::FrameType::Error);
+    CHECK(engine.size() == 0);
+    CHECK_FALSE(conn.ch->should_close());
+
+    tn::RpcProtocol::bind_engine(nullptr);
+  }
+}
@@ -0,0 +1,188 @@
+#include <arpa/inet.h>
+#include <cstdint>
+#include <doctest.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+import tskv.net.socket;
+namespace tn = tskv::net;
+
+namespace { // helper functions
+
+int get_int_option(int fd, int level, int name)
+{
+  int       value = -1;
+  socklen_t len   = sizeof value;
+  REQUIRE(getsockopt(fd, level, name, &value, &len) == 0);
+  return value;
+}
+
+std::uint16_t bound_port(int fd)
+{
+  sockaddr_storage addr{};
+  socklen_t        len = sizeof addr;
+  REQUIRE(getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) == 0);
+  if (addr.ss_family == AF_INET6) {
+    return ntohs(reinterpret_cast<const sockaddr_in6&>(addr).sin6_port);
+  }
+  return ntohs(reinterpret_cast<const sockaddr_in&>(addr).sin_port);
+}
+
+// Blocking IPv4 connect to 127.0.0.1:port.
+int connect_v4(std::uint16_t port)
+{
+  const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  REQUIRE(fd != -1);
+
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  REQUIRE(connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == 0);
+  return fd;
+}
+
+int connect_unix(const std::string& path)
+{
+  const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  REQUIRE(fd != -1);
+
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  path.copy(addr.sun_path, sizeof addr.sun_path - 1);
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// The listener is non-blocking; wait for the pending connection instead of spinning.
+int accept_one(int listen_fd)
+{
+  for (int attempt = 0; attempt < 1000; ++attempt) {
+    const int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd != -1) {
+      return fd;
+    }
+    usleep(1000);
+  }
+  FAIL("no connection to accept");
+  return -1;
+}
+
+} // namespace
+
+TEST_SUITE("tskv.net.socket")
+{
+  TEST_CASE("socket_profile")
+  {
+    tn::SocketProfile profile;
+    profile.backlog         = 16;
+    profile.rcvbuf_bytes    = 256 * 1024;
+    profile.sndbuf_bytes    = 128 * 1024;
+    profile.notsent_lowat   = 16 * 1024;
+    profile.user_timeout_ms = 5000;
+
+    const int listen_fd = tn::start_listener("127.0.0.1", 0, false, profile);
+    REQUIRE(listen_fd != -1);
+
+    // the kernel doubles the requested size for bookkeeping overhead
+    CHECK(get_int_option(listen_fd, SOL_SOCKET, SO_RCVBUF) >= 256 * 1024);
+    CHECK(get_int_option(listen_fd, SOL_SOCKET, SO_SNDBUF) >= 128 * 1024);
+    CHECK(get_int_option(listen_fd, IPPROTO_TCP, TCP_DEFER_ACCEPT) == 0);
+
+    const int client_fd = connect_v4(bound_port(listen_fd));
+    const int fd        = accept_one(listen_fd);
+
+    CHECK(get_int_option(fd, IPPROTO_TCP, TCP_NODELAY) == 0);
+    CHECK(tn::apply_socket_profile(fd, profile));
+    CHECK(get_int_option(fd, IPPROTO_TCP, TCP_NODELAY) == 1);
+    CHECK(get_int_option(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT) == 16 * 1024);
+    CHECK(get_int_option(fd, IPPROTO_TCP, TCP_USER_TIMEOUT) == 5000);
+
+    // buffer sizes are inherited from the listener
+    CHECK(get_int_option(fd, SOL_SOCKET, SO_RCVBUF) >= 256 * 1024);
+
+    ::close(fd);
+    ::close(client_fd);
+    ::close(listen_fd);
+  }
+
+  TEST_CASE("defer_accept")
+  {
+    tn::SocketProfile profile;
+    profile.defer_accept_s = 1;
+
+    const int listen_fd = tn::start_listener("127.0.0.1", 0, false, profile);
+    REQUIRE(listen_fd != -1);
+    CHECK(get_int_option(listen_fd, IPPROTO_TCP, TCP_DEFER_ACCEPT) > 0);
+
+    const int client_fd = connect_v4(bound_port(listen_fd));
+    CHECK(accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC) == -1);
+
+    REQUIRE(::write(client_fd, "x", 1) == 1);
+    const int fd = accept_one(listen_fd);
+    CHECK(fd != -1);
+
+    ::close(fd);
+    ::close(client_fd);
+    ::close(listen_fd);
+  }
+
+  TEST_CASE("ipv6_dual_stack")
+  {
+    const int listen_fd = tn::start_listener("::", 0);
+    if (listen_fd == -1) {
+      MESSAGE("IPv6 unavailable; skipping");
+      return;
+    }
+
+    CHECK(get_int_option(listen_fd, IPPROTO_IPV6, IPV6_V6ONLY) == 0);
+
+    const int client_fd = connect_v4(bound_port(listen_fd));
+    const int fd        = accept_one(listen_fd);
+    CHECK(fd != -1);
+
+    ::close(fd);
+    ::close(client_fd);
+    ::close(listen_fd);
+  }
+
+  TEST_CASE("unix_listener.stale_socket")
+  {
+    const std::string path = "/tmp/tskv-test-socket-" + std::to_string(getpid()) + ".sock";
+
+    { // leave a socket file behind with nobody listening on it
+      const int   stale = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      sockaddr_un addr{};
+      addr.sun_family = AF_UNIX;
+      path.copy(addr.sun_path, sizeof addr.sun_path - 1);
+      REQUIRE(bind(stale, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) == 0);
+      ::close(stale);
+    }
+
+    const int listen_fd = tn::start_unix_listener(path.c_str());
+    REQUIRE(listen_fd != -1);
+
+    const int client_fd = connect_unix(path);
+    CHECK(client_fd != -1);
+    const int fd = accept_one(listen_fd);
+    CHECK(fd != -1);
+
+    // a second listener must not take over the path from a live one
+    CHECK(tn::start_unix_listener(path.c_str()) == -1);
+    struct stat st{};
+    CHECK(::stat(path.c_str(), &st) == 0);
+
+    ::close(fd);
+    ::close(client_fd);
+    ::close(listen_fd);
+    ::unlink(path.c_str());
+  }
+}
@@ -0,0 +1,143 @@
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <optional>
+#include <vector>
+
+import tskv.net.timer_wheel;
+namespace tn = tskv::net;
+
+namespace { // helper functions
+
+// Advance to `now`, returning the cookies of the timers that fired, in order.
+std::vector<std::uint64_t> advance_to(tn::TimerWheel& wheel, std::uint64_t now)
+{
+  std::vector<std::uint64_t> fired;
+  wheel.advance(now, [&](tn::Timer& t) {
+    CHECK_FALSE(t.armed());
+    CHECK(t.expires() <= now);
+    fired.push_back(t.cookie);
+  });
+  return fired;
+}
+
+} // namespace
+
+TEST_SUITE("tskv.net.timer_wheel")
+{
+  TEST_CASE("expiry_order")
+  {
+    tn::TimerWheel wheel;
+
+    // one per level boundary region, scheduled out of order
+    const std::uint64_t expiries[] = {70, 5, 64, 4097, 63, 262144 + 3};
+    tn::Timer           timers[6];
+    for (std::size_t i = 0; i < 6; ++i) {
+      timers[i].cookie = expiries[i];
+      wheel.schedule(timers[i], expiries[i]);
+    }
+    CHECK(wheel.size() == 6);
+
+    CHECK(advance_to(wheel, 4).empty());
+    CHECK(advance_to(wheel, 63) == std::vector<std::uint64_t>{5, 63});
+    CHECK(advance_to(wheel, 69) == std::vector<std::uint64_t>{64});
+    CHECK(advance_to(wheel, 70) == std::vector<std::uint64_t>{70});
+    CHECK(advance_to(wheel, 4096).empty());
+    CHECK(advance_to(wheel, 1'000'000) == std::vector<std::uint64_t>{4097, 262144 + 3});
+    CHECK(wheel.empty());
+    CHECK(wheel.now() == 1'000'000);
+  }
+
+  TEST_CASE("next_due.never_overshoots")
+  {
+    tn::TimerWheel wheel(12345);
+    CHECK_FALSE(wheel.next_due().has_value());
+
+    tn::Timer t;
+    wheel.schedule(t, 12345 + 100'000);
+
+    // may report cascade points first, but always reaches the expiry exactly
+    std::uint64_t steps = 0;
+    while (t.armed()) {
+      const std::optional<std::uint64_t> due = wheel.next_due();
+      REQUIRE(due.has_value());
+      REQUIRE(*due <= t.expires());
+      wheel.advance(*due, [](tn::Timer& fired) { CHECK(fired.expires() == 12345 + 100'000); });
+      ++steps;
+    }
+    CHECK(steps <= tn::TimerWheel::LEVELS);
+    CHECK(wheel.now() == 12345 + 100'000);
+  }
+
+  TEST_CASE("cancel_and_reschedule")
+  {
+    tn::TimerWheel wheel;
+
+    tn::Timer a, b;
+    a.cookie = 1;
+    b.cookie = 2;
+    wheel.schedule(a, 10);
+    wheel.schedule(b, 20);
+
+    wheel.cancel(a);
+    wheel.cancel(a); // no-op
+    CHECK_FALSE(a.armed());
+    CHECK(wheel.size() == 1);
+
+    wheel.schedule(b, 5000); // move out
+    CHECK(wheel.size() == 1);
+    CHECK(advance_to(wheel, 4999).empty());
+
+    wheel.schedule(a, 0); // in the past: fires on the next tick
+    CHECK(a.expires() == 5000);
+    CHECK(advance_to(wheel, 5000).size() == 2); // same tick; no order among equal expiries
+  }
+
+  TEST_CASE("callbacks.rearm_and_cancel")
+  {
+    tn::TimerWheel wheel;
+
+    tn::Timer periodic, victim;
+    periodic.cookie = 1;
+    victim.cookie   = 2;
+    wheel.schedule(periodic, 10);
+    wheel.schedule(victim, 10);
+
+    int ticks = 0;
+    wheel.advance(100, [&](tn::Timer& t) {
+      if (&t == &periodic) {
+        ++ticks;
+        wheel.cancel(victim);
+        wheel.schedule(periodic, wheel.now() + 10);
+      }
+      else {
+        FAIL("cancelled timer fired");
+      }
+    });
+
+    CHECK(ticks == 10); // 10, 20, ..., 100
+    CHECK(periodic.armed());
+    CHECK(periodic.expires() == 110);
+    wheel.cancel(periodic);
+  }
+
+  TEST_CASE("max_delay_clamp")
+  {
+    tn::TimerWheel wheel;
+
+    tn::Timer t;
+    wheel.schedule(t, UINT64_MAX);
+    CHECK(t.expires() == tn::TimerWheel::MAX_DELAY);
+    wheel.cancel(t);
+  }
+
+  TEST_CASE("destructor_disarms")
+  {
+    tn::Timer t;
+    {
+      tn::TimerWheel wheel;
+      wheel.schedule(t, 42);
+    }
+    CHECK_FALSE(t.armed());
+  }
+}
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/uio.h>
+
+import tskv.net.tx_queue;
+namespace tn = tskv::net;
+
+namespace { // helper functions
+
+std::string_view iov_view(const iovec& iov)
+{
+  return {static_cast<const char*>(iov.iov_base), iov.iov_len};
+}
+
+constexpr auto never = [](const tn::TxSegment&) { return false; };
+
+} // namespace
+
+TEST_SUITE("tskv.net.tx_queue")
+{
+  TEST_CASE("segment.shared_owner")
+  {
+    tn::TxSegment seg = tn::TxSegment::from_string(std::string("hello world"));
+    REQUIRE(seg.size() == 11);
+
+    std::weak_ptr<const void> watch = seg.owner;
+
+    tn::TxSegment world = seg.subsegment(6, 5);
+    seg                 = {};
+    CHECK_FALSE(watch.expired());
+    CHECK(std::string_view(reinterpret_cast<const char*>(world.bytes.data()), world.size()) ==
+          "world");
+
+    world = {};
+    CHECK(watch.expired());
+  }
+
+  TEST_CASE("queue.gather_and_consume")
+  {
+    tn::TxQueue q;
+    q.push(tn::TxSegment::from_string("abc"));
+    q.push(tn::TxSegment::from_string("")); // ignored
+    q.push(tn::TxSegment::from_string("defgh"));
+    q.push(tn::TxSegment::from_string("ij"));
+
+    CHECK(q.bytes() == 10);
+
+    iovec iov[8];
+    std::size_t n = q.gather(iov, 100, never);
+    REQUIRE(n == 3);
+    CHECK(iov_view(iov[0]) == "abc");
+    CHECK(iov_view(iov[1]) == "defgh");
+    CHECK(iov_view(iov[2]) == "ij");
+
+    // max_bytes trims the last iovec
+    n = q.gather(iov, 5, never);
+    REQUIRE(n == 2);
+    CHECK(iov_view(iov[1]) == "de");
+
+    // a short send ends mid-segment
+    q.consume(4);
+    CHECK(q.bytes() == 6);
+    n = q.gather(iov, 100, never);
+    REQUIRE(n == 2);
+    CHECK(iov_view(iov[0]) == "efgh");
+
+    q.consume(6);
+    CHECK(q.empty());
+    CHECK(q.bytes() == 0);
+  }
+
+  TEST_CASE("queue.gather_limits")
+  {
+    tn::TxQueue q;
+    q.push(tn::TxSegment::from_string("a"));
+    q.push(tn::TxSegment::from_string("b"));
+    q.push(tn::TxSegment::from_string("LARGE"));
+    q.push(tn::TxSegment::from_string("c"));
+
+    iovec iov[2];
+    CHECK(q.gather(iov, 100, never) == 2);
+
+    iovec wide[8];
+    const auto large = [](const tn::TxSegment& seg) { return seg.size() > 1; };
+    CHECK(q.gather(wide, 100, large) == 2);
+
+    q.consume(2);
+    CHECK(q.gather(wide, 100, large) == 0); // the caller sends the head on its own
+  }
+
+  TEST_CASE("queue.bounded_while_never_empty")
+  {
+    // a scan refilling behind its own sends: the queue never drains to empty
+    tn::TxQueue q;
+    q.push(tn::TxSegment::from_string("0000"));
+    q.push(tn::TxSegment::from_string("0001"));
+
+    std::size_t max_slots = 0;
+    for (int i = 2; i < 10'000; ++i) {
+      q.push(tn::TxSegment::from_string(std::to_string(10'000 + i).substr(1)));
+      q.consume(i % 2 == 0 ? 3 : 5); // sends ending mid-segment and across a boundary
+      REQUIRE_FALSE(q.empty());
+      max_slots = std::max(max_slots, q.slots());
+    }
+    CHECK(max_slots <= 8);
+
+    iovec iov[4];
+    REQUIRE(q.gather(iov, 100, never) == 2);
+    CHECK(iov_view(iov[0]) == "9998");
+    CHECK(iov_view(iov[1]) == "9999");
+    CHECK(q.bytes() == 8);
+  }
+
+  TEST_CASE("zerocopy.completion_ranges")
+  {
+    tn::ZeroCopyTracker zc;
+    CHECK(zc.idle());
+
+    auto a = std::make_shared<int>(1);
+    auto b = std::make_shared<int>(2);
+    auto c = std::make_shared<int>(3);
+    zc.on_send(a);
+    zc.on_send(b);
+    zc.on_send(c);
+    CHECK(a.use_count() == 2);
+
+    CHECK(zc.on_completion(1) == 2); // kernel reports the range [0, 1]
+    CHECK(a.use_count() == 1);
+    CHECK(b.use_count() == 1);
+    CHECK(c.use_count() == 2);
+    CHECK_FALSE(zc.idle());
+
+    CHECK(zc.on_completion(1) == 0); // duplicate report
+    CHECK(zc.on_completion(2) == 1);
+    CHECK(zc.idle());
+    CHECK(c.use_count() == 1);
+  }
+
+  TEST_CASE("zerocopy.bounded_while_never_idle")
+  {
+    // steady zerocopy sends with completions always outstanding
+    tn::ZeroCopyTracker zc;
+    auto                owner = std::make_shared<int>(0);
+    zc.on_send(owner);
+    zc.on_send(owner);
+
+    std::size_t max_slots = 0;
+    for (std::uint32_t seq = 2; seq < 10'000; ++seq) {
+      zc.on_send(owner);
+      REQUIRE(zc.on_completion(seq - 2) == 1);
+      REQUIRE_FALSE(zc.idle());
+      max_slots = std::max(max_slots, zc.slots());
+    }
+    CHECK(max_slots <= 8);
+    CHECK(owner.use_count() == 3);
+
+    CHECK(zc.on_completion(9'999) == 2);
+    CHECK(zc.idle());
+    CHECK(owner.use_count() == 1);
+  }
+}
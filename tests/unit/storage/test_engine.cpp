@@ -0,0 +1,378 @@
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+import tskv.storage.engine;
+import tskv.storage.memtable;
+import tskv.storage.point_codec;
+import tskv.storage.series;
+import tskv.storage.wal;
+namespace fs = std::filesystem;
+namespace ts = tskv::storage;
+
+namespace { // helper functions
+
+// A fresh directory under /tmp, removed again when the test ends.
+struct TempDir {
+  fs::path path;
+
+  explicit TempDir(std::string_view name)
+    : path(fs::temp_directory_path() /
+           ("tskv-test-" + std::string(name) + "-" + std::to_string(::getpid())))
+  {
+    fs::remove_all(path);
+  }
+
+  ~TempDir() { fs::remove_all(path); }
+
+  TempDir(const TempDir&)            = delete;
+  TempDir& operator=(const TempDir&) = delete;
+};
+
+void put_sample(ts::Engine& engine, std::string_view series, std::int64_t timestamp, double sample)
+{
+  std::string value;
+  ts::encode_sample(value, sample);
+  CHECK(engine.put(ts::point_key(series, timestamp), value));
+}
+
+std::string value_of(const ts::Engine& engine, std::string_view key)
+{
+  std::string value = "<none>";
+  engine.get(key, [&](std::string_view v) { value = v; });
+  return value;
+}
+
+} // namespace
+
+TEST_SUITE("tskv.storage.engine")
+{
+  TEST_CASE("memtable.overwrite")
+  {
+    ts::Memtable table;
+    table.put("key", "value");
+    CHECK(table.bytes() == 8);
+
+    table.put("key", "v");
+    CHECK(table.size() == 1);
+    CHECK(table.bytes() == 4);
+    REQUIRE(table.find("key") != nullptr);
+    CHECK(*table.find("key") == "v");
+
+    CHECK(table.erase("key"));
+    CHECK_FALSE(table.erase("key"));
+    CHECK(table.bytes() == 0);
+    CHECK(table.find("key") == nullptr);
+  }
+
+  TEST_CASE("get_many.order")
+  {
+    ts::Engine engine;
+    engine.put("b", "2");
+    engine.put("a", "1");
+
+    std::string value;
+    CHECK(engine.get("a", [&](std::string_view v) { value = v; }));
+    CHECK(value == "1");
+    CHECK_FALSE(engine.get("c", [&](std::string_view) { FAIL("called for a missing key"); }));
+
+    const std::vector<std::string_view> keys{"b", "c", "a"};
+    std::vector<std::string>            values;
+    engine.get_many(keys, [&](std::optional<std::string_view> v) {
+      values.emplace_back(v.value_or("<none>"));
+    });
+    CHECK(values == std::vector<std::string>{"2", "<none>", "1"});
+  }
+
+  TEST_CASE("scan.resume")
+  {
+    ts::Engine engine;
+    for (const char* key : {"d", "a", "c", "b", "e"}) {
+      engine.put(key, key);
+    }
+
+    std::vector<std::string> seen;
+    const auto               visit = [&](std::string_view key, std::string_view) {
+      seen.emplace_back(key);
+      return true;
+    };
+
+    std::optional<std::string> next = engine.scan("b", 2, visit);
+    CHECK(seen == std::vector<std::string>{"b", "c"});
+    REQUIRE(next.has_value());
+    CHECK(*next == "d");
+
+    next = engine.scan(*next, 2, visit);
+    CHECK_FALSE(next.has_value()); // "d" and "e" were the last two
+    CHECK(seen.size() == 4);
+
+    // stopping early also ends the scan
+    CHECK_FALSE(engine.scan("", 10, [](std::string_view, std::string_view) { return false; }));
+  }
+
+  TEST_CASE("scan_range.bounds")
+  {
+    ts::Engine engine;
+    for (const char* key : {"a", "b", "c", "d", "e"}) {
+      engine.put(key, key);
+    }
+
+    std::vector<std::string> seen;
+
+    std::optional<std::string> next = engine.scan_range("b", "", [&](std::string_view key, auto) {
+      if (seen.size() == 2) {
+        return false;
+      }
+      seen.emplace_back(key);
+      return true;
+    });
+    CHECK(seen == std::vector<std::string>{"b", "c"});
+    REQUIRE(next.has_value());
+    CHECK(*next == "d"); // declined, so it comes first next time
+
+    seen.clear();
+    next = engine.scan_range(*next, "e", [&](std::string_view key, auto) {
+      seen.emplace_back(key);
+      return true;
+    });
+    CHECK(seen == std::vector<std::string>{"d"});
+    CHECK_FALSE(next.has_value());
+  }
+
+  TEST_CASE("memtable.put_batch")
+  {
+    ts::Memtable                    table;
+    const std::vector<ts::KeyValue> batch{
+      {"s1:03", "c"}, {"s1:01", "a"}, {"s1:02", "b"}, {"s1:04", "d"}, {"s1:02", "B"}, {"s0", "z"}};
+    table.put_batch(batch);
+
+    CHECK(table.size() == 5);
+    CHECK(table.bytes() == 4 * 6 + 2 + 1);
+    REQUIRE(table.find("s1:02") != nullptr);
+    CHECK(*table.find("s1:02") == "B"); // later duplicates win
+
+    std::string order;
+    for (auto it = table.lower_bound(""); it != table.end(); ++it) {
+      order += it->second;
+    }
+    CHECK(order == "zaBcd");
+  }
+
+  TEST_CASE("wal.replay")
+  {
+    TempDir dir("wal");
+
+    {
+      ts::Engine engine(dir.path, ts::WALSyncPolicy::Append);
+      CHECK(engine.put_batch(std::vector<ts::KeyValue>{{"a", "1"}, {"b", "2"}, {"c", "3"}}));
+      CHECK(engine.put("b", "22"));
+      CHECK(engine.erase("c"));
+      CHECK_FALSE(engine.erase("missing"));
+    }
+
+    {
+      ts::Engine engine(dir.path, ts::WALSyncPolicy::FDataSync);
+      CHECK(engine.size() == 2);
+      CHECK(value_of(engine, "a") == "1");
+      CHECK(value_of(engine, "b") == "22");
+      CHECK(value_of(engine, "c") == "<none>");
+      CHECK(engine.put("d", "4"));
+    }
+
+    // a crash halfway through the last append
+    const fs::path log = dir.path / "wal.log";
+    fs::resize_file(log, fs::file_size(log) - 1);
+
+    {
+      ts::Engine engine(dir.path, ts::WALSyncPolicy::Append);
+      CHECK(engine.size() == 2);
+      CHECK(value_of(engine, "d") == "<none>");
+      CHECK(engine.put("e", "5")); // lands right after the last whole record
+    }
+
+    ts::Engine engine(dir.path, ts::WALSyncPolicy::Append);
+    CHECK(engine.size() == 3);
+    CHECK(value_of(engine, "e") == "5");
+  }
+
+  TEST_CASE("wal.replay_point_block")
+  {
+    TempDir dir("wal-points");
+
+    const std::vector<ts::Point> points = {{-20, 0.5}, {0, 1.5}, {20, 2.5}};
+    std::vector<std::byte>       block;
+    ts::encode_points(block, "cpu", points);
+
+    {
+      ts::Engine                engine(dir.path, ts::WALSyncPolicy::Append);
+      std::string               arena;
+      std::vector<ts::KeyValue> batch;
+      REQUIRE(ts::expand_points(block, arena, batch) == "cpu");
+      CHECK(engine.put_points(block, batch));
+      put_sample(engine, "cpu", 0, 9.0); // later records still win
+    }
+
+    ts::Engine engine(dir.path, ts::WALSyncPolicy::Append);
+    CHECK(engine.size() == 3);
+    CHECK(ts::decode_sample(value_of(engine, ts::point_key("cpu", -20))) == 0.5);
+    CHECK(ts::decode_sample(value_of(engine, ts::point_key("cpu", 0))) == 9.0);
+    CHECK(ts::decode_sample(value_of(engine, ts::point_key("cpu", 20))) == 2.5);
+  }
+
+  TEST_CASE("point_key.order")
+  {
+    const std::int64_t timestamps[] = {INT64_MIN, -1'000, -1, 0, 1, 1'000, INT64_MAX};
+
+    std::string previous;
+    for (const std::int64_t timestamp : timestamps) {
+      const std::string key = ts::point_key("cpu", timestamp);
+      CHECK(key > previous);
+      CHECK(key < ts::point_key("cpu0", INT64_MIN)); // the separator sorts below every name byte
+      previous = key;
+
+      const std::optional<ts::PointKey> point = ts::parse_point_key(key);
+      REQUIRE(point.has_value());
+      CHECK(point->series == "cpu");
+      CHECK(point->timestamp == timestamp);
+    }
+    CHECK_FALSE(ts::parse_point_key("cpu"));
+
+    std::string value;
+    ts::encode_sample(value, -2.5);
+    CHECK(ts::decode_sample(value) == -2.5);
+    CHECK_FALSE(ts::decode_sample("1.5"));
+
+    CHECK(ts::bucket_start(59, 60) == 0);
+    CHECK(ts::bucket_start(60, 60) == 60);
+    CHECK(ts::bucket_start(-1, 60) == -60);
+    CHECK(ts::bucket_start(-60, 60) == -60);
+
+    // at the i64 extremes; a bucket whose multiple lies below INT64_MIN starts at INT64_MIN
+    constexpr std::int64_t MIN = std::numeric_limits<std::int64_t>::min();
+    constexpr std::int64_t MAX = std::numeric_limits<std::int64_t>::max();
+    CHECK(ts::bucket_start(MIN, 2) == MIN);
+    CHECK(ts::bucket_start(MIN, 3) == MIN);
+    CHECK(ts::bucket_start(MIN + 1, 3) == MIN);
+    CHECK(ts::bucket_start(MIN + 2, 3) == MIN + 2);
+    CHECK(ts::bucket_start(MAX, 3) == MAX - 1);
+    CHECK(ts::bucket_start(MAX, MAX) == MAX);
+    CHECK(ts::bucket_start(MIN, MAX) == MIN);
+    CHECK(ts::bucket_start(-1, MAX) == -MAX);
+  }
+
+  TEST_CASE("aggregate.i64_extremes")
+  {
+    constexpr std::int64_t MIN = std::numeric_limits<std::int64_t>::min();
+    constexpr std::int64_t MAX = std::numeric_limits<std::int64_t>::max();
+
+    ts::Engine engine;
+    put_sample(engine, "cpu", MIN, 1.0);
+    put_sample(engine, "cpu", MIN + 1, 2.0);
+    put_sample(engine, "cpu", MIN + 2, 3.0);
+    put_sample(engine, "cpu", MAX - 1, 4.0);
+
+    std::vector<ts::BucketAggregate> buckets;
+    const auto collect = [&](const ts::BucketAggregate& bucket) { buckets.push_back(bucket); };
+
+    ts::BucketAggregate open;
+
+    // MIN and MIN + 1 share the partial bucket below the first multiple of 3, MIN + 2
+    CHECK_FALSE(engine.aggregate("cpu", MIN, MAX, 3, 10, SIZE_MAX, open, collect));
+    REQUIRE(buckets.size() == 3);
+    CHECK(buckets[0].start == MIN);
+    CHECK(buckets[0].count == 2);
+    CHECK(buckets[1].start == MIN + 2);
+    CHECK(buckets[2].start == MAX - 1);
+
+    buckets.clear();
+    CHECK_FALSE(engine.aggregate("cpu", MIN, MAX, MAX, 10, SIZE_MAX, open, collect));
+    REQUIRE(buckets.size() == 3);
+    CHECK(buckets[0].start == MIN);
+    CHECK(buckets[0].count == 1);
+    CHECK(buckets[1].start == -MAX);
+    CHECK(buckets[1].count == 2);
+    CHECK(buckets[2].start == 0);
+  }
+
+  TEST_CASE("aggregate.buckets_and_resume")
+  {
+    ts::Engine engine;
+    for (std::int64_t t = 0; t < 10; ++t) {
+      put_sample(engine, "cpu", 100 + t * 10, static_cast<double>(t)); // 100, 110, ..., 190
+    }
+    put_sample(engine, "cp", 150, 1000.0); // neighbouring series on both sides
+    put_sample(engine, "cpu.user", 150, 1000.0);
+    CHECK(engine.put(ts::point_key("cpu", 155), "not a sample"));
+
+    std::vector<ts::BucketAggregate> buckets;
+    const auto collect = [&](const ts::BucketAggregate& bucket) { buckets.push_back(bucket); };
+    ts::BucketAggregate open;
+
+    // [105, 185) holds t = 1..8 at 110..180; buckets of 50 start at 100 and 150
+    std::optional<std::int64_t> next =
+      engine.aggregate("cpu", 105, 185, 50, 10, SIZE_MAX, open, collect);
+    CHECK_FALSE(next.has_value());
+    REQUIRE(buckets.size() == 2);
+    CHECK(buckets[0].start == 100);
+    CHECK(buckets[0].count == 4);
+    CHECK(buckets[0].min == 1.0);
+    CHECK(buckets[0].max == 4.0);
+    CHECK(buckets[0].sum == 10.0);
+    CHECK(buckets[1].start == 150);
+    CHECK(buckets[1].count == 4);
+    CHECK(buckets[1].avg() == 6.5);
+
+    // one bucket at a time, resuming where the last call stopped
+    buckets.clear();
+    next = std::int64_t{0};
+    std::size_t calls = 0;
+    while (next) {
+      next = engine.aggregate("cpu", *next, 1'000, 30, 1, SIZE_MAX, open, collect);
+      ++calls;
+    }
+    CHECK(calls == 4);
+    REQUIRE(buckets.size() == 4);
+    CHECK(buckets[0].start == 90); // 100
+    CHECK(buckets[3].start == 180); // 180, 190
+    CHECK(buckets[3].count == 2);
+  }
+
+  TEST_CASE("aggregate.entry_cap")
+  {
+    ts::Engine engine;
+    for (std::int64_t t = 0; t < 100; ++t) {
+      put_sample(engine, "cpu", t, 1.0);
+    }
+    CHECK(engine.put(ts::point_key("cpu", 50) + "x", "not a point")); // sorts after t = 50
+
+    std::vector<ts::BucketAggregate> buckets;
+    const auto collect = [&](const ts::BucketAggregate& bucket) { buckets.push_back(bucket); };
+    ts::BucketAggregate open;
+
+    // one bucket of 90 points, then one of 10, at most 16 entries per call
+    std::optional<std::int64_t> next = std::int64_t{0};
+    std::size_t                 calls = 0;
+    while (next) {
+      next = engine.aggregate("cpu", *next, 100, 90, 10, 16, open, collect);
+      ++calls;
+      if (next) {
+        CHECK(open.count > 0); // every call stops inside a bucket here
+      }
+    }
+    CHECK(calls == 7); // 101 entries
+    CHECK(open.count == 0);
+    REQUIRE(buckets.size() == 2);
+    CHECK(buckets[0].start == 0);
+    CHECK(buckets[0].count == 90);
+    CHECK(buckets[0].sum == 90.0);
+    CHECK(buckets[1].start == 90);
+    CHECK(buckets[1].count == 10);
+  }
+}
@@ -0,0 +1,237 @@
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <doctest.h>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+import tskv.storage.memtable;
+import tskv.storage.point_codec;
+import tskv.storage.series;
+namespace ts = tskv::storage;
+
+namespace { // helper functions
+
+std::vector<ts::Point> decode_all(std::span<const std::byte> block, bool& done)
+{
+  ts::PointDecoder       decoder(block);
+  std::vector<ts::Point> points;
+  while (const std::optional<ts::Point> point = decoder.next()) {
+    points.push_back(*point);
+  }
+  done = decoder.done();
+  return points;
+}
+
+// Bit-exact, so NaN payloads and -0.0 count.
+bool same(const std::vector<ts::Point>& a, const std::vector<ts::Point>& b)
+{
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (a[i].timestamp != b[i].timestamp ||
+        std::bit_cast<std::uint64_t>(a[i].value) != std::bit_cast<std::uint64_t>(b[i].value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Packs a string of '0'/'1' into bytes, MSB first, zero-padded like a value column.
+std::vector<std::byte> pack_bits(std::string_view bits)
+{
+  std::vector<std::byte> out((bits.size() + 7) / 8);
+  for (std::size_t i = 0; i < bits.size(); ++i) {
+    if (bits[i] == '1') {
+      out[i / 8] |= std::byte{0x80} >> (i % 8);
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+TEST_SUITE("tskv.storage.point_codec")
+{
+  TEST_CASE("roundtrip")
+  {
+    constexpr std::int64_t MIN = std::numeric_limits<std::int64_t>::min();
+    constexpr std::int64_t MAX = std::numeric_limits<std::int64_t>::max();
+    constexpr double       INF = std::numeric_limits<double>::infinity();
+
+    std::vector<ts::Point> points;
+
+    SUBCASE("empty") {}
+
+    SUBCASE("one point")
+    {
+      points = {{-5, 1.5}};
+    }
+
+    SUBCASE("steady interval with jitter and repeats")
+    {
+      for (std::int64_t i = 0; i < 1000; ++i) {
+        const std::int64_t jitter = i % 7 == 0 ? 3 : 0;
+        points.push_back(
+          {1'700'000'000'000 + i * 1000 + jitter, static_cast<double>(i / 10) * 0.5});
+      }
+    }
+
+    SUBCASE("extremes")
+    {
+      points = {{MAX, INF},
+        {MIN, -INF},
+        {0, -0.0},
+        {MAX, std::numeric_limits<double>::quiet_NaN()},
+        {-1, std::numeric_limits<double>::denorm_min()},
+        {MIN, std::numeric_limits<double>::max()},
+        {MIN, std::numeric_limits<double>::max()}};
+    }
+
+    std::vector<std::byte> block;
+    ts::encode_points(block, "cpu.user", points);
+
+    bool                         done    = false;
+    const std::vector<ts::Point> decoded = decode_all(block, done);
+    CHECK(done);
+    CHECK(same(decoded, points));
+    CHECK(ts::PointDecoder(block).series() == "cpu.user");
+  }
+
+  TEST_CASE("compression")
+  {
+    std::vector<ts::Point> points;
+    for (std::int64_t i = 0; i < 10'000; ++i) {
+      points.push_back({1'700'000'000 + i * 10, static_cast<double>(20 + i / 100 % 4)});
+    }
+
+    std::vector<std::byte> block;
+    ts::encode_points(block, "temp", points);
+
+    // key/value records would take (series + 9 + 8) bytes and two lengths per point
+    CHECK(block.size() < points.size() * 2);
+    CHECK(block.size() * 10 < points.size() * (4 + 9 + 8 + 8));
+  }
+
+  TEST_CASE("rejects_truncated_or_padded")
+  {
+    std::vector<ts::Point> points;
+    for (std::int64_t i = 0; i < 50; ++i) {
+      points.push_back({i * i, std::sqrt(static_cast<double>(i))});
+    }
+    std::vector<std::byte> block;
+    ts::encode_points(block, "s", points);
+
+    std::string               arena;
+    std::vector<ts::KeyValue> batch;
+    for (std::size_t size = 0; size < block.size(); ++size) {
+      CHECK_FALSE(ts::expand_points(std::span(block).first(size), arena, batch));
+    }
+    std::vector<std::byte> padded = block;
+    padded.push_back(std::byte{0});
+    CHECK_FALSE(ts::expand_points(padded, arena, batch));
+
+    // a count no timestamp column could hold is refused before anything is sized for it
+    const std::byte huge[] = {std::byte{1},
+      std::byte{'s'},
+      std::byte{0xff},
+      std::byte{0xff},
+      std::byte{0x7f},
+      std::byte{0}};
+    CHECK_FALSE(ts::expand_points(huge, arena, batch));
+
+    // so is a count the value column is too short for (64 bits, then one more per point)
+    const std::byte no_values[] = {std::byte{1},
+      std::byte{'s'},
+      std::byte{2},
+      std::byte{2},
+      std::byte{0},
+      std::byte{0},
+      std::byte{0},
+      std::byte{0},
+      std::byte{0},
+      std::byte{0},
+      std::byte{0},
+      std::byte{0},
+      std::byte{0},
+      std::byte{0}};
+    CHECK_FALSE(ts::expand_points(no_values, arena, batch));
+
+    CHECK(ts::expand_points(block, arena, batch) == "s");
+  }
+
+  TEST_CASE("rejects_wide_value_window")
+  {
+    // two points at t = 0; v0 = 0.0, then '11', leading = 10, meaningful length 60 (10 + 60 > 64)
+    std::vector<std::byte> block = {std::byte{1},
+      std::byte{'s'},
+      std::byte{2},
+      std::byte{2},
+      std::byte{0},
+      std::byte{0}};
+    const std::vector<std::byte> values =
+      pack_bits(std::string(64, '0') + "11" + "01010" + "111011" + std::string(60, '1'));
+    block.insert(block.end(), values.begin(), values.end());
+
+    ts::PointDecoder decoder(block);
+    REQUIRE(decoder.ok());
+    CHECK(decoder.next());
+    CHECK_FALSE(decoder.next());
+    CHECK_FALSE(decoder.ok());
+
+    std::string               arena;
+    std::vector<ts::KeyValue> batch;
+    CHECK_FALSE(ts::expand_points(block, arena, batch));
+  }
+
+  TEST_CASE("max_expanded_bytes")
+  {
+    // the longest valid series at MAX_BLOCK_POINTS steady points is over the limit
+    std::vector<ts::Point> points(ts::MAX_BLOCK_POINTS);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      points[i] = {static_cast<std::int64_t>(i), 0.0};
+    }
+    const std::string      series(ts::MAX_SERIES_LEN, 's');
+    std::vector<std::byte> block;
+    ts::encode_points(block, series, points);
+    REQUIRE((series.size() + ts::POINT_KEY_SUFFIX + ts::SAMPLE_SIZE) * points.size() >
+            ts::MAX_EXPANDED_BYTES);
+
+    std::string               arena;
+    std::vector<ts::KeyValue> batch;
+    CHECK_FALSE(ts::expand_points(block, arena, batch));
+    CHECK(arena.capacity() < ts::MAX_EXPANDED_BYTES);
+
+    // and a series longer than MAX_SERIES_LEN is not a series at all
+    block.clear();
+    ts::encode_points(block, std::string(ts::MAX_SERIES_LEN + 1, 's'), {points.data(), 1});
+    CHECK_FALSE(ts::expand_points(block, arena, batch));
+  }
+
+  TEST_CASE("expand_points")
+  {
+    const std::vector<ts::Point> points = {{-10, 1.0}, {0, 2.0}, {10, 3.0}};
+    std::vector<std::byte>       block;
+    ts::encode_points(block, "mem", points);
+
+    std::string               arena;
+    std::vector<ts::KeyValue> batch;
+    REQUIRE(ts::expand_points(block, arena, batch) == "mem");
+    REQUIRE(batch.size() == 3);
+    for (std::size_t i = 0; i < 3; ++i) {
+      CHECK(batch[i].key == ts::point_key("mem", points[i].timestamp));
+      CHECK(ts::decode_sample(batch[i].value) == points[i].value);
+    }
+
+    // the series is checked like any other
+    block.clear();
+    ts::encode_points(block, std::string_view("a\0b", 3), points);
+    CHECK_FALSE(ts::expand_points(block, arena, batch));
+  }
+}